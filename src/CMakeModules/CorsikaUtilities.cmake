@@ -153,3 +153,47 @@ function (CORSIKA_ADD_TEST)
   endif ()
   add_test (NAME ${name} COMMAND ${name} -o ${PROJECT_BINARY_DIR}/test_outputs/junit-${name}.xml -s -r junit)
 endfunction (CORSIKA_ADD_TEST)
+
+#################################################
+#
+# central macro to register micro benchmarks in cmake
+#
+# Example: CORSIKA_ADD_BENCHMARK (benchmarkSomething)
+#
+# This generates target benchmarkSomething from file benchmarkSomething.cc,
+# or from the files given with the SOURCES keyword:
+#
+# Example: CORSIKA_ADD_BENCHMARK (benchmarkSomething
+#              SOURCES source1.cc source2.cc)
+#
+# Benchmarks are built with the normal build, so they do not rot, but
+# they are not registered with ctest since they measure run time
+# rather than correctness. Run them by hand, or all of them with the
+# target "run_benchmarks", which also writes the results as JSON to
+# benchmark_outputs/ in the build directory, see testing/Benchmark.h.
+function (CORSIKA_ADD_BENCHMARK)
+  cmake_parse_arguments (PARSE_ARGV 1 _ "" "" "SOURCES")
+
+  set (name ${ARGV0})
+
+  if (NOT __SOURCES)
+    set (sources ${name}.cc)
+  else ()
+    set (sources ${__SOURCES})
+  endif ()
+
+  add_executable (${name} ${sources})
+  target_include_directories (${name} PRIVATE ${CMAKE_CURRENT_SOURCE_DIR})
+  target_link_libraries (${name} CORSIKAtesting)
+
+  file (MAKE_DIRECTORY ${PROJECT_BINARY_DIR}/benchmark_outputs/)
+  add_custom_target (run_${name}
+    COMMAND ${CMAKE_COMMAND} -E env
+    CORSIKA_BENCHMARK_JSON=${PROJECT_BINARY_DIR}/benchmark_outputs/${name}.json
+    $<TARGET_FILE:${name}>
+    DEPENDS ${name})
+  if (NOT TARGET run_benchmarks)
+    add_custom_target (run_benchmarks)
+  endif ()
+  add_dependencies (run_benchmarks run_${name})
+endfunction (CORSIKA_ADD_BENCHMARK)
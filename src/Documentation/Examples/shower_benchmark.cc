@@ -0,0 +1,521 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+/**
+ * End-to-end benchmark of complete showers, for the comparison of
+ * releases: a matrix of primaries, energies and process sequences, each
+ * run with a fixed seed, in the setup of vertical_EAS (homogeneous air,
+ * here of the vertical depth of the atmosphere).
+ *
+ * For each configuration the wall and CPU time, the counters of the
+ * Cascade (steps, interactions, decays, particles), the peak stack size
+ * and the peak resident memory are measured and reported as a table, in
+ * CSV (--csv) and, via testing::BenchmarkReport, as JSON. With
+ * --baseline, the steps per second are compared to an earlier CSV file,
+ * and the program fails if a configuration got slower than --tolerance.
+ *
+ * There is no electromagnetic model yet, so photons only cross the
+ * atmosphere, and iron nuclei of 1 TeV are still below the energy range
+ * of NUCLIB.
+ *
+ * Each configuration runs in a child process: the Fortran models keep
+ * global state and cannot be initialized twice, the peak memory is that
+ * of the configuration alone, and a model aborting the program only
+ * fails its configuration. The standard output of the child, including
+ * that of the cascade and the models, goes to /dev/null. It is still
+ * formatted, as in a production run with the output redirected.
+ */
+
+#include <corsika/cascade/Cascade.h>
+#include <corsika/environment/Environment.h>
+#include <corsika/environment/HomogeneousMedium.h>
+#include <corsika/environment/NuclearComposition.h>
+#include <corsika/geometry/Sphere.h>
+#include <corsika/process/BoundaryCrossingProcess.h>
+#include <corsika/process/ProcessSequence.h>
+#include <corsika/process/null_model/NullModel.h>
+#include <corsika/process/particle_cut/ParticleCut.h>
+#include <corsika/process/sibyll/Decay.h>
+#include <corsika/process/sibyll/Interaction.h>
+#include <corsika/process/sibyll/NuclearInteraction.h>
+#include <corsika/process/switch_process/SwitchProcess.h>
+#include <corsika/process/tracking_line/TrackingLine.h>
+#include <corsika/process/urqmd/UrQMD.h>
+#include <corsika/random/RNGManager.h>
+#include <corsika/setup/SetupEnvironment.h>
+#include <corsika/setup/SetupStack.h>
+#include <corsika/testing/Benchmark.h>
+#include <corsika/units/PhysicalUnits.h>
+#include <corsika/utl/CorsikaFenv.h>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace corsika;
+using namespace corsika::process;
+using namespace corsika::units::si;
+
+namespace {
+
+  struct Primary {
+    std::string fName;
+    particles::Code fCode;
+    unsigned short fA = 0; //!< for nuclei only
+    unsigned short fZ = 0;
+  };
+
+  Primary GetPrimary(std::string const& vName) {
+    if (vName == "p") { return {vName, particles::Code::Proton}; }
+    if (vName == "Fe") { return {vName, particles::Code::Nucleus, 56, 26}; }
+    if (vName == "gamma") { return {vName, particles::Code::Gamma}; }
+    throw std::runtime_error("unknown primary " + vName + ", use p, Fe or gamma");
+  }
+
+  std::vector<std::string> const kModels = {"null", "sibyll", "sibyll+nuclib",
+                                            "sibyll+nuclib+urqmd"};
+
+  struct Options {
+    std::vector<std::string> fPrimaries = {"p", "Fe", "gamma"};
+    std::vector<double> fEnergies = {1e3, 1e4}; //!< in GeV
+    std::vector<std::string> fModels = kModels;
+    int fShowers = 1;
+    double fCut = 2; //!< in GeV, UrQMD gives up on nucleons close to threshold
+    uint64_t fSeed = 1;
+    std::string fCSV;
+    std::string fBaseline;
+    double fTolerance = 0.1;
+  };
+
+  std::vector<std::string> Split(std::string const& vList) {
+    std::vector<std::string> items;
+    std::istringstream in(vList);
+    for (std::string item; std::getline(in, item, ',');) {
+      if (!item.empty()) { items.push_back(item); }
+    }
+    return items;
+  }
+
+  Options ReadOptions(int const argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+      std::string const option = argv[i];
+      if (i + 1 == argc) { throw std::runtime_error("missing value of " + option); }
+      std::string const value = argv[++i];
+      if (option == "--primaries") {
+        options.fPrimaries = Split(value);
+      } else if (option == "--energies") {
+        options.fEnergies.clear();
+        for (auto const& e : Split(value)) { options.fEnergies.push_back(std::stod(e)); }
+      } else if (option == "--models") {
+        options.fModels = Split(value);
+        for (auto const& m : options.fModels) {
+          if (std::find(kModels.begin(), kModels.end(), m) == kModels.end()) {
+            throw std::runtime_error("unknown model " + m);
+          }
+        }
+      } else if (option == "--showers") {
+        options.fShowers = std::stoi(value);
+      } else if (option == "--cut") {
+        options.fCut = std::stod(value);
+      } else if (option == "--seed") {
+        options.fSeed = std::stoull(value);
+      } else if (option == "--csv") {
+        options.fCSV = value;
+      } else if (option == "--baseline") {
+        options.fBaseline = value;
+      } else if (option == "--tolerance") {
+        options.fTolerance = std::stod(value);
+      } else {
+        throw std::runtime_error("unknown option " + option);
+      }
+    }
+    return options;
+  }
+
+  void PrintUsage() {
+    std::cerr
+        << "usage: shower_benchmark [--primaries p,Fe,gamma] [--energies GeV,...]\n"
+           "         [--models null,sibyll,sibyll+nuclib,sibyll+nuclib+urqmd]\n"
+           "         [--showers N] [--cut GeV] [--seed N] [--csv file]\n"
+           "         [--baseline file.csv] [--tolerance fraction]"
+        << std::endl;
+  }
+
+  /// deletes the particles leaving the atmosphere
+  class Absorber : public BoundaryCrossingProcess<Absorber> {
+  public:
+    void Init() {}
+
+    template <typename TParticle, typename TNode>
+    EProcessReturn DoBoundaryCrossing(TParticle& vP, TNode const&, TNode const& vTo) {
+      if (!vTo.HasModelProperties()) { vP.Delete(); }
+      return EProcessReturn::eOk;
+    }
+  };
+
+  using EnvType = environment::Environment<setup::IEnvironmentModel>;
+
+  /// vertical depth of the homogeneous atmosphere, 1030 g/cm^2 at 1 kg/m^3
+  LengthType const kDepth = 10.3_km;
+
+  std::unique_ptr<EnvType> MakeAtmosphere() {
+    auto env = std::make_unique<EnvType>();
+    auto medium = EnvType::CreateNode<geometry::Sphere>(
+        geometry::Point{env->GetCoordinateSystem(), 0_m, 0_m, 0_m}, kDepth / 2);
+    medium->SetModelProperties<
+        environment::HomogeneousMedium<setup::IEnvironmentModel>>(
+        1_kg / (1_m * 1_m * 1_m),
+        environment::NuclearComposition(
+            std::vector<particles::Code>{particles::Code::Nitrogen,
+                                         particles::Code::Oxygen},
+            std::vector<float>{0.79f, 0.21f}));
+    env->GetUniverse()->AddChild(std::move(medium));
+    return env;
+  }
+
+  /// vertically downwards, from just below the top of the atmosphere
+  void AddPrimary(setup::Stack& vStack, Primary const& vPrimary,
+                  HEPEnergyType const vEnergy) {
+    auto const& rootCS =
+        geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+    HEPMassType const mass = vPrimary.fCode == particles::Code::Nucleus
+                                 ? particles::GetNucleusMass(vPrimary.fA, vPrimary.fZ)
+                                 : particles::GetMass(vPrimary.fCode);
+    HEPMomentumType const p = sqrt((vEnergy - mass) * (vEnergy + mass));
+    corsika::stack::MomentumVector const momentum(rootCS, {0_GeV, 0_GeV, -p});
+    geometry::Point const position(rootCS, {0_m, 0_m, kDepth / 2 - 1_m});
+    if (vPrimary.fCode == particles::Code::Nucleus) {
+      vStack.AddParticle(
+          std::tuple<particles::Code, HEPEnergyType, corsika::stack::MomentumVector,
+                     geometry::Point, TimeType, unsigned short, unsigned short>{
+              vPrimary.fCode, vEnergy, momentum, position, 0_ns, vPrimary.fA,
+              vPrimary.fZ});
+    } else {
+      vStack.AddParticle(
+          std::tuple<particles::Code, HEPEnergyType, corsika::stack::MomentumVector,
+                     geometry::Point, TimeType>{vPrimary.fCode, vEnergy, momentum,
+                                                position, 0_ns});
+    }
+  }
+
+  /**
+   * NullModel as ContinuousProcess, so that its maximum step length is
+   * applied and the shower of the primary has a number of steps.
+   */
+  class NullSteps : public ContinuousProcess<NullSteps> {
+  public:
+    explicit NullSteps(LengthType const vMaxStepLength)
+        : fNull(vMaxStepLength) {}
+
+    void Init() { fNull.Init(); }
+
+    template <typename TParticle, typename TTrack>
+    EProcessReturn DoContinuous(TParticle& vP, TTrack& vT) const {
+      return fNull.DoContinuous(vP, vT);
+    }
+    template <typename TParticle, typename TTrack>
+    LengthType MaxStepLength(TParticle& vP, TTrack& vT) const {
+      return fNull.MaxStepLength(vP, vT);
+    }
+
+  private:
+    null_model::NullModel fNull;
+  };
+
+  struct Measurement {
+    std::string fName;
+    int fShowers = 0;
+    double fWallSeconds = 0;
+    double fCPUSeconds = 0;
+    cascade::CascadeStatistics fStatistics;
+    std::size_t fParticles = 0; //!< primaries and secondaries
+    long fPeakRSS = 0;          //!< in kB
+    int fStatus = 0;            //!< of the child process, 0 if successful
+
+    double GetStepsPerSecond() const { return fStatistics.fSteps / fWallSeconds; }
+    double GetParticlesPerSecond() const { return fParticles / fWallSeconds; }
+  };
+
+  template <typename TSequence>
+  Measurement Measure(std::string const& vName, EnvType const& vEnv,
+                      TSequence& vSequence, Primary const& vPrimary,
+                      HEPEnergyType const vEnergy, Options const& vOptions) {
+    random::RNGManager::GetInstance().SeedAll(vOptions.fSeed);
+    setup::Stack stack;
+    process::tracking_line::TrackingLine tracking;
+    cascade::Cascade EAS(vEnv, tracking, vSequence, stack);
+
+    Measurement m;
+    m.fName = vName;
+    m.fShowers = vOptions.fShowers;
+    EAS.Init();
+    std::clock_t const cpuStart = std::clock();
+    auto const wallStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < vOptions.fShowers; ++i) {
+      stack.Clear();
+      AddPrimary(stack, vPrimary, vEnergy);
+      EAS.Run();
+    }
+    std::chrono::duration<double> const wall =
+        std::chrono::steady_clock::now() - wallStart;
+    m.fWallSeconds = wall.count();
+    m.fCPUSeconds = double(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    m.fStatistics = EAS.GetStatistics();
+    m.fParticles = vOptions.fShowers + m.fStatistics.fSecondaries;
+    return m;
+  }
+
+  Measurement Measure(std::string const& vName, Primary const& vPrimary,
+                      HEPEnergyType const vEnergy, std::string const& vModel,
+                      Options const& vOptions) {
+    std::string const name = vName;
+    auto const env = MakeAtmosphere();
+    Absorber absorber;
+
+    if (vModel == "null") {
+      NullSteps null(10_m);
+      auto sequence = null << absorber;
+      return Measure(name, *env, sequence, vPrimary, vEnergy, vOptions);
+    }
+
+    process::sibyll::Interaction sibyll;
+    process::sibyll::NuclearInteraction sibyllNuc(sibyll, *env);
+    process::sibyll::Decay decay;
+    process::particle_cut::ParticleCut cut(vOptions.fCut * 1_GeV);
+    sibyll.SetSecondaryFilter(cut.GetSecondaryFilter());
+    decay.SetSecondaryFilter(cut.GetSecondaryFilter());
+
+    if (vModel == "sibyll") {
+      auto sequence = sibyll << decay << cut << absorber;
+      return Measure(name, *env, sequence, vPrimary, vEnergy, vOptions);
+    }
+    if (vModel == "sibyll+nuclib") {
+      auto sequence = sibyll << sibyllNuc << decay << cut << absorber;
+      return Measure(name, *env, sequence, vPrimary, vEnergy, vOptions);
+    }
+    process::UrQMD::UrQMD urqmd;
+    urqmd.SetSecondaryFilter(cut.GetSecondaryFilter());
+    switch_process::SwitchProcess switchProcess(urqmd, sibyll, 55_GeV);
+    auto sequence = switchProcess << sibyllNuc << decay << cut << absorber;
+    return Measure(name, *env, sequence, vPrimary, vEnergy, vOptions);
+  }
+
+  /**
+   * Measures a configuration in a child process, see above. The results
+   * are passed back through a pipe.
+   */
+  Measurement MeasureInChild(Primary const& vPrimary, HEPEnergyType const vEnergy,
+                             std::string const& vModel, Options const& vOptions) {
+    std::ostringstream name;
+    name << vPrimary.fName << "/" << vEnergy / 1_GeV << "GeV/" << vModel;
+    Measurement m;
+    m.fName = name.str();
+    m.fShowers = vOptions.fShowers;
+
+    int fds[2];
+    if (pipe(fds) != 0) { throw std::runtime_error("shower_benchmark: no pipe"); }
+    std::cout.flush();
+    pid_t const pid = fork();
+    if (pid < 0) { throw std::runtime_error("shower_benchmark: fork failed"); }
+
+    if (pid == 0) {
+      close(fds[0]);
+      int const devNull = open("/dev/null", O_WRONLY);
+      dup2(devNull, STDOUT_FILENO);
+      Measurement const c = Measure(m.fName, vPrimary, vEnergy, vModel, vOptions);
+      auto const& s = c.fStatistics;
+      std::ostringstream out;
+      out << std::setprecision(17) << c.fWallSeconds << " " << c.fCPUSeconds << " "
+          << s.fSteps << " " << s.fInteractions << " " << s.fDecays << " "
+          << s.fBoundaryCrossings << " " << s.fSecondaries << " " << s.fMaxStackSize
+          << " " << c.fParticles;
+      std::string const result = out.str();
+      std::cout.flush();
+      bool const written =
+          write(fds[1], result.data(), result.size()) == ssize_t(result.size());
+      _exit(written ? 0 : 1);
+    }
+
+    close(fds[1]);
+    std::string result;
+    char buffer[256];
+    for (ssize_t n; (n = read(fds[0], buffer, sizeof(buffer))) > 0;) {
+      result.append(buffer, n);
+    }
+    close(fds[0]);
+
+    int status = 0;
+    rusage usage;
+    wait4(pid, &status, 0, &usage);
+    m.fPeakRSS = usage.ru_maxrss;
+    m.fStatus = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+
+    auto& s = m.fStatistics;
+    std::istringstream in(result);
+    if (!(in >> m.fWallSeconds >> m.fCPUSeconds >> s.fSteps >> s.fInteractions >>
+          s.fDecays >> s.fBoundaryCrossings >> s.fSecondaries >> s.fMaxStackSize >>
+          m.fParticles) &&
+        m.fStatus == 0) {
+      m.fStatus = -1;
+    }
+    return m;
+  }
+
+  void WriteCSV(std::ostream& vOut, std::vector<Measurement> const& vMeasurements) {
+    vOut << "configuration,showers,wall_s,cpu_s,steps,interactions,decays,"
+            "boundary_crossings,particles,max_stack_size,peak_rss_kB,steps_per_s,"
+            "particles_per_s\n";
+    for (auto const& m : vMeasurements) {
+      auto const& s = m.fStatistics;
+      vOut << m.fName << "," << m.fShowers << "," << m.fWallSeconds << ","
+           << m.fCPUSeconds << "," << s.fSteps << "," << s.fInteractions << ","
+           << s.fDecays << "," << s.fBoundaryCrossings << "," << m.fParticles << ","
+           << s.fMaxStackSize << "," << m.fPeakRSS << "," << m.GetStepsPerSecond()
+           << "," << m.GetParticlesPerSecond() << "\n";
+    }
+  }
+
+  /// the columns of the CSV file vFile, by configuration
+  std::map<std::string, std::map<std::string, std::string>> ReadCSV(
+      std::string const& vFile) {
+    std::ifstream in(vFile);
+    if (!in) { throw std::runtime_error("cannot read " + vFile); }
+    std::string line;
+    std::getline(in, line);
+    std::vector<std::string> const header = Split(line);
+    std::map<std::string, std::map<std::string, std::string>> rows;
+    while (std::getline(in, line)) {
+      std::vector<std::string> const fields = Split(line);
+      if (fields.size() != header.size()) { continue; }
+      for (std::size_t i = 1; i < fields.size(); ++i) {
+        rows[fields[0]][header[i]] = fields[i];
+      }
+    }
+    return rows;
+  }
+
+  /**
+   * Compares the steps per second to those of the baseline. Returns false
+   * if a configuration is slower by more than vTolerance.
+   */
+  bool CompareToBaseline(std::vector<Measurement> const& vMeasurements,
+                         std::string const& vFile, double const vTolerance) {
+    auto const baseline = ReadCSV(vFile);
+    bool ok = true;
+    std::cout << "\ncomparison to " << vFile << " (steps/s, tolerance "
+              << vTolerance * 100 << "%):\n";
+    for (auto const& m : vMeasurements) {
+      auto const row = baseline.find(m.fName);
+      if (row == baseline.end()) {
+        std::cout << std::left << std::setw(36) << m.fName << "not in baseline\n";
+        continue;
+      }
+      double const ratio =
+          m.GetStepsPerSecond() / std::stod(row->second.at("steps_per_s"));
+      bool const slower = ratio < 1 - vTolerance;
+      ok = ok && !slower;
+      std::cout << std::left << std::setw(36) << m.fName << std::right << std::fixed
+                << std::setprecision(3) << std::setw(8) << ratio
+                << (slower ? "  SLOWER" : "");
+      if (std::stoull(row->second.at("steps")) != m.fStatistics.fSteps) {
+        std::cout << "  (different shower: " << row->second.at("steps") << " steps)";
+      }
+      std::cout << "\n";
+    }
+    return ok;
+  }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  feenableexcept(FE_INVALID);
+
+  Options options;
+  try {
+    options = ReadOptions(argc, argv);
+  } catch (std::exception const& e) {
+    std::cerr << e.what() << std::endl;
+    PrintUsage();
+    return 1;
+  }
+
+  for (auto const* stream : {"cascade", "s_rndm", "UrQMD"}) {
+    random::RNGManager::GetInstance().RegisterRandomStream(stream);
+  }
+
+  std::vector<Measurement> measurements;
+  bool failed = false;
+  std::cout << std::left << std::setw(36) << "configuration" << std::right
+            << std::setw(10) << "wall/s" << std::setw(10) << "cpu/s" << std::setw(10)
+            << "steps" << std::setw(12) << "steps/s" << std::setw(12) << "particles/s"
+            << std::setw(10) << "stack" << std::setw(12) << "RSS/kB" << std::endl;
+  for (auto const& primaryName : options.fPrimaries) {
+    Primary const primary = GetPrimary(primaryName);
+    for (double const energy : options.fEnergies) {
+      for (auto const& model : options.fModels) {
+        Measurement const m = MeasureInChild(primary, energy * 1_GeV, model, options);
+        if (m.fStatus != 0) {
+          std::cout << std::left << std::setw(36) << m.fName << "failed, status "
+                    << m.fStatus << std::endl;
+          failed = true;
+          continue;
+        }
+        std::cout << std::left << std::setw(36) << m.fName << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(10) << m.fWallSeconds
+                  << std::setw(10) << m.fCPUSeconds << std::setw(10)
+                  << m.fStatistics.fSteps << std::setprecision(0) << std::setw(12)
+                  << m.GetStepsPerSecond() << std::setw(12) << m.GetParticlesPerSecond()
+                  << std::setw(10) << m.fStatistics.fMaxStackSize << std::setw(12)
+                  << m.fPeakRSS << std::endl;
+        measurements.push_back(m);
+
+        auto const& s = m.fStatistics;
+        testing::BenchmarkReport::GetInstance().Add(testing::BenchmarkResult{
+            m.fName,
+            std::size_t(m.fShowers),
+            m.fWallSeconds / m.fShowers * 1e9,
+            {{"cpu_time", m.fCPUSeconds / m.fShowers * 1e9},
+             {"steps", double(s.fSteps)},
+             {"interactions", double(s.fInteractions)},
+             {"decays", double(s.fDecays)},
+             {"particles", double(m.fParticles)},
+             {"max_stack_size", double(s.fMaxStackSize)},
+             {"peak_rss_kB", double(m.fPeakRSS)},
+             {"steps_per_second", m.GetStepsPerSecond()},
+             {"particles_per_second", m.GetParticlesPerSecond()}}});
+      }
+    }
+  }
+
+  if (!options.fCSV.empty()) {
+    std::ofstream csv(options.fCSV);
+    csv << std::setprecision(9);
+    WriteCSV(csv, measurements);
+  }
+  if (!options.fBaseline.empty() &&
+      !CompareToBaseline(measurements, options.fBaseline, options.fTolerance)) {
+    failed = true;
+  }
+  return failed ? 1 : 0;
+}
@@ -10,6 +10,7 @@
 
 #include <corsika/cascade/Cascade.h>
 #include <corsika/process/ProcessSequence.h>
+#include <corsika/process/cascade_equations/CascadeEquations.h>
 #include <corsika/process/energy_loss/EnergyLoss.h>
 #include <corsika/process/hadronic_elastic_model/HadronicElasticModel.h>
 #include <corsika/process/stack_inspector/StackInspector.h>
@@ -131,11 +132,33 @@ int main() {
   process::sibyll::Decay decay;
   process::particle_cut::ParticleCut cut(20_GeV);
 
+  // hybrid mode: hadrons below 1 TeV are handed to the cascade equations,
+  // with yields tabulated from sibyll, before its secondaries are filtered
+  using process::cascade_equations::CascadeEquations;
+  using process::cascade_equations::CascadeEquationsTable;
+  using process::cascade_equations::MonteCarloProfile;
+  std::vector<Code> const hadrons{Code::Proton, Code::Neutron, Code::PiPlus,
+                                  Code::PiMinus, Code::KPlus,   Code::KMinus};
+  CascadeEquationsTable table(hadrons, 20_GeV, 2, 7);
+  sibyll.Init();
+  table.TabulateInteractions(sibyll, env, Point(rootCS, 0_m, 0_m, 112.8_km), 20);
+  // vertical depth in the homogeneous atmosphere
+  auto const depth = [&](Point const& p) {
+    return (112.8_km - p.GetCoordinates(rootCS).GetZ()) * 1_kg / (1_m * 1_m * 1_m);
+  };
+  CascadeEquations cascadeEquations(table, 1_TeV, depth, 2000_g / (1_cm * 1_cm), 40);
+  MonteCarloProfile mcProfile(cascadeEquations, table);
+
+  // apply the cuts before the secondaries are written to the stack
+  sibyll.SetSecondaryFilter(cut.GetSecondaryFilter());
+  decay.SetSecondaryFilter(cut.GetSecondaryFilter());
+
   process::track_writer::TrackWriter trackWriter("tracks.dat");
   process::energy_loss::EnergyLoss eLoss;
 
   // assemble all processes into an ordered process list
-  auto sequence = sibyll << sibyllNuc << decay << eLoss << cut << stackInspect;
+  auto sequence = sibyll << sibyllNuc << decay << cascadeEquations << mcProfile << eLoss
+                         << cut << stackInspect;
 
   // define air shower object, run simulation
   cascade::Cascade EAS(env, tracking, sequence, stack);
@@ -144,9 +167,22 @@ int main() {
 
   eLoss.PrintProfile(); // print longitudinal profile
 
+  // longitudinal profiles of the hadrons, Monte-Carlo plus cascade equations
+  cout << "hadron profile  X [g/cm2]  N(X) of " << hadrons.size() << " types" << endl;
+  for (unsigned int bin = 0; bin < cascadeEquations.GetNumberOfDepthBins(); ++bin) {
+    cout << cascadeEquations.GetDepth(bin) / (1_g / (1_cm * 1_cm));
+    for (auto const code : hadrons) {
+      cout << " " << mcProfile.GetCombinedProfile(code)[bin];
+    }
+    cout << endl;
+  }
+  cout << "captured by cascade equations: "
+       << cascadeEquations.GetNumberOfCapturedParticles() << " particles, "
+       << cascadeEquations.GetCapturedEnergy() / 1_GeV << " GeV" << endl;
+
   cut.ShowResults();
-  const HEPEnergyType Efinal =
-      cut.GetCutEnergy() + cut.GetInvEnergy() + cut.GetEmEnergy();
+  const HEPEnergyType Efinal = cut.GetCutEnergy() + cut.GetInvEnergy() +
+                               cut.GetEmEnergy() + cascadeEquations.GetCapturedEnergy();
   cout << "total cut energy (GeV): " << Efinal / 1_GeV << endl
        << "relative difference (%): " << (Efinal / E0 - 1) * 100 << endl;
   cout << "total dEdX energy (GeV): " << eLoss.GetTotal() / 1_GeV << endl
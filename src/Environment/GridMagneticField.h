@@ -0,0 +1,138 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_environment_GridMagneticField_h_
+#define _include_environment_GridMagneticField_h_
+
+#include <corsika/geometry/CoordinateSystem.h>
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/Vector.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace corsika::environment {
+
+  /**
+   * A static magnetic field given on a regular 3-D grid, e.g. a slice of the
+   * geomagnetic field precomputed with IGRF. The field is interpolated tri-linearly
+   * between the grid points; outside of the grid the values at the border are used.
+   *
+   * The grid is defined in the coordinate system passed to the constructor. The file
+   * format is plain text, lines starting with '#' are comments:
+   *
+   * \verbatim
+     nx ny nz
+     x0/m y0/m z0/m
+     dx/m dy/m dz/m
+     Bx/T By/T Bz/T     (nx*ny*nz lines, x is the fastest running index)
+     \endverbatim
+   */
+  class GridMagneticField {
+  public:
+    using MagneticFieldVector =
+        corsika::geometry::Vector<corsika::units::si::magnetic_flux_density_d>;
+
+    GridMagneticField(corsika::geometry::CoordinateSystem const& vCS,
+                      std::string const& vFilename)
+        : fCS(vCS) {
+      std::ifstream file(vFilename);
+      if (!file) {
+        throw std::runtime_error("GridMagneticField: cannot open " + vFilename);
+      }
+
+      std::vector<double> numbers;
+      std::string line;
+      while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ls(line);
+        double x;
+        while (ls >> x) numbers.push_back(x);
+      }
+
+      if (numbers.size() < 9) {
+        throw std::runtime_error("GridMagneticField: incomplete header in " + vFilename);
+      }
+      for (int i = 0; i < 3; ++i) {
+        fN[i] = static_cast<int>(numbers[i]);
+        fOrigin[i] = numbers[3 + i];
+        fSpacing[i] = numbers[6 + i];
+        if (fN[i] < 1 || (fN[i] > 1 && fSpacing[i] <= 0)) {
+          throw std::runtime_error("GridMagneticField: invalid grid in " + vFilename);
+        }
+      }
+
+      size_t const nValues = 3 * size_t(fN[0]) * fN[1] * fN[2];
+      if (numbers.size() != 9 + nValues) {
+        throw std::runtime_error("GridMagneticField: wrong number of values in " +
+                                 vFilename);
+      }
+      fB.assign(numbers.begin() + 9, numbers.end());
+    }
+
+    MagneticFieldVector GetMagneticField(corsika::geometry::Point const& vP) const {
+      using namespace corsika::units::si;
+      auto const pos = vP.GetCoordinates(fCS);
+
+      // cell index and fractional position inside the cell for each dimension
+      std::array<int, 3> i0;
+      std::array<double, 3> f;
+      for (int k = 0; k < 3; ++k) {
+        if (fN[k] == 1) {
+          i0[k] = 0;
+          f[k] = 0;
+          continue;
+        }
+        double const u = std::clamp((pos[k] / 1_m - fOrigin[k]) / fSpacing[k], 0.,
+                                    double(fN[k] - 1));
+        i0[k] = std::min(int(u), fN[k] - 2);
+        f[k] = u - i0[k];
+      }
+
+      std::array<double, 3> b{0, 0, 0};
+      for (int corner = 0; corner < 8; ++corner) {
+        double w = 1;
+        std::array<int, 3> idx;
+        for (int k = 0; k < 3; ++k) {
+          int const up = (corner >> k) & 1;
+          if (up && fN[k] == 1) {
+            w = 0;
+            break;
+          }
+          idx[k] = i0[k] + up;
+          w *= up ? f[k] : 1 - f[k];
+        }
+        if (w == 0) continue;
+        size_t const offset =
+            3 * (idx[0] + size_t(fN[0]) * (idx[1] + size_t(fN[1]) * idx[2]));
+        for (int k = 0; k < 3; ++k) b[k] += w * fB[offset + k];
+      }
+
+      return MagneticFieldVector(fCS, b[0] * tesla, b[1] * tesla, b[2] * tesla);
+    }
+
+  private:
+    corsika::geometry::CoordinateSystem const& fCS;
+    std::array<int, 3> fN;
+    std::array<double, 3> fOrigin;  // in m
+    std::array<double, 3> fSpacing; // in m
+    std::vector<double> fB;         // in T, flat Bx,By,Bz per grid point
+  };
+
+} // namespace corsika::environment
+
+#endif
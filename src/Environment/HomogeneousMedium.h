@@ -44,6 +44,10 @@ namespace corsika::environment {
     }
     NuclearComposition const& GetNuclearComposition() const override { return fNuclComp; }
 
+    corsika::units::si::MassDensityType GetMajorantMassDensity() const override {
+      return fDensity;
+    }
+
     corsika::units::si::GrammageType IntegratedGrammage(
         corsika::geometry::Trajectory<corsika::geometry::Line> const&,
         corsika::units::si::LengthType pTo) const override {
@@ -17,6 +17,8 @@
 #include <corsika/geometry/Trajectory.h>
 #include <corsika/units/PhysicalUnits.h>
 
+#include <limits>
+
 namespace corsika::environment {
 
   class IMediumModel {
@@ -37,6 +39,16 @@ namespace corsika::environment {
         corsika::units::si::GrammageType) const = 0;
 
     virtual NuclearComposition const& GetNuclearComposition() const = 0;
+
+    /**
+     * Upper bound of GetMassDensity() within the volume this medium is
+     * assigned to, used for delta (Woodcock) tracking. Infinity means that
+     * no bound is known, then the grammage integration is used.
+     */
+    virtual corsika::units::si::MassDensityType GetMajorantMassDensity() const {
+      return corsika::units::si::MassDensityType(
+          phys::units::detail::magnitude_tag, std::numeric_limits<double>::infinity());
+    }
   };
 
 } // namespace corsika::environment
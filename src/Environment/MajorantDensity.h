@@ -0,0 +1,51 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_environment_MajorantDensity_h_
+#define _include_environment_MajorantDensity_h_
+
+#include <corsika/units/PhysicalUnits.h>
+
+#include <stdexcept>
+#include <utility>
+
+namespace corsika::environment {
+
+  /**
+   * Adds an explicit upper bound of the mass density to any medium model T,
+   * which enables delta (Woodcock) tracking in media without a known bound,
+   * e.g. exponential atmospheres. The bound must hold in the whole volume the
+   * medium is assigned to; this is not checked.
+   *
+   * Example: <code>MajorantDensity<FlatExponential<IMediumModel>>(rhoMax, p0,
+   * axis, rho0, lambda, composition)</code>
+   */
+  template <class T>
+  class MajorantDensity : public T {
+    corsika::units::si::MassDensityType const fMajorant;
+
+  public:
+    template <typename... TArgs>
+    MajorantDensity(corsika::units::si::MassDensityType vMajorant, TArgs&&... vArgs)
+        : T(std::forward<TArgs>(vArgs)...)
+        , fMajorant(vMajorant) {
+      if (vMajorant.magnitude() < 0) {
+        throw std::runtime_error("MajorantDensity: negative majorant density");
+      }
+    }
+
+    corsika::units::si::MassDensityType GetMajorantMassDensity() const override {
+      return fMajorant;
+    }
+  };
+
+} // namespace corsika::environment
+
+#endif
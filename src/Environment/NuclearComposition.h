@@ -15,6 +15,8 @@
 #include <corsika/units/PhysicalUnits.h>
 
 #include <cassert>
+#include <cstddef>
+#include <limits>
 #include <numeric>
 #include <random>
 #include <stdexcept>
@@ -28,35 +30,6 @@ namespace corsika::environment {
 
     double const fAvgMassNumber;
 
-    template <class AConstIterator, class BConstIterator>
-    class WeightProviderIterator {
-      AConstIterator fAIter;
-      BConstIterator fBIter;
-
-    public:
-      using value_type = double;
-      using iterator_category = std::input_iterator_tag;
-      using pointer = value_type*;
-      using reference = value_type&;
-      using difference_type = ptrdiff_t;
-
-      WeightProviderIterator(AConstIterator a, BConstIterator b)
-          : fAIter(a)
-          , fBIter(b) {}
-
-      value_type operator*() const { return ((*fAIter) * (*fBIter)).magnitude(); }
-
-      WeightProviderIterator& operator++() { // prefix ++
-        ++fAIter;
-        ++fBIter;
-        return *this;
-      }
-
-      auto operator==(WeightProviderIterator other) { return fAIter == other.fAIter; }
-
-      auto operator!=(WeightProviderIterator other) { return !(*this == other); }
-    };
-
   public:
     NuclearComposition(std::vector<corsika::particles::Code> pComponents,
                        std::vector<float> pFractions)
@@ -109,24 +82,38 @@ namespace corsika::environment {
     auto const& GetComponents() const { return fComponents; }
     auto const GetAverageMassNumber() const { return fAvgMassNumber; }
 
-    template <class TRNG>
-    corsika::particles::Code SampleTarget(
-        std::vector<corsika::units::si::CrossSectionType> const& sigma,
-        TRNG& randomStream) const {
-      using namespace corsika::units::si;
-
-      assert(sigma.size() == fNumberFractions.size());
-
-      std::discrete_distribution channelDist(
-          WeightProviderIterator<decltype(fNumberFractions.begin()),
-                                 decltype(sigma.begin())>(fNumberFractions.begin(),
-                                                          sigma.begin()),
-          WeightProviderIterator<decltype(fNumberFractions.begin()),
-                                 decltype(sigma.end())>(fNumberFractions.end(),
-                                                        sigma.end()));
-
-      auto const iChannel = channelDist(randomStream);
-      return fComponents[iChannel];
+    /**
+     * Samples a target component according to the number fractions
+     * weighted by the cross sections vSigma, which can be any container
+     * of CrossSectionType, e.g. a std::pmr::vector in the
+     * utl::GetStepResource().
+     *
+     * The result and the random numbers used are those of
+     * std::discrete_distribution (as in libstdc++), without building its
+     * tables on the heap.
+     */
+    template <class TSigma, class TRNG>
+    corsika::particles::Code SampleTarget(TSigma const& vSigma,
+                                          TRNG& randomStream) const {
+      std::size_t const n = vSigma.size();
+      assert(n == fNumberFractions.size());
+      if (n < 2) { return fComponents[0]; }
+
+      auto const weight = [&](std::size_t const i) {
+        return (fNumberFractions[i] * vSigma[i]).magnitude();
+      };
+      double sum = 0;
+      for (std::size_t i = 0; i < n; ++i) { sum += weight(i); }
+
+      double const random =
+          std::generate_canonical<double, std::numeric_limits<double>::digits>(
+              randomStream);
+      double cumulative = 0;
+      for (std::size_t i = 0; i < n - 1; ++i) {
+        cumulative += weight(i) / sum;
+        if (random <= cumulative) { return fComponents[i]; }
+      }
+      return fComponents[n - 1];
     }
   };
 
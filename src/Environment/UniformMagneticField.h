@@ -0,0 +1,41 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_environment_UniformMagneticField_h_
+#define _include_environment_UniformMagneticField_h_
+
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/Vector.h>
+#include <corsika/units/PhysicalUnits.h>
+
+namespace corsika::environment {
+
+  /**
+   * A static magnetic field, which is the same everywhere.
+   */
+  class UniformMagneticField {
+  public:
+    using MagneticFieldVector =
+        corsika::geometry::Vector<corsika::units::si::magnetic_flux_density_d>;
+
+    UniformMagneticField(MagneticFieldVector const& vB)
+        : fB(vB) {}
+
+    MagneticFieldVector GetMagneticField(corsika::geometry::Point const&) const {
+      return fB;
+    }
+
+  private:
+    MagneticFieldVector const fB;
+  };
+
+} // namespace corsika::environment
+
+#endif
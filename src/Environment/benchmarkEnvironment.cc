@@ -0,0 +1,57 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+/**
+ * Sampling of the target nucleus of an interaction with
+ * NuclearComposition::SampleTarget, for air and for a mixture of ten
+ * components, and the weighted sums over the components.
+ */
+
+#include <corsika/environment/NuclearComposition.h>
+#include <corsika/particles/ParticleProperties.h>
+#include <corsika/testing/Benchmark.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace corsika;
+using namespace corsika::units::si;
+using corsika::environment::NuclearComposition;
+using corsika::particles::Code;
+using corsika::testing::DoNotOptimize;
+using corsika::testing::RunBenchmark;
+
+void Run(std::string const& vLabel, NuclearComposition const& vComposition) {
+  std::vector<CrossSectionType> sigma;
+  for (std::size_t i = 0; i < vComposition.size(); ++i) {
+    sigma.push_back((100 + 10 * i) * 1_mb);
+  }
+  std::mt19937 rng(42);
+
+  RunBenchmark("SampleTarget" + vLabel, [&]() {
+    DoNotOptimize(vComposition.SampleTarget(sigma, rng));
+  });
+  RunBenchmark("WeightedSum" + vLabel, [&]() {
+    DoNotOptimize(vComposition.WeightedSum(
+        [](Code const vCode) { return particles::GetMass(vCode); }));
+  });
+}
+
+int main() {
+  Run(" (air)",
+      NuclearComposition({Code::Nitrogen, Code::Oxygen, Code::Argon},
+                         {0.78f, 0.21f, 0.01f}));
+
+  std::vector<Code> const components(10, Code::Oxygen);
+  std::vector<float> const fractions(10, 0.1f);
+  Run(" (10 components)", NuclearComposition(components, fractions));
+}
@@ -10,12 +10,14 @@
 
 #include <corsika/environment/DensityFunction.h>
 #include <corsika/environment/FlatExponential.h>
+#include <corsika/environment/GridMagneticField.h>
 #include <corsika/environment/HomogeneousMedium.h>
 #include <corsika/environment/IMediumModel.h>
 #include <corsika/environment/InhomogeneousMedium.h>
 #include <corsika/environment/LinearApproximationIntegrator.h>
 #include <corsika/environment/NuclearComposition.h>
 #include <corsika/environment/SlidingPlanarExponential.h>
+#include <corsika/environment/UniformMagneticField.h>
 #include <corsika/environment/VolumeTreeNode.h>
 #include <corsika/geometry/Line.h>
 #include <corsika/geometry/RootCoordinateSystem.h>
@@ -25,6 +27,8 @@
 
 #include <catch2/catch.hpp>
 
+#include <fstream>
+
 using namespace corsika::geometry;
 using namespace corsika::environment;
 using namespace corsika::particles;
@@ -196,3 +200,41 @@ TEST_CASE("InhomogeneousMedium") {
             inhMedium.ArclengthFromGrammage(trajectory, 20_g / (1_cm * 1_cm)));
   }
 }
+
+TEST_CASE("MagneticField") {
+  SECTION("uniform") {
+    UniformMagneticField const field(
+        Vector<magnetic_flux_density_d>(gCS, 0 * tesla, 20e-6 * tesla, -40e-6 * tesla));
+    auto const b = field.GetMagneticField(Point(gCS, 1_km, 2_km, 3_km));
+    REQUIRE(b.GetComponents(gCS)[1] / tesla == Approx(20e-6));
+    REQUIRE(b.GetComponents(gCS)[2] / tesla == Approx(-40e-6));
+  }
+
+  SECTION("grid") {
+    // 2x2x1 grid, B_z grows linearly with x, B_x with y
+    {
+      std::ofstream file("testGridMagneticField.dat");
+      file << "# test grid\n"
+           << "2 2 1\n"
+           << "0 0 0\n"
+           << "10 10 1\n"
+           << "0 0 1\n"
+           << "0 0 3\n"
+           << "2 0 1\n"
+           << "2 0 3\n";
+    }
+    GridMagneticField const field(gCS, "testGridMagneticField.dat");
+
+    auto const b = field.GetMagneticField(Point(gCS, 2.5_m, 5_m, 0_m));
+    REQUIRE(b.GetComponents(gCS)[0] / tesla == Approx(1));
+    REQUIRE(b.GetComponents(gCS)[1] / tesla == Approx(0).margin(1e-12));
+    REQUIRE(b.GetComponents(gCS)[2] / tesla == Approx(1.5));
+
+    // outside of the grid the border values are used
+    auto const bOut = field.GetMagneticField(Point(gCS, 20_m, -5_m, 7_m));
+    REQUIRE(bOut.GetComponents(gCS)[0] / tesla == Approx(0).margin(1e-12));
+    REQUIRE(bOut.GetComponents(gCS)[2] / tesla == Approx(3));
+
+    REQUIRE_THROWS(GridMagneticField(gCS, "doesNotExist.dat"));
+  }
+}
@@ -11,6 +11,8 @@
 #ifndef _include_corsika_cascade_Cascade_h_
 #define _include_corsika_cascade_Cascade_h_
 
+#include <corsika/cascade/DeltaTracking.h>
+#include <corsika/cascade/ParticleBatch.h>
 #include <corsika/environment/Environment.h>
 #include <corsika/process/ProcessReturn.h>
 #include <corsika/random/ExponentialDistribution.h>
@@ -18,6 +20,8 @@
 #include <corsika/random/UniformRealDistribution.h>
 #include <corsika/stack/SecondaryView.h>
 #include <corsika/units/PhysicalUnits.h>
+#include <corsika/utl/StepArena.h>
+#include <corsika/utl/Tracer.h>
 
 #include <corsika/setup/SetupTrajectory.h>
 
@@ -29,11 +33,15 @@
  */
 #include <corsika/setup/SetupStack.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <iostream>
 #include <limits>
+#include <stdexcept>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <boost/type_index.hpp>
 using boost::typeindex::type_id_with_cvr;
@@ -44,6 +52,41 @@ using boost::typeindex::type_id_with_cvr;
 
 namespace corsika::cascade {
 
+  /**
+   * How the distance to the next interaction is determined in Cascade::Step.
+   */
+  enum class StepStrategy {
+    /// sample the grammage and convert it into a length by
+    /// IMediumModel::ArclengthFromGrammage (default)
+    eGrammageIntegration,
+    /// delta (Woodcock) tracking against IMediumModel::GetMajorantMassDensity,
+    /// see DeltaTracking.h. Volumes without a finite majorant, and steps
+    /// without a finite length limit, still use eGrammageIntegration.
+    eDeltaTracking
+  };
+
+  /**
+   * Counters of the work done by a Cascade, see Cascade::GetStatistics().
+   */
+  struct CascadeStatistics {
+    std::size_t fSteps = 0;
+    std::size_t fInteractions = 0;
+    std::size_t fDecays = 0;
+    std::size_t fBoundaryCrossings = 0;
+    std::size_t fSecondaries = 0;  //!< particles produced by interactions and decays
+    std::size_t fMaxStackSize = 0; //!< largest number of particles on the Stack
+  };
+
+  // to detect a tracking that can treat a whole ParticleBatch at once
+  template <typename T, typename TBatch, typename = void>
+  struct has_batch_tracking : std::false_type {};
+
+  template <typename T, typename TBatch>
+  struct has_batch_tracking<
+      T, TBatch,
+      std::void_t<decltype(std::declval<T&>().GetTracks(std::declval<TBatch&>()))>>
+      : std::true_type {};
+
   /**
    * \class Cascade
    *
@@ -54,12 +97,16 @@ namespace corsika::cascade {
    * <b>TTracking</b> must be a class according to the
    * TrackingInterface providing the functions:
    * <code>auto GetTrack(Particle const& p)</auto>,
-   * with the return type <code>geometry::Trajectory<corsika::geometry::Line>
-   * </code>
+   * with the return type <code>std::tuple(geometry::Trajectory<T>, LengthType,
+   * VolumeTreeNode const*)</code>, where T is either <code>geometry::Line</code> or
+   * <code>geometry::Helix</code>. If the tracking limits the step itself without
+   * reaching a volume boundary, it returns the current volume as next volume.
    *
    * <b>TProcessList</b> must be a ProcessSequence.   *
    * <b>Stack</b> is the storage object for particle data, i.e. with
-   * Particle class type <code>Stack::ParticleType</code>
+   * Particle class type <code>Stack::ParticleType</code>. The particles are
+   * processed in the order of <code>Stack::GetNextParticle()</code>, see
+   * stack::ordered::OrderedStack for alternatives to LIFO.
    *
    *
    */
@@ -96,16 +143,72 @@ namespace corsika::cascade {
      * All components of the Cascade simulation must be configured here.
      */
     void Init() {
+      utl::TraceScope const trace("Cascade::Init", "Cascade");
       fProcessSequence.Init();
       fStack.Init();
     }
 
+    /**
+     * Select how the distance to the next interaction is sampled, see
+     * StepStrategy.
+     */
+    void SetStepStrategy(StepStrategy const vStrategy) { fStepStrategy = vStrategy; }
+    StepStrategy GetStepStrategy() const { return fStepStrategy; }
+
+    /**
+     * Use vRNG instead of the "cascade" stream of the RNGManager, e.g. the
+     * stream of a sub-shower, see SubShowerScheduler.
+     */
+    void SetRNG(corsika::random::RNG& vRNG) { fRNG = &vRNG; }
+
+    /**
+     * Lineage-keyed random numbers: at the start of every step the random
+     * streams are re-keyed with the next step key of the particle, see
+     * stack::lineage::LineageData. The random numbers of a particle then
+     * depend only on its ancestry, so that the shower does not depend on
+     * the order of the stack or on how it is split up, e.g. by
+     * SubShowerScheduler. A particle type without lineage key throws
+     * std::runtime_error; setup::Stack has it only if configured
+     * WITH_LINEAGE_STACK.
+     *
+     * With vAllStreams all streams of the RNGManager are re-keyed as well,
+     * including those of the Fortran models, see RNGManager::SetLineageKey.
+     * This is not thread-safe, use vAllStreams = false for more than one
+     * worker of a SubShowerScheduler. In RunBatched(), the random numbers
+     * of batched continuous processes are not covered.
+     *
+     * Philox4x32 (CORSIKA_PHILOX_RNG) is recommended, as re-keying a
+     * std::mt19937 is expensive.
+     */
+    void SetLineageRNG(bool const vLineage, bool const vAllStreams = true) {
+      if (vLineage && !stack::lineage::has_lineage_key<Particle>::value) {
+        throw std::runtime_error("Cascade: the particles have no lineage key");
+      }
+      fLineageRNG = vLineage;
+      fLineageAllStreams = vAllStreams;
+    }
+    bool GetLineageRNG() const { return fLineageRNG; }
+
+    /**
+     * The memory for temporaries of the tracking and the processes, which
+     * is reset after each Step(), see utl::StepArena.
+     */
+    utl::StepArena const& GetStepArena() const { return fStepArena; }
+
+    /**
+     * The counters of all Run() and RunBatched() since the construction or
+     * the last ResetStatistics().
+     */
+    CascadeStatistics const& GetStatistics() const { return fStatistics; }
+    void ResetStatistics() { fStatistics = CascadeStatistics(); }
+
     /**
      * set the nodes for all particles on the stack according to their numerical
-     * position
+     * position, unless a node is already assigned
      */
     void SetNodes() {
       std::for_each(fStack.begin(), fStack.end(), [&](auto& p) {
+        if (p.GetNode()) { return; } // e.g. restored from a checkpoint
         auto const* numericalNode =
             fEnvironment.GetUniverse()->GetContainingNode(p.GetPosition());
         p.SetNode(numericalNode);
@@ -117,21 +220,132 @@ namespace corsika::cascade {
      * particles from the Stack until the Stack is empty.
      */
     void Run() {
+      utl::TraceScope const trace("Cascade::Run", "Cascade");
       SetNodes();
 
       while (!fStack.IsEmpty()) {
         while (!fStack.IsEmpty()) {
+          CountStackSize();
           auto pNext = fStack.GetNextParticle();
           Step(pNext);
           fProcessSequence.DoStack(fStack);
         }
         // do cascade equations, which can put new particles on Stack,
         // thus, the double loop
-        // DoCascadeEquations();
+        utl::TraceScope const traceEquations("DoCascadeEquations", "Cascade");
+        fProcessSequence.DoCascadeEquations(fStack);
+      }
+    }
+
+    /**
+     * Alternative to Run() for straight-line tracking: particles of the
+     * same type in the same volume are taken from the top of the Stack in
+     * batches of up to vMaxBatchSize, see ParticleBatch.
+     *
+     * The tracking, if it provides <code>GetTracks(ParticleBatch&)</code>,
+     * and the ContinuousProcesses with batched interface treat a whole
+     * batch at once. The rest, in particular interactions and decays, is
+     * done per particle as in Run(). StackProcesses are executed once per
+     * batch. With an OrderedStack only the first particle of each batch is
+     * selected according to the StackOrder.
+     */
+    void RunBatched(std::size_t const vMaxBatchSize = 256) {
+      utl::TraceScope const trace("Cascade::RunBatched", "Cascade");
+      SetNodes();
+      ParticleBatch<TStack> batch(fStack);
+
+      while (!fStack.IsEmpty()) {
+        while (!fStack.IsEmpty()) {
+          CountStackSize();
+          batch.Gather(vMaxBatchSize);
+          StepBatch(batch);
+          fProcessSequence.DoStack(fStack);
+        }
+        utl::TraceScope const traceEquations("DoCascadeEquations", "Cascade");
+        fProcessSequence.DoCascadeEquations(fStack);
       }
     }
 
   private:
+    void CountStackSize() {
+      fStatistics.fMaxStackSize =
+          std::max(fStatistics.fMaxStackSize, std::size_t(fStack.GetSize()));
+    }
+
+    /**
+     * The batched version of Step(), see RunBatched().
+     */
+    void StepBatch(ParticleBatch<TStack>& vBatch) {
+      using namespace corsika::units::si;
+      utl::TraceStep const traceStep("StepBatch");
+      utl::StepArena::Scope const arenaScope(fStepArena);
+      std::size_t const n = vBatch.GetSize();
+      auto const& medium = vBatch.GetNode()->GetModelProperties();
+      fStatistics.fSteps += n;
+
+      // geometric limits
+      {
+        utl::TraceScope const trace("Tracking", "Cascade");
+        if constexpr (has_batch_tracking<TTracking, ParticleBatch<TStack>>::value) {
+          fTracking.GetTracks(vBatch);
+        } else {
+          for (std::size_t i = 0; i < n; ++i) {
+            auto const particle = vBatch.GetParticle(i);
+            auto const [step, geomMaxLength, nextVol] = fTracking.GetTrack(particle);
+            static_assert(std::is_same_v<std::decay_t<decltype(step)>,
+                                         geometry::Trajectory<geometry::Line>>,
+                          "Cascade::RunBatched needs straight-line tracking");
+            vBatch.GetStepLength()[i] = geomMaxLength.magnitude();
+            vBatch.GetNextNode()[i] = nextVol;
+          }
+        }
+      }
+      fProcessSequence.MaxStepLengthBatch(vBatch);
+
+      // the distances to interaction and decay, per particle
+      fBatchLimits.resize(n);
+      fBatchStepLength.resize(n);
+      fBatchKeys.resize(n);
+      for (std::size_t i = 0; i < n; ++i) {
+        auto particle = vBatch.GetParticle(i);
+        fBatchKeys[i] = SeedStep(particle);
+        auto const track = vBatch.GetTrajectory(i);
+        LengthType const geomMaxLength(phys::units::detail::magnitude_tag,
+                                       vBatch.GetStepLength()[i]);
+        LengthType const distance_max(phys::units::detail::magnitude_tag,
+                                      vBatch.GetMaxStepLength()[i]);
+        LengthType const distance_interact = SampleInteractionDistance(
+            medium, track, fProcessSequence.GetTotalInverseInteractionLength(particle),
+            std::min(distance_max, geomMaxLength));
+        LengthType const distance_decay = SampleDecayDistance(particle);
+        LengthType const min_distance =
+            std::min({distance_interact, distance_decay, distance_max, geomMaxLength});
+        fBatchLimits[i] = StepLimits{distance_interact, distance_decay, distance_max,
+                                     geomMaxLength, min_distance};
+        fBatchStepLength[i] = min_distance.magnitude();
+      }
+
+      // transport and continuous processes for the whole batch
+      vBatch.Move(fBatchStepLength);
+      {
+        utl::TraceScope const trace("DoContinuousBatch", "Cascade");
+        fProcessSequence.DoContinuousBatch(vBatch);
+      }
+      vBatch.Scatter();
+
+      // from the top of the stack downwards, so that deleting particles and
+      // adding secondaries does not move the particles still to be done
+      for (std::size_t i = 0; i < n; ++i) {
+        auto particle = vBatch.GetParticle(i);
+        if (vBatch.GetAbsorbed()[i]) {
+          particle.Delete();
+        } else {
+          if (fLineageRNG) { SeedStreams(~fBatchKeys[i]); }
+          FinishStep(particle, fBatchLimits[i], vBatch.GetNextNode()[i]);
+        }
+      }
+    }
+
     /**
      * The Step function is executed for each particle from the
      * stack. It will calcualte geometric transport of the particles,
@@ -146,21 +360,22 @@ namespace corsika::cascade {
       using namespace corsika;
       using namespace corsika::units::si;
 
+      utl::TraceStep const traceStep;
+      utl::StepArena::Scope const arenaScope(fStepArena);
+      ++fStatistics.fSteps;
+      SeedStep(vParticle);
+
       // determine geometric tracking
-      auto [step, geomMaxLength, nextVol] = fTracking.GetTrack(vParticle);
+      auto [step, geomMaxLength, nextVol] = [&] {
+        utl::TraceScope const trace("Tracking", "Cascade");
+        return fTracking.GetTrack(vParticle);
+      }();
       [[maybe_unused]] auto const& dummy_nextVol = nextVol;
 
       // determine combined total interaction length (inverse)
       InverseGrammageType const total_inv_lambda =
           fProcessSequence.GetTotalInverseInteractionLength(vParticle);
 
-      // sample random exponential step length in grammage
-      corsika::random::ExponentialDistribution expDist(1 / total_inv_lambda);
-      GrammageType const next_interact = expDist(fRNG);
-
-      std::cout << "total_inv_lambda=" << total_inv_lambda
-                << ", next_interact=" << next_interact << std::endl;
-
       auto const* currentLogicalNode = vParticle.GetNode();
 
       // assert that particle stays outside void Universe if it has no
@@ -168,28 +383,19 @@ namespace corsika::cascade {
       assert(currentLogicalNode != &*fEnvironment.GetUniverse() ||
              fEnvironment.GetUniverse()->HasModelProperties());
 
-      // convert next_step from grammage to length
-      LengthType const distance_interact =
-          currentLogicalNode->GetModelProperties().ArclengthFromGrammage(step,
-                                                                         next_interact);
+      auto const& medium = currentLogicalNode->GetModelProperties();
 
       // determine the maximum geometric step length
       LengthType const distance_max = fProcessSequence.MaxStepLength(vParticle, step);
       std::cout << "distance_max=" << distance_max << std::endl;
 
-      // determine combined total inverse decay time
-      InverseTimeType const total_inv_lifetime =
-          fProcessSequence.GetTotalInverseLifetime(vParticle);
-
-      // sample random exponential decay time
-      corsika::random::ExponentialDistribution expDistDecay(1 / total_inv_lifetime);
-      TimeType const next_decay = expDistDecay(fRNG);
-      std::cout << "total_inv_lifetime=" << total_inv_lifetime
-                << ", next_decay=" << next_decay << std::endl;
+      LengthType const distance_interact = SampleInteractionDistance(
+          medium, step, total_inv_lambda, std::min(distance_max, geomMaxLength));
+      std::cout << "total_inv_lambda=" << total_inv_lambda
+                << ", distance_interact=" << distance_interact << std::endl;
 
-      // convert next_decay from time to length [m]
-      LengthType const distance_decay = next_decay * vParticle.GetMomentum().norm() /
-                                        vParticle.GetEnergy() * units::constants::c;
+      LengthType const distance_decay = SampleDecayDistance(vParticle);
+      std::cout << "distance_decay=" << distance_decay << std::endl;
 
       // take minimum of geometry, interaction, decay for next step
       auto const min_distance =
@@ -205,6 +411,13 @@ namespace corsika::cascade {
 
       step.LimitEndTo(min_distance);
 
+      if constexpr (!std::is_same_v<std::decay_t<decltype(step)>,
+                                    geometry::Trajectory<geometry::Line>>) {
+        // on a curved trajectory also the direction of the momentum changes
+        auto const direction = step.GetVelocity(step.GetDuration()).normalized();
+        vParticle.SetMomentum(direction * vParticle.GetMomentum().GetNorm());
+      }
+
       // apply all continuous processes on particle + track
       process::EProcessReturn status = fProcessSequence.DoContinuous(vParticle, step);
 
@@ -218,7 +431,96 @@ namespace corsika::cascade {
       std::cout << "sth. happening before geometric limit ? "
                 << ((min_distance < geomMaxLength) ? "yes" : "no") << std::endl;
 
-      if (min_distance < geomMaxLength) { // interaction to happen within geometric limit
+      FinishStep(vParticle,
+                 StepLimits{distance_interact, distance_decay, distance_max,
+                            geomMaxLength, min_distance},
+                 nextVol);
+    }
+
+    /// the candidates for the length of a step, and the length taken
+    struct StepLimits {
+      units::si::LengthType fInteraction, fDecay, fContinuous, fGeometry, fStep;
+    };
+
+    /// in lineage mode, re-keys the streams for the next step of vParticle
+    uint64_t SeedStep(Particle& vParticle) {
+      if constexpr (stack::lineage::has_lineage_key<Particle>::value) {
+        if (fLineageRNG) {
+          uint64_t const key = vParticle.NextStepKey();
+          SeedStreams(key);
+          return key;
+        }
+      }
+      return 0;
+    }
+
+    void SeedStreams(uint64_t const vKey) {
+      auto& rngManager = corsika::random::RNGManager::GetInstance();
+      if (fLineageAllStreams) { rngManager.SetLineageKey(vKey); }
+      corsika::random::RNGManager::SeedLineage(*fRNG, vKey, fCascadeStreamId);
+    }
+
+    /**
+     * Samples the distance to the next interaction along vTrack, which is
+     * limited to vStepLimit, according to the StepStrategy.
+     */
+    template <typename TTrack>
+    units::si::LengthType SampleInteractionDistance(
+        MediumInterface const& vMedium, TTrack const& vTrack,
+        units::si::InverseGrammageType const vTotalInvLambda,
+        units::si::LengthType const vStepLimit) {
+      if (fStepStrategy == StepStrategy::eDeltaTracking &&
+          std::isfinite(vMedium.GetMajorantMassDensity().magnitude()) &&
+          std::isfinite(vStepLimit.magnitude())) {
+        return DeltaTrackingDistance(vMedium, vTrack, vTotalInvLambda, vStepLimit, *fRNG);
+      }
+      // sample random exponential step length in grammage
+      corsika::random::ExponentialDistribution expDist(1 / vTotalInvLambda);
+      units::si::GrammageType const next_interact = expDist(*fRNG);
+      // convert next_step from grammage to length
+      return vMedium.ArclengthFromGrammage(geometry::LinearApproximation(vTrack),
+                                           next_interact);
+    }
+
+    /// samples the distance of vParticle to its decay
+    units::si::LengthType SampleDecayDistance(Particle const& vParticle) {
+      using namespace corsika::units::si;
+      // determine combined total inverse decay time
+      InverseTimeType const total_inv_lifetime =
+          fProcessSequence.GetTotalInverseLifetime(vParticle);
+
+      // sample random exponential decay time
+      corsika::random::ExponentialDistribution expDistDecay(1 / total_inv_lifetime);
+      TimeType const next_decay = expDistDecay(*fRNG);
+
+      // convert next_decay from time to length [m]
+      return next_decay * vParticle.GetMomentum().norm() / vParticle.GetEnergy() *
+             units::constants::c;
+    }
+
+    /**
+     * The part of a step after the continuous processes: the discrete
+     * interaction or decay, or the crossing into the volume vNextVol.
+     */
+    void FinishStep(Particle& vParticle, StepLimits const& vLimits,
+                    VolumeTreeNode const* const vNextVol) {
+      using namespace corsika;
+      using namespace corsika::units::si;
+
+      auto const* currentLogicalNode = vParticle.GetNode();
+      auto const* nextVol = vNextVol;
+      LengthType const min_distance = vLimits.fStep;
+      LengthType const distance_interact = vLimits.fInteraction;
+      [[maybe_unused]] LengthType const distance_decay = vLimits.fDecay;
+      LengthType const distance_max = vLimits.fContinuous;
+      LengthType const geomMaxLength = vLimits.fGeometry;
+
+      // the tracking may limit the step without reaching a volume boundary, e.g.
+      // because of the bending in a magnetic field
+      bool const limitedByTracking = (nextVol == currentLogicalNode);
+
+      if (min_distance < geomMaxLength ||
+          limitedByTracking) { // interaction to happen within geometric limit
 
         // check whether decay or interaction limits this step the
         // outcome of decay or interaction MAY be a) new particles in
@@ -227,7 +529,7 @@ namespace corsika::cascade {
 
         TStackView secondaries(vParticle);
 
-        if (min_distance != distance_max) {
+        if (min_distance != distance_max && min_distance != geomMaxLength) {
           /*
             Create SecondaryView object on Stack. The data container
             remains untouched and identical, and 'projectil' is identical
@@ -248,10 +550,11 @@ namespace corsika::cascade {
 
             random::UniformRealDistribution<InverseGrammageType> uniDist(
                 current_inv_length);
-            const auto sample_process = uniDist(fRNG);
+            const auto sample_process = uniDist(*fRNG);
             InverseGrammageType inv_lambda_count = 0. * meter * meter / gram;
             fProcessSequence.SelectInteraction(vParticle, projectile, sample_process,
                                                inv_lambda_count);
+            ++fStatistics.fInteractions;
           } else {
             assert(min_distance == distance_decay);
             std::cout << "decay" << std::endl;
@@ -259,7 +562,7 @@ namespace corsika::cascade {
                 fProcessSequence.GetTotalInverseLifetime(vParticle);
 
             random::UniformRealDistribution<InverseTimeType> uniDist(actual_decay_time);
-            const auto sample_process = uniDist(fRNG);
+            const auto sample_process = uniDist(*fRNG);
             InverseTimeType inv_decay_count = 0 / second;
             fProcessSequence.SelectDecay(vParticle, projectile, sample_process,
                                          inv_decay_count);
@@ -267,9 +570,14 @@ namespace corsika::cascade {
             if (secondaries.GetSize() == 1 &&
                 projectile.GetPID() == secondaries.GetNextParticle().GetPID())
               throw std::runtime_error("Cascade::Step: Particle decays into itself!");
+            ++fStatistics.fDecays;
           }
+          fStatistics.fSecondaries += secondaries.GetSize();
 
-          fProcessSequence.DoSecondaries(secondaries);
+          {
+            utl::TraceScope const trace("DoSecondaries", "Cascade");
+            fProcessSequence.DoSecondaries(secondaries);
+          }
           vParticle.Delete(); // todo: this should be reviewed. Where
                               // exactly are particles best deleted, and
                               // where they should NOT be
@@ -291,8 +599,10 @@ namespace corsika::cascade {
         assert(assertion()); // numerical and logical nodes don't match
       } else {               // boundary crossing, step is limited by volume boundary
         std::cout << "boundary crossing! next node = " << nextVol << std::endl;
+        ++fStatistics.fBoundaryCrossings;
         vParticle.SetNode(nextVol);
         // DoBoundary may delete the particle (or not)
+        utl::TraceScope const trace("DoBoundaryCrossing", "Cascade");
         fProcessSequence.DoBoundaryCrossing(vParticle, *currentLogicalNode, *nextVol);
       }
     }
@@ -302,8 +612,18 @@ namespace corsika::cascade {
     TTracking& fTracking;
     TProcessList& fProcessSequence;
     TStack& fStack;
-    corsika::random::RNG& fRNG =
-        corsika::random::RNGManager::GetInstance().GetRandomStream("cascade");
+    corsika::random::RNG* fRNG =
+        &corsika::random::RNGManager::GetInstance().GetRandomStream("cascade");
+    StepStrategy fStepStrategy = StepStrategy::eGrammageIntegration;
+    bool fLineageRNG = false;
+    bool fLineageAllStreams = true;
+    uint64_t const fCascadeStreamId =
+        corsika::random::RNGManager::GetStreamId("cascade");
+    std::vector<StepLimits> fBatchLimits;  //!< per particle, see StepBatch()
+    Eigen::ArrayXd fBatchStepLength;        //!< per particle, see StepBatch()
+    std::vector<uint64_t> fBatchKeys;       //!< per particle, see StepBatch()
+    utl::StepArena fStepArena;              //!< temporaries of one step
+    CascadeStatistics fStatistics;
   }; // namespace corsika::cascade
 
 } // namespace corsika::cascade
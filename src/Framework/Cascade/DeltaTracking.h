@@ -0,0 +1,76 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_corsika_cascade_DeltaTracking_h_
+#define _include_corsika_cascade_DeltaTracking_h_
+
+#include <corsika/random/ExponentialDistribution.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+namespace corsika::cascade {
+
+  /**
+   * Delta (Woodcock) tracking: samples the distance to the next real
+   * interaction along \p vTrajectory in \p vMedium without any grammage
+   * integration.
+   *
+   * Candidate (virtual) collisions are sampled with the constant majorant
+   * interaction rate \f$ \varrho_\text{max} / \lambda \f$, where
+   * \f$ \varrho_\text{max} \f$ is vMedium.GetMajorantMassDensity() and
+   * \f$ 1/\lambda \f$ = \p vInvLambda, and are accepted as real with
+   * probability \f$ \varrho(x) / \varrho_\text{max} \f$. This needs one
+   * density lookup per candidate, and gives exactly the same distribution as
+   * the conversion of an exponentially distributed grammage into a length.
+   *
+   * Returns infinity if there is no real interaction before \p vMaxLength,
+   * which must be finite.
+   */
+  template <typename TMedium, typename TTrajectory, typename TRNG>
+  units::si::LengthType DeltaTrackingDistance(TMedium const& vMedium,
+                                              TTrajectory const& vTrajectory,
+                                              units::si::InverseGrammageType vInvLambda,
+                                              units::si::LengthType vMaxLength,
+                                              TRNG& vRNG) {
+    using namespace corsika::units::si;
+
+    if (!std::isfinite(vMaxLength.magnitude())) {
+      throw std::runtime_error("DeltaTrackingDistance: step limit must be finite");
+    }
+
+    LengthType const noInteraction =
+        std::numeric_limits<double>::infinity() * units::si::meter;
+    MassDensityType const rhoMax = vMedium.GetMajorantMassDensity();
+    if (rhoMax.magnitude() <= 0 || vInvLambda.magnitude() <= 0) { return noInteraction; }
+
+    corsika::random::ExponentialDistribution expDist(1 / (rhoMax * vInvLambda));
+    std::uniform_real_distribution<double> uniform;
+
+    LengthType distance = 0 * units::si::meter;
+    while (true) {
+      distance += expDist(vRNG);
+      if (distance >= vMaxLength) { return noInteraction; }
+
+      auto const rho =
+          vMedium.GetMassDensity(vTrajectory.PositionFromArclength(distance));
+      if (rho > rhoMax) {
+        throw std::runtime_error("DeltaTrackingDistance: majorant density exceeded");
+      }
+      if (uniform(vRNG) * rhoMax < rho) { return distance; } // real collision
+    }
+  }
+
+} // namespace corsika::cascade
+
+#endif
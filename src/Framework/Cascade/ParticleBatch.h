@@ -0,0 +1,292 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_corsika_cascade_ParticleBatch_h_
+#define _include_corsika_cascade_ParticleBatch_h_
+
+#include <corsika/geometry/Line.h>
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/geometry/Trajectory.h>
+#include <corsika/geometry/Vector.h>
+#include <corsika/particles/ParticleProperties.h>
+#include <corsika/process/ProcessReturn.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <Eigen/Core>
+
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace corsika::cascade {
+
+  /**
+   * \class ParticleBatch
+   *
+   * Particles of one type in one volume, copied from the top of a Stack into
+   * a structure of arrays, so that tracking and continuous processes can
+   * treat them together with vectorised kernels, see Cascade::RunBatched.
+   *
+   * All numbers are bare magnitudes of the phys::units quantities, vectors
+   * are given in the root coordinate system. Batch index 0 is the top of the
+   * stack, the stack index decreases with the batch index.
+   *
+   * The arrays are the valid particle data between Gather() and Scatter(),
+   * Store() and Load() synchronise single particles with the stack. As the
+   * particles below the top are changed in place, Gather() reports them to
+   * Stack::LowerLowWater().
+   */
+  template <typename TStack>
+  class ParticleBatch {
+
+  public:
+    using ParticleType = typename TStack::ParticleType;
+    using NodeType =
+        std::remove_pointer_t<decltype(std::declval<ParticleType>().GetNode())>;
+    using TrajectoryType = geometry::Trajectory<geometry::Line>;
+    using Array = Eigen::ArrayXd;
+    using Mask = Eigen::Array<bool, Eigen::Dynamic, 1>;
+
+    ParticleBatch(TStack& vStack)
+        : fStack(vStack) {}
+
+    /**
+     * Loads the particle returned by TStack::GetNextParticle() and the
+     * particles below it on the stack, as long as they have the same type and
+     * volume, up to vMaxSize particles. Returns the size of the batch.
+     */
+    std::size_t Gather(std::size_t const vMaxSize) {
+      fIndex.clear();
+      if (fStack.IsEmpty() || vMaxSize == 0) {
+        Resize(0);
+        return 0;
+      }
+      // GetNextParticle() puts the selected particle on top, see OrderedStack
+      auto const top = fStack.GetNextParticle();
+      fPID = top.GetPID();
+      fNode = top.GetNode();
+      for (int i = fStack.GetSize() - 1; i >= 0 && fIndex.size() < vMaxSize; --i) {
+        auto const p = fStack.begin() + i;
+        if (p.GetPID() != fPID || p.GetNode() != fNode) { break; }
+        fIndex.push_back(i);
+      }
+      fStack.LowerLowWater(fIndex.back());
+      Resize(fIndex.size());
+      for (std::size_t i = 0; i < fIndex.size(); ++i) { Load(i); }
+      fStartX = fX;
+      fStartY = fY;
+      fStartZ = fZ;
+      fStepLength.setZero();
+      fMaxStepLength.setConstant(kInfinity);
+      fAbsorbed.setConstant(false);
+      std::fill(fNextNode.begin(), fNextNode.end(), fNode);
+      fHasGrammage = false;
+      return fIndex.size();
+    }
+
+    /// writes the batch back to the stack
+    void Scatter() {
+      for (std::size_t i = 0; i < fIndex.size(); ++i) { Store(i); }
+    }
+
+    /// reads particle vI from the stack into the arrays
+    void Load(std::size_t const vI) {
+      auto const p = GetParticle(vI);
+      auto const& rootCS = GetRootCS();
+      auto const& momentum = p.GetMomentum().GetComponents(rootCS).eVector;
+      auto const& position = p.GetPosition().GetCoordinates(rootCS).eVector;
+      fEnergy[vI] = p.GetEnergy().magnitude();
+      fPX[vI] = momentum(0);
+      fPY[vI] = momentum(1);
+      fPZ[vI] = momentum(2);
+      fX[vI] = position(0);
+      fY[vI] = position(1);
+      fZ[vI] = position(2);
+      fTime[vI] = p.GetTime().magnitude();
+    }
+
+    /// writes particle vI from the arrays to the stack
+    void Store(std::size_t const vI) {
+      using namespace units::si;
+      auto p = GetParticle(vI);
+      auto const& rootCS = GetRootCS();
+      p.SetEnergy(HEPEnergyType(phys::units::detail::magnitude_tag, fEnergy[vI]));
+      p.SetMomentum(geometry::Vector<hepmomentum_d>(
+          rootCS, geometry::QuantityVector<hepmomentum_d>(
+                      Eigen::Vector3d(fPX[vI], fPY[vI], fPZ[vI]))));
+      p.SetPosition(geometry::Point(
+          rootCS,
+          geometry::QuantityVector<length_d>(Eigen::Vector3d(fX[vI], fY[vI], fZ[vI]))));
+      p.SetTime(TimeType(phys::units::detail::magnitude_tag, fTime[vI]));
+    }
+
+    std::size_t GetSize() const { return fIndex.size(); }
+    particles::Code GetPID() const { return fPID; }
+    units::si::HEPMassType GetMass() const { return particles::GetMass(fPID); }
+    int GetChargeNumber() const { return particles::GetChargeNumber(fPID); }
+    NodeType const* GetNode() const { return fNode; }
+
+    /// the stack entry of particle vI
+    ParticleType GetParticle(std::size_t const vI) const {
+      return fStack.begin() + int(fIndex[vI]);
+    }
+
+    /// @name the particle data
+    /// @{
+    Array& GetEnergy() { return fEnergy; }
+    Array& GetMomentumX() { return fPX; }
+    Array& GetMomentumY() { return fPY; }
+    Array& GetMomentumZ() { return fPZ; }
+    Array& GetX() { return fX; }
+    Array& GetY() { return fY; }
+    Array& GetZ() { return fZ; }
+    Array& GetTime() { return fTime; }
+    Array const& GetEnergy() const { return fEnergy; }
+    Array const& GetMomentumX() const { return fPX; }
+    Array const& GetMomentumY() const { return fPY; }
+    Array const& GetMomentumZ() const { return fPZ; }
+    Array const& GetX() const { return fX; }
+    Array const& GetY() const { return fY; }
+    Array const& GetZ() const { return fZ; }
+    Array const& GetTime() const { return fTime; }
+    Array GetMomentumNorm() const { return (fPX * fPX + fPY * fPY + fPZ * fPZ).sqrt(); }
+    /// @}
+
+    /// @name the current step
+    /// @{
+    /// position at the start of the step
+    Array const& GetStartX() const { return fStartX; }
+    Array const& GetStartY() const { return fStartY; }
+    Array const& GetStartZ() const { return fStartZ; }
+    /// the length of the step, i.e. the geometric limit before Move()
+    Array& GetStepLength() { return fStepLength; }
+    Array const& GetStepLength() const { return fStepLength; }
+    /// the step limit of the continuous processes, infinity by default
+    Array& GetMaxStepLength() { return fMaxStepLength; }
+    /// the volume entered at the geometric limit
+    std::vector<NodeType const*>& GetNextNode() { return fNextNode; }
+    /// particles to be removed after the step
+    Mask& GetAbsorbed() { return fAbsorbed; }
+    Mask const& GetAbsorbed() const { return fAbsorbed; }
+    /// @}
+
+    /// the straight trajectory of the current step of particle vI
+    TrajectoryType GetTrajectory(std::size_t const vI) const {
+      using namespace units::si;
+      auto const& rootCS = GetRootCS();
+      geometry::Point const start(
+          rootCS, geometry::QuantityVector<length_d>(
+                      Eigen::Vector3d(fStartX[vI], fStartY[vI], fStartZ[vI])));
+      Eigen::Vector3d const momentum(fPX[vI], fPY[vI], fPZ[vI]);
+      double const p = momentum.norm();
+      double const speed = p / fEnergy[vI] * units::constants::c.magnitude();
+      geometry::Vector<SpeedType::dimension_type> const velocity(
+          rootCS, geometry::QuantityVector<SpeedType::dimension_type>(
+                      momentum * (p > 0 ? speed / p : 0.)));
+      return TrajectoryType(geometry::Line(start, velocity),
+                            TimeType(phys::units::detail::magnitude_tag,
+                                     speed > 0 ? fStepLength[vI] / speed : 0));
+    }
+
+    /**
+     * Sets the step length and moves all particles along their momenta, the
+     * time advances with the speed of light, like in Cascade::Step.
+     */
+    void Move(Array const& vLength) {
+      fStepLength = vLength;
+      Array const norm = GetMomentumNorm();
+      Array const scale = (norm > 0).select(fStepLength / norm, 0.);
+      fX = fStartX + fPX * scale;
+      fY = fStartY + fPY * scale;
+      fZ = fStartZ + fPZ * scale;
+      fTime += fStepLength / units::constants::c.magnitude();
+      fHasGrammage = false;
+    }
+
+    /// grammage along the current step of each particle
+    Array const& GetGrammage() {
+      if (!fHasGrammage) {
+        // the media have no batched interface, they are asked per particle
+        auto const& medium = fNode->GetModelProperties();
+        for (std::size_t i = 0; i < fIndex.size(); ++i) {
+          auto const track = GetTrajectory(i);
+          fGrammage[i] = medium.IntegratedGrammage(track, track.GetLength()).magnitude();
+        }
+        fHasGrammage = true;
+      }
+      return fGrammage;
+    }
+
+    /**
+     * Applies the per-particle DoContinuous of vProcess to all particles that
+     * are not absorbed yet. This is how a ContinuousProcess without batched
+     * interface takes part in a batched step.
+     */
+    template <typename TProcess>
+    void ApplyContinuous(TProcess& vProcess) {
+      for (std::size_t i = 0; i < fIndex.size(); ++i) {
+        if (fAbsorbed[i]) { continue; }
+        Store(i);
+        auto particle = GetParticle(i);
+        auto const track = GetTrajectory(i);
+        if (vProcess.DoContinuous(particle, track) ==
+            process::EProcessReturn::eParticleAbsorbed) {
+          fAbsorbed[i] = true;
+        }
+        Load(i);
+      }
+      fHasGrammage = false;
+    }
+
+    /// the per-particle MaxStepLength of vProcess, see ApplyContinuous()
+    template <typename TProcess>
+    void ApplyMaxStepLength(TProcess& vProcess) {
+      for (std::size_t i = 0; i < fIndex.size(); ++i) {
+        auto const particle = GetParticle(i);
+        auto const track = GetTrajectory(i);
+        fMaxStepLength[i] = std::min(fMaxStepLength[i],
+                                     vProcess.MaxStepLength(particle, track).magnitude());
+      }
+    }
+
+  private:
+    static constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+    static geometry::CoordinateSystem const& GetRootCS() {
+      return geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+    }
+
+    void Resize(std::size_t const vN) {
+      for (auto* a : {&fEnergy, &fPX, &fPY, &fPZ, &fX, &fY, &fZ, &fTime, &fStartX,
+                      &fStartY, &fStartZ, &fStepLength, &fMaxStepLength, &fGrammage}) {
+        a->resize(vN);
+      }
+      fAbsorbed.resize(vN);
+      fNextNode.resize(vN);
+    }
+
+    TStack& fStack;
+    std::vector<unsigned int> fIndex; //!< stack index of each particle
+    particles::Code fPID = particles::Code::Unknown;
+    NodeType const* fNode = nullptr;
+
+    Array fEnergy, fPX, fPY, fPZ, fX, fY, fZ, fTime;
+    Array fStartX, fStartY, fStartZ, fStepLength, fMaxStepLength, fGrammage;
+    Mask fAbsorbed;
+    std::vector<NodeType const*> fNextNode;
+    bool fHasGrammage = false;
+  };
+
+} // namespace corsika::cascade
+
+#endif
@@ -0,0 +1,391 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_corsika_cascade_SubShowerScheduler_h_
+#define _include_corsika_cascade_SubShowerScheduler_h_
+
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/Vector.h>
+#include <corsika/particles/ParticleProperties.h>
+#include <corsika/process/BaseProcess.h>
+#include <corsika/process/StackProcess.h>
+#include <corsika/random/RNGManager.h>
+#include <corsika/stack/lineage/LineageStackExtension.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace corsika::cascade {
+
+  /**
+   * \class SubShowerScheduler
+   *
+   * Simulates one shower on several cores by splitting it into independent
+   * sub-showers (tasks), each with its own stack and random-number stream.
+   *
+   * The shower starts from the tasks created with AddTask(). A worker runs
+   * a task, usually with a Cascade on the task's stack. Whenever the stack
+   * of a running task grows beyond the split threshold, the
+   * SubShowerSplitter in the worker's ProcessSequence moves the lower half
+   * of it, i.e. the oldest and typically most energetic particles, into a
+   * new task. Every worker keeps its tasks in a deque, takes new work from
+   * the back of its own deque and, when that is empty, steals from the
+   * front of the others.
+   *
+   * The result does not depend on the number of workers or on timing: the
+   * random stream of a task is determined by the seed and the task ID, and
+   * the ID of a sub-shower by its parent and the number of splits of the
+   * parent before. Output must be collected per task, e.g. in
+   * ShardedResults, and merged in the order of the task IDs.
+   *
+   * Each worker needs its own instances of all processes. Processes with
+   * global state, e.g. the Fortran interaction models, and processes
+   * drawing from the RNGManager are not thread-safe: they specialise
+   * process::is_thread_safe to false, and a ProcessSequence containing a
+   * SubShowerSplitter does not compile with them.
+   *
+   * TStack is setup::Stack or alike, see MoveParticles().
+   */
+  template <typename TStack>
+  class SubShowerScheduler {
+
+  public:
+    class Task {
+    public:
+      uint64_t GetId() const { return fId; }
+      TStack& GetStack() { return fStack; }
+      random::RNG& GetRNG() { return fRNG; }
+
+    private:
+      friend class SubShowerScheduler;
+
+      Task(uint64_t const vId, random::RNG const& vRNG)
+          : fId(vId)
+          , fRNG(vRNG) {}
+
+      uint64_t const fId;
+      TStack fStack;
+      random::RNG fRNG;
+      uint64_t fNSplits = 0;
+    };
+
+    /**
+     * \param vNWorkers number of threads, including the calling one
+     * \param vSplitThreshold stack size above which a task is split
+     * \param vSeed seed of the random streams of all tasks
+     */
+    SubShowerScheduler(std::size_t const vNWorkers, std::size_t const vSplitThreshold,
+                       uint64_t const vSeed = 0)
+        : fSplitThreshold(vSplitThreshold)
+        , fSeed(vSeed) {
+      if (vNWorkers == 0) {
+        throw std::runtime_error("SubShowerScheduler: at least one worker needed");
+      }
+      if (vSplitThreshold < 2) {
+        throw std::runtime_error("SubShowerScheduler: split threshold must be >= 2");
+      }
+      for (std::size_t i = 0; i < vNWorkers; ++i) {
+        fQueues.push_back(std::make_unique<Queue>());
+      }
+      fCurrent.resize(vNWorkers, nullptr);
+    }
+
+    std::size_t GetNumberOfWorkers() const { return fQueues.size(); }
+    std::size_t GetSplitThreshold() const { return fSplitThreshold; }
+
+    /// creates a task to be filled with particles before Run()
+    TStack& AddTask() {
+      auto task = MakeTask(Mix(kGolden * ++fNRootTasks));
+      auto& stack = task->GetStack();
+      Push(fNRootTasks % fQueues.size(), std::move(task));
+      return stack;
+    }
+
+    /**
+     * Calls vRunTask(worker, task) for all tasks, including those created
+     * while running, from GetNumberOfWorkers() threads. Returns when all
+     * tasks are done. An exception in a task stops all workers and is
+     * rethrown here.
+     */
+    template <typename TRunTask>
+    void Run(TRunTask vRunTask) {
+      fAbort = false;
+      fException = nullptr;
+
+      std::vector<std::thread> threads;
+      for (std::size_t w = 1; w < fQueues.size(); ++w) {
+        threads.emplace_back([this, w, &vRunTask]() { Work(w, vRunTask); });
+      }
+      Work(0, vRunTask);
+      for (auto& thread : threads) { thread.join(); }
+
+      if (fException) {
+        for (auto& queue : fQueues) { queue->fTasks.clear(); }
+        fPending = 0;
+        std::rethrow_exception(fException);
+      }
+    }
+
+    /**
+     * Moves the lower half of vStack, the stack of the task running on
+     * worker vWorker, into a new task if it is larger than the split
+     * threshold. Returns true if so.
+     */
+    bool SplitIfLarge(std::size_t const vWorker, TStack& vStack) {
+      if (vStack.GetSize() <= fSplitThreshold) { return false; }
+      Task& parent = *fCurrent.at(vWorker);
+      if (&parent.GetStack() != &vStack) {
+        throw std::runtime_error("SubShowerScheduler: stack of another task");
+      }
+      auto child = MakeTask(Mix(parent.fId + kGolden * ++parent.fNSplits));
+      MoveParticles(vStack, vStack.GetSize() / 2, child->GetStack());
+      Push(vWorker, std::move(child));
+      ++fNSplits;
+      return true;
+    }
+
+    /// @name statistics of all Run() calls
+    /// @{
+    std::size_t GetNumberOfTasks() const { return fNTasks; }
+    std::size_t GetNumberOfSplits() const { return fNSplits; }
+    std::size_t GetNumberOfSteals() const { return fNSteals; }
+    /// @}
+
+    /**
+     * Appends the lowest vN particles of vFrom to vTo, keeping their order,
+     * and removes them from vFrom. The particles remaining in vFrom are
+     * moved down, which lowers vFrom.GetLowWater() to 0, so that
+     * checkpoints and stack wrappers see the change.
+     */
+    static void MoveParticles(TStack& vFrom, std::size_t const vN, TStack& vTo) {
+      using namespace units::si;
+      using MomentumVector = geometry::Vector<hepmomentum_d>;
+      std::size_t const size = vFrom.GetSize();
+      for (std::size_t i = 0; i < vN; ++i) {
+        auto const p = vFrom.begin() + int(i);
+        auto const code = p.GetPID();
+        auto q = code == particles::Code::Nucleus
+                     ? vTo.AddParticle(
+                           std::tuple<particles::Code, HEPEnergyType,
+                                      MomentumVector, geometry::Point, TimeType,
+                                      unsigned short, unsigned short>{
+                               code, p.GetEnergy(), p.GetMomentum(), p.GetPosition(),
+                               p.GetTime(), (unsigned short)(p.GetNuclearA()),
+                               (unsigned short)(p.GetNuclearZ())})
+                     : vTo.AddParticle(
+                           std::tuple<particles::Code, HEPEnergyType,
+                                      MomentumVector, geometry::Point, TimeType>{
+                               code, p.GetEnergy(), p.GetMomentum(), p.GetPosition(),
+                               p.GetTime()});
+        q.SetNode(p.GetNode());
+        if constexpr (stack::lineage::has_lineage_key<decltype(q)>::value) {
+          q.SetLineageRecord(p.GetLineageRecord());
+        }
+      }
+      for (std::size_t i = vN; i < size; ++i) {
+        vFrom.Copy(vFrom.begin() + int(i), vFrom.begin() + int(i - vN));
+      }
+      for (std::size_t i = 0; i < vN; ++i) { vFrom.DeleteLast(); }
+    }
+
+  private:
+    struct Queue {
+      std::mutex fMutex;
+      std::deque<std::unique_ptr<Task>> fTasks;
+    };
+
+    static uint64_t constexpr kGolden = 0x9E3779B97F4A7C15ull;
+
+    /// the finaliser of splitmix64, a bijection with good avalanche
+    static uint64_t Mix(uint64_t z) {
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+      return z ^ (z >> 31);
+    }
+
+    std::unique_ptr<Task> MakeTask(uint64_t const vId) const {
+      if constexpr (std::is_same_v<random::RNG, random::Philox4x32>) {
+        return std::unique_ptr<Task>(new Task(vId, random::RNG(fSeed, vId)));
+      } else {
+        std::seed_seq seq{uint32_t(fSeed), uint32_t(fSeed >> 32), uint32_t(vId),
+                          uint32_t(vId >> 32)};
+        return std::unique_ptr<Task>(new Task(vId, random::RNG(seq)));
+      }
+    }
+
+    void Push(std::size_t const vWorker, std::unique_ptr<Task> vTask) {
+      {
+        std::lock_guard<std::mutex> lock(fIdleMutex);
+        ++fPending; // before the task is visible, so that nobody quits
+      }
+      {
+        auto& queue = *fQueues[vWorker];
+        std::lock_guard<std::mutex> lock(queue.fMutex);
+        queue.fTasks.push_back(std::move(vTask));
+      }
+      fIdle.notify_one();
+    }
+
+    /// the newest own task, or else the oldest task of another worker
+    std::unique_ptr<Task> Take(std::size_t const vWorker) {
+      {
+        auto& queue = *fQueues[vWorker];
+        std::lock_guard<std::mutex> lock(queue.fMutex);
+        if (!queue.fTasks.empty()) {
+          auto task = std::move(queue.fTasks.back());
+          queue.fTasks.pop_back();
+          return task;
+        }
+      }
+      for (std::size_t i = 1; i < fQueues.size(); ++i) {
+        auto& queue = *fQueues[(vWorker + i) % fQueues.size()];
+        std::lock_guard<std::mutex> lock(queue.fMutex);
+        if (!queue.fTasks.empty()) {
+          auto task = std::move(queue.fTasks.front());
+          queue.fTasks.pop_front();
+          ++fNSteals;
+          return task;
+        }
+      }
+      return nullptr;
+    }
+
+    template <typename TRunTask>
+    void Work(std::size_t const vWorker, TRunTask& vRunTask) {
+      while (!fAbort) {
+        auto task = Take(vWorker);
+        if (!task) {
+          std::unique_lock<std::mutex> lock(fIdleMutex);
+          if (fPending == 0) { return; }
+          // new tasks are announced, the timeout covers a missed one
+          fIdle.wait_for(lock, std::chrono::milliseconds(1));
+          continue;
+        }
+
+        fCurrent[vWorker] = task.get();
+        try {
+          vRunTask(vWorker, *task);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(fIdleMutex);
+          if (!fException) { fException = std::current_exception(); }
+          fAbort = true;
+        }
+        fCurrent[vWorker] = nullptr;
+        ++fNTasks;
+
+        std::lock_guard<std::mutex> lock(fIdleMutex);
+        if (--fPending == 0 || fAbort) { fIdle.notify_all(); }
+      }
+    }
+
+    std::size_t const fSplitThreshold;
+    uint64_t const fSeed;
+    uint64_t fNRootTasks = 0;
+
+    std::vector<std::unique_ptr<Queue>> fQueues;
+    std::vector<Task*> fCurrent; //!< the task running on each worker
+
+    std::mutex fIdleMutex;
+    std::condition_variable fIdle;
+    std::size_t fPending = 0; //!< tasks queued or running
+    std::atomic<bool> fAbort{false};
+    std::exception_ptr fException;
+
+    std::atomic<std::size_t> fNTasks{0};
+    std::atomic<std::size_t> fNSplits{0};
+    std::atomic<std::size_t> fNSteals{0};
+  };
+
+  /**
+   * \class SubShowerSplitter
+   *
+   * StackProcess handing the lower half of a stack that has grown beyond
+   * the split threshold to the SubShowerScheduler. Add one to the
+   * ProcessSequence of each worker.
+   */
+  template <typename TScheduler>
+  class SubShowerSplitter : public process::StackProcess<SubShowerSplitter<TScheduler>> {
+
+  public:
+    SubShowerSplitter(TScheduler& vScheduler, std::size_t const vWorker)
+        : process::StackProcess<SubShowerSplitter<TScheduler>>(1)
+        , fScheduler(vScheduler)
+        , fWorker(vWorker) {}
+
+    void Init() {}
+
+    template <typename TStack>
+    process::EProcessReturn DoStack(TStack& vStack) {
+      fScheduler.SplitIfLarge(fWorker, vStack);
+      return process::EProcessReturn::eOk;
+    }
+
+  private:
+    TScheduler& fScheduler;
+    std::size_t const fWorker;
+  };
+
+  /**
+   * \class ShardedResults
+   *
+   * Output of a SubShowerScheduler run, one shard per task. Shards can be
+   * created from all workers at the same time, ForEach() visits them in the
+   * order of the task IDs, so the merged output is reproducible.
+   */
+  template <typename TShard>
+  class ShardedResults {
+
+  public:
+    /// the shard of task vTaskId, created on first access
+    TShard& GetShard(uint64_t const vTaskId) {
+      std::lock_guard<std::mutex> lock(fMutex);
+      return fShards[vTaskId]; // references into a std::map remain valid
+    }
+
+    template <typename TFunction>
+    void ForEach(TFunction&& vFunction) const {
+      for (auto const& [id, shard] : fShards) { vFunction(id, shard); }
+    }
+
+    std::size_t GetSize() const { return fShards.size(); }
+    void Clear() { fShards.clear(); }
+
+  private:
+    std::mutex fMutex;
+    std::map<uint64_t, TShard> fShards;
+  };
+
+} // namespace corsika::cascade
+
+namespace corsika::process {
+
+  /// the workers run the same ProcessSequence at the same time
+  template <typename TScheduler>
+  struct needs_thread_safe_sequence<cascade::SubShowerSplitter<TScheduler>>
+      : std::true_type {};
+
+} // namespace corsika::process
+
+#endif
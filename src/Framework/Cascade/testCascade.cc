@@ -11,6 +11,9 @@
 #include <corsika/cascade/testCascade.h>
 
 #include <corsika/cascade/Cascade.h>
+#include <corsika/cascade/DeltaTracking.h>
+#include <corsika/cascade/ParticleBatch.h>
+#include <corsika/cascade/SubShowerScheduler.h>
 
 #include <corsika/process/ProcessSequence.h>
 #include <corsika/process/null_model/NullModel.h>
@@ -19,13 +22,22 @@
 
 #include <corsika/particles/ParticleProperties.h>
 
+#include <corsika/stack/ordered/OrderedStack.h>
+#include <corsika/stack/particle_class/ParticleClassStack.h>
+
 #include <corsika/geometry/Point.h>
 #include <corsika/geometry/RootCoordinateSystem.h>
 #include <corsika/geometry/Vector.h>
 
+#include <corsika/environment/FlatExponential.h>
 #include <corsika/environment/HomogeneousMedium.h>
+#include <corsika/environment/MajorantDensity.h>
 #include <corsika/environment/NuclearComposition.h>
 
+#include <corsika/utl/Tracer.h>
+
+#include <corsika/testing/AllocationCounter.h>
+
 #include <catch2/catch.hpp>
 
 using namespace corsika;
@@ -33,18 +45,25 @@ using namespace corsika::process;
 using namespace corsika::units;
 using namespace corsika::units::si;
 using namespace corsika::geometry;
+using corsika::stack::ordered::OrderedStack;
+using corsika::stack::ordered::StackOrder;
 
+#include <algorithm>
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
 using namespace std;
 
-auto MakeDummyEnv() {
+auto MakeDummyEnv(LengthType const vRadius = 100_km *
+                                              std::numeric_limits<double>::infinity()) {
   TestEnvironmentType env; // dummy environment
   auto& universe = *(env.GetUniverse());
 
   auto theMedium = TestEnvironmentType::CreateNode<Sphere>(
-      Point{env.GetCoordinateSystem(), 0_m, 0_m, 0_m},
-      100_km * std::numeric_limits<double>::infinity());
+      Point{env.GetCoordinateSystem(), 0_m, 0_m, 0_m}, vRadius);
 
   using MyHomogeneousModel = environment::HomogeneousMedium<environment::IMediumModel>;
   theMedium->SetModelProperties<MyHomogeneousModel>(
@@ -128,6 +147,63 @@ public:
   int GetCalls() const { return fCalls; }
 };
 
+class ProcessCount : public process::ContinuousProcess<ProcessCount> {
+
+  int fCalls = 0;
+
+public:
+  template <typename Particle, typename Track>
+  EProcessReturn DoContinuous(Particle&, Track const&) {
+    fCalls++;
+    return EProcessReturn::eOk;
+  }
+
+  template <typename Particle, typename Track>
+  LengthType MaxStepLength(Particle const&, Track const&) const {
+    return 1_m * std::numeric_limits<double>::infinity();
+  }
+
+  void Init() { fCalls = 0; }
+
+  int GetCalls() const { return fCalls; }
+};
+
+// the same as ProcessCount, with the batched interface
+class ProcessCountBatch : public process::ContinuousProcess<ProcessCountBatch> {
+
+  int fCalls = 0;
+  int fBatches = 0;
+
+public:
+  template <typename Particle, typename Track>
+  EProcessReturn DoContinuous(Particle&, Track const&) {
+    fCalls++;
+    return EProcessReturn::eOk;
+  }
+
+  template <typename Particle, typename Track>
+  LengthType MaxStepLength(Particle const&, Track const&) const {
+    return 1_m * std::numeric_limits<double>::infinity();
+  }
+
+  template <typename TBatch>
+  void DoContinuousBatch(TBatch& vB) {
+    fCalls += vB.GetSize();
+    fBatches++;
+  }
+
+  template <typename TBatch>
+  void MaxStepLengthBatch(TBatch&) {}
+
+  void Init() {
+    fCalls = 0;
+    fBatches = 0;
+  }
+
+  int GetCalls() const { return fCalls; }
+  int GetBatches() const { return fBatches; }
+};
+
 TEST_CASE("Cascade", "[Cascade]") {
 
   HEPEnergyType E0 = 100_GeV;
@@ -135,7 +211,10 @@ TEST_CASE("Cascade", "[Cascade]") {
   random::RNGManager& rmng = random::RNGManager::GetInstance();
   rmng.RegisterRandomStream("cascade");
 
-  auto env = MakeDummyEnv();
+  bool const deltaTracking = GENERATE(false, true);
+
+  // delta tracking needs a finite step limit, hence a bounded volume
+  auto env = deltaTracking ? MakeDummyEnv(100_km) : MakeDummyEnv();
   tracking_line::TrackingLine tracking;
 
   stack_inspector::StackInspector<TestCascadeStack> stackInspect(1, true, E0);
@@ -151,6 +230,7 @@ TEST_CASE("Cascade", "[Cascade]") {
   cascade::Cascade<tracking_line::TrackingLine, decltype(sequence), TestCascadeStack,
                    TestCascadeStackView>
       EAS(env, tracking, sequence, stack);
+  if (deltaTracking) { EAS.SetStepStrategy(cascade::StepStrategy::eDeltaTracking); }
   CoordinateSystem const& rootCS =
       RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
 
@@ -167,4 +247,652 @@ TEST_CASE("Cascade", "[Cascade]") {
   CHECK(cut.GetCount() == 2048);
   CHECK(cut.GetCalls() == 2047);
   CHECK(split.GetCalls() == 2047);
+
+  auto const& statistics = EAS.GetStatistics();
+  CHECK(statistics.fSteps == 2047);
+  CHECK(statistics.fInteractions == 2047);
+  CHECK(statistics.fDecays == 0);
+  CHECK(statistics.fBoundaryCrossings == 0);
+  CHECK(statistics.fSecondaries == 2 * 2047);
+  CHECK(statistics.fMaxStackSize == 11); // one particle per generation, LIFO
+
+  EAS.ResetStatistics();
+  CHECK(EAS.GetStatistics().fSteps == 0);
+}
+
+TEST_CASE("Cascade trace", "[Cascade]") {
+
+  HEPEnergyType E0 = 100_GeV;
+  random::RNGManager::GetInstance().RegisterRandomStream("cascade");
+
+  auto env = MakeDummyEnv();
+  tracking_line::TrackingLine tracking;
+  ProcessSplit split(20_g / square(1_cm));
+  ProcessCut cut(85_MeV);
+  auto sequence = split << cut;
+  TestCascadeStack stack;
+
+  cascade::Cascade<tracking_line::TrackingLine, decltype(sequence), TestCascadeStack,
+                   TestCascadeStackView>
+      EAS(env, tracking, sequence, stack);
+  CoordinateSystem const& rootCS =
+      RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+  stack.AddParticle(
+      std::tuple<particles::Code, units::si::HEPEnergyType,
+                 corsika::stack::MomentumVector, geometry::Point, units::si::TimeType>{
+          particles::Code::Electron, E0,
+          corsika::stack::MomentumVector(rootCS, {0_GeV, 0_GeV, -1_GeV}),
+          Point(rootCS, {0_m, 0_m, 10_km}), 0_ns});
+
+  auto& tracer = utl::Tracer::GetInstance();
+  tracer.Start("", 16);
+  EAS.Init();
+  EAS.Run();
+  tracer.Stop();
+
+  std::ostringstream out;
+  tracer.Write(out);
+  std::string const json = out.str();
+  auto const count = [&json](std::string const& vWhat) {
+    std::size_t n = 0;
+    for (auto pos = json.find(vWhat); pos != std::string::npos;
+         pos = json.find(vWhat, pos + 1)) {
+      ++n;
+    }
+    return n;
+  };
+
+  CHECK(count("\"name\": \"Cascade::Init\"") == 1);
+  CHECK(count("\"name\": \"Cascade::Run\"") == 1);
+  // every 16th of the 2047 steps, each with one interaction
+  CHECK(count("\"name\": \"Step\"") == 128);
+  CHECK(count("ProcessSplit\", \"cat\": \"DoInteraction\"") == 128);
+  CHECK(count("ProcessSplit\", \"cat\": \"Init\"") == 1);
+  tracer.Clear();
+}
+
+TEST_CASE("Cascade batched", "[Cascade]") {
+
+  HEPEnergyType E0 = 100_GeV;
+
+  random::RNGManager& rmng = random::RNGManager::GetInstance();
+  rmng.RegisterRandomStream("cascade");
+
+  std::size_t const batchSize = GENERATE(1, 3, 256);
+
+  auto env = MakeDummyEnv(100_km);
+  tracking_line::TrackingLine tracking;
+  ProcessSplit split(20_g / square(1_cm));
+  ProcessCut cut(85_MeV);
+  ProcessCount count;
+  ProcessCountBatch countBatch;
+  auto sequence = split << count << countBatch << cut;
+  TestCascadeStack stack;
+
+  cascade::Cascade<tracking_line::TrackingLine, decltype(sequence), TestCascadeStack,
+                   TestCascadeStackView>
+      EAS(env, tracking, sequence, stack);
+  CoordinateSystem const& rootCS =
+      RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+
+  stack.Clear();
+  stack.AddParticle(
+      std::tuple<particles::Code, units::si::HEPEnergyType,
+                 corsika::stack::MomentumVector, geometry::Point, units::si::TimeType>{
+          particles::Code::Electron, E0,
+          corsika::stack::MomentumVector(rootCS, {0_GeV, 0_GeV, -1_GeV}),
+          Point(rootCS, {0_m, 0_m, 10_km}), 0_ns});
+  EAS.Init();
+  EAS.RunBatched(batchSize);
+
+  // the same shower as with Run()
+  CHECK(cut.GetCount() == 2048);
+  CHECK(split.GetCalls() == 2047);
+  // one step per particle, with and without batched interface
+  CHECK(count.GetCalls() == 2047);
+  CHECK(countBatch.GetCalls() == 2047);
+  CHECK(EAS.GetStatistics().fSteps == 2047);
+  CHECK(EAS.GetStatistics().fInteractions == 2047);
+  if (batchSize == 1) {
+    CHECK(countBatch.GetBatches() == 2047);
+  } else {
+    CHECK(countBatch.GetBatches() < 2047);
+  }
+}
+
+TEST_CASE("ParticleBatch", "[Cascade]") {
+
+  auto env = MakeDummyEnv(1_km);
+  auto const* node = env.GetUniverse()->GetChildNodes().front().get();
+  CoordinateSystem const& rootCS =
+      RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+
+  TestCascadeStack stack;
+  auto add = [&](particles::Code const pid, stack::MomentumVector const& p,
+                 Point const& x) {
+    stack.AddParticle(
+        std::tuple<particles::Code, units::si::HEPEnergyType,
+                   corsika::stack::MomentumVector, geometry::Point, units::si::TimeType>{
+            pid, 10_GeV, p, x, 0_ns});
+    stack.last().SetNode(node);
+  };
+  add(particles::Code::Electron, {rootCS, {0_GeV, 0_GeV, 10_GeV}},
+      Point(rootCS, {0_m, 0_m, 0_m}));
+  add(particles::Code::Proton, {rootCS, {0_GeV, 0_GeV, 10_GeV}},
+      Point(rootCS, {0_m, 0_m, 0_m}));
+  add(particles::Code::Proton, {rootCS, {10_GeV, 0_GeV, 0_GeV}},
+      Point(rootCS, {0_m, 500_m, 0_m}));
+  add(particles::Code::Proton, {rootCS, {0_GeV, -10_GeV, 0_GeV}},
+      Point(rootCS, {100_m, 0_m, 0_m}));
+
+  cascade::ParticleBatch<TestCascadeStack> batch(stack);
+
+  SECTION("gather") {
+    // the electron at the bottom ends the batch
+    REQUIRE(batch.Gather(10) == 3);
+    CHECK(batch.GetPID() == particles::Code::Proton);
+    CHECK(batch.GetNode() == node);
+    CHECK(batch.GetX()[0] == 100);
+    CHECK(batch.GetY()[1] == 500);
+    CHECK(batch.Gather(2) == 2);
+  }
+
+  SECTION("move and scatter") {
+    REQUIRE(batch.Gather(10) == 3);
+    Eigen::ArrayXd length(3);
+    length << 1, 2, 3;
+    batch.Move(length);
+    batch.Scatter();
+    auto const p = stack.begin() + 1;
+    CHECK(p.GetPosition().GetCoordinates(rootCS).GetZ() / 1_m == Approx(3));
+    CHECK(p.GetTime() / (3_m / constants::c) == Approx(1));
+    // batch index 0 is the top of the stack
+    CHECK((stack.begin() + 3).GetPosition().GetCoordinates(rootCS).GetY() / 1_m ==
+          Approx(-1));
+    CHECK(batch.GetGrammage()[2] / (3_m * 1_g / (1_cm * 1_cm * 1_cm)).magnitude() ==
+          Approx(1));
+  }
+
+  SECTION("tracking") {
+    REQUIRE(batch.Gather(10) == 3);
+    tracking_line::TrackingLine tracking;
+    tracking.GetTracks(batch);
+    for (std::size_t i = 0; i < batch.GetSize(); ++i) {
+      auto const [track, length, next] = tracking.GetTrack(batch.GetParticle(i));
+      CHECK(batch.GetStepLength()[i] / length.magnitude() == Approx(1));
+      CHECK(batch.GetNextNode()[i] == next);
+      CHECK(batch.GetTrajectory(i).GetLength() / length == Approx(1).epsilon(1e-6));
+    }
+  }
+}
+
+// records the depth of all steps, for the comparison of showers
+class ProcessRecord : public process::ContinuousProcess<ProcessRecord> {
+
+public:
+  template <typename Particle, typename Track>
+  EProcessReturn DoContinuous(Particle& vP, Track const&) {
+    fRecord->push_back(vP.GetPosition().GetCoordinates()[2] / 1_m);
+    return EProcessReturn::eOk;
+  }
+
+  template <typename Particle, typename Track>
+  LengthType MaxStepLength(Particle const&, Track const&) const {
+    return 1_m * std::numeric_limits<double>::infinity();
+  }
+
+  void Init() {}
+
+  std::vector<double>* fRecord = nullptr;
+};
+
+TEST_CASE("SubShowerScheduler", "[Cascade]") {
+
+  random::RNGManager& rmng = random::RNGManager::GetInstance();
+  rmng.RegisterRandomStream("cascade");
+
+  auto env = MakeDummyEnv();
+  CoordinateSystem const& rootCS =
+      RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+  auto electron = [&](HEPEnergyType const E) {
+    return std::tuple<particles::Code, units::si::HEPEnergyType,
+                      corsika::stack::MomentumVector, geometry::Point,
+                      units::si::TimeType>{
+        particles::Code::Electron, E,
+        corsika::stack::MomentumVector(rootCS, {0_GeV, 0_GeV, -1_GeV}),
+        Point(rootCS, {0_m, 0_m, 10_km}), 0_ns};
+  };
+
+  using Scheduler = cascade::SubShowerScheduler<TestCascadeStack>;
+  using Splitter = cascade::SubShowerSplitter<Scheduler>;
+
+  // everything a thread needs for itself
+  struct Worker {
+    Worker(Scheduler& vScheduler, std::size_t const vIndex)
+        : fSplitter(vScheduler, vIndex)
+        , fSequence(fSplit << fRecord << fCut << fSplitter) {}
+
+    tracking_line::TrackingLine fTracking;
+    ProcessSplit fSplit{20_g / square(1_cm)};
+    ProcessRecord fRecord;
+    ProcessCut fCut{85_MeV};
+    Splitter fSplitter;
+    decltype(fSplit << fRecord << fCut << fSplitter) fSequence;
+  };
+  static_assert(process::needs_thread_safe_sequence_v<decltype(Worker::fSequence)>);
+
+  struct Result {
+    int fCut = 0;
+    int fSplit = 0;
+    std::size_t fSplits = 0;
+    std::vector<double> fRecord;
+  };
+
+  auto runShower = [&](std::size_t const vNWorkers) {
+    Scheduler scheduler(vNWorkers, 8, 42);
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (std::size_t i = 0; i < vNWorkers; ++i) {
+      workers.push_back(std::make_unique<Worker>(scheduler, i));
+      workers.back()->fSequence.Init();
+    }
+    cascade::ShardedResults<std::vector<double>> output;
+
+    scheduler.AddTask().AddParticle(electron(100_GeV));
+    scheduler.Run([&](std::size_t const vWorker, Scheduler::Task& vTask) {
+      auto& w = *workers[vWorker];
+      w.fRecord.fRecord = &output.GetShard(vTask.GetId());
+      cascade::Cascade<tracking_line::TrackingLine, decltype(w.fSequence),
+                       TestCascadeStack, TestCascadeStackView>
+          EAS(env, w.fTracking, w.fSequence, vTask.GetStack());
+      EAS.SetRNG(vTask.GetRNG());
+      EAS.Run();
+    });
+
+    Result result;
+    for (auto const& w : workers) {
+      result.fCut += w->fCut.GetCount();
+      result.fSplit += w->fSplit.GetCalls();
+    }
+    result.fSplits = scheduler.GetNumberOfSplits();
+    CHECK(scheduler.GetNumberOfTasks() == result.fSplits + 1);
+    output.ForEach([&](uint64_t, std::vector<double> const& vShard) {
+      result.fRecord.insert(result.fRecord.end(), vShard.begin(), vShard.end());
+    });
+    return result;
+  };
+
+  SECTION("shower") {
+    auto const serial = runShower(1);
+    auto const parallel = runShower(4);
+
+    CHECK(serial.fCut == 2048);
+    CHECK(serial.fSplit == 2047);
+    CHECK(serial.fSplits > 0);
+    CHECK(serial.fRecord.size() == 2047);
+
+    // independent of the number of workers
+    CHECK(parallel.fCut == 2048);
+    CHECK(parallel.fSplit == 2047);
+    CHECK(parallel.fSplits == serial.fSplits);
+    CHECK(parallel.fRecord == serial.fRecord);
+  }
+
+  SECTION("move particles") {
+    TestCascadeStack from, to;
+    for (int i = 1; i <= 5; ++i) { from.AddParticle(electron(i * 1_GeV)); }
+    from.ResetLowWater();
+    Scheduler::MoveParticles(from, 2, to);
+    CHECK(from.GetLowWater() == 0);
+    REQUIRE(from.GetSize() == 3);
+    REQUIRE(to.GetSize() == 2);
+    CHECK(to.begin().GetEnergy() == 1_GeV);
+    CHECK((to.begin() + 1).GetEnergy() == 2_GeV);
+    CHECK(from.begin().GetEnergy() == 3_GeV);
+    CHECK((from.begin() + 2).GetEnergy() == 5_GeV);
+  }
+
+  SECTION("exceptions") {
+    CHECK_THROWS(Scheduler(0, 8));
+    CHECK_THROWS(Scheduler(1, 1));
+
+    Scheduler scheduler(2, 8);
+    scheduler.AddTask();
+    scheduler.AddTask();
+    CHECK_THROWS(scheduler.Run([](std::size_t, Scheduler::Task&) {
+      throw std::runtime_error("failed task");
+    }));
+  }
+}
+
+TEST_CASE("Cascade lineage", "[Cascade]") {
+
+  random::RNGManager& rmng = random::RNGManager::GetInstance();
+  rmng.RegisterRandomStream("cascade");
+
+  auto env = MakeDummyEnv();
+  CoordinateSystem const& rootCS =
+      RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+  auto const electron = std::tuple<particles::Code, units::si::HEPEnergyType,
+                                   corsika::stack::MomentumVector, geometry::Point,
+                                   units::si::TimeType>{
+      particles::Code::Electron, 100_GeV,
+      corsika::stack::MomentumVector(rootCS, {0_GeV, 0_GeV, -1_GeV}),
+      Point(rootCS, {0_m, 0_m, 10_km}), 0_ns};
+
+  // the sorted z positions of all steps of the shower
+  auto runShower = [&](StackOrder const vOrder, bool const vLineage) {
+    tracking_line::TrackingLine tracking;
+    ProcessSplit split(20_g / square(1_cm));
+    ProcessRecord record;
+    ProcessCut cut(85_MeV);
+    auto sequence = split << record << cut;
+    std::vector<double> steps;
+    record.fRecord = &steps;
+
+    using Stack = OrderedStack<TestCascadeStack>;
+    Stack stack;
+    stack.SetOrder(vOrder);
+    cascade::Cascade<tracking_line::TrackingLine, decltype(sequence), Stack,
+                     TestCascadeStackView>
+        EAS(env, tracking, sequence, stack);
+    EAS.SetLineageRNG(vLineage);
+    stack.AddParticle(electron);
+    EAS.Init();
+    EAS.Run();
+    CHECK(cut.GetCount() == 2048);
+    std::sort(steps.begin(), steps.end());
+    return steps;
+  };
+
+  SECTION("stack order") {
+    rmng.SeedAll(1);
+    auto const lifo = runShower(StackOrder::eLastInFirstOut, true);
+    rmng.SeedAll(2);
+    auto const ordered = runShower(StackOrder::eLowestEnergyFirst, true);
+    CHECK(lifo.size() == 2047);
+    CHECK(ordered == lifo);
+
+    // but not without lineage keys
+    rmng.SeedAll(1);
+    auto const plain = runShower(StackOrder::eLowestEnergyFirst, false);
+    CHECK(plain.size() == 2047);
+    CHECK(plain != lifo);
+  }
+
+  SECTION("sub-showers") {
+    auto const lifo = runShower(StackOrder::eLastInFirstOut, true);
+
+    using Scheduler = cascade::SubShowerScheduler<TestCascadeStack>;
+    struct Worker {
+      Worker(Scheduler& vScheduler, std::size_t const vIndex)
+          : fSplitter(vScheduler, vIndex)
+          , fSequence(fSplit << fRecord << fCut << fSplitter) {}
+
+      tracking_line::TrackingLine fTracking;
+      ProcessSplit fSplit{20_g / square(1_cm)};
+      ProcessRecord fRecord;
+      ProcessCut fCut{85_MeV};
+      cascade::SubShowerSplitter<Scheduler> fSplitter;
+      decltype(fSplit << fRecord << fCut << fSplitter) fSequence;
+    };
+
+    std::size_t const nWorkers = 4;
+    Scheduler scheduler(nWorkers, 5, 7);
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (std::size_t i = 0; i < nWorkers; ++i) {
+      workers.push_back(std::make_unique<Worker>(scheduler, i));
+    }
+    cascade::ShardedResults<std::vector<double>> output;
+
+    scheduler.AddTask().AddParticle(electron);
+    scheduler.Run([&](std::size_t const vWorker, Scheduler::Task& vTask) {
+      auto& w = *workers[vWorker];
+      w.fRecord.fRecord = &output.GetShard(vTask.GetId());
+      cascade::Cascade<tracking_line::TrackingLine, decltype(w.fSequence),
+                       TestCascadeStack, TestCascadeStackView>
+          EAS(env, w.fTracking, w.fSequence, vTask.GetStack());
+      EAS.SetRNG(vTask.GetRNG());
+      EAS.SetLineageRNG(true, false);
+      EAS.Run();
+    });
+
+    std::vector<double> steps;
+    output.ForEach([&](uint64_t, std::vector<double> const& vShard) {
+      steps.insert(steps.end(), vShard.begin(), vShard.end());
+    });
+    std::sort(steps.begin(), steps.end());
+    CHECK(scheduler.GetNumberOfSplits() > 0);
+    CHECK(steps == lifo);
+  }
+
+  SECTION("batched") {
+    auto const lifo = runShower(StackOrder::eLastInFirstOut, true);
+    CHECK(lifo.size() == 2047);
+
+    tracking_line::TrackingLine tracking;
+    ProcessSplit split(20_g / square(1_cm));
+    ProcessCut cut(85_MeV);
+    auto sequence = split << cut;
+    TestCascadeStack stack;
+    cascade::Cascade<tracking_line::TrackingLine, decltype(sequence), TestCascadeStack,
+                     TestCascadeStackView>
+        EAS(env, tracking, sequence, stack);
+    EAS.SetLineageRNG(true);
+    CHECK(EAS.GetLineageRNG());
+    stack.AddParticle(electron);
+    EAS.RunBatched(3);
+    CHECK(cut.GetCount() == 2048);
+  }
+}
+
+TEST_CASE("Cascade stack order", "[Cascade]") {
+
+  HEPEnergyType E0 = 100_GeV;
+
+  random::RNGManager& rmng = random::RNGManager::GetInstance();
+  rmng.RegisterRandomStream("cascade");
+
+  auto const order = GENERATE(StackOrder::eLastInFirstOut, StackOrder::eLowestEnergyFirst,
+                              StackOrder::eHighestGenerationFirst, StackOrder::eHybrid);
+
+  auto env = MakeDummyEnv();
+  tracking_line::TrackingLine tracking;
+  ProcessSplit split(20_g / square(1_cm));
+  ProcessCut cut(85_MeV);
+  auto sequence = split << cut;
+
+  using Stack = OrderedStack<TestCascadeStack>;
+  Stack stack;
+  stack.SetOrder(order);
+  stack.SetHybridThreshold(4);
+
+  cascade::Cascade<tracking_line::TrackingLine, decltype(sequence), Stack,
+                   TestCascadeStackView>
+      EAS(env, tracking, sequence, stack);
+  CoordinateSystem const& rootCS =
+      RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+
+  stack.Clear();
+  stack.AddParticle(
+      std::tuple<particles::Code, units::si::HEPEnergyType,
+                 corsika::stack::MomentumVector, geometry::Point, units::si::TimeType>{
+          particles::Code::Electron, E0,
+          corsika::stack::MomentumVector(rootCS, {0_GeV, 0_GeV, -1_GeV}),
+          Point(rootCS, {0_m, 0_m, 10_km}), 0_ns});
+  EAS.Init();
+  EAS.Run();
+
+  // the same shower, only processed in a different order
+  CHECK(cut.GetCount() == 2048);
+  CHECK(split.GetCalls() == 2047);
+  CHECK(stack.GetPeakSize() <= 12);
+}
+
+TEST_CASE("Cascade step allocations", "[Cascade]") {
+
+  random::RNGManager& rmng = random::RNGManager::GetInstance();
+  rmng.RegisterRandomStream("cascade");
+
+  auto env = MakeDummyEnv();
+  tracking_line::TrackingLine tracking;
+  ProcessSplit split(20_g / square(1_cm));
+  ProcessCut cut(85_MeV);
+  auto sequence = split << cut;
+
+  TestCascadeStack stack;
+  cascade::Cascade<tracking_line::TrackingLine, decltype(sequence), TestCascadeStack,
+                   TestCascadeStackView>
+      EAS(env, tracking, sequence, stack);
+  CoordinateSystem const& rootCS =
+      RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+
+  auto shower = [&]() {
+    stack.Clear();
+    stack.AddParticle(
+        std::tuple<particles::Code, units::si::HEPEnergyType,
+                   corsika::stack::MomentumVector, geometry::Point, units::si::TimeType>{
+            particles::Code::Electron, 100_GeV,
+            corsika::stack::MomentumVector(rootCS, {0_GeV, 0_GeV, -1_GeV}),
+            Point(rootCS, {0_m, 0_m, 10_km}), 0_ns});
+    EAS.Run();
+  };
+
+  EAS.Init();
+  // the first shower sizes the stack, the step arena and the caches
+  shower();
+  std::size_t const nAllocations = testing::GetNumberOfAllocations();
+  shower();
+  CHECK(testing::GetNumberOfAllocations() - nAllocations == 0);
+  CHECK(cut.GetCount() == 2 * 2048);
+  CHECK(EAS.GetStepArena().GetCapacity() > 0);
+}
+
+TEST_CASE("Cascade particle classes", "[Cascade]") {
+
+  HEPEnergyType E0 = 100_GeV;
+
+  random::RNGManager& rmng = random::RNGManager::GetInstance();
+  rmng.RegisterRandomStream("cascade");
+
+  auto env = MakeDummyEnv();
+  tracking_line::TrackingLine tracking;
+  ProcessSplit split(20_g / square(1_cm));
+  ProcessCut cut(85_MeV);
+  auto sequence = split << cut;
+
+  using Stack = stack::particle_class::ParticleClassStack<TestCascadeStack>;
+  Stack stack;
+  stack.SetClassOrder({particles::ParticleClass::eMuon});
+
+  cascade::Cascade<tracking_line::TrackingLine, decltype(sequence), Stack,
+                   TestCascadeStackView>
+      EAS(env, tracking, sequence, stack);
+  CoordinateSystem const& rootCS =
+      RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+
+  stack.Clear();
+  for (auto const pid :
+       {particles::Code::Electron, particles::Code::Proton, particles::Code::MuMinus}) {
+    stack.AddParticle(
+        std::tuple<particles::Code, units::si::HEPEnergyType,
+                   corsika::stack::MomentumVector, geometry::Point, units::si::TimeType>{
+            pid, E0, corsika::stack::MomentumVector(rootCS, {0_GeV, 0_GeV, -1_GeV}),
+            Point(rootCS, {0_m, 0_m, 10_km}), 0_ns});
+  }
+  EAS.Init();
+  EAS.Run();
+
+  // three times the same shower, one class after the other
+  CHECK(cut.GetCount() == 3 * 2048);
+  CHECK(split.GetCalls() == 3 * 2047);
+  CHECK(stack.GetNumberOfClassSwitches() == 3);
+}
+
+TEST_CASE("DeltaTracking", "[Cascade]") {
+
+  random::RNGManager& rmng = random::RNGManager::GetInstance();
+  rmng.RegisterRandomStream("deltatracking");
+  auto& rng = rmng.GetRandomStream("deltatracking");
+
+  CoordinateSystem const& rootCS =
+      RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+  environment::NuclearComposition const protonComposition(
+      std::vector<particles::Code>{particles::Code::Proton}, std::vector<float>{1.f});
+
+  // exponential atmosphere, density increasing by e^2 along the track
+  LengthType const lambda = 1_km;
+  LengthType const maxLength = 2_km;
+  MassDensityType const rho0 = 1_kg / (1_m * 1_m * 1_m);
+  Vector<dimensionless_d> const axis(rootCS, QuantityVector<dimensionless_d>(0, 0, 1));
+  Point const start(rootCS, {0_m, 0_m, 0_m});
+  using ExpMedium = environment::FlatExponential<environment::IMediumModel>;
+  environment::MajorantDensity<ExpMedium> const medium(rho0 * exp(2.), start, axis,
+                                                       rho0, lambda, protonComposition);
+
+  Line const line(start, Vector<SpeedType::dimension_type>(rootCS, {0_m / second,
+                                                                     0_m / second,
+                                                                     1_m / second}));
+  setup::Trajectory const track(line, maxLength / (1_m / second));
+
+  InverseGrammageType const invLambda = 1 / (1000_g / square(1_cm));
+
+  SECTION("majorant") {
+    CHECK(medium.GetMajorantMassDensity() / (rho0 * exp(2.)) == Approx(1));
+    CHECK(std::isinf(ExpMedium(start, axis, rho0, lambda, protonComposition)
+                         .GetMajorantMassDensity()
+                         .magnitude()));
+    environment::HomogeneousMedium<environment::IMediumModel> const homogeneous(
+        rho0, protonComposition);
+    CHECK(homogeneous.GetMajorantMassDensity() / rho0 == Approx(1));
+  }
+
+  SECTION("compare to grammage integration") {
+    // capped mean distance and probability to cross the track without interaction,
+    // sampled with delta tracking and with the grammage conversion
+    int const n = 100000;
+    LengthType sumDelta = 0_m, sumIntegration = 0_m;
+    int noInteractionDelta = 0, noInteractionIntegration = 0;
+    random::ExponentialDistribution expDist(1 / invLambda);
+
+    for (int i = 0; i < n; ++i) {
+      auto const dDelta =
+          cascade::DeltaTrackingDistance(medium, track, invLambda, maxLength, rng);
+      if (dDelta >= maxLength) {
+        ++noInteractionDelta;
+        sumDelta += maxLength;
+      } else {
+        sumDelta += dDelta;
+      }
+
+      auto const dIntegration = medium.ArclengthFromGrammage(track, expDist(rng));
+      if (dIntegration >= maxLength) {
+        ++noInteractionIntegration;
+        sumIntegration += maxLength;
+      } else {
+        sumIntegration += dIntegration;
+      }
+    }
+
+    // analytically: X(L) = rho0 lambda (e^2 - 1), P(no interaction) = exp(-X(L)/X0)
+    double const pNoInteraction = exp(-(rho0 * lambda * (exp(2.) - 1)) * invLambda);
+    double const sigma = sqrt(pNoInteraction * (1 - pNoInteraction) / n);
+    CHECK(noInteractionDelta / double(n) == Approx(pNoInteraction).margin(5 * sigma));
+    CHECK(noInteractionIntegration / double(n) ==
+          Approx(pNoInteraction).margin(5 * sigma));
+    CHECK(sumDelta / sumIntegration == Approx(1).epsilon(0.01));
+  }
+
+  SECTION("majorant violated") {
+    environment::MajorantDensity<ExpMedium> const wrongMedium(
+        rho0 / 10, start, axis, rho0, lambda, protonComposition);
+    // short mean free path, so that there is a candidate collision for sure
+    InverseGrammageType const largeInvLambda = 1 / (1_g / square(1_cm));
+    REQUIRE_THROWS(cascade::DeltaTrackingDistance(wrongMedium, track, largeInvLambda,
+                                                  maxLength, rng));
+  }
+
+  SECTION("infinite step limit") {
+    REQUIRE_THROWS(cascade::DeltaTrackingDistance(
+        medium, track, invLambda, std::numeric_limits<double>::infinity() * 1_m, rng));
+  }
 }
@@ -26,17 +26,28 @@ using StackWithGeometryInterface = corsika::stack::CombinedParticleInterface<
     corsika::setup::detail::ParticleDataStack::PIType, SetupGeometryDataInterface,
     StackIter>;
 
-using TestCascadeStack = corsika::stack::CombinedStack<
+using TestStackWithGeometry = corsika::stack::CombinedStack<
     typename corsika::setup::detail::ParticleDataStack::StackImpl,
     GeometryData<TestEnvironmentType>, StackWithGeometryInterface>;
 
+// and with lineage keys, like setup::Stack
+template <typename StackIter>
+using StackWithLineageInterface = corsika::stack::CombinedParticleInterface<
+    TestStackWithGeometry::PIType, corsika::stack::lineage::LineageDataInterface,
+    StackIter>;
+
+using TestCascadeStack =
+    corsika::stack::CombinedStack<typename TestStackWithGeometry::StackImpl,
+                                  corsika::stack::lineage::LineageData,
+                                  StackWithLineageInterface>;
+
 /*
   See also Issue 161
 */
 #if defined(__clang__)
 using TestCascadeStackView =
     corsika::stack::SecondaryView<typename TestCascadeStack::StackImpl,
-                                  StackWithGeometryInterface>;
+                                  StackWithLineageInterface>;
 #elif defined(__GNUC__) || defined(__GNUG__)
 using TestCascadeStackView = corsika::stack::MakeView<TestCascadeStack>::type;
 #endif
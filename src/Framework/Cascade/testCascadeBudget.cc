@@ -0,0 +1,352 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+/**
+ * Budgets of small deterministic showers, against regressions in the hot
+ * path: heap allocations per step, attributed to the tracking, to each
+ * process and to the Cascade itself, the number of steps per shower and
+ * the wall time per step, compared to the baseline below.
+ *
+ * The time budget is Baseline::fNanoSecondsPerStep times the factor in
+ * the environment variable CORSIKA_TIME_BUDGET_FACTOR. Without it the
+ * time is not checked, since it depends on the machine and the build
+ * type; ctest sets it for Release builds without sanitizers only. The
+ * allocation and step budgets are always checked, they allow for the
+ * rare growth of the step arena and of caches in the models.
+ */
+
+#include <corsika/cascade/Cascade.h>
+#include <corsika/environment/Environment.h>
+#include <corsika/environment/HomogeneousMedium.h>
+#include <corsika/environment/NuclearComposition.h>
+#include <corsika/geometry/Sphere.h>
+#include <corsika/process/BoundaryCrossingProcess.h>
+#include <corsika/process/ContinuousProcess.h>
+#include <corsika/process/DecayProcess.h>
+#include <corsika/process/InteractionProcess.h>
+#include <corsika/process/ProcessSequence.h>
+#include <corsika/process/SecondariesProcess.h>
+#include <corsika/process/null_model/NullModel.h>
+#include <corsika/process/particle_cut/ParticleCut.h>
+#include <corsika/process/sibyll/Decay.h>
+#include <corsika/process/sibyll/Interaction.h>
+#include <corsika/process/sibyll/NuclearInteraction.h>
+#include <corsika/process/tracking_line/TrackingLine.h>
+#include <corsika/random/RNGManager.h>
+#include <corsika/setup/SetupEnvironment.h>
+#include <corsika/setup/SetupStack.h>
+#include <corsika/testing/AllocationCounter.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+using namespace corsika;
+using namespace corsika::process;
+using namespace corsika::units::si;
+
+namespace {
+
+  /// the allocations and calls booked under one name
+  struct Phase {
+    std::string fName;
+    double fBudget; //!< allocations per step
+    std::size_t fAllocations = 0;
+    std::size_t fCalls = 0;
+  };
+
+  /// books the allocations during its lifetime to vPhase
+  class Booking {
+  public:
+    explicit Booking(Phase& vPhase)
+        : fPhase(vPhase)
+        , fStart(testing::GetNumberOfAllocations()) {
+      ++fPhase.fCalls;
+    }
+    ~Booking() { fPhase.fAllocations += testing::GetNumberOfAllocations() - fStart; }
+
+  private:
+    Phase& fPhase;
+    std::size_t const fStart;
+  };
+
+  /**
+   * Forwards the calls of the Cascade to TProcess, which is of the kind
+   * TKind (InteractionProcess, DecayProcess, ...), and books them to a
+   * Phase.
+   */
+  template <typename TProcess, template <typename> typename TKind>
+  class Booked : public TKind<Booked<TProcess, TKind>> {
+  public:
+    Booked(TProcess& vProcess, Phase& vPhase)
+        : fProcess(vProcess)
+        , fPhase(vPhase) {}
+
+    void Init() { fProcess.Init(); }
+
+    template <typename TParticle>
+    decltype(auto) GetInteractionLength(TParticle& vP) {
+      Booking const b(fPhase);
+      return fProcess.GetInteractionLength(vP);
+    }
+    template <typename TProjectile>
+    decltype(auto) DoInteraction(TProjectile& vP) {
+      Booking const b(fPhase);
+      return fProcess.DoInteraction(vP);
+    }
+    template <typename TParticle>
+    decltype(auto) GetLifetime(TParticle& vP) {
+      Booking const b(fPhase);
+      return fProcess.GetLifetime(vP);
+    }
+    template <typename TProjectile>
+    decltype(auto) DoDecay(TProjectile& vP) {
+      Booking const b(fPhase);
+      return fProcess.DoDecay(vP);
+    }
+    template <typename TSecondaries>
+    decltype(auto) DoSecondaries(TSecondaries& vS) {
+      Booking const b(fPhase);
+      return fProcess.DoSecondaries(vS);
+    }
+    template <typename TParticle, typename TTrack>
+    decltype(auto) DoContinuous(TParticle& vP, TTrack& vT) {
+      Booking const b(fPhase);
+      return fProcess.DoContinuous(vP, vT);
+    }
+    template <typename TParticle, typename TTrack>
+    decltype(auto) MaxStepLength(TParticle& vP, TTrack& vT) {
+      Booking const b(fPhase);
+      return fProcess.MaxStepLength(vP, vT);
+    }
+
+  private:
+    TProcess& fProcess;
+    Phase& fPhase;
+  };
+
+  template <template <typename> typename TKind, typename TProcess>
+  auto Book(TProcess& vProcess, Phase& vPhase) {
+    return Booked<TProcess, TKind>(vProcess, vPhase);
+  }
+
+  /// the tracking, booked to a Phase; every call is one step
+  class BookedTracking {
+  public:
+    explicit BookedTracking(Phase& vPhase)
+        : fPhase(vPhase) {}
+
+    template <typename TParticle>
+    auto GetTrack(TParticle const& vP) {
+      Booking const b(fPhase);
+      return fTracking.GetTrack(vP);
+    }
+
+  private:
+    process::tracking_line::TrackingLine fTracking;
+    Phase& fPhase;
+  };
+
+  /// removes the particles leaving the world
+  class Absorber : public BoundaryCrossingProcess<Absorber> {
+  public:
+    void Init() {}
+
+    template <typename TParticle, typename TNode>
+    EProcessReturn DoBoundaryCrossing(TParticle& vP, TNode const&, TNode const& vTo) {
+      if (!vTo.HasModelProperties()) { vP.Delete(); }
+      return EProcessReturn::eOk;
+    }
+  };
+
+  using EnvType = environment::Environment<setup::IEnvironmentModel>;
+
+  /// homogeneous air in a sphere of radius vRadius
+  std::unique_ptr<EnvType> MakeAir(LengthType const vRadius) {
+    auto env = std::make_unique<EnvType>();
+    auto medium = EnvType::CreateNode<geometry::Sphere>(
+        geometry::Point{env->GetCoordinateSystem(), 0_m, 0_m, 0_m}, vRadius);
+    medium->SetModelProperties<
+        environment::HomogeneousMedium<setup::IEnvironmentModel>>(
+        1_kg / (1_m * 1_m * 1_m),
+        environment::NuclearComposition(
+            std::vector<particles::Code>{particles::Code::Nitrogen,
+                                         particles::Code::Oxygen},
+            std::vector<float>{0.79f, 0.21f}));
+    env->GetUniverse()->AddChild(std::move(medium));
+    return env;
+  }
+
+  /**
+   * Discards everything written to std::cout during its lifetime. The
+   * output is still formatted, but does not end up in the buffers of the
+   * test reporter, which would count as allocations.
+   */
+  class DiscardCout {
+    struct NullBuffer : std::streambuf {
+      int overflow(int vC) override { return vC; }
+    };
+
+  public:
+    DiscardCout()
+        : fPrevious(std::cout.rdbuf(&fNull)) {}
+    ~DiscardCout() { std::cout.rdbuf(fPrevious); }
+
+  private:
+    NullBuffer fNull;
+    std::streambuf* const fPrevious;
+  };
+
+  /// the result of one shower
+  struct Shower {
+    std::size_t fSteps;
+    double fNanoSeconds;
+  };
+
+  template <typename TCascade>
+  Shower RunShower(TCascade& vEAS, setup::Stack& vStack, Phase& vTracking,
+                   Phase& vCascade) {
+    auto const& rootCS =
+        geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+    vStack.Clear();
+    vStack.AddParticle(
+        std::tuple<particles::Code, HEPEnergyType, corsika::stack::MomentumVector,
+                   geometry::Point, TimeType>{
+            particles::Code::Proton, 1_TeV,
+            corsika::stack::MomentumVector(rootCS, {0_GeV, 0_GeV, -1_TeV}),
+            geometry::Point(rootCS, {0_m, 0_m, 0_m}), 0_ns});
+
+    std::size_t const steps = vTracking.fCalls;
+    auto const start = std::chrono::steady_clock::now();
+    {
+      DiscardCout const discard;
+      Booking const b(vCascade); // everything, the processes are subtracted later
+      vEAS.Run();
+    }
+    auto const stop = std::chrono::steady_clock::now();
+    return Shower{vTracking.fCalls - steps,
+                  std::chrono::duration<double, std::nano>(stop - start).count()};
+  }
+
+  /// the stored baseline of a shower, see Check()
+  struct Baseline {
+    std::size_t fSteps;        //!< steps of the first shower
+    double fNanoSecondsPerStep; //!< in a release build
+  };
+
+  double TimeBudgetFactor() {
+    char const* const factor = std::getenv("CORSIKA_TIME_BUDGET_FACTOR");
+    return factor ? std::atof(factor) : 0;
+  }
+
+  /**
+   * Runs a shower to warm up, and vNShowers to measure, and checks the
+   * budgets. The Cascade phase gets the allocations not booked to any
+   * other phase.
+   */
+  template <typename TCascade>
+  void Check(TCascade& vEAS, setup::Stack& vStack, std::vector<Phase*> const& vPhases,
+             Phase& vTracking, Phase& vCascade, Baseline const& vBaseline,
+             int const vNShowers) {
+    vEAS.Init();
+    Shower const first = RunShower(vEAS, vStack, vTracking, vCascade);
+    INFO("steps of the first shower: " << first.fSteps << ", baseline "
+                                       << vBaseline.fSteps);
+    CHECK(first.fSteps <= 1.2 * vBaseline.fSteps);
+    CHECK(first.fSteps >= 0.8 * vBaseline.fSteps);
+
+    for (auto* const phase : vPhases) { phase->fAllocations = phase->fCalls = 0; }
+    std::size_t steps = 0;
+    double nanoSecondsPerStep = std::numeric_limits<double>::infinity();
+    for (int i = 0; i < vNShowers; ++i) {
+      Shower const shower = RunShower(vEAS, vStack, vTracking, vCascade);
+      steps += shower.fSteps;
+      nanoSecondsPerStep =
+          std::min(nanoSecondsPerStep, shower.fNanoSeconds / shower.fSteps);
+    }
+    REQUIRE(steps > 0);
+
+    for (auto* const phase : vPhases) {
+      if (phase != &vCascade) { vCascade.fAllocations -= phase->fAllocations; }
+    }
+    for (auto* const phase : vPhases) {
+      double const perStep = double(phase->fAllocations) / steps;
+      INFO(phase->fName << ": " << perStep << " allocations per step in " << steps
+                        << " steps, budget " << phase->fBudget);
+      CHECK(perStep <= phase->fBudget);
+    }
+
+    double const factor = TimeBudgetFactor();
+    if (factor > 0) {
+      INFO("wall time: " << nanoSecondsPerStep << " ns per step, baseline "
+                         << vBaseline.fNanoSecondsPerStep << " ns, factor " << factor);
+      CHECK(nanoSecondsPerStep <= factor * vBaseline.fNanoSecondsPerStep);
+    }
+  }
+
+} // namespace
+
+TEST_CASE("Cascade budget", "[Cascade]") {
+
+  random::RNGManager::GetInstance().RegisterRandomStream("cascade");
+  random::RNGManager::GetInstance().RegisterRandomStream("s_rndm");
+
+  Phase tracking{"tracking", 0};
+  Phase cascade{"Cascade", 0.01};
+  setup::Stack stack;
+  Absorber absorber;
+
+  SECTION("NullModel") {
+    // 100 steps of 100 m and one to the boundary, which must not end
+    // exactly on a step
+    auto const env = MakeAir(10.05_km);
+    null_model::NullModel null(100_m);
+    Phase nullPhase{"NullModel", 0};
+    auto bookedNull = Book<ContinuousProcess>(null, nullPhase);
+    auto sequence = bookedNull << absorber;
+    BookedTracking bookedTracking(tracking);
+    cascade::Cascade EAS(*env, bookedTracking, sequence, stack);
+
+    Check(EAS, stack, {&tracking, &cascade, &nullPhase}, tracking, cascade,
+          Baseline{101, 8000}, 10);
+  }
+
+  SECTION("Sibyll") {
+    auto const env = MakeAir(10_km);
+    process::sibyll::Interaction sibyll;
+    process::sibyll::NuclearInteraction sibyllNuc(sibyll, *env);
+    process::sibyll::Decay decay;
+    process::particle_cut::ParticleCut cut(1_GeV);
+
+    Phase sibyllPhase{"sibyll::Interaction", 0.5};
+    Phase sibyllNucPhase{"sibyll::NuclearInteraction", 0.5};
+    Phase decayPhase{"sibyll::Decay", 0.5};
+    Phase cutPhase{"ParticleCut", 0};
+    auto bookedSibyll = Book<InteractionProcess>(sibyll, sibyllPhase);
+    auto bookedSibyllNuc = Book<InteractionProcess>(sibyllNuc, sibyllNucPhase);
+    auto bookedDecay = Book<DecayProcess>(decay, decayPhase);
+    auto bookedCut = Book<SecondariesProcess>(cut, cutPhase);
+    auto sequence =
+        bookedSibyll << bookedSibyllNuc << bookedDecay << bookedCut << absorber;
+    BookedTracking bookedTracking(tracking);
+    cascade::Cascade EAS(*env, bookedTracking, sequence, stack);
+
+    Check(EAS, stack,
+          {&tracking, &cascade, &sibyllPhase, &sibyllNucPhase, &decayPhase, &cutPhase},
+          tracking, cascade, Baseline{84, 300000}, 10);
+  }
+}
@@ -27,6 +27,16 @@ namespace corsika::geometry {
         \vec{v}_{\parallel} &= \frac{\vec{v}_0 \cdot \vec{B}}{\vec{B}^2} \vec{B} \\
         \vec{v}_{\perp} &= \vec{v}_0 - \vec{v}_{\parallel}
      \f}
+   *
+   * The position at time \f$ t \f$ is
+   * \f[
+        \vec{r}(t) = \vec{r}_0 + \vec{v}_{\parallel} t + \frac{1}{\omega_c} \left(
+                     \vec{v}_{\perp} \sin(\omega_c t) +
+                     \vec{u}_{\perp} (1 - \cos(\omega_c t)) \right)
+     \f]
+   * with \f$ \vec{u}_{\perp} = \vec{v}_{\perp} \times \hat{B} \f$. The sign of
+   * \f$ \omega_c \f$ is the sign of the electric charge. A vanishing
+   * \f$ \omega_c \f$ is allowed and describes a straight line.
    */
 
   class Helix {
@@ -41,18 +51,35 @@ namespace corsika::geometry {
     corsika::units::si::LengthType const radius;
 
   public:
+    /*!
+     * The axis of the helix is taken from \p pvPar, which therefore must not vanish.
+     */
     Helix(Point const& pR0, corsika::units::si::FrequencyType pOmegaC,
           VelocityVec const& pvPar, VelocityVec const& pvPerp)
+        : Helix(pR0, pOmegaC, pvPar, pvPerp, pvPerp.cross(pvPar.normalized())) {}
+
+    /*!
+     * \p puPerp has to be \f$ \vec{v}_{\perp} \times \hat{B} \f$, use this constructor
+     * if \f$ \vec{v}_{\parallel} \f$ may vanish.
+     */
+    Helix(Point const& pR0, corsika::units::si::FrequencyType pOmegaC,
+          VelocityVec const& pvPar, VelocityVec const& pvPerp, VelocityVec const& puPerp)
         : r0(pR0)
         , omegaC(pOmegaC)
         , vPar(pvPar)
         , vPerp(pvPerp)
-        , uPerp(vPerp.cross(vPar.normalized()))
-        , radius(pvPar.norm() / abs(pOmegaC)) {}
+        , uPerp(puPerp)
+        , radius(pvPerp.norm() / abs(pOmegaC)) {}
 
     Point GetPosition(corsika::units::si::TimeType t) const {
+      if (omegaC.magnitude() == 0) { return r0 + (vPar + vPerp) * t; }
       return r0 + vPar * t +
-             (vPerp * (cos(omegaC * t) - 1) + uPerp * sin(omegaC * t)) / omegaC;
+             (vPerp * sin(omegaC * t) + uPerp * (1 - cos(omegaC * t))) / omegaC;
+    }
+
+    //! the velocity at time \p t, its norm is constant
+    VelocityVec GetVelocity(corsika::units::si::TimeType t) const {
+      return vPar + vPerp * cos(omegaC * t) + uPerp * sin(omegaC * t);
     }
 
     Point PositionFromArclength(corsika::units::si::LengthType l) const {
@@ -60,6 +87,10 @@ namespace corsika::geometry {
     }
 
     auto GetRadius() const { return radius; }
+    auto GetOmegaC() const { return omegaC; }
+    auto GetVPerp() const { return vPerp; }
+    auto GetR0() const { return r0; }
+    auto GetV0() const { return vPar + vPerp; }
 
     corsika::units::si::LengthType ArcLength(corsika::units::si::TimeType t1,
                                              corsika::units::si::TimeType t2) const {
@@ -11,6 +11,7 @@
 #ifndef _include_TRAJECTORY_H
 #define _include_TRAJECTORY_H
 
+#include <corsika/geometry/Helix.h>
 #include <corsika/geometry/Line.h>
 #include <corsika/geometry/Point.h>
 #include <corsika/units/PhysicalUnits.h>
@@ -55,6 +56,30 @@ namespace corsika::geometry {
     }
   };
 
+  /**
+   * Straight-line approximation of a trajectory, e.g. for the grammage integration of
+   * the media, which only know about straight lines. For a Line this is the identity.
+   */
+  inline Trajectory<Line> const& LinearApproximation(Trajectory<Line> const& vTrack) {
+    return vTrack;
+  }
+
+  /**
+   * A Trajectory<Helix> is approximated by its chord. The speed along the chord is the
+   * one of the helix, so that the length of the result equals the arc length of the
+   * helix. This is a good approximation only as long as the bending angle is small.
+   */
+  inline Trajectory<Line> LinearApproximation(Trajectory<Helix> const& vTrack) {
+    auto const v0 = vTrack.GetV0();
+    auto const chord = vTrack.GetPosition(1.) - vTrack.GetR0();
+    auto const chordLength = chord.norm();
+    if (chordLength.magnitude() == 0) {
+      return Trajectory<Line>(Line(vTrack.GetR0(), v0), vTrack.GetDuration());
+    }
+    return Trajectory<Line>(Line(vTrack.GetR0(), chord * (v0.norm() / chordLength)),
+                            vTrack.GetDuration());
+  }
+
 } // namespace corsika::geometry
 
 #endif
@@ -0,0 +1,66 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+/**
+ * Transformations of Point and Vector between coordinate systems: in the
+ * same system, to a translated and rotated system one level below the
+ * root, and between two such systems in different branches of the tree.
+ */
+
+#include <corsika/geometry/CoordinateSystem.h>
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/geometry/Vector.h>
+#include <corsika/testing/Benchmark.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <cmath>
+
+using namespace corsika;
+using namespace corsika::geometry;
+using namespace corsika::units::si;
+using corsika::testing::DoNotOptimize;
+using corsika::testing::RunBenchmark;
+
+int main() {
+  CoordinateSystem& rootCS =
+      RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+  // keep the intermediate systems alive, the rotated ones refer to them
+  CoordinateSystem const translated1 = rootCS.translate({1_km, 2_km, 3_km});
+  CoordinateSystem const cs1 =
+      translated1.rotate(QuantityVector<length_d>(1_m, 1_m, 0_m), 0.3);
+  CoordinateSystem const translated2 = rootCS.translate({-1_km, 0_km, 10_km});
+  CoordinateSystem const cs2 =
+      translated2.rotate(QuantityVector<length_d>(0_m, 0_m, 1_m), M_PI / 5);
+
+  Point const point(cs1, {10_m, 20_m, 30_m});
+  Vector<hepmomentum_d> const momentum(cs1, {1_GeV, -2_GeV, 3_GeV});
+
+  RunBenchmark("Point::GetCoordinates same system", [&]() {
+    DoNotOptimize(point.GetCoordinates(cs1));
+  });
+  RunBenchmark("Point::GetCoordinates to root", [&]() {
+    DoNotOptimize(point.GetCoordinates(rootCS));
+  });
+  RunBenchmark("Point::GetCoordinates across branches", [&]() {
+    DoNotOptimize(point.GetCoordinates(cs2));
+  });
+  RunBenchmark("Vector::GetComponents to root", [&]() {
+    DoNotOptimize(momentum.GetComponents(rootCS));
+  });
+  RunBenchmark("Vector::GetComponents across branches", [&]() {
+    DoNotOptimize(momentum.GetComponents(cs2));
+  });
+
+  Point const other(cs2, {1_m, 2_m, 3_m});
+  RunBenchmark("Point - Point across branches", [&]() {
+    DoNotOptimize((point - other).norm());
+  });
+}
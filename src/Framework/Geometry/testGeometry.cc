@@ -198,7 +198,23 @@ TEST_CASE("Trajectories") {
               .magnitude() == Approx(0).margin(absMargin));
 
     CHECK((helix.GetPosition(0.25_s).GetCoordinates() -
-           QuantityVector<length_d>(-3_m / (2 * M_PI), -3_m / (2 * M_PI), 1_m))
+           QuantityVector<length_d>(3_m / (2 * M_PI), -3_m / (2 * M_PI), 1_m))
+              .norm()
+              .magnitude() == Approx(0).margin(absMargin));
+
+    CHECK(helix.GetRadius() / (3_m / (2 * M_PI)) == Approx(1));
+
+    // the initial velocity is the sum of both components
+    CHECK((helix.GetVelocity(0_s).GetComponents() -
+           QuantityVector<SpeedType::dimension_type>(3_m / second, 0_m / second,
+                                                    4_m / second))
+              .norm()
+              .magnitude() == Approx(0).margin(absMargin));
+
+    // after half a period the perpendicular component is reversed
+    CHECK((helix.GetVelocity(0.5_s).GetComponents() -
+           QuantityVector<SpeedType::dimension_type>(-3_m / second, 0_m / second,
+                                                    4_m / second))
               .norm()
               .magnitude() == Approx(0).margin(absMargin));
 
@@ -213,4 +229,36 @@ TEST_CASE("Trajectories") {
 
     CHECK(base.ArcLength(0_s, 1_s) / 1_m == Approx(5));
   }
+
+  SECTION("Helix without parallel velocity") {
+    Vector<SpeedType::dimension_type> const vPar(
+        rootCS, {0_m / second, 0_m / second, 0_m / second});
+    Vector<SpeedType::dimension_type> const vPerp(
+        rootCS, {3_m / second, 0_m / second, 0_m / second});
+    Vector<SpeedType::dimension_type> const uPerp(
+        rootCS, {0_m / second, -3_m / second, 0_m / second});
+
+    auto const omegaC = 2 * M_PI / 1_s;
+    Helix const helix(r0, omegaC, vPar, vPerp, uPerp);
+
+    // a full circle in the x-y plane
+    CHECK((helix.GetPosition(1_s) - r0).norm() / 1_m == Approx(0).margin(absMargin));
+    CHECK((helix.GetPosition(0.5_s).GetCoordinates() -
+           QuantityVector<length_d>(0_m, -3_m / M_PI, 0_m))
+              .norm()
+              .magnitude() == Approx(0).margin(absMargin));
+  }
+
+  SECTION("Helix without field") {
+    Vector<SpeedType::dimension_type> const vPar(
+        rootCS, {0_m / second, 0_m / second, 0_m / second});
+    Vector<SpeedType::dimension_type> const vPerp(
+        rootCS, {3_m / second, 0_m / second, 0_m / second});
+
+    Helix const helix(r0, 0 / 1_s, vPar, vPerp, vPar);
+    CHECK((helix.GetPosition(2_s).GetCoordinates() -
+           QuantityVector<length_d>(6_m, 0_m, 0_m))
+              .norm()
+              .magnitude() == Approx(0).margin(absMargin));
+  }
 }
@@ -17,16 +17,4 @@ namespace corsika::particles {
     return stream << corsika::particles::GetName(p);
   }
 
-  Code ConvertFromPDG(PDGCode p) {
-    static_assert(detail::conversionArray.size() % 2 == 1);
-    // this will fail, for the strange case where the maxPDG is negative...
-    unsigned int constexpr maxPDG{(detail::conversionArray.size() - 1) >> 1};
-    auto k = static_cast<PDGCodeType>(p);
-    if ((unsigned int)abs(k) <= maxPDG) {
-      return detail::conversionArray[k + maxPDG];
-    } else {
-      return detail::conversionMap.at(p);
-    }
-  }
-
 } // namespace corsika::particles
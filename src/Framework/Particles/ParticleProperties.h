@@ -18,8 +18,11 @@
 #define _include_corsika_particles_ParticleProperties_h_
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <iosfwd>
+#include <stdexcept>
+#include <string>
 #include <type_traits>
 
 #include <corsika/units/PhysicalUnits.h>
@@ -137,13 +140,91 @@ namespace corsika::particles {
     return (p == Code::Nucleus) || (GetNucleusA(p) != 0);
   }
 
+  /*!
+   * Disjoint coarse classes of particles, which are handled by the same
+   * models and processes, see GetParticleClass().
+   */
+  enum class ParticleClass : uint8_t {
+    eElectromagnetic, ///< IsEM()
+    eMuon,            ///< IsMuon()
+    eHadron,          ///< IsHadron(), but not IsNucleus()
+    eNucleus,         ///< IsNucleus()
+    eNeutrino,        ///< IsNeutrino()
+    eOther            ///< e.g. tau leptons
+  };
+
+  std::size_t constexpr kNParticleClasses = 6;
+
+  ParticleClass constexpr GetParticleClass(Code const p) {
+    if (IsEM(p)) { return ParticleClass::eElectromagnetic; }
+    if (IsMuon(p)) { return ParticleClass::eMuon; }
+    if (IsNeutrino(p)) { return ParticleClass::eNeutrino; }
+    if (IsNucleus(p)) { return ParticleClass::eNucleus; }
+    if (IsHadron(p)) { return ParticleClass::eHadron; }
+    return ParticleClass::eOther;
+  }
+
   /**
    * the output operator for humand-readable particle codes
    **/
 
   std::ostream& operator<<(std::ostream&, corsika::particles::Code);
 
-  Code ConvertFromPDG(PDGCode);
+  namespace detail {
+    /**
+     * hash function of the PDG-code perfect hash (pdgHashSeeds,
+     * pdgHashTable), must be identical to hash_pdg() in pdxml_reader.py
+     */
+    uint32_t constexpr HashPDG(PDGCodeType const vPDG, uint32_t const vSeed) {
+      uint32_t x = static_cast<uint32_t>(vPDG) ^ vSeed;
+      x ^= x >> 16;
+      x *= 0x7feb352d;
+      x ^= x >> 15;
+      x *= 0x846ca68b;
+      x ^= x >> 16;
+      return x;
+    }
+  } // namespace detail
+
+  /**
+   * Converts a PDG code to the CORSIKA code, with two hash evaluations and
+   * two table look-ups, for all particles and nuclei.
+   *
+   * \throws std::out_of_range if the PDG code is unknown
+   */
+  Code constexpr ConvertFromPDG(PDGCode const p) {
+    auto const k = static_cast<PDGCodeType>(p);
+    auto const bucket = detail::HashPDG(k, 0) & (detail::pdgHashSeeds.size() - 1);
+    auto const slot = detail::HashPDG(k, detail::pdgHashSeeds[bucket]) &
+                      (detail::pdgHashTable.size() - 1);
+    Code const code = detail::pdgHashTable[slot];
+    if (GetPDG(code) != p) {
+      throw std::out_of_range("ConvertFromPDG: unknown PDG code " + std::to_string(k));
+    }
+    return code;
+  }
+
+  /**
+   * PDG code of the nucleus (\p vA, \p vZ), in the closed form 10LZZZAAAI
+   * with L = I = 0; the nucleus does not need to be a known particle
+   */
+  PDGCode constexpr GetNucleusPDG(int const vA, int const vZ) {
+    return static_cast<PDGCode>(1000000000 + vZ * 10000 + vA * 10);
+  }
+
+  bool constexpr IsNucleusPDG(PDGCode const p) {
+    return static_cast<PDGCodeType>(p) >= 1000000000;
+  }
+
+  /// mass number A of a nuclear PDG code
+  int constexpr GetNucleusAFromPDG(PDGCode const p) {
+    return static_cast<PDGCodeType>(p) / 10 % 1000;
+  }
+
+  /// charge number Z of a nuclear PDG code
+  int constexpr GetNucleusZFromPDG(PDGCode const p) {
+    return static_cast<PDGCodeType>(p) / 10000 % 1000;
+  }
 
   /**
    * Get mass of nucleus
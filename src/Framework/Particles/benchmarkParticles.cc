@@ -0,0 +1,70 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+/**
+ * Conversion of a large mixed list of secondaries (hadrons, leptons, charm
+ * and bottom hadrons, nuclei) from PDG to CORSIKA codes: the generated perfect
+ * hash of ConvertFromPDG versus a std::map look-up.
+ */
+
+#include <corsika/particles/ParticleProperties.h>
+#include <corsika/testing/Benchmark.h>
+
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace corsika::particles;
+using corsika::testing::DoNotOptimize;
+using corsika::testing::RunBenchmark;
+
+int main() {
+  std::vector<PDGCode> allCodes;
+  std::map<PDGCode, Code> reference;
+  for (auto i = static_cast<CodeIntType>(Code::FirstParticle);
+       i < static_cast<CodeIntType>(Code::LastParticle); ++i) {
+    auto const code = static_cast<Code>(i);
+    allCodes.push_back(GetPDG(code));
+    reference[GetPDG(code)] = code;
+  }
+
+  // mostly pions, kaons and nucleons, as in a hadronic secondary list
+  std::vector<PDGCode> const frequent = {
+      PDGCode::PiPlus, PDGCode::PiMinus, PDGCode::Pi0,    PDGCode::KPlus,
+      PDGCode::KMinus, PDGCode::Proton,  PDGCode::Neutron};
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<std::size_t> anyCode(0, allCodes.size() - 1);
+  std::uniform_int_distribution<std::size_t> frequentCode(0, frequent.size() - 1);
+  std::bernoulli_distribution isFrequent(0.7);
+
+  std::vector<PDGCode> secondaries(100000);
+  for (auto& pdg : secondaries) {
+    pdg = isFrequent(rng) ? frequent[frequentCode(rng)] : allCodes[anyCode(rng)];
+  }
+  std::cout << secondaries.size() << " secondaries of " << allCodes.size()
+            << " different types" << std::endl;
+
+  RunBenchmark("ConvertFromPDG (perfect hash)", [&]() {
+    CodeIntType sum = 0;
+    for (auto const pdg : secondaries) {
+      sum += static_cast<CodeIntType>(ConvertFromPDG(pdg));
+    }
+    DoNotOptimize(sum);
+  });
+
+  RunBenchmark("std::map<PDGCode, Code>::at", [&]() {
+    CodeIntType sum = 0;
+    for (auto const pdg : secondaries) {
+      sum += static_cast<CodeIntType>(reference.at(pdg));
+    }
+    DoNotOptimize(sum);
+  });
+}
@@ -227,41 +227,94 @@ def read_nuclei_db(filename, particle_db, classnames):
 
 ###############################################################
 # 
-# build conversion table PDG -> ngc
+# closed-form PDG encoding of nuclei: 10LZZZAAAI, see ParticleProperties.h
+# 
+def nucleus_pdg(A, Z):
+    return 1000000000 + Z * 10000 + A * 10
+
+
+###############################################################
+# 
+# the hash function of the PDG -> ngc perfect hash, must be identical
+# to corsika::particles::detail::HashPDG() in ParticleProperties.h
+# 
+def hash_pdg(pdg, seed):
+    mask = 0xffffffff
+    x = ((pdg & mask) ^ seed) & mask
+    x ^= x >> 16
+    x = (x * 0x7feb352d) & mask
+    x ^= x >> 15
+    x = (x * 0x846ca68b) & mask
+    x ^= x >> 16
+    return x
+
+
+###############################################################
+# 
+# build a minimal-search perfect hash ("hash and displace"): the PDG codes
+# are distributed into buckets by hash_pdg(pdg, 0), then for each bucket,
+# largest first, a seed is searched that places all its codes into free
+# slots of the table by hash_pdg(pdg, seed).
+# 
+def perfect_hash(keys):
+    def pow2_ceil(n):
+        return 1 << max(0, (n - 1).bit_length())
+
+    nBuckets = pow2_ceil(max(1, len(keys) // 4))
+    nSlots = pow2_ceil(len(keys))
+    
+    buckets = [[] for i in range(nBuckets)]
+    for k in keys:
+        buckets[hash_pdg(k, 0) & (nBuckets - 1)].append(k)
+
+    seeds = [0] * nBuckets
+    slots = [None] * nSlots
+    for iBucket in sorted(range(nBuckets), key=lambda i: -len(buckets[i])):
+        bucket = buckets[iBucket]
+        if not bucket:
+            continue
+        for seed in range(1, 1 << 20):
+            positions = [hash_pdg(k, seed) & (nSlots - 1) for k in bucket]
+            if len(set(positions)) == len(positions) and all(slots[i] is None for i in positions):
+                break
+        else:
+            raise Exception("no perfect hash found for PDG codes")
+        seeds[iBucket] = seed
+        for k, i in zip(bucket, positions):
+            slots[i] = k
+
+    return seeds, slots
+
+
+###############################################################
+# 
+# build perfect hash table PDG -> ngc
 # 
 def gen_conversion_PDG_ngc(particle_db):
-    # todo: find a optimum value, think about cache miss with array vs lookup time with map
-    P_MAX = 500 # the maximum PDG code that is still filled into the table
-        
-    conversionDict = dict()
-    conversionTable = [None] * (2*P_MAX + 1)
+    pdg2cId = dict()
     for cId, p in particle_db.items():
         pdg = p['pdg']
-        
-        if abs(pdg) < P_MAX:
-            if conversionTable[pdg + P_MAX]:
-                raise Exception("table entry already occupied")
-            else:
-                conversionTable[pdg + P_MAX] = cId
-        else:
-            if pdg in conversionDict.keys():
-                raise Exception(f"map entry {pdg} already occupied")
-            else:
-                conversionDict[pdg] = cId
+        if pdg in pdg2cId:
+            raise Exception(f"PDG code {pdg} already occupied")
+        pdg2cId[pdg] = cId
+        if p['isNucleus'] and pdg != nucleus_pdg(p['A'], p['Z']):
+            raise Exception(f"PDG code {pdg} of {cId} does not match A={p['A']}, Z={p['Z']}")
+
+    seeds, slots = perfect_hash(list(pdg2cId.keys()))
     
     output = io.StringIO()
     def oprint(*args, **kwargs):
         print(*args, **kwargs, file=output)
         
-    oprint(f"static std::array<Code, {len(conversionTable)}> constexpr conversionArray {{")
-    for ngc in conversionTable:
-        oprint("    Code::{0},".format(ngc if ngc else "Unknown"))
+    oprint(f"static std::array<uint32_t, {len(seeds)}> constexpr pdgHashSeeds {{")
+    for seed in seeds:
+        oprint(f"    {seed},")
     oprint("};")
     oprint()
     
-    oprint("static std::map<PDGCode, Code> const conversionMap {")
-    for ngc in conversionDict.values():
-        oprint(f"    {{PDGCode::{ngc}, Code::{ngc}}},")
+    oprint(f"static std::array<Code, {len(slots)}> constexpr pdgHashTable {{")
+    for pdg in slots:
+        oprint("    Code::{0},".format(pdg2cId[pdg] if pdg is not None else "Unknown"))
     oprint("};")
     oprint()
     
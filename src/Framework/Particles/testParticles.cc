@@ -68,6 +68,19 @@ TEST_CASE("ParticleProperties", "[Particles]") {
     REQUIRE(ConvertFromPDG(PDGCode::KStarMinus) == Code::KStarMinus);
     REQUIRE(ConvertFromPDG(PDGCode::MuPlus) == Code::MuPlus);
     REQUIRE(ConvertFromPDG(PDGCode::SigmaStarCMinusBar) == Code::SigmaStarCMinusBar);
+    REQUIRE(ConvertFromPDG(PDGCode::Iron) == Code::Iron);
+    REQUIRE(ConvertFromPDG(PDGCode::Unknown) == Code::Unknown);
+    static_assert(ConvertFromPDG(PDGCode::PiPlus) == Code::PiPlus);
+
+    for (auto i = static_cast<CodeIntType>(Code::FirstParticle);
+         i < static_cast<CodeIntType>(Code::LastParticle); ++i) {
+      auto const code = static_cast<Code>(i);
+      REQUIRE(ConvertFromPDG(GetPDG(code)) == code);
+    }
+
+    REQUIRE_THROWS_AS(ConvertFromPDG(static_cast<PDGCode>(1)), std::out_of_range);
+    REQUIRE_THROWS_AS(ConvertFromPDG(static_cast<PDGCode>(99999)), std::out_of_range);
+    REQUIRE_THROWS_AS(ConvertFromPDG(GetNucleusPDG(100, 50)), std::out_of_range);
   }
 
   SECTION("Lifetimes") {
@@ -123,6 +136,18 @@ TEST_CASE("ParticleProperties", "[Particles]") {
     REQUIRE_FALSE(IsNeutrino(Code::Oxygen));
   }
 
+  SECTION("Particle classes") {
+    REQUIRE(GetParticleClass(Code::Gamma) == ParticleClass::eElectromagnetic);
+    REQUIRE(GetParticleClass(Code::Positron) == ParticleClass::eElectromagnetic);
+    REQUIRE(GetParticleClass(Code::MuMinus) == ParticleClass::eMuon);
+    REQUIRE(GetParticleClass(Code::PiPlus) == ParticleClass::eHadron);
+    REQUIRE(GetParticleClass(Code::Proton) == ParticleClass::eHadron);
+    REQUIRE(GetParticleClass(Code::Nucleus) == ParticleClass::eNucleus);
+    REQUIRE(GetParticleClass(Code::Oxygen) == ParticleClass::eNucleus);
+    REQUIRE(GetParticleClass(Code::NuTauBar) == ParticleClass::eNeutrino);
+    REQUIRE(GetParticleClass(Code::TauMinus) == ParticleClass::eOther);
+  }
+
   SECTION("Nuclei") {
     REQUIRE_FALSE(IsNucleus(Code::Gamma));
     REQUIRE(IsNucleus(Code::Argon));
@@ -138,5 +163,15 @@ TEST_CASE("ParticleProperties", "[Particles]") {
 
     REQUIRE_THROWS(GetNucleusA(Code::Nucleus));
     REQUIRE_THROWS(GetNucleusZ(Code::Nucleus));
+
+    REQUIRE(GetNucleusPDG(56, 26) == static_cast<PDGCode>(1000260560));
+    REQUIRE(GetNucleusPDG(14, 7) == PDGCode::Nitrogen);
+    REQUIRE(IsNucleusPDG(PDGCode::Oxygen));
+    REQUIRE_FALSE(IsNucleusPDG(PDGCode::Proton));
+    REQUIRE(GetNucleusAFromPDG(PDGCode::Xenon) == 128);
+    REQUIRE(GetNucleusZFromPDG(PDGCode::Xenon) == 54);
+    for (auto const code : {Code::Deuterium, Code::Boron11, Code::Fluor, Code::Argon}) {
+      REQUIRE(GetPDG(code) == GetNucleusPDG(GetNucleusA(code), GetNucleusZ(code)));
+    }
   }
 }
@@ -40,6 +40,31 @@ namespace corsika::process {
   template <class T>
   std::true_type is_process_impl(const BaseProcess<T>* impl);
 
+  /**
+     Whether instances of the process T can run in several threads at
+     once, one instance per thread, e.g. in the workers of a
+     cascade::SubShowerScheduler. Specialise it to false for processes with
+     global state, e.g. the Fortran models and the streams of the
+     RNGManager, or with output for the whole shower, e.g. a file.
+   */
+  template <typename T>
+  struct is_thread_safe : std::true_type {};
+
+  template <typename T>
+  bool constexpr is_thread_safe_v = is_thread_safe<std::decay_t<T>>::value;
+
+  /**
+     Marks processes that may only be combined with thread-safe ones in a
+     ProcessSequence, e.g. cascade::SubShowerSplitter, so that the
+     ProcessSequence fails to compile otherwise.
+   */
+  template <typename T>
+  struct needs_thread_safe_sequence : std::false_type {};
+
+  template <typename T>
+  bool constexpr needs_thread_safe_sequence_v =
+      needs_thread_safe_sequence<std::decay_t<T>>::value;
+
 } // namespace corsika::process
 
 #endif
@@ -0,0 +1,52 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_corsika_cascadeequationsprocess_h_
+#define _include_corsika_cascadeequationsprocess_h_
+
+#include <corsika/process/ProcessReturn.h> // for convenience
+#include <corsika/units/PhysicalUnits.h>
+
+namespace corsika::process {
+
+  /**
+     \class CascadeEquationsProcess
+
+     The structural base type of a process that takes over particles
+     from the Monte-Carlo and treats them with a numerical solution of
+     the cascade equations. It sees all secondaries like a
+     SecondariesProcess, where it can remove the particles it takes
+     over, and is executed by Cascade::Run each time the Stack has run
+     empty. It may put new particles on the Stack.
+
+   */
+
+  template <typename derived>
+  struct CascadeEquationsProcess {
+
+    derived& GetRef() { return static_cast<derived&>(*this); }
+    const derived& GetRef() const { return static_cast<const derived&>(*this); }
+
+    /// here starts the interface-definition part
+    // -> enforce derived to implement DoSecondaries and DoCascadeEquations...
+    template <typename TSecondaries>
+    inline EProcessReturn DoSecondaries(TSecondaries&);
+
+    template <typename TStack>
+    inline EProcessReturn DoCascadeEquations(TStack&);
+  };
+
+  // overwrite the default trait class, to mark BaseProcess<T> as useful process
+  template <class T>
+  std::true_type is_process_impl(const CascadeEquationsProcess<T>* impl);
+
+} // namespace corsika::process
+
+#endif
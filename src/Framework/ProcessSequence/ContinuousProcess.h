@@ -23,6 +23,13 @@ namespace corsika::process {
      ProcessSequence. Both, the ProcessSequence and all its elements
      are of type ContinuousProcess<T>
 
+     Optionally, a ContinuousProcess can treat many particles at once
+     in Cascade::RunBatched by providing
+     <code>void DoContinuousBatch(TBatch&)</code> and
+     <code>void MaxStepLengthBatch(TBatch&)</code>, with TBatch a
+     cascade::ParticleBatch. Otherwise the per-particle functions are
+     called for each particle of the batch.
+
    */
 
   template <typename derived>
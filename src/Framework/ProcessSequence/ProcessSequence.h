@@ -13,6 +13,7 @@
 
 #include <corsika/process/BaseProcess.h>
 #include <corsika/process/BoundaryCrossingProcess.h>
+#include <corsika/process/CascadeEquationsProcess.h>
 #include <corsika/process/ContinuousProcess.h>
 #include <corsika/process/DecayProcess.h>
 #include <corsika/process/InteractionProcess.h>
@@ -20,9 +21,13 @@
 #include <corsika/process/SecondariesProcess.h>
 #include <corsika/process/StackProcess.h>
 #include <corsika/units/PhysicalUnits.h>
+#include <corsika/utl/Tracer.h>
+
+#include <boost/type_index.hpp>
 
 #include <cmath>
 #include <limits>
+#include <string>
 #include <type_traits>
 
 namespace corsika::process {
@@ -54,7 +59,9 @@ namespace corsika::process {
   namespace switch_process {
     template <typename A, typename B>
     class SwitchProcess; // fwd-decl.
-  }
+    template <typename... TModels>
+    class EnergyRangeSwitch; // fwd-decl.
+  } // namespace switch_process
 
   // to detect SwitchProcesses inside the ProcessSequence
   template <typename T>
@@ -66,6 +73,22 @@ namespace corsika::process {
   template <typename A, typename B>
   struct is_switch_process<switch_process::SwitchProcess<A, B>> : std::true_type {};
 
+  template <typename... TModels>
+  struct is_switch_process<switch_process::EnergyRangeSwitch<TModels...>>
+      : std::true_type {};
+
+  // to detect ContinuousProcesses with the optional batched interface
+  template <typename T, typename TBatch, typename = void>
+  struct has_continuous_batch : std::false_type {};
+
+  template <typename T, typename TBatch>
+  struct has_continuous_batch<T, TBatch,
+                              std::void_t<decltype(std::declval<T&>().DoContinuousBatch(
+                                  std::declval<TBatch&>()))>> : std::true_type {};
+
+  template <typename T, typename TBatch>
+  bool constexpr has_continuous_batch_v = has_continuous_batch<T, TBatch>::value;
+
   /**
      T1 and T2 are both references if possible (lvalue), otherwise
      (rvalue) they are just classes. This allows us to handle both,
@@ -83,6 +106,25 @@ namespace corsika::process {
     static bool constexpr t1SwitchProc = is_switch_process_v<T1type>;
     static bool constexpr t2SwitchProc = is_switch_process_v<T2type>;
 
+    static_assert(!(needs_thread_safe_sequence_v<T1type> ||
+                    needs_thread_safe_sequence_v<T2type>) ||
+                      (is_thread_safe_v<T1type> && is_thread_safe_v<T2type>),
+                  "ProcessSequence: a process that is not thread-safe (see "
+                  "is_thread_safe) is combined with one that needs thread safety");
+
+    /// name of the process T in the utl::Tracer, none for a ProcessSequence
+    template <typename T>
+    static char const* TraceName() {
+      if constexpr (is_process_sequence_v<T>) {
+        return nullptr;
+      } else {
+        // never destroyed, the Tracer may write at exit
+        static std::string const* const name =
+            new std::string(boost::typeindex::type_id<T>().pretty_name());
+        return name->c_str();
+      }
+    }
+
   public:
     T1 A; // this is a reference, if possible
     T2 B; // this is a reference, if possible
@@ -116,26 +158,83 @@ namespace corsika::process {
     EProcessReturn DoContinuous(TParticle& vP, TTrack& vT) {
       EProcessReturn ret = EProcessReturn::eOk;
       if constexpr (std::is_base_of_v<ContinuousProcess<T1type>, T1type> || t1ProcSeq) {
+        utl::TraceScope const trace(TraceName<T1type>, "DoContinuous");
         ret |= A.DoContinuous(vP, vT);
       }
       if constexpr (std::is_base_of_v<ContinuousProcess<T2type>, T2type> || t2ProcSeq) {
+        utl::TraceScope const trace(TraceName<T2type>, "DoContinuous");
         ret |= B.DoContinuous(vP, vT);
       }
       return ret;
     }
 
+    /**
+       Batched DoContinuous, see cascade::ParticleBatch. Processes
+       without batched interface are called for each particle.
+     */
+    template <typename TBatch>
+    void DoContinuousBatch(TBatch& vB) {
+      if constexpr (t1ProcSeq || has_continuous_batch_v<T1type, TBatch>) {
+        A.DoContinuousBatch(vB);
+      } else if constexpr (std::is_base_of_v<ContinuousProcess<T1type>, T1type>) {
+        vB.ApplyContinuous(A);
+      }
+      if constexpr (t2ProcSeq || has_continuous_batch_v<T2type, TBatch>) {
+        B.DoContinuousBatch(vB);
+      } else if constexpr (std::is_base_of_v<ContinuousProcess<T2type>, T2type>) {
+        vB.ApplyContinuous(B);
+      }
+    }
+
+    /// batched MaxStepLength, the result is in TBatch::GetMaxStepLength()
+    template <typename TBatch>
+    void MaxStepLengthBatch(TBatch& vB) {
+      if constexpr (t1ProcSeq || has_continuous_batch_v<T1type, TBatch>) {
+        A.MaxStepLengthBatch(vB);
+      } else if constexpr (std::is_base_of_v<ContinuousProcess<T1type>, T1type>) {
+        vB.ApplyMaxStepLength(A);
+      }
+      if constexpr (t2ProcSeq || has_continuous_batch_v<T2type, TBatch>) {
+        B.MaxStepLengthBatch(vB);
+      } else if constexpr (std::is_base_of_v<ContinuousProcess<T2type>, T2type>) {
+        vB.ApplyMaxStepLength(B);
+      }
+    }
+
     template <typename TSecondaries>
     EProcessReturn DoSecondaries(TSecondaries& vS) {
       EProcessReturn ret = EProcessReturn::eOk;
-      if constexpr (std::is_base_of_v<SecondariesProcess<T1type>, T1type> || t1ProcSeq) {
+      if constexpr (std::is_base_of_v<SecondariesProcess<T1type>, T1type> ||
+                    std::is_base_of_v<CascadeEquationsProcess<T1type>, T1type> ||
+                    t1ProcSeq) {
         ret |= A.DoSecondaries(vS);
       }
-      if constexpr (std::is_base_of_v<SecondariesProcess<T2type>, T2type> || t2ProcSeq) {
+      if constexpr (std::is_base_of_v<SecondariesProcess<T2type>, T2type> ||
+                    std::is_base_of_v<CascadeEquationsProcess<T2type>, T2type> ||
+                    t2ProcSeq) {
         ret |= B.DoSecondaries(vS);
       }
       return ret;
     }
 
+    /**
+       Execute the CascadeEquationsProcess-es in the ProcessSequence,
+       this is done by Cascade::Run each time the Stack is empty
+     */
+    template <typename TStack>
+    EProcessReturn DoCascadeEquations(TStack& vS) {
+      EProcessReturn ret = EProcessReturn::eOk;
+      if constexpr (std::is_base_of_v<CascadeEquationsProcess<T1type>, T1type> ||
+                    t1ProcSeq) {
+        ret |= A.DoCascadeEquations(vS);
+      }
+      if constexpr (std::is_base_of_v<CascadeEquationsProcess<T2type>, T2type> ||
+                    t2ProcSeq) {
+        ret |= B.DoCascadeEquations(vS);
+      }
+      return ret;
+    }
+
     /**
        The processes of type StackProcess do have an internal counter,
        so they can be exectuted only each N steps. Often these are
@@ -162,10 +261,16 @@ namespace corsika::process {
     EProcessReturn DoStack(TStack& vS) {
       EProcessReturn ret = EProcessReturn::eOk;
       if constexpr (std::is_base_of_v<StackProcess<T1type>, T1type> || t1ProcSeq) {
-        if (A.CheckStep()) { ret |= A.DoStack(vS); }
+        if (A.CheckStep()) {
+          utl::TraceScope const trace(TraceName<T1type>, "DoStack");
+          ret |= A.DoStack(vS);
+        }
       }
       if constexpr (std::is_base_of_v<StackProcess<T2type>, T2type> || t2ProcSeq) {
-        if (B.CheckStep()) { ret |= B.DoStack(vS); }
+        if (B.CheckStep()) {
+          utl::TraceScope const trace(TraceName<T2type>, "DoStack");
+          ret |= B.DoStack(vS);
+        }
       }
       return ret;
     }
@@ -232,6 +337,7 @@ namespace corsika::process {
         lambda_inv_count += A.GetInverseInteractionLength(vP);
         // check if we should execute THIS process and then EXIT
         if (lambda_select < lambda_inv_count) {
+          utl::TraceScope const trace(TraceName<T1type>, "DoInteraction");
           A.DoInteraction(vS);
           return EProcessReturn::eInteracted;
         }
@@ -248,6 +354,7 @@ namespace corsika::process {
         lambda_inv_count += B.GetInverseInteractionLength(vP);
         // check if we should execute THIS process and then EXIT
         if (lambda_select < lambda_inv_count) {
+          utl::TraceScope const trace(TraceName<T2type>, "DoInteraction");
           B.DoInteraction(vS);
           return EProcessReturn::eInteracted;
         }
@@ -297,6 +404,7 @@ namespace corsika::process {
         // check if we should execute THIS process and then EXIT
         if (decay_select < decay_inv_count) { // more pedagogical: rndm_select <
                                               // decay_inv_count / decay_inv_tot
+          utl::TraceScope const trace(TraceName<T1type>, "DoDecay");
           A.DoDecay(vS);
           return EProcessReturn::eDecayed;
         }
@@ -312,6 +420,7 @@ namespace corsika::process {
         decay_inv_count += B.GetInverseLifetime(vP);
         // check if we should execute THIS process and then EXIT
         if (decay_select < decay_inv_count) {
+          utl::TraceScope const trace(TraceName<T2type>, "DoDecay");
           B.DoDecay(vS);
           return EProcessReturn::eDecayed;
         }
@@ -320,8 +429,14 @@ namespace corsika::process {
     }
 
     void Init() {
-      A.Init();
-      B.Init();
+      {
+        utl::TraceScope const trace(TraceName<T1type>, "Init");
+        A.Init();
+      }
+      {
+        utl::TraceScope const trace(TraceName<T2type>, "Init");
+        B.Init();
+      }
     }
   };
 
@@ -342,6 +457,24 @@ namespace corsika::process {
   template <typename A, typename B>
   struct is_process_sequence<corsika::process::ProcessSequence<A, B>> : std::true_type {};
 
+  /// a ProcessSequence is thread-safe if all its processes are
+  template <typename A, typename B>
+  struct is_thread_safe<ProcessSequence<A, B>>
+      : std::bool_constant<is_thread_safe_v<A> && is_thread_safe_v<B>> {};
+
+  template <typename A, typename B>
+  struct needs_thread_safe_sequence<ProcessSequence<A, B>>
+      : std::bool_constant<needs_thread_safe_sequence_v<A> ||
+                           needs_thread_safe_sequence_v<B>> {};
+
+  template <typename A, typename B>
+  struct is_thread_safe<switch_process::SwitchProcess<A, B>>
+      : std::bool_constant<is_thread_safe_v<A> && is_thread_safe_v<B>> {};
+
+  template <typename... TModels>
+  struct is_thread_safe<switch_process::EnergyRangeSwitch<TModels...>>
+      : std::bool_constant<(is_thread_safe_v<TModels> && ...)> {};
+
 } // namespace corsika::process
 
 #endif
@@ -0,0 +1,39 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_corsika_secondaryfilter_h_
+#define _include_corsika_secondaryfilter_h_
+
+#include <corsika/particles/ParticleProperties.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <functional>
+
+namespace corsika::process {
+
+  /**
+     \class SecondaryFilter
+
+     Pre-filter for the secondaries of a model: called with PID, lab
+     energy and time of every secondary before it is written to the
+     stack. If it returns true, the secondary is dropped; the filter
+     is responsible for accounting for it, e.g. by
+     ParticleCut::RejectSecondary.
+
+     Only use a filter if no other SecondariesProcess needs to see the
+     rejected particles.
+   */
+
+  using SecondaryFilter = std::function<bool(
+      particles::Code, units::si::HEPEnergyType, units::si::TimeType)>;
+
+} // namespace corsika::process
+
+#endif
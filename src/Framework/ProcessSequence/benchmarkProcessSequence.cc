@@ -0,0 +1,89 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+/**
+ * Overhead of the static dispatch in ProcessSequence: DoContinuous,
+ * MaxStepLength and GetTotalInverseInteractionLength of sequences of 2, 5
+ * and 10 trivial processes, per call of the sequence.
+ */
+
+#include <corsika/process/ProcessSequence.h>
+#include <corsika/testing/Benchmark.h>
+#include <corsika/units/PhysicalUnits.h>
+
+using namespace corsika;
+using namespace corsika::process;
+using namespace corsika::units::si;
+using corsika::testing::DoNotOptimize;
+using corsika::testing::RunBenchmark;
+
+struct DummyParticle {
+  double fEnergy = 1;
+};
+struct DummyTrack {
+  double fLength = 1;
+};
+
+template <int N>
+class Continuous : public ContinuousProcess<Continuous<N>> {
+public:
+  void Init() {}
+  template <typename TParticle, typename TTrack>
+  EProcessReturn DoContinuous(TParticle& vP, TTrack&) const {
+    vP.fEnergy *= 0.999;
+    return EProcessReturn::eOk;
+  }
+  template <typename TParticle, typename TTrack>
+  LengthType MaxStepLength(TParticle const& vP, TTrack const&) const {
+    return (N + vP.fEnergy) * 1_m;
+  }
+};
+
+template <int N>
+class Interaction : public InteractionProcess<Interaction<N>> {
+public:
+  void Init() {}
+  template <typename TParticle>
+  EProcessReturn DoInteraction(TParticle&) const {
+    return EProcessReturn::eOk;
+  }
+  template <typename TParticle>
+  GrammageType GetInteractionLength(TParticle const& vP) const {
+    return (N + vP.fEnergy) * 1_g / (1_cm * 1_cm);
+  }
+};
+
+template <typename TSequence>
+void Run(char const* vLabel, TSequence&& vSequence) {
+  DummyParticle particle;
+  DummyTrack track;
+  std::string const label = vLabel;
+
+  RunBenchmark("DoContinuous" + label, [&]() {
+    particle.fEnergy = 1;
+    DoNotOptimize(vSequence.DoContinuous(particle, track));
+  });
+  RunBenchmark("MaxStepLength" + label, [&]() {
+    DoNotOptimize(vSequence.MaxStepLength(particle, track));
+  });
+  RunBenchmark("GetTotalInverseInteractionLength" + label, [&]() {
+    DoNotOptimize(vSequence.GetTotalInverseInteractionLength(particle));
+  });
+}
+
+int main() {
+  Run(" (2 processes)", Continuous<0>() << Interaction<0>());
+  Run(" (5 processes)", Continuous<0>() << Interaction<0>() << Continuous<1>() <<
+                            Interaction<1>() << Continuous<2>());
+  Run(" (10 processes)", Continuous<0>() << Interaction<0>() << Continuous<1>() <<
+                             Interaction<1>() << Continuous<2>() << Interaction<2>() <<
+                             Continuous<3>() << Interaction<3>() << Continuous<4>() <<
+                             Interaction<4>());
+}
@@ -186,6 +186,57 @@ public:
   int GetCount() const { return fCount; }
 };
 
+class CascadeEquations1 : public CascadeEquationsProcess<CascadeEquations1> {
+  int fCaptured = 0;
+  int fSolved = 0;
+
+public:
+  void Init() {}
+  template <typename TSecondaries>
+  EProcessReturn DoSecondaries(TSecondaries&) {
+    fCaptured++;
+    return EProcessReturn::eOk;
+  }
+  template <typename TStack>
+  EProcessReturn DoCascadeEquations(TStack&) {
+    fSolved++;
+    return EProcessReturn::eOk;
+  }
+  int GetCaptured() const { return fCaptured; }
+  int GetSolved() const { return fSolved; }
+};
+
+// process with global state
+class Global1 : public ContinuousProcess<Global1> {
+public:
+  template <typename D, typename T>
+  inline EProcessReturn DoContinuous(D&, T&) const {
+    return EProcessReturn::eOk;
+  }
+};
+
+// process running in several threads, like cascade::SubShowerSplitter
+class Threads1 : public StackProcess<Threads1> {
+  int fCount = 0;
+
+public:
+  Threads1()
+      : StackProcess(1) {}
+  template <typename TStack>
+  EProcessReturn DoStack(TStack&) {
+    fCount++;
+    return EProcessReturn::eOk;
+  }
+  int GetCount() const { return fCount; }
+};
+
+namespace corsika::process {
+  template <>
+  struct is_thread_safe<Global1> : std::false_type {};
+  template <>
+  struct needs_thread_safe_sequence<Threads1> : std::true_type {};
+} // namespace corsika::process
+
 struct DummyStack {};
 struct DummyData {
   double p[nData] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
@@ -289,6 +340,27 @@ TEST_CASE("Process Sequence", "[Process Sequence]") {
     CHECK(s1.GetCount() == 20);
     CHECK(s2.GetCount() == 10);
   }
+
+  SECTION("CascadeEquationsProcess") {
+
+    Stack1 s1(1);
+    CascadeEquations1 ce1;
+    CascadeEquations1 ce2;
+
+    auto sequence = s1 << ce1 << ce2;
+
+    DummyStack stack;
+    sequence.DoSecondaries(stack);
+    sequence.DoStack(stack);
+    sequence.DoCascadeEquations(stack);
+    sequence.DoCascadeEquations(stack);
+
+    CHECK(ce1.GetCaptured() == 1);
+    CHECK(ce2.GetCaptured() == 1);
+    CHECK(ce1.GetSolved() == 2);
+    CHECK(ce2.GetSolved() == 2);
+    CHECK(s1.GetCount() == 1);
+  }
 }
 
 /*
@@ -301,3 +373,28 @@ TEST_CASE("SwitchProcess") {
   switch_process::SwitchProcess s(p1, p2, 10_GeV);
   REQUIRE(is_switch_process_v<decltype(s)>);
 }
+
+TEST_CASE("thread safety", "[Process Sequence]") {
+  Process1 p1(0);
+  Process2 p2(0);
+  ContinuousProcess1 cp1(0);
+  Global1 g1;
+  Threads1 t1;
+
+  // a ProcessSequence is thread-safe if all its processes are
+  static_assert(is_thread_safe_v<decltype(p1 << cp1)>);
+  static_assert(!is_thread_safe_v<decltype(p1 << g1 << cp1)>);
+  static_assert(!is_thread_safe_v<decltype(cp1 << (p1 << g1))>);
+  static_assert(!is_thread_safe_v<switch_process::SwitchProcess<Global1, Process2>>);
+
+  // and needs thread safety if one of them does
+  static_assert(!needs_thread_safe_sequence_v<decltype(p1 << g1)>);
+  static_assert(needs_thread_safe_sequence_v<decltype(p1 << cp1 << t1)>);
+  static_assert(needs_thread_safe_sequence_v<decltype(t1 << (p1 << p2))>);
+
+  // a ProcessSequence of t1 with g1 does not compile
+  auto sequence = p1 << p2 << cp1 << t1;
+  DummyStack stack;
+  sequence.DoStack(stack);
+  CHECK(t1.GetCount() == 1);
+}
@@ -0,0 +1,200 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_corsika_random_Philox_h_
+#define _include_corsika_random_Philox_h_
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+namespace corsika::random {
+
+  /**
+   * Counter-based random-number generator Philox4x32-10 (J. K. Salmon et al.,
+   * "Parallel random numbers: as easy as 1, 2, 3", SC11).
+   *
+   * The output is a bijection of a 128-bit counter, keyed by a 64-bit key:
+   * every call of the 10-round function yields four 32-bit numbers. The
+   * complete state is the key, the counter and the position within the
+   * current block, i.e. 28 bytes (std::mt19937: 2.5 kB, 5 kB on LP64),
+   * seeding is free, and discard() is O(1).
+   *
+   * Independent reproducible streams are obtained by using different keys,
+   * or, for one key, different substreams: the upper 64 bits of the counter
+   * are the substream number, the lower 64 bits are incremented by the
+   * engine.
+   *
+   * The class fulfills the requirements of a C++ RandomNumberEngine, so it
+   * can be used with all std:: distributions.
+   */
+  class Philox4x32 {
+  public:
+    using result_type = uint32_t;
+    using KeyType = std::array<uint32_t, 2>;
+    using CounterType = std::array<uint32_t, 4>;
+
+    static constexpr uint64_t default_seed = 0;
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    explicit Philox4x32(uint64_t const vKey = default_seed,
+                        uint64_t const vSubstream = 0) {
+      seed(vKey);
+      SetSubstream(vSubstream);
+    }
+
+    template <typename TSeedSeq, typename = std::enable_if_t<
+                                     !std::is_same_v<std::decay_t<TSeedSeq>, Philox4x32>>>
+    explicit Philox4x32(TSeedSeq& vSeedSeq) {
+      seed(vSeedSeq);
+    }
+
+    /// set the key to \p vKey, and reset the counter to zero
+    void seed(uint64_t const vKey = default_seed) {
+      fKey = {uint32_t(vKey), uint32_t(vKey >> 32)};
+      fCounter = {0, 0, 0, 0};
+      fIndex = 4;
+    }
+
+    /// take the key from a std::seed_seq (or any SeedSequence)
+    template <typename TSeedSeq, typename = std::enable_if_t<
+                                     !std::is_same_v<std::decay_t<TSeedSeq>, Philox4x32>>>
+    void seed(TSeedSeq& vSeedSeq) {
+      std::array<uint32_t, 2> key;
+      vSeedSeq.generate(key.begin(), key.end());
+      seed(uint64_t(key[0]) | (uint64_t(key[1]) << 32));
+    }
+
+    result_type operator()() {
+      if (fIndex == 4) {
+        fBlock = Block(fCounter, fKey);
+        Increment(1);
+        fIndex = 0;
+      }
+      return fBlock[fIndex++];
+    }
+
+    /// advance the engine by \p vCount numbers, in O(1)
+    void discard(unsigned long long vCount) {
+      // numbers left in the current block
+      unsigned long long const left = 4 - fIndex;
+      if (vCount <= left) {
+        fIndex += vCount;
+        return;
+      }
+      vCount -= left;
+      // fCounter already points to the block after the current one
+      Increment((vCount - 1) / 4);
+      fBlock = Block(fCounter, fKey);
+      Increment(1);
+      fIndex = (vCount - 1) % 4 + 1;
+    }
+
+    /**
+     * Start substream \p vSubstream of the current key from its beginning.
+     * Each substream has a period of 2^66 numbers.
+     */
+    void SetSubstream(uint64_t const vSubstream) {
+      fCounter = {0, 0, uint32_t(vSubstream), uint32_t(vSubstream >> 32)};
+      fIndex = 4;
+    }
+
+    KeyType const& GetKey() const { return fKey; }
+
+    /// change the key, the next number is taken from the next block
+    void SetKey(KeyType const& vKey) {
+      fKey = vKey;
+      fIndex = 4;
+    }
+
+    /// the counter of the next block to be generated
+    CounterType const& GetCounter() const { return fCounter; }
+    void SetCounter(CounterType const& vCounter) {
+      fCounter = vCounter;
+      fIndex = 4;
+    }
+
+    /// the Philox4x32-10 bijection itself
+    static CounterType Block(CounterType vCounter, KeyType vKey) {
+      for (int round = 0; round < 10; ++round) {
+        if (round > 0) {
+          vKey[0] += kWeyl0;
+          vKey[1] += kWeyl1;
+        }
+        uint64_t const product0 = uint64_t(kMultiplier0) * vCounter[0];
+        uint64_t const product1 = uint64_t(kMultiplier1) * vCounter[2];
+        vCounter = {uint32_t(product1 >> 32) ^ vCounter[1] ^ vKey[0],
+                    uint32_t(product1),
+                    uint32_t(product0 >> 32) ^ vCounter[3] ^ vKey[1],
+                    uint32_t(product0)};
+      }
+      return vCounter;
+    }
+
+    friend bool operator==(Philox4x32 const& a, Philox4x32 const& b) {
+      // the block buffer is a function of key and counter
+      return a.fKey == b.fKey && a.fCounter == b.fCounter && a.fIndex == b.fIndex;
+    }
+    friend bool operator!=(Philox4x32 const& a, Philox4x32 const& b) { return !(a == b); }
+
+    /// writes key, counter and position in the current block
+    friend std::ostream& operator<<(std::ostream& os, Philox4x32 const& vEngine) {
+      os << vEngine.fKey[0] << ' ' << vEngine.fKey[1];
+      for (auto const c : vEngine.fCounter) { os << ' ' << c; }
+      return os << ' ' << vEngine.fIndex;
+    }
+
+    friend std::istream& operator>>(std::istream& is, Philox4x32& vEngine) {
+      Philox4x32 tmp;
+      is >> tmp.fKey[0] >> tmp.fKey[1];
+      for (auto& c : tmp.fCounter) { is >> c; }
+      is >> tmp.fIndex;
+      if (is && tmp.fIndex <= 4) {
+        if (tmp.fIndex < 4) {
+          // regenerate the current block, the counter points to the next one
+          tmp.Increment(-1ull);
+          tmp.fBlock = Block(tmp.fCounter, tmp.fKey);
+          tmp.Increment(1);
+        }
+        vEngine = tmp;
+      } else {
+        is.setstate(std::ios::failbit);
+      }
+      return is;
+    }
+
+  private:
+    /// adds \p vBlocks to the lower 64 bits of the counter, modulo 2^64
+    void Increment(uint64_t const vBlocks) {
+      uint64_t const low =
+          (uint64_t(fCounter[0]) | (uint64_t(fCounter[1]) << 32)) + vBlocks;
+      fCounter[0] = uint32_t(low);
+      fCounter[1] = uint32_t(low >> 32);
+    }
+
+    static constexpr uint32_t kMultiplier0 = 0xD2511F53;
+    static constexpr uint32_t kMultiplier1 = 0xCD9E8D57;
+    static constexpr uint32_t kWeyl0 = 0x9E3779B9; // golden ratio
+    static constexpr uint32_t kWeyl1 = 0xBB67AE85; // sqrt(3) - 1
+
+    KeyType fKey;
+    CounterType fCounter; //!< counter of the next block
+    CounterType fBlock{}; //!< output of the current block
+    unsigned int fIndex;  //!< next number in fBlock, 4 if exhausted
+  };
+
+} // namespace corsika::random
+
+#endif
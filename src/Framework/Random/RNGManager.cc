@@ -9,6 +9,9 @@
  */
 
 #include <corsika/random/RNGManager.h>
+#include <corsika/utl/BinaryIO.h>
+
+#include <stdexcept>
 
 void corsika::random::RNGManager::RegisterRandomStream(std::string const& pStreamName) {
   corsika::random::RNG rng;
@@ -18,6 +21,10 @@ void corsika::random::RNGManager::RegisterRandomStream(std::string const& pStrea
   }
 
   rngs[pStreamName] = std::move(rng);
+
+  if (auto it = uniformBuffers.find(pStreamName); it != uniformBuffers.end()) {
+    it->second.Clear();
+  }
 }
 
 corsika::random::RNG& corsika::random::RNGManager::GetRandomStream(
@@ -25,6 +32,23 @@ corsika::random::RNG& corsika::random::RNGManager::GetRandomStream(
   return rngs.at(pStreamName);
 }
 
+corsika::random::UniformBuffer<corsika::random::RNG>&
+corsika::random::RNGManager::GetUniformBuffer(std::string const& pStreamName) {
+  if (auto it = uniformBuffers.find(pStreamName); it != uniformBuffers.end()) {
+    return it->second;
+  }
+
+  std::size_t const size = fDeterministicBuffers ? 1 : UniformBuffer<RNG>::kDefaultSize;
+  return uniformBuffers.try_emplace(pStreamName, rngs.at(pStreamName), size)
+      .first->second;
+}
+
+void corsika::random::RNGManager::SetDeterministicBuffers(bool vDeterministic) {
+  fDeterministicBuffers = vDeterministic;
+  std::size_t const size = vDeterministic ? 1 : UniformBuffer<RNG>::kDefaultSize;
+  for (auto& entry : uniformBuffers) { entry.second.SetSize(size); }
+}
+
 std::stringstream corsika::random::RNGManager::dumpState() const {
   std::stringstream buffer;
   for (auto const& [streamName, rng] : rngs) {
@@ -34,8 +58,47 @@ std::stringstream corsika::random::RNGManager::dumpState() const {
   return buffer;
 }
 
+void corsika::random::RNGManager::SaveState(std::ostream& vStream) const {
+  using corsika::utl::WriteBinary;
+  WriteBinary(vStream, uint64_t(rngs.size()));
+  for (auto const& [streamName, rng] : rngs) {
+    std::ostringstream engineState;
+    engineState << rng;
+    WriteBinary(vStream, streamName);
+    WriteBinary(vStream, engineState.str());
+
+    auto const it = uniformBuffers.find(streamName);
+    WriteBinary(vStream, it != uniformBuffers.end());
+    if (it != uniformBuffers.end()) { it->second.SaveState(vStream); }
+  }
+}
+
+void corsika::random::RNGManager::LoadState(std::istream& vStream) {
+  using corsika::utl::ReadBinary;
+  auto const nStreams = ReadBinary<uint64_t>(vStream);
+  for (uint64_t i = 0; i < nStreams; ++i) {
+    auto const streamName = ReadBinary<std::string>(vStream);
+    std::istringstream engineState(ReadBinary<std::string>(vStream));
+    auto const stream = rngs.find(streamName);
+    if (stream == rngs.end()) {
+      throw std::runtime_error("RNGManager: state of unregistered stream " + streamName);
+    }
+    auto& rng = stream->second;
+    if (!(engineState >> rng)) {
+      throw std::runtime_error("RNGManager: corrupt state of stream " + streamName);
+    }
+
+    if (ReadBinary<bool>(vStream)) {
+      GetUniformBuffer(streamName).LoadState(vStream);
+    } else if (auto it = uniformBuffers.find(streamName); it != uniformBuffers.end()) {
+      it->second.Clear();
+    }
+  }
+}
+
 void corsika::random::RNGManager::SeedAll(uint64_t vSeed) {
   for (auto& entry : rngs) { entry.second.seed(vSeed++); }
+  for (auto& entry : uniformBuffers) { entry.second.Clear(); }
 }
 
 void corsika::random::RNGManager::SeedAll() {
@@ -45,6 +108,35 @@ void corsika::random::RNGManager::SeedAll() {
     std::seed_seq sseq{rd(), rd(), rd(), rd(), rd(), rd()};
     entry.second.seed(sseq);
   }
+  for (auto& entry : uniformBuffers) { entry.second.Clear(); }
+}
+
+void corsika::random::RNGManager::SetLineageKey(uint64_t vKey) {
+  for (auto& [streamName, rng] : rngs) {
+    SeedLineage(rng, vKey, GetStreamId(streamName));
+  }
+  for (auto& entry : uniformBuffers) { entry.second.Clear(); }
+}
+
+void corsika::random::RNGManager::SeedLineage(RNG& vRNG, uint64_t vKey,
+                                              uint64_t vStreamId) {
+#ifdef CORSIKA_PHILOX_RNG
+  vRNG.seed(vKey);
+  vRNG.SetSubstream(vStreamId);
+#else
+  std::seed_seq sseq{uint32_t(vKey), uint32_t(vKey >> 32), uint32_t(vStreamId),
+                     uint32_t(vStreamId >> 32)};
+  vRNG.seed(sseq);
+#endif
+}
+
+uint64_t corsika::random::RNGManager::GetStreamId(std::string const& pStreamName) {
+  // FNV-1a
+  uint64_t id = 0xCBF29CE484222325ull;
+  for (unsigned char const c : pStreamName) {
+    id = (id ^ c) * 0x100000001B3ull;
+  }
+  return id;
 }
 
 /*
@@ -11,9 +11,13 @@
 #ifndef _include_RNGManager_h_
 #define _include_RNGManager_h_
 
+#include <corsika/random/Philox.h>
+#include <corsika/random/UniformBuffer.h>
 #include <corsika/utl/Singleton.h>
 
+#include <istream>
 #include <map>
+#include <ostream>
 #include <random>
 #include <sstream>
 #include <string>
@@ -24,7 +28,11 @@
 
 namespace corsika::random {
 
+#ifdef CORSIKA_PHILOX_RNG
+  using RNG = Philox4x32; //!< the actual RNG type that will be used
+#else
   using RNG = std::mt19937; //!< the actual RNG type that will be used
+#endif
 
   class RNGManager : public corsika::utl::Singleton<RNGManager> {
 
@@ -32,6 +40,8 @@ namespace corsika::random {
 
     std::map<std::string, RNG> rngs;
     std::map<std::string, std::seed_seq> seeds;
+    std::map<std::string, UniformBuffer<RNG>> uniformBuffers;
+    bool fDeterministicBuffers = false;
 
   protected:
     RNGManager() {}
@@ -51,12 +61,45 @@ namespace corsika::random {
      */
     RNG& GetRandomStream(std::string const& pStreamName);
 
+    /*!
+     * returns a buffered generator of uniform numbers in [0, 1) drawing from
+     * stream \a pStreamName, created on first use. Its numbers are the same
+     * as those of std::uniform_real_distribution<double> on the stream.
+     *
+     * \throws std::out_of_range when the stream is not registered
+     */
+    UniformBuffer<RNG>& GetUniformBuffer(std::string const& pStreamName);
+
+    /*!
+     * In deterministic mode all uniform buffers have size 1, i.e. the
+     * streams are consumed exactly as without buffering. Use this when other
+     * code draws from the same streams and results must be reproducible
+     * with respect to unbuffered consumption.
+     */
+    void SetDeterministicBuffers(bool vDeterministic);
+    bool GetDeterministicBuffers() const { return fDeterministicBuffers; }
+
     /*!
      * dumps the names and states of all registered random-number streams
      * into a std::stringstream.
      */
     std::stringstream dumpState() const;
 
+    /*!
+     * writes the states of all registered streams and their uniform
+     * buffers in binary form, e.g. for a checkpoint
+     */
+    void SaveState(std::ostream& vStream) const;
+
+    /*!
+     * restores the states written by SaveState(). Streams and buffers are
+     * updated in place, i.e. references obtained before remain valid.
+     *
+     * \throws std::runtime_error on corrupt data, or if a stream was not
+     * registered before
+     */
+    void LoadState(std::istream& vStream);
+
     /**
      * set seed_seq of \a pStreamName to \a pSeedSeq
      */
@@ -69,6 +112,25 @@ namespace corsika::random {
     void SeedAll(uint64_t vSeed);
 
     void SeedAll(); //!< seed all currently registered streams with "real" randomness
+
+    /*!
+     * Re-keys all registered streams for the lineage key \a vKey of the
+     * current step, see Cascade::SetLineageRNG: each stream starts over at a
+     * state given only by \a vKey and its name, and the uniform buffers are
+     * emptied. Thus all random numbers of a step, including those drawn by
+     * the Fortran models through the buffers, are independent of the order
+     * in which the particles are processed and of the number of threads.
+     *
+     * With Philox4x32 (CORSIKA_PHILOX_RNG) this is O(1) per stream, with
+     * std::mt19937 each stream goes through a std::seed_seq.
+     */
+    void SetLineageKey(uint64_t vKey);
+
+    /// sets \a vRNG to the state for key \a vKey of the stream with id \a vStreamId
+    static void SeedLineage(RNG& vRNG, uint64_t vKey, uint64_t vStreamId);
+
+    /// the id of stream \a pStreamName used by SetLineageKey()
+    static uint64_t GetStreamId(std::string const& pStreamName);
   };
 
 } // namespace corsika::random
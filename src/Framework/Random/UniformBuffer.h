@@ -0,0 +1,131 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_corsika_random_UniformBuffer_h_
+#define _include_corsika_random_UniformBuffer_h_
+
+#include <corsika/utl/BinaryIO.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace corsika::random {
+
+  /**
+   * Block-buffered uniform random numbers in [0, 1), meant for the
+   * RNG call-backs of the Fortran interaction models, which are called
+   * millions of times per event.
+   *
+   * The buffer is refilled with GetSize() numbers at once: first the raw
+   * 32-bit words are drawn from the engine, then they are converted in a
+   * separate loop without dependencies, which the compiler can vectorize.
+   * Two words are used per number, in exactly the same way as
+   * std::uniform_real_distribution<double> does, so the sequence of numbers
+   * is identical to the unbuffered one.
+   *
+   * The engine, however, runs ahead by up to 2 * GetSize() words. If other
+   * code draws from the same engine, or its state is compared, use a buffer
+   * size of 1 (the deterministic mode), which is equivalent to unbuffered
+   * consumption.
+   */
+  template <typename TEngine>
+  class UniformBuffer {
+    static_assert(TEngine::min() == 0 && TEngine::max() == 0xffffffffu,
+                  "UniformBuffer needs an engine producing 32-bit numbers");
+
+  public:
+    static constexpr std::size_t kDefaultSize = 4096;
+
+    explicit UniformBuffer(TEngine& vEngine, std::size_t const vSize = kDefaultSize)
+        : fEngine(&vEngine) {
+      SetSize(vSize);
+    }
+
+    double operator()() {
+      if (fNext == fValues.size()) { Refill(); }
+      return fValues[fNext++];
+    }
+
+    /// change the number of values generated per refill, drops buffered values
+    void SetSize(std::size_t const vSize) {
+      if (vSize == 0) { throw std::runtime_error("UniformBuffer: size must be > 0"); }
+      fWords.resize(2 * vSize);
+      fValues.resize(vSize);
+      Clear();
+    }
+    std::size_t GetSize() const { return fValues.size(); }
+
+    /// number of values left in the buffer
+    std::size_t GetAvailable() const { return fValues.size() - fNext; }
+
+    /// drop all buffered values, e.g. after the engine was re-seeded
+    void Clear() { fNext = fValues.size(); }
+
+    TEngine& GetEngine() const { return *fEngine; }
+
+    /**
+     * write size and not yet consumed values, needed together with the
+     * engine state to continue the exact sequence after a restart
+     */
+    void SaveState(std::ostream& vStream) const {
+      using corsika::utl::WriteBinary;
+      WriteBinary(vStream, uint64_t(GetSize()));
+      WriteBinary(vStream, uint64_t(GetAvailable()));
+      for (std::size_t i = fNext; i < fValues.size(); ++i) {
+        WriteBinary(vStream, fValues[i]);
+      }
+    }
+
+    /// \throws std::runtime_error on inconsistent or truncated data
+    void LoadState(std::istream& vStream) {
+      using corsika::utl::ReadBinary;
+      auto const size = ReadBinary<uint64_t>(vStream);
+      auto const available = ReadBinary<uint64_t>(vStream);
+      if (available > size) {
+        throw std::runtime_error("UniformBuffer: inconsistent state");
+      }
+      SetSize(size);
+      fNext = size - available;
+      for (std::size_t i = fNext; i < size; ++i) {
+        fValues[i] = ReadBinary<double>(vStream);
+      }
+    }
+
+  private:
+    void Refill() {
+      for (auto& word : fWords) { word = uint32_t((*fEngine)()); }
+
+      // same arithmetic as std::generate_canonical<double, 53> for 32-bit engines
+      double const belowOne = std::nextafter(1., 0.);
+      uint32_t const* const words = fWords.data();
+      double* const values = fValues.data();
+      std::size_t const n = fValues.size();
+      for (std::size_t i = 0; i < n; ++i) {
+        double const x =
+            (double(words[2 * i]) + double(words[2 * i + 1]) * 0x1p32) * 0x1p-64;
+        values[i] = x < 1 ? x : belowOne;
+      }
+      fNext = 0;
+    }
+
+    TEngine* fEngine;
+    std::vector<uint32_t> fWords;
+    std::vector<double> fValues;
+    std::size_t fNext; //!< index of the next value in fValues
+  };
+
+} // namespace corsika::random
+
+#endif
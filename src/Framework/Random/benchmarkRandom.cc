@@ -0,0 +1,74 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+/**
+ * Throughput of Philox4x32 versus std::mt19937: raw 32-bit numbers,
+ * uniform doubles, creating and seeding a new stream, and skipping ahead.
+ * Uniform doubles are also drawn through UniformBuffer, as done by the
+ * Fortran call-backs, in buffered and in deterministic mode.
+ */
+
+#include <corsika/random/Philox.h>
+#include <corsika/random/UniformBuffer.h>
+#include <corsika/testing/Benchmark.h>
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+
+using corsika::random::Philox4x32;
+using corsika::random::UniformBuffer;
+using corsika::testing::DoNotOptimize;
+using corsika::testing::RunBenchmark;
+
+template <typename TEngine>
+void RunEngineBenchmarks(std::string const& vName) {
+  std::cout << vName << ": state size " << sizeof(TEngine) << " bytes" << std::endl;
+
+  TEngine engine;
+  RunBenchmark(vName + " 1000 x operator()", [&]() {
+    uint32_t sum = 0;
+    for (int i = 0; i < 1000; ++i) { sum += engine(); }
+    DoNotOptimize(sum);
+  });
+
+  std::uniform_real_distribution<double> uniform;
+  RunBenchmark(vName + " 1000 x uniform double", [&]() {
+    double sum = 0;
+    for (int i = 0; i < 1000; ++i) { sum += uniform(engine); }
+    DoNotOptimize(sum);
+  });
+
+  for (std::size_t const size : {std::size_t(1), UniformBuffer<TEngine>::kDefaultSize}) {
+    UniformBuffer<TEngine> buffer(engine, size);
+    RunBenchmark(vName + " 1000 x UniformBuffer(" + std::to_string(size) + ")", [&]() {
+      double sum = 0;
+      for (int i = 0; i < 1000; ++i) { sum += buffer(); }
+      DoNotOptimize(sum);
+    });
+  }
+
+  uint64_t seed = 0;
+  RunBenchmark(vName + " new stream + seed", [&]() {
+    TEngine fresh(++seed);
+    DoNotOptimize(fresh());
+  });
+
+  RunBenchmark(vName + " discard(1000000)", [&]() {
+    engine.discard(1000000);
+    DoNotOptimize(engine);
+  });
+}
+
+int main() {
+  RunEngineBenchmarks<std::mt19937>("std::mt19937");
+  RunEngineBenchmarks<Philox4x32>("Philox4x32");
+}
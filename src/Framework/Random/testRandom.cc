@@ -11,13 +11,20 @@
 #include <catch2/catch.hpp>
 
 #include <corsika/random/ExponentialDistribution.h>
+#include <corsika/random/Philox.h>
 #include <corsika/random/RNGManager.h>
+#include <corsika/random/UniformBuffer.h>
 #include <corsika/random/UniformRealDistribution.h>
 #include <corsika/units/PhysicalUnits.h>
+#include <corsika/utl/BinaryIO.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <limits>
 #include <random>
+#include <sstream>
 #include <type_traits>
+#include <vector>
 
 using namespace corsika::random;
 
@@ -105,3 +112,256 @@ TEST_CASE("ExponentialDistribution") {
     CHECK(mean / beta == Approx(1).margin(1e-2));
   }
 }
+
+TEST_CASE("Philox4x32") {
+  using Counter = Philox4x32::CounterType;
+  using Key = Philox4x32::KeyType;
+
+  SECTION("known-answer test") {
+    // reference values of the Random123 distribution (kat_vectors)
+    CHECK(Philox4x32::Block(Counter{0, 0, 0, 0}, Key{0, 0}) ==
+          Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+    CHECK(Philox4x32::Block(Counter{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+                            Key{0xffffffff, 0xffffffff}) ==
+          Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+    CHECK(Philox4x32::Block(Counter{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+                            Key{0xa4093822, 0x299f31d0}) ==
+          Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1});
+
+    Philox4x32 engine;
+    CHECK(engine() == 0x6627e8d5);
+    CHECK(engine() == 0xe169c58d);
+  }
+
+  SECTION("discard") {
+    for (unsigned long long const skip : {0ull, 1ull, 3ull, 4ull, 5ull, 17ull, 1000ull}) {
+      for (int const offset : {0, 1, 3}) {
+        Philox4x32 a(12345), b(12345);
+        for (int i = 0; i < offset; ++i) {
+          a();
+          b();
+        }
+        for (unsigned long long i = 0; i < skip; ++i) { a(); }
+        b.discard(skip);
+        CHECK(a == b);
+        CHECK(a() == b());
+      }
+    }
+
+    // O(1): far jumps are cheap and land on the expected block
+    Philox4x32 far(1);
+    far.discard(4ull << 40);
+    CHECK(far.GetCounter() == Counter{0, 1u << 8, 0, 0});
+  }
+
+  SECTION("serialization") {
+    Philox4x32 a(0xdeadbeefcafeull, 7);
+    for (int i = 0; i < 6; ++i) { a(); }
+
+    std::stringstream buffer;
+    buffer << a;
+    Philox4x32 b;
+    buffer >> b;
+    REQUIRE(buffer);
+    CHECK(a == b);
+    for (int i = 0; i < 10; ++i) { CHECK(a() == b()); }
+
+    std::stringstream broken("1 2 3");
+    Philox4x32 c;
+    broken >> c;
+    CHECK_FALSE(broken);
+    CHECK(c == Philox4x32());
+  }
+
+  SECTION("streams") {
+    Philox4x32 a(1), b(2), c(1, 1);
+    std::seed_seq seq{1, 2, 3};
+    Philox4x32 d(seq);
+
+    int equalAB = 0, equalAC = 0, equalAD = 0;
+    for (int i = 0; i < 1000; ++i) {
+      auto const x = a();
+      equalAB += (x == b());
+      equalAC += (x == c());
+      equalAD += (x == d());
+    }
+    CHECK(equalAB < 2);
+    CHECK(equalAC < 2);
+    CHECK(equalAD < 2);
+  }
+
+  SECTION("statistical smoke test") {
+    Philox4x32 engine(42);
+    std::uniform_real_distribution<double> uniform;
+
+    int constexpr N = 1'000'000;
+    int constexpr nBins = 100;
+    std::vector<int> histogram(nBins);
+    double sum = 0, sum2 = 0, sumLag = 0, previous = 0.5;
+    double min = 1, max = 0;
+    for (int i = 0; i < N; ++i) {
+      double const x = uniform(engine);
+      min = std::min(min, x);
+      max = std::max(max, x);
+      ++histogram[int(x * nBins)];
+      sum += x;
+      sum2 += x * x;
+      sumLag += (x - 0.5) * (previous - 0.5);
+      previous = x;
+    }
+
+    CHECK(min >= 0);
+    CHECK(max < 1);
+
+    double const mean = sum / N;
+    double const variance = sum2 / N - mean * mean;
+    CHECK(mean == Approx(0.5).margin(5 * std::sqrt(1. / 12 / N)));
+    CHECK(variance == Approx(1. / 12).epsilon(0.01));
+    // lag-1 autocorrelation
+    CHECK(sumLag / N / variance == Approx(0).margin(5 / std::sqrt(N)));
+
+    // chi^2 with 99 degrees of freedom, 99.99% quantile is about 162
+    double chi2 = 0;
+    double const expected = double(N) / nBins;
+    for (auto const n : histogram) { chi2 += (n - expected) * (n - expected) / expected; }
+    CHECK(chi2 < 162);
+  }
+}
+
+TEMPLATE_TEST_CASE("UniformBuffer", "", std::mt19937, Philox4x32) {
+  using Engine = TestType;
+
+  SECTION("same numbers as std::uniform_real_distribution") {
+    Engine engine(42), reference(42);
+    std::uniform_real_distribution<double> dist;
+    UniformBuffer<Engine> buffer(engine, 100);
+
+    for (int i = 0; i < 1000; ++i) {
+      double const x = buffer();
+      REQUIRE(x == dist(reference)); // bitwise identical
+      REQUIRE(x >= 0);
+      REQUIRE(x < 1);
+    }
+    CHECK(buffer.GetAvailable() == 0);
+    CHECK(engine == reference);
+  }
+
+  SECTION("deterministic mode") {
+    Engine engine(7), reference(7);
+    std::uniform_real_distribution<double> dist;
+    UniformBuffer<Engine> buffer(engine, 1);
+
+    // interleaved use of the engine is not affected by the buffer
+    for (int i = 0; i < 100; ++i) {
+      REQUIRE(buffer() == dist(reference));
+      REQUIRE(engine() == reference());
+      REQUIRE(engine == reference);
+    }
+  }
+
+  SECTION("resize and clear") {
+    Engine engine;
+    UniformBuffer<Engine> buffer(engine, 16);
+    buffer();
+    CHECK(buffer.GetAvailable() == 15);
+    buffer.Clear();
+    CHECK(buffer.GetAvailable() == 0);
+    buffer.SetSize(4);
+    CHECK(buffer.GetSize() == 4);
+    CHECK_THROWS(buffer.SetSize(0));
+  }
+}
+
+TEST_CASE("RNGManager uniform buffers") {
+  auto& rngManager = RNGManager::GetInstance();
+  rngManager.RegisterRandomStream("buffered");
+  rngManager.SeedAll(1);
+
+  auto& buffer = rngManager.GetUniformBuffer("buffered");
+  CHECK(&rngManager.GetUniformBuffer("buffered") == &buffer);
+  CHECK(&buffer.GetEngine() == &rngManager.GetRandomStream("buffered"));
+  CHECK(buffer.GetSize() == UniformBuffer<RNG>::kDefaultSize);
+  CHECK_THROWS(rngManager.GetUniformBuffer("not registered"));
+
+  SECTION("re-seeding drops buffered values") {
+    buffer();
+    rngManager.SeedAll(1);
+    CHECK(buffer.GetAvailable() == 0);
+
+    RNG reference = rngManager.GetRandomStream("buffered");
+    std::uniform_real_distribution<double> dist;
+    CHECK(buffer() == dist(reference));
+  }
+
+  SECTION("deterministic mode") {
+    rngManager.SetDeterministicBuffers(true);
+    CHECK(buffer.GetSize() == 1);
+
+    RNG reference = rngManager.GetRandomStream("buffered");
+    std::uniform_real_distribution<double> dist;
+    for (int i = 0; i < 10; ++i) { buffer(); }
+    for (int i = 0; i < 10; ++i) { dist(reference); }
+    CHECK(reference == rngManager.GetRandomStream("buffered"));
+
+    rngManager.SetDeterministicBuffers(false);
+    CHECK(buffer.GetSize() == UniformBuffer<RNG>::kDefaultSize);
+  }
+}
+
+TEST_CASE("RNGManager lineage keys") {
+  auto& rngManager = RNGManager::GetInstance();
+  rngManager.RegisterRandomStream("lineage1");
+  rngManager.RegisterRandomStream("lineage2");
+  auto& s1 = rngManager.GetRandomStream("lineage1");
+  auto& s2 = rngManager.GetRandomStream("lineage2");
+  auto& buffer = rngManager.GetUniformBuffer("lineage1");
+
+  CHECK(RNGManager::GetStreamId("lineage1") != RNGManager::GetStreamId("lineage2"));
+
+  rngManager.SetLineageKey(17);
+  auto const first1 = s1();
+  auto const first2 = s2();
+  CHECK(first1 != first2);
+  double const u = buffer();
+
+  // the state depends only on the key, not on what was drawn before
+  for (int i = 0; i < 100; ++i) { s2(); }
+  rngManager.SetLineageKey(18);
+  s1();
+  rngManager.SetLineageKey(17);
+  CHECK(buffer.GetAvailable() == 0);
+  CHECK(s1() == first1);
+  CHECK(s2() == first2);
+  CHECK(buffer() == u);
+
+  RNG rng;
+  RNGManager::SeedLineage(rng, 17, RNGManager::GetStreamId("lineage1"));
+  CHECK(rng() == first1);
+  RNGManager::SeedLineage(rng, 18, RNGManager::GetStreamId("lineage1"));
+  CHECK(rng() != first1);
+}
+
+TEST_CASE("RNGManager state") {
+  auto& rngManager = RNGManager::GetInstance();
+  rngManager.RegisterRandomStream("saved");
+  auto& stream = rngManager.GetRandomStream("saved");
+  rngManager.SeedAll(3);
+
+  std::stringstream state;
+  rngManager.SaveState(state);
+  auto const first = stream();
+  rngManager.LoadState(state);
+  CHECK(stream() == first);
+
+  SECTION("unregistered stream") {
+    std::stringstream unknown;
+    corsika::utl::WriteBinary(unknown, uint64_t(1));
+    corsika::utl::WriteBinary(unknown, std::string("never registered"));
+    std::ostringstream engineState;
+    engineState << stream;
+    corsika::utl::WriteBinary(unknown, engineState.str());
+    corsika::utl::WriteBinary(unknown, false);
+    CHECK_THROWS_AS(rngManager.LoadState(unknown), std::runtime_error);
+    CHECK_THROWS(rngManager.GetRandomStream("never registered"));
+  }
+}
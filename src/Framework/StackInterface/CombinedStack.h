@@ -15,6 +15,8 @@
 #include <corsika/stack/Stack.h>
 #include <corsika/units/PhysicalUnits.h>
 
+#include <utility>
+
 namespace corsika::stack {
 
   /**
@@ -93,6 +95,19 @@ namespace corsika::stack {
       PI_A::SetParticleData(static_cast<PI_A&>(p), vA);
       PI_B::SetParticleData(static_cast<PI_B&>(p), vB);
     }
+
+    /// raw data, see ParticleBase::EmplaceSecondary, is passed on to A
+    template <typename... Args1>
+    void SetParticleData(EmplaceTag, Args1&&... vA) {
+      PI_A::SetParticleData(EmplaceTag{}, std::forward<Args1>(vA)...);
+      PI_B::SetParticleData();
+    }
+    template <typename... Args1>
+    void SetParticleData(PI_C& p, EmplaceTag, Args1&&... vA) {
+      PI_A::SetParticleData(static_cast<PI_A&>(p), EmplaceTag{},
+                            std::forward<Args1>(vA)...);
+      PI_B::SetParticleData(static_cast<PI_B&>(p));
+    }
     ///@}
   };
 
@@ -12,9 +12,18 @@
 #define _include_particleBase_h_
 
 #include <type_traits>
+#include <utility>
 
 namespace corsika::stack {
 
+  /**
+   * Tag selecting the SetParticleData(EmplaceTag, ...) overloads of a
+   * ParticleInterface, which take the particle data as separate raw
+   * components instead of a std::tuple, see
+   * ParticleBase::EmplaceSecondary and Stack::EmplaceParticle.
+   */
+  struct EmplaceTag {};
+
   /**
    @class ParticleBase
 
@@ -72,8 +81,20 @@ namespace corsika::stack {
      * function description in the user defined ParticleInterface::AddSecondary(...)
      */
     template <typename... TArgs>
-    StackIterator AddSecondary(const TArgs... args) {
-      return GetStack().AddSecondary(GetIterator(), args...);
+    StackIterator AddSecondary(TArgs&&... args) {
+      return GetStack().AddSecondary(GetIterator(), std::forward<TArgs>(args)...);
+    }
+
+    /**
+     * Add a secondary particle based on *this on the stack, like
+     * AddSecondary(...), but the data is forwarded as it is to
+     * ParticleInterface::SetParticleData(parent, EmplaceTag, args...),
+     * i.e. written directly to the stack without building a tuple.
+     */
+    template <typename... TArgs>
+    StackIterator EmplaceSecondary(TArgs&&... args) {
+      return GetStack().AddSecondary(GetIterator(), EmplaceTag{},
+                                     std::forward<TArgs>(args)...);
     }
 
     // protected: // todo should [MAY]be proteced, but don't now how to 'friend Stack'
@@ -12,8 +12,11 @@
 #define _include_corsika_stack_secondaryview_h_
 
 #include <corsika/stack/Stack.h>
+#include <corsika/utl/StepArena.h>
 
+#include <memory_resource>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
 namespace corsika::stack {
@@ -46,8 +49,9 @@ namespace corsika::stack {
      *Further information about implementation (for developers):* All
      data is stored in the original stack privided at construction
      time. The secondary particle (view) indices are stored in an
-     extra std::vector of SecondaryView class 'fIndices' referring to
-     the original stack slot indices. The index of the primary
+     extra std::pmr::vector of SecondaryView class 'fIndices' referring to
+     the original stack slot indices, allocated from the
+     utl::GetStepResource() of the current step. The index of the primary
      projectle particle is also explicitly stored in
      'fProjectileIndex'. StackIterator indices
      'i = StackIterator::GetIndex()' are referring to those numbers,
@@ -121,13 +125,13 @@ namespace corsika::stack {
     }
 
     template <typename... Args>
-    auto AddSecondary(const Args... v) {
+    auto AddSecondary(Args&&... v) {
       StackIterator proj = GetProjectile();
-      return AddSecondary(proj, v...);
+      return AddSecondary(proj, std::forward<Args>(v)...);
     }
 
     template <typename... Args>
-    auto AddSecondary(StackIterator& proj, const Args... v) {
+    auto AddSecondary(StackIterator& proj, Args&&... v) {
       // make space on stack
       InnerStackType::GetStackData().IncrementSize();
       // get current number of secondaries on stack
@@ -137,7 +141,7 @@ namespace corsika::stack {
       fIndices.push_back(index);
       // NOTE: "+1" is since "0" is special marker here for PROJECTILE, see
       // GetIndexFromIterator
-      return StackIterator(*this, idSec + 1, proj, v...);
+      return StackIterator(*this, idSec + 1, proj, std::forward<Args>(v)...);
     }
 
     /**
@@ -195,6 +199,49 @@ namespace corsika::stack {
      */
     void Delete(ParticleInterfaceType p) { Delete(p.GetIterator()); }
 
+    /**
+     * need overwrite Stack::RemoveIf, since we want to call
+     * SecondaryView::DeleteLast
+     *
+     * Same as Stack::RemoveIf for the secondaries of the view: the
+     * remaining secondaries are compacted on the internal stack in one
+     * pass, the deleted ones end up at the very end of it and are
+     * removed together with their entries in fIndices. Like Delete,
+     * this relies on the secondaries being the last particles on the
+     * internal stack.
+     *
+     * @return the number of deleted secondaries
+     */
+    template <typename TPredicate>
+    unsigned int RemoveIf(TPredicate vPredicate, bool const vKeepOrder = false) {
+      auto& data = InnerStackType::GetStackData();
+      unsigned int const size = GetSize();
+      unsigned int keep = 0;
+      // NOTE: "+1" is since "0" is special marker here for PROJECTILE, see
+      // GetIndexFromIterator
+      if (vKeepOrder) {
+        for (unsigned int i = 0; i < size; ++i) {
+          StackIterator p(*this, i + 1);
+          if (vPredicate(*p)) { continue; }
+          if (keep != i) { data.Copy(fIndices[i], fIndices[keep]); }
+          ++keep;
+        }
+      } else {
+        keep = size;
+        unsigned int i = 0;
+        while (i < keep) {
+          StackIterator p(*this, i + 1);
+          if (!vPredicate(*p)) {
+            ++i;
+            continue;
+          }
+          if (i < --keep) { data.Copy(fIndices[keep], fIndices[i]); }
+        }
+      }
+      for (unsigned int i = keep; i < size; ++i) { DeleteLast(); }
+      return size - keep;
+    }
+
     /**
      * delete last particle on stack by decrementing stack size
      */
@@ -227,7 +274,7 @@ namespace corsika::stack {
 
   private:
     unsigned int fProjectileIndex;
-    std::vector<unsigned int> fIndices;
+    std::pmr::vector<unsigned int> fIndices{utl::GetStepResource()};
   };
 
   /*
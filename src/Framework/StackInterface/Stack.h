@@ -16,8 +16,11 @@
 #include <corsika/stack/SecondaryView.h>
 #include <corsika/utl/MetaProgramming.h>
 
+#include <algorithm>
+#include <limits>
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
 
 /**
    All classes around management of particles on a stack.
@@ -59,6 +62,7 @@ namespace corsika::stack {
     using StackDataValueType = std::remove_reference_t<StackDataType>;
 
     StackDataType fData; ///< this in general holds all the data and can be quite big
+    unsigned int fLowWater = std::numeric_limits<unsigned int>::max();
 
   private:
     Stack(Stack&) = delete; ///< since Stack can be very big, we don't want to copy it
@@ -137,10 +141,28 @@ namespace corsika::stack {
     }
     template <typename... Args>
     auto Clear(Args... args) {
+      fLowWater = 0;
       return fData.Clear(args...);
     }
     ///@}
 
+    /**
+     * @name Lowest index changed since ResetLowWater()
+     *
+     * For observers that expect changes only at the top of the stack, e.g.
+     * process::checkpoint::Checkpoint. Swap, Copy, Delete, RemoveIf,
+     * DeleteLast and Clear lower it, particles changed in place below the
+     * top must be reported with LowerLowWater(). The particles below
+     * GetLowWater() are unchanged.
+     * @{
+     */
+    unsigned int GetLowWater() const { return std::min(fLowWater, GetSize()); }
+    void LowerLowWater(unsigned int const vIndex) {
+      fLowWater = std::min(fLowWater, vIndex);
+    }
+    void ResetLowWater() { fLowWater = std::numeric_limits<unsigned int>::max(); }
+    ///@}
+
   public:
     /**
      * @name These are functions required by std containers and std loops
@@ -163,9 +185,18 @@ namespace corsika::stack {
      * increase stack size, create new particle at end of stack
      */
     template <typename... Args>
-    StackIterator AddParticle(const Args... v) {
+    StackIterator AddParticle(Args&&... v) {
       fData.IncrementSize();
-      return StackIterator(*this, GetSize() - 1, v...);
+      return StackIterator(*this, GetSize() - 1, std::forward<Args>(v)...);
+    }
+
+    /**
+     * increase stack size, create new particle at end of stack from raw
+     * data, see ParticleBase::EmplaceSecondary
+     */
+    template <typename... Args>
+    StackIterator EmplaceParticle(Args&&... v) {
+      return AddParticle(EmplaceTag{}, std::forward<Args>(v)...);
     }
 
     /**
@@ -173,21 +204,25 @@ namespace corsika::stack {
      * particle/projectile
      */
     template <typename... Args>
-    StackIterator AddSecondary(StackIterator& parent, const Args... v) {
+    StackIterator AddSecondary(StackIterator& parent, Args&&... v) {
       fData.IncrementSize();
-      return StackIterator(*this, GetSize() - 1, parent, v...);
+      return StackIterator(*this, GetSize() - 1, parent, std::forward<Args>(v)...);
     }
 
     void Swap(StackIterator a, StackIterator b) {
+      LowerLowWater(std::min(a.GetIndex(), b.GetIndex()));
       fData.Swap(a.GetIndex(), b.GetIndex());
     }
     void Swap(ConstStackIterator a, ConstStackIterator b) {
+      LowerLowWater(std::min(a.GetIndex(), b.GetIndex()));
       fData.Swap(a.GetIndex(), b.GetIndex());
     }
     void Copy(StackIterator a, StackIterator b) {
+      LowerLowWater(b.GetIndex());
       fData.Copy(a.GetIndex(), b.GetIndex());
     }
     void Copy(ConstStackIterator a, StackIterator b) {
+      LowerLowWater(b.GetIndex());
       fData.Copy(a.GetIndex(), b.GetIndex());
     }
 
@@ -198,7 +233,10 @@ namespace corsika::stack {
       if (GetSize() == 0) { /*error*/
         throw std::runtime_error("Stack, cannot delete entry since size is zero");
       }
-      if (p.GetIndex() < GetSize() - 1) fData.Copy(GetSize() - 1, p.GetIndex());
+      if (p.GetIndex() < GetSize() - 1) {
+        LowerLowWater(p.GetIndex());
+        fData.Copy(GetSize() - 1, p.GetIndex());
+      }
       DeleteLast();
     }
     /**
@@ -206,10 +244,58 @@ namespace corsika::stack {
      */
     void Delete(ParticleInterfaceType p) { Delete(p.GetIterator()); }
 
+    /**
+     * delete all particles for which vPredicate(particle) is true, in
+     * one pass and with one DecrementSize per removed particle at the
+     * end. vPredicate is called exactly once per particle.
+     *
+     * Without vKeepOrder the gaps are filled with the last particles,
+     * as by Delete, which results in the same stack as calling Delete
+     * in a loop. With vKeepOrder the remaining particles keep their
+     * relative order.
+     *
+     * @return the number of deleted particles
+     */
+    template <typename TPredicate>
+    unsigned int RemoveIf(TPredicate vPredicate, bool const vKeepOrder = false) {
+      unsigned int const size = GetSize();
+      unsigned int keep = 0;
+      if (vKeepOrder) {
+        for (unsigned int i = 0; i < size; ++i) {
+          StackIterator p(*this, i);
+          if (vPredicate(*p)) { continue; }
+          if (keep != i) {
+            LowerLowWater(keep);
+            fData.Copy(i, keep);
+          }
+          ++keep;
+        }
+      } else {
+        keep = size;
+        unsigned int i = 0;
+        while (i < keep) {
+          StackIterator p(*this, i);
+          if (!vPredicate(*p)) {
+            ++i;
+            continue;
+          }
+          if (i < --keep) {
+            LowerLowWater(i);
+            fData.Copy(keep, i);
+          }
+        }
+      }
+      for (unsigned int i = keep; i < size; ++i) { DeleteLast(); }
+      return size - keep;
+    }
+
     /**
      * delete last particle on stack by decrementing stack size
      */
-    void DeleteLast() { fData.DecrementSize(); }
+    void DeleteLast() {
+      fData.DecrementSize();
+      LowerLowWater(GetSize());
+    }
 
     /**
      * check if there are no further particles on stack
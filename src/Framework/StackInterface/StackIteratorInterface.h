@@ -114,10 +114,10 @@ namespace corsika::stack {
        ParticleInterfaceType::SetParticleData(...) function
      */
     template <typename... Args>
-    StackIteratorInterface(StackType& data, const unsigned int index, const Args... args)
+    StackIteratorInterface(StackType& data, const unsigned int index, Args&&... args)
         : fIndex(index)
         , fData(&data) {
-      (**this).SetParticleData(args...);
+      (**this).SetParticleData(std::forward<Args>(args)...);
     }
 
     /** constructor that also sets new values on particle data object, including reference
@@ -132,10 +132,10 @@ namespace corsika::stack {
     */
     template <typename... Args>
     StackIteratorInterface(StackType& data, const unsigned int index,
-                           StackIteratorInterface& parent, const Args... args)
+                           StackIteratorInterface& parent, Args&&... args)
         : fIndex(index)
         , fData(&data) {
-      (**this).SetParticleData(*parent, args...);
+      (**this).SetParticleData(*parent, std::forward<Args>(args)...);
     }
 
   public:
@@ -194,4 +194,42 @@ TEST_CASE("SecondaryStack", "[stack]") {
       CHECK(stack.GetSize() == 6);
     }
   }
+
+  SECTION("remove if") {
+    auto data = [](StackTest const& vS) {
+      std::vector<double> v;
+      for (auto const& p : vS) v.push_back(p.GetData());
+      return v;
+    };
+
+    StackTest stack;
+    stack.AddParticle(std::tuple{-99.});
+    stack.AddParticle(std::tuple{0.});
+
+    {
+      auto particle = stack.GetNextParticle();
+      StackTestView view(particle);
+      for (double const v : {-2., 3., -1., 1., -3., 2.}) {
+        view.AddSecondary(std::tuple{v});
+      }
+      CHECK(view.RemoveIf([](auto const& p) { return p.GetData() < 0; }, true) == 3);
+      CHECK(view.GetSize() == 3);
+      CHECK(data(stack) == std::vector<double>{-99., 0., 3., 1., 2.});
+    }
+
+    {
+      auto particle = stack.GetNextParticle();
+      StackTestView view(particle);
+      for (double const v : {-2., 3., -1., 1., -3., 2.}) {
+        view.AddSecondary(std::tuple{v});
+      }
+      CHECK(view.RemoveIf([](auto const& p) { return p.GetData() < 0; }) == 3);
+      CHECK(view.GetSize() == 3);
+      // gaps are filled from the end, as by Delete
+      CHECK(data(stack) == std::vector<double>{-99., 0., 3., 1., 2., 2., 3., 1.});
+      double v = 0;
+      for (auto const& p : view) v += p.GetData();
+      CHECK(v == 6.);
+    }
+  }
 }
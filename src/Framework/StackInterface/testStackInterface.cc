@@ -120,4 +120,67 @@ TEST_CASE("Stack", "[Stack]") {
 
     REQUIRE(s.GetSize() == 0);
   }
+
+  SECTION("remove if") {
+    auto data = [](StackTest const& vS) {
+      std::vector<double> v;
+      for (auto const& p : vS) v.push_back(p.GetData());
+      return v;
+    };
+    auto negative = [](auto const& p) { return p.GetData() < 0; };
+
+    StackTest s;
+    StackTest t;
+    for (double const v : {1., -1., 2., -2., -3., 3., -4.}) {
+      s.AddParticle(std::tuple{v});
+      t.AddParticle(std::tuple{v});
+    }
+    REQUIRE(s.RemoveIf(negative) == 4);
+    // same as Delete in a loop
+    auto p = t.begin();
+    while (p != t.end()) {
+      if (p.GetData() < 0) {
+        p.Delete();
+      } else {
+        ++p;
+      }
+    }
+    CHECK(data(s) == data(t));
+
+    s.Clear();
+    for (double const v : {1., -1., 2., -2., -3., 3., -4.}) s.AddParticle(std::tuple{v});
+    REQUIRE(s.RemoveIf(negative, true) == 4);
+    CHECK(data(s) == std::vector<double>{1., 2., 3.});
+    CHECK(s.RemoveIf(negative) == 0);
+    CHECK(s.RemoveIf([](auto const&) { return true; }, true) == 3);
+    CHECK(s.IsEmpty());
+  }
+
+  SECTION("low water") {
+    StackTest s;
+    for (double const v : {1., 2., 3., 4., 5.}) s.AddParticle(std::tuple{v});
+    CHECK(s.GetLowWater() == 5);
+    s.ResetLowWater();
+    s.AddParticle(std::tuple{6.}); // above the previous size
+    CHECK(s.GetLowWater() == 6);
+    s.Swap(s.begin() + 2, s.begin() + 4);
+    CHECK(s.GetLowWater() == 2);
+
+    s.ResetLowWater();
+    s.DeleteLast();
+    CHECK(s.GetLowWater() == 5);
+    s.Delete(s.begin() + 1); // the last particle is moved to index 1
+    CHECK(s.GetLowWater() == 1);
+
+    s.ResetLowWater();
+    s.RemoveIf([](auto const& p) { return p.GetData() == 1.; });
+    CHECK(s.GetLowWater() == 0);
+
+    s.ResetLowWater();
+    s.LowerLowWater(1);
+    CHECK(s.GetLowWater() == 1);
+    s.Clear();
+    s.AddParticle(std::tuple{7.});
+    CHECK(s.GetLowWater() == 0);
+  }
 }
@@ -0,0 +1,66 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_corsika_testing_AllocationCounter_h_
+#define _include_corsika_testing_AllocationCounter_h_
+
+/**
+ * Replaces the global operator new and delete by versions counting the
+ * heap allocations of the program, for tests of the allocation behaviour:
+ * \code
+ * std::size_t const n = testing::GetNumberOfAllocations();
+ * RunSomething();
+ * CHECK(testing::GetNumberOfAllocations() - n == 0);
+ * \endcode
+ *
+ * The replacement functions are defined here, so this header must be
+ * included in exactly one translation unit of a test program.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace corsika::testing {
+
+  namespace detail {
+    inline std::atomic<std::size_t> gNAllocations{0};
+  }
+
+  /// number of calls of the global operator new so far
+  inline std::size_t GetNumberOfAllocations() {
+    return detail::gNAllocations.load(std::memory_order_relaxed);
+  }
+
+} // namespace corsika::testing
+
+void* operator new(std::size_t vSize) {
+  corsika::testing::detail::gNAllocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* const p = std::malloc(vSize ? vSize : 1)) { return p; }
+  throw std::bad_alloc();
+}
+
+void* operator new(std::size_t vSize, std::align_val_t const vAlign) {
+  // e.g. from std::pmr::new_delete_resource()
+  corsika::testing::detail::gNAllocations.fetch_add(1, std::memory_order_relaxed);
+  std::size_t const align = static_cast<std::size_t>(vAlign);
+  if (void* const p = std::aligned_alloc(align, (vSize + align - 1) / align * align)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* vP) noexcept { std::free(vP); }
+void operator delete(void* vP, std::size_t) noexcept { std::free(vP); }
+void operator delete(void* vP, std::align_val_t) noexcept { std::free(vP); }
+void operator delete(void* vP, std::size_t, std::align_val_t) noexcept { std::free(vP); }
+
+#endif
@@ -0,0 +1,151 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_corsika_testing_Benchmark_h_
+#define _include_corsika_testing_Benchmark_h_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * \file Benchmark.h
+ *
+ * Minimal timing harness for the micro benchmarks registered with
+ * CORSIKA_ADD_BENCHMARK. The code under test is called repeatedly until
+ * a minimum wall-clock time has passed, and the mean time per call is
+ * reported.
+ *
+ * If the environment variable CORSIKA_BENCHMARK_JSON names a file, all
+ * results of the program are also written there as JSON, in the format of
+ * Google Benchmark, for tracking them over time. The run_<benchmark>
+ * targets write to benchmark_outputs/ in the build directory.
+ */
+
+namespace corsika::testing {
+
+  /**
+   * Prevents the compiler from optimizing away a computation whose result
+   * is otherwise unused.
+   */
+  template <typename T>
+  inline void DoNotOptimize(T const& vValue) {
+    asm volatile("" : : "g"(&vValue) : "memory");
+  }
+
+  struct BenchmarkResult {
+    std::string fName;
+    std::size_t fIterations = 0;
+    double fNanoSecondsPerIteration = 0;
+    /// further quantities, written as user counters of Google Benchmark
+    std::vector<std::pair<std::string, double>> fCounters = {};
+  };
+
+  /**
+   * Collects the results of a benchmark program and writes them to
+   * CORSIKA_BENCHMARK_JSON at the end of the program.
+   */
+  class BenchmarkReport {
+  public:
+    static BenchmarkReport& GetInstance() {
+      static BenchmarkReport report;
+      return report;
+    }
+
+    /// for results measured without RunBenchmark
+    void Add(BenchmarkResult const& vResult) { fResults.push_back(vResult); }
+
+    std::vector<BenchmarkResult> const& GetResults() const { return fResults; }
+
+    void WriteJSON(std::ostream& vOut) const {
+      char date[32] = "";
+      std::time_t const now = std::time(nullptr);
+      std::strftime(date, sizeof(date), "%FT%T%z", std::localtime(&now));
+      vOut << "{\n  \"context\": {\"date\": \"" << date << "\"},\n"
+           << "  \"benchmarks\": [";
+      for (std::size_t i = 0; i < fResults.size(); ++i) {
+        auto const& r = fResults[i];
+        vOut << (i ? "," : "") << "\n    {\"name\": \"" << Escape(r.fName)
+             << "\", \"iterations\": " << r.fIterations << ", \"real_time\": "
+             << std::setprecision(6) << std::scientific << r.fNanoSecondsPerIteration
+             << std::defaultfloat << ", \"time_unit\": \"ns\"";
+        for (auto const& [name, value] : r.fCounters) {
+          vOut << ", \"" << Escape(name) << "\": " << std::setprecision(6)
+               << std::scientific << value << std::defaultfloat;
+        }
+        vOut << "}";
+      }
+      vOut << "\n  ]\n}\n";
+    }
+
+    ~BenchmarkReport() {
+      char const* const file = std::getenv("CORSIKA_BENCHMARK_JSON");
+      if (!file || !*file) { return; }
+      std::ofstream out(file);
+      WriteJSON(out);
+    }
+
+  private:
+    BenchmarkReport() = default;
+
+    static std::string Escape(std::string const& vText) {
+      std::string escaped;
+      for (char const c : vText) {
+        if (c == '"' || c == '\\') { escaped += '\\'; }
+        escaped += c;
+      }
+      return escaped;
+    }
+
+    std::vector<BenchmarkResult> fResults;
+  };
+
+  /**
+   * Runs \p vFunction repeatedly, doubling the number of calls per round,
+   * until one round takes at least \p vMinSeconds. The result of the last
+   * round is printed, added to the BenchmarkReport and returned.
+   */
+  template <typename TFunction>
+  BenchmarkResult RunBenchmark(std::string const& vName, TFunction&& vFunction,
+                               double const vMinSeconds = 0.2) {
+    using clock = std::chrono::steady_clock;
+
+    vFunction(); // warm-up
+
+    std::size_t n = 1;
+    while (true) {
+      auto const start = clock::now();
+      for (std::size_t i = 0; i < n; ++i) { vFunction(); }
+      std::chrono::duration<double> const elapsed = clock::now() - start;
+
+      if (elapsed.count() >= vMinSeconds || n >= (std::size_t(1) << 40)) {
+        BenchmarkResult const result{vName, n, elapsed.count() / n * 1e9};
+        std::cout << std::left << std::setw(48) << vName << std::right
+                  << std::setw(14) << std::fixed << std::setprecision(2)
+                  << result.fNanoSecondsPerIteration << " ns/iteration  (" << n
+                  << " iterations)" << std::endl;
+        BenchmarkReport::GetInstance().Add(result);
+        return result;
+      }
+      n *= 2;
+    }
+  }
+
+} // namespace corsika::testing
+
+#endif
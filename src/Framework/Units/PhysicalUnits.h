@@ -69,6 +69,8 @@ namespace corsika::units::si {
       phys::units::quantity<phys::units::dimensions<0, 0, -1>, double>;
   using InverseGrammageType =
       phys::units::quantity<phys::units::dimensions<2, -1, 0>, double>;
+  using MagneticFluxDensityType =
+      phys::units::quantity<phys::units::magnetic_flux_density_d, double>;
 
   namespace detail {
     template <int N, typename T>
@@ -0,0 +1,62 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _corsika_utl_BinaryIO_h_
+#define _corsika_utl_BinaryIO_h_
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace corsika::utl {
+
+  /**
+   * Raw binary output of trivially copyable objects and strings, used for
+   * checkpoints. The data are written in native byte order, i.e. they are
+   * meant to be read back on the same kind of machine.
+   */
+  template <typename T>
+  void WriteBinary(std::ostream& vStream, T const& vValue) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    vStream.write(reinterpret_cast<char const*>(&vValue), sizeof(T));
+  }
+
+  inline void WriteBinary(std::ostream& vStream, std::string const& vValue) {
+    WriteBinary(vStream, uint64_t(vValue.size()));
+    vStream.write(vValue.data(), vValue.size());
+  }
+
+  /// \throws std::runtime_error if the stream ends prematurely
+  template <typename T>
+  T ReadBinary(std::istream& vStream) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value;
+    if (!vStream.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+      throw std::runtime_error("ReadBinary: unexpected end of data");
+    }
+    return value;
+  }
+
+  template <>
+  inline std::string ReadBinary<std::string>(std::istream& vStream) {
+    auto const size = ReadBinary<uint64_t>(vStream);
+    std::string value(size, '\0');
+    if (!vStream.read(value.data(), size)) {
+      throw std::runtime_error("ReadBinary: unexpected end of data");
+    }
+    return value;
+  }
+
+} // namespace corsika::utl
+
+#endif
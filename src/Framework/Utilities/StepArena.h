@@ -0,0 +1,145 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _corsika_utl_StepArena_h_
+#define _corsika_utl_StepArena_h_
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+namespace corsika::utl {
+
+  /**
+   * \class StepArena StepArena.h utl/StepArena.h
+   *
+   * Monotonic memory for the temporaries of one step of the cascade, which
+   * is released as a whole at the end of the step.
+   *
+   * While a StepArena::Scope exists, GetStepResource() returns the arena
+   * of the scope, otherwise the default resource of std::pmr. Code
+   * running inside a step, i.e. tracking and processes, constructs its
+   * short-lived containers as
+   * \code
+   * std::pmr::vector<CrossSectionType> sigma(n, utl::GetStepResource());
+   * \endcode
+   * Such containers must not outlive the step.
+   *
+   * Memory exceeding the buffer comes from the heap. At the next Reset()
+   * the buffer is enlarged to the size needed, so that a steady state
+   * does not allocate any more.
+   */
+  class StepArena {
+
+    /// forwards to the heap and counts the bytes taken from there
+    class Upstream : public std::pmr::memory_resource {
+    public:
+      std::size_t fBytes = 0;
+
+    private:
+      void* do_allocate(std::size_t const vBytes, std::size_t const vAlign) override {
+        fBytes += vBytes;
+        return std::pmr::new_delete_resource()->allocate(vBytes, vAlign);
+      }
+      void do_deallocate(void* const vP, std::size_t const vBytes,
+                         std::size_t const vAlign) override {
+        std::pmr::new_delete_resource()->deallocate(vP, vBytes, vAlign);
+      }
+      bool do_is_equal(std::pmr::memory_resource const& vOther) const
+          noexcept override {
+        return this == &vOther;
+      }
+    };
+
+  public:
+    explicit StepArena(std::size_t const vBytes = 1 << 16) { Allocate(vBytes); }
+
+    StepArena(StepArena const&) = delete;
+    StepArena& operator=(StepArena const&) = delete;
+
+    std::pmr::memory_resource* GetResource() { return &*fResource; }
+
+    /**
+     * Releases all memory given out since the last Reset(), and enlarges
+     * the buffer if it was too small.
+     */
+    void Reset() {
+      if (fUpstream.fBytes == 0) {
+        fResource->release();
+        return;
+      }
+      ++fNOverflows;
+      std::size_t const needed = fCapacity + fUpstream.fBytes;
+      fResource.reset();
+      fUpstream.fBytes = 0;
+      Allocate(std::max(2 * fCapacity, needed));
+    }
+
+    /// size of the buffer in bytes
+    std::size_t GetCapacity() const { return fCapacity; }
+    /// number of steps which needed more than the buffer
+    std::size_t GetNumberOfOverflows() const { return fNOverflows; }
+
+    /**
+     * Makes vArena the resource of GetStepResource() for the lifetime of
+     * the Scope, and resets it at the end.
+     */
+    class Scope {
+    public:
+      explicit Scope(StepArena& vArena)
+          : fArena(vArena)
+          , fPrevious(Current()) {
+        Current() = vArena.GetResource();
+      }
+      ~Scope() {
+        Current() = fPrevious;
+        fArena.Reset();
+      }
+      Scope(Scope const&) = delete;
+      Scope& operator=(Scope const&) = delete;
+
+    private:
+      StepArena& fArena;
+      std::pmr::memory_resource* const fPrevious;
+    };
+
+  private:
+    friend std::pmr::memory_resource* GetStepResource();
+
+    /// the resource of the innermost Scope of this thread
+    static std::pmr::memory_resource*& Current() {
+      thread_local std::pmr::memory_resource* current = nullptr;
+      return current;
+    }
+
+    void Allocate(std::size_t const vBytes) {
+      fBuffer = std::make_unique<std::byte[]>(vBytes);
+      fCapacity = vBytes;
+      fResource.emplace(fBuffer.get(), fCapacity, &fUpstream);
+    }
+
+    std::unique_ptr<std::byte[]> fBuffer;
+    std::size_t fCapacity = 0;
+    std::size_t fNOverflows = 0;
+    Upstream fUpstream;
+    std::optional<std::pmr::monotonic_buffer_resource> fResource;
+  };
+
+  /// the memory for temporaries of the current step, see StepArena
+  inline std::pmr::memory_resource* GetStepResource() {
+    auto* const current = StepArena::Current();
+    return current ? current : std::pmr::get_default_resource();
+  }
+
+} // namespace corsika::utl
+
+#endif
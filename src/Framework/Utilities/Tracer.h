@@ -0,0 +1,313 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _corsika_utl_Tracer_h_
+#define _corsika_utl_Tracer_h_
+
+#include <corsika/utl/Singleton.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace corsika::utl {
+
+  /**
+   * \class Tracer Tracer.h utl/Tracer.h
+   *
+   * Timeline of the execution in the trace-event format of Chrome, to be
+   * viewed with chrome://tracing or https://ui.perfetto.dev. In contrast
+   * to aggregated timings it shows single stalls, e.g. the initialisation
+   * of a model or the flush of an output file.
+   *
+   * The events are recorded by TraceScope and TraceStep into a buffer per
+   * thread, so that recording needs no locking. Each scope is written as
+   * one complete event ("ph":"X"), i.e. begin and end in one record.
+   *
+   * The Tracer is off by default, a disabled TraceScope costs one load
+   * and branch. It is switched on by Start() or by the environment
+   * variable CORSIKA_TRACE_JSON=<file>. Of the steps of the cascade only
+   * every N-th is recorded including its content, with N from
+   * SetSampling() or CORSIKA_TRACE_EVERY=<N>, so that full showers can be
+   * traced with small overhead. The file is written by Stop() or at the
+   * exit of the program.
+   *
+   * Clear(), Write() and Stop() must not be called while other threads
+   * are recording.
+   */
+  class Tracer : public Singleton<Tracer> {
+
+    struct Event {
+      char const* fName;
+      char const* fCategory;
+      int64_t fBegin;    //!< ns since Start()
+      int64_t fDuration; //!< ns
+    };
+
+  public:
+    /// the events of one thread
+    struct ThreadBuffer {
+      std::vector<Event> fEvents;
+      unsigned int fThreadId = 0;
+      uint64_t fNSteps = 0;      //!< for the sampling of TraceStep
+      bool fSkipping = false;    //!< inside a step that is not sampled
+      std::size_t fNDropped = 0; //!< events beyond GetMaxEvents()
+    };
+
+    /**
+     * Starts recording. The events are written to vFilename at Stop() or
+     * at exit, unless vFilename is empty. Events of a previous run are
+     * discarded.
+     */
+    void Start(std::string const& vFilename = "", unsigned int const vEveryNthStep = 1) {
+      Clear();
+      fFilename = vFilename;
+      SetSampling(vEveryNthStep);
+      fOrigin = std::chrono::steady_clock::now();
+      fEnabled.store(true, std::memory_order_relaxed);
+    }
+
+    /// stops recording, and writes the file given to Start()
+    void Stop() {
+      if (!IsEnabled()) { return; }
+      fEnabled.store(false, std::memory_order_relaxed);
+      if (fFilename.empty()) { return; }
+      std::ofstream file(fFilename);
+      if (!file) { throw std::runtime_error("Tracer: cannot open " + fFilename); }
+      Write(file);
+    }
+
+    bool IsEnabled() const { return fEnabled.load(std::memory_order_relaxed); }
+
+    /// record only every vEveryNthStep-th TraceStep
+    void SetSampling(unsigned int const vEveryNthStep) {
+      if (vEveryNthStep == 0) {
+        throw std::invalid_argument("Tracer: sampling must be at least 1");
+      }
+      fEveryNthStep = vEveryNthStep;
+    }
+    unsigned int GetSampling() const { return fEveryNthStep; }
+
+    /// limit of the number of events per thread, further ones are dropped
+    void SetMaxEvents(std::size_t const vMax) { fMaxEvents = vMax; }
+    std::size_t GetMaxEvents() const { return fMaxEvents; }
+
+    std::size_t GetNumberOfEvents() const {
+      std::lock_guard lock(fMutex);
+      std::size_t n = 0;
+      for (auto const& buffer : fBuffers) { n += buffer->fEvents.size(); }
+      return n;
+    }
+
+    std::size_t GetNumberOfDroppedEvents() const {
+      std::lock_guard lock(fMutex);
+      std::size_t n = 0;
+      for (auto const& buffer : fBuffers) { n += buffer->fNDropped; }
+      return n;
+    }
+
+    /// discards all events recorded so far
+    void Clear() {
+      std::lock_guard lock(fMutex);
+      for (auto& buffer : fBuffers) {
+        buffer->fEvents.clear();
+        buffer->fNSteps = 0;
+        buffer->fNDropped = 0;
+      }
+    }
+
+    /// writes all events as JSON object in the trace-event format
+    void Write(std::ostream& vOut) const {
+      std::lock_guard lock(fMutex);
+      auto const flags = vOut.flags();
+      vOut.setf(std::ios::fixed);
+      auto const precision = vOut.precision(3);
+
+      vOut << "{\n  \"displayTimeUnit\": \"ns\",\n  \"traceEvents\": [";
+      char const* separator = "\n";
+      for (auto const& buffer : fBuffers) {
+        vOut << separator << "    {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, "
+             << "\"tid\": " << buffer->fThreadId
+             << ", \"args\": {\"name\": \"thread " << buffer->fThreadId << "\"}}";
+        separator = ",\n";
+        for (auto const& event : buffer->fEvents) {
+          vOut << separator << "    {\"name\": \"";
+          WriteEscaped(vOut, event.fName);
+          vOut << "\", \"cat\": \"";
+          WriteEscaped(vOut, event.fCategory);
+          vOut << "\", \"ph\": \"X\", \"ts\": " << event.fBegin * 1e-3
+               << ", \"dur\": " << event.fDuration * 1e-3
+               << ", \"pid\": 1, \"tid\": " << buffer->fThreadId << "}";
+        }
+      }
+      vOut << "\n  ]\n}\n";
+
+      vOut.precision(precision);
+      vOut.flags(flags);
+    }
+
+    /// the buffer of the calling thread
+    ThreadBuffer& GetThreadBuffer() {
+      thread_local ThreadBuffer* local = nullptr;
+      if (!local) {
+        std::lock_guard lock(fMutex);
+        fBuffers.push_back(std::make_unique<ThreadBuffer>());
+        local = fBuffers.back().get();
+        local->fThreadId = fBuffers.size();
+      }
+      return *local;
+    }
+
+    /// ns since Start()
+    int64_t Now() const {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 std::chrono::steady_clock::now() - fOrigin)
+          .count();
+    }
+
+    void Record(ThreadBuffer& vBuffer, char const* const vName,
+                char const* const vCategory, int64_t const vBegin) {
+      if (vBuffer.fEvents.size() >= fMaxEvents) {
+        ++vBuffer.fNDropped;
+        return;
+      }
+      vBuffer.fEvents.push_back(Event{vName, vCategory, vBegin, Now() - vBegin});
+    }
+
+  private:
+    Tracer() {
+      if (char const* const every = std::getenv("CORSIKA_TRACE_EVERY")) {
+        fEveryNthStep = std::max(1l, std::strtol(every, nullptr, 10));
+      }
+      if (char const* const file = std::getenv("CORSIKA_TRACE_JSON")) {
+        Start(file, fEveryNthStep);
+      }
+    }
+
+    ~Tracer() {
+      try {
+        Stop();
+      } catch (std::exception const&) {
+        // nothing to be done about it at exit
+      }
+    }
+
+    friend class Singleton<Tracer>;
+
+    static void WriteEscaped(std::ostream& vOut, char const* vText) {
+      for (; *vText; ++vText) {
+        if (*vText == '"' || *vText == '\\') { vOut << '\\'; }
+        vOut << *vText;
+      }
+    }
+
+    std::atomic<bool> fEnabled{false};
+    std::string fFilename;
+    unsigned int fEveryNthStep = 1;
+    std::size_t fMaxEvents = 10000000;
+    std::chrono::steady_clock::time_point fOrigin = std::chrono::steady_clock::now();
+    mutable std::mutex fMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> fBuffers;
+  };
+
+  /**
+   * Records the time from construction to destruction as event vName of
+   * category vCategory. Both must be string literals, or otherwise live
+   * until the Tracer is written.
+   *
+   * The name can also be given by a function, which is only called when
+   * the event is recorded, e.g. to build the name of a type. If it
+   * returns nullptr, nothing is recorded.
+   */
+  class TraceScope {
+  public:
+    TraceScope(char const* const vName, char const* const vCategory) {
+      auto& tracer = Tracer::GetInstance();
+      if (tracer.IsEnabled()) { Begin(tracer, vName, vCategory); }
+    }
+
+    TraceScope(char const* (*const vName)(), char const* const vCategory) {
+      auto& tracer = Tracer::GetInstance();
+      if (tracer.IsEnabled()) { Begin(tracer, vName(), vCategory); }
+    }
+
+    ~TraceScope() {
+      if (fBuffer) { Tracer::GetInstance().Record(*fBuffer, fName, fCategory, fBegin); }
+    }
+
+    TraceScope(TraceScope const&) = delete;
+    TraceScope& operator=(TraceScope const&) = delete;
+
+  private:
+    void Begin(Tracer& vTracer, char const* const vName, char const* const vCategory) {
+      if (!vName) { return; }
+      auto& buffer = vTracer.GetThreadBuffer();
+      if (buffer.fSkipping) { return; }
+      fBuffer = &buffer;
+      fName = vName;
+      fCategory = vCategory;
+      fBegin = vTracer.Now();
+    }
+
+    Tracer::ThreadBuffer* fBuffer = nullptr;
+    char const* fName = nullptr;
+    char const* fCategory = nullptr;
+    int64_t fBegin = 0;
+  };
+
+  /**
+   * Like TraceScope, for one step of the cascade: only every N-th step of
+   * a thread is recorded, see Tracer::SetSampling(). Within the other
+   * steps all TraceScope are skipped.
+   */
+  class TraceStep {
+  public:
+    explicit TraceStep(char const* const vName = "Step") {
+      auto& tracer = Tracer::GetInstance();
+      if (!tracer.IsEnabled()) { return; }
+      auto& buffer = tracer.GetThreadBuffer();
+      fBuffer = &buffer;
+      fWasSkipping = buffer.fSkipping;
+      if (buffer.fNSteps++ % tracer.GetSampling() != 0) {
+        buffer.fSkipping = true;
+      } else if (!buffer.fSkipping) {
+        fName = vName;
+        fBegin = tracer.Now();
+      }
+    }
+
+    ~TraceStep() {
+      if (!fBuffer) { return; }
+      fBuffer->fSkipping = fWasSkipping;
+      if (fName) { Tracer::GetInstance().Record(*fBuffer, fName, "step", fBegin); }
+    }
+
+    TraceStep(TraceStep const&) = delete;
+    TraceStep& operator=(TraceStep const&) = delete;
+
+  private:
+    Tracer::ThreadBuffer* fBuffer = nullptr;
+    char const* fName = nullptr;
+    bool fWasSkipping = false;
+    int64_t fBegin = 0;
+  };
+
+} // namespace corsika::utl
+
+#endif
@@ -0,0 +1,67 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+/**
+ * COMBoost: the construction from projectile and target, and the
+ * transformation of a four-momentum to and from the center-of-mass frame.
+ * COMBoost prints diagnostics; std::cout is switched off during the
+ * benchmarks, so that the formatting is not measured, and the results are
+ * printed at the end.
+ */
+
+#include <corsika/geometry/FourVector.h>
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/geometry/Vector.h>
+#include <corsika/testing/Benchmark.h>
+#include <corsika/units/PhysicalUnits.h>
+#include <corsika/utl/COMBoost.h>
+
+#include <iomanip>
+#include <iostream>
+
+using namespace corsika;
+using namespace corsika::geometry;
+using namespace corsika::units::si;
+using corsika::testing::DoNotOptimize;
+using corsika::testing::RunBenchmark;
+using corsika::utl::COMBoost;
+
+int main() {
+  auto const& rootCS = RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+  using MomentumVector = Vector<hepmomentum_d>;
+
+  HEPEnergyType const targetMass = 14 * 0.93827_GeV;
+  FourVector<HEPEnergyType, MomentumVector> const projectile(
+      1e5_GeV, MomentumVector(rootCS, {1_GeV, 2_GeV, 1e5_GeV}));
+  FourVector<HEPEnergyType, MomentumVector> const secondary(
+      10_GeV, MomentumVector(rootCS, {0.1_GeV, 0.2_GeV, 9.9_GeV}));
+
+  std::cout.setstate(std::ios_base::badbit);
+
+  RunBenchmark("COMBoost construction", [&]() {
+    COMBoost const boost(projectile, targetMass);
+    DoNotOptimize(boost.GetRotationMatrix());
+  });
+
+  COMBoost const boost(projectile, targetMass);
+  RunBenchmark("COMBoost::toCoM", [&]() { DoNotOptimize(boost.toCoM(secondary)); });
+
+  auto const secondaryCoM = boost.toCoM(secondary);
+  RunBenchmark("COMBoost::fromCoM",
+               [&]() { DoNotOptimize(boost.fromCoM(secondaryCoM)); });
+
+  std::cout.clear();
+  for (auto const& result : testing::BenchmarkReport::GetInstance().GetResults()) {
+    std::cout << std::left << std::setw(48) << result.fName << std::right
+              << std::setw(14) << std::fixed << std::setprecision(2)
+              << result.fNanoSecondsPerIteration << " ns/iteration  ("
+              << result.fIterations << " iterations)" << std::endl;
+  }
+}
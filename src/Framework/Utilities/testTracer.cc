@@ -0,0 +1,116 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <corsika/utl/Tracer.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace corsika::utl;
+
+namespace {
+  std::size_t Count(std::string const& vText, std::string const& vWhat) {
+    std::size_t n = 0;
+    for (auto pos = vText.find(vWhat); pos != std::string::npos;
+         pos = vText.find(vWhat, pos + 1)) {
+      ++n;
+    }
+    return n;
+  }
+
+  char const* MakeName() { return "made"; }
+  char const* NoName() { return nullptr; }
+} // namespace
+
+TEST_CASE("Tracer") {
+  auto& tracer = Tracer::GetInstance();
+
+  SECTION("disabled") {
+    tracer.Stop();
+    tracer.Clear();
+    { TraceScope const trace("scope", "test"); }
+    { TraceStep const step; }
+    CHECK(tracer.GetNumberOfEvents() == 0);
+  }
+
+  SECTION("scopes") {
+    tracer.Start();
+    {
+      TraceScope const outer("outer", "test");
+      TraceScope const inner(MakeName, "test");
+      TraceScope const none(NoName, "test");
+    }
+    tracer.Stop();
+    CHECK(tracer.GetNumberOfEvents() == 2);
+
+    std::ostringstream out;
+    tracer.Write(out);
+    std::string const json = out.str();
+    CHECK(json.find("\"traceEvents\": [") != std::string::npos);
+    CHECK(Count(json, "\"name\": \"outer\", \"cat\": \"test\", \"ph\": \"X\"") == 1);
+    CHECK(Count(json, "\"name\": \"made\"") == 1);
+    CHECK(Count(json, "\"ph\": \"M\"") >= 1);
+    CHECK(json.substr(json.size() - 6) == "  ]\n}\n");
+  }
+
+  SECTION("sampling of steps") {
+    tracer.Start("", 4);
+    for (int i = 0; i < 10; ++i) {
+      TraceStep const step;
+      TraceScope const inner("inner", "test");
+    }
+    tracer.Stop();
+
+    std::ostringstream out;
+    tracer.Write(out);
+    // steps 0, 4 and 8 with their content
+    CHECK(Count(out.str(), "\"name\": \"Step\"") == 3);
+    CHECK(Count(out.str(), "\"name\": \"inner\"") == 3);
+
+    CHECK_THROWS(tracer.SetSampling(0));
+    tracer.SetSampling(1);
+  }
+
+  SECTION("threads") {
+    tracer.Start();
+    std::thread worker([] { TraceScope const trace("worker", "test"); });
+    worker.join();
+    { TraceScope const trace("main", "test"); }
+    tracer.Stop();
+
+    std::ostringstream out;
+    tracer.Write(out);
+    CHECK(Count(out.str(), "\"name\": \"thread_name\"") >= 2);
+    CHECK(tracer.GetNumberOfEvents() == 2);
+  }
+
+  SECTION("limit") {
+    tracer.Start();
+    tracer.SetMaxEvents(5);
+    for (int i = 0; i < 8; ++i) { TraceScope const trace("scope", "test"); }
+    tracer.Stop();
+    CHECK(tracer.GetNumberOfEvents() == 5);
+    CHECK(tracer.GetNumberOfDroppedEvents() == 3);
+    tracer.SetMaxEvents(10000000);
+  }
+
+  SECTION("escaping") {
+    tracer.Start();
+    { TraceScope const trace("a \"quoted\\ name", "test"); }
+    tracer.Stop();
+
+    std::ostringstream out;
+    tracer.Write(out);
+    CHECK(out.str().find("a \\\"quoted\\\\ name") != std::string::npos);
+  }
+}
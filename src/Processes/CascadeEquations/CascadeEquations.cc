@@ -0,0 +1,300 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#include <corsika/process/cascade_equations/CascadeEquations.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+
+using namespace corsika;
+using namespace corsika::process;
+using namespace corsika::units::si;
+using namespace corsika::particles;
+using namespace corsika::setup;
+
+namespace corsika::process {
+  namespace cascade_equations {
+
+    CascadeEquationsTable::CascadeEquationsTable(vector<Code> const& vCodes,
+                                                 HEPEnergyType const vEmin,
+                                                 double const vRatio,
+                                                 unsigned int const vNBins)
+        : fCodes(vCodes)
+        , fEmin(vEmin)
+        , fRatio(vRatio)
+        , fNBins(vNBins)
+        , fLambda(vCodes.size() * vNBins,
+                  numeric_limits<double>::infinity() * 1_g / (1_cm * 1_cm))
+        , fDeposited(vCodes.size() * vNBins, 0_eV) {
+      if (vCodes.empty() || vNBins < 2 || vRatio <= 1 || vEmin <= 0_eV) {
+        throw runtime_error("CascadeEquationsTable: invalid energy grid");
+      }
+    }
+
+    int CascadeEquationsTable::GetTypeIndex(Code const vCode) const {
+      auto const it = find(fCodes.begin(), fCodes.end(), vCode);
+      return it == fCodes.end() ? -1 : it - fCodes.begin();
+    }
+
+    unsigned int CascadeEquationsTable::GetIndex(Code const vCode,
+                                                 unsigned int const vBin) const {
+      int const type = GetTypeIndex(vCode);
+      if (type < 0 || vBin >= fNBins) {
+        throw runtime_error("CascadeEquationsTable: particle or node not in table");
+      }
+      return type * fNBins + vBin;
+    }
+
+    void CascadeEquationsTable::SetInteractionLength(Code const vCode,
+                                                     unsigned int const vBin,
+                                                     GrammageType const vLambda) {
+      fLambda[GetIndex(vCode, vBin)] = vLambda;
+    }
+
+    GrammageType CascadeEquationsTable::GetInteractionLength(
+        unsigned int const vType, unsigned int const vBin) const {
+      return fLambda[vType * fNBins + vBin];
+    }
+
+    void CascadeEquationsTable::AddSecondary(Code const vProjectile,
+                                             unsigned int const vBin,
+                                             Code const vSecondary,
+                                             HEPEnergyType const vE,
+                                             double const vWeight) {
+      unsigned int const from = GetIndex(vProjectile, vBin);
+      int const type = GetTypeIndex(vSecondary);
+      bool const onGrid = type >= 0 && Distribute(vE, [&](unsigned int k, double w) {
+                            fYields[{from, type * fNBins + k}] += vWeight * w;
+                          });
+      if (!onGrid) { fDeposited[from] += vWeight * vE; }
+    }
+
+    CascadeEquations::CascadeEquations(CascadeEquationsTable const& vTable,
+                                       HEPEnergyType const vThreshold,
+                                       DepthFunction vDepth,
+                                       GrammageType const vMaxDepth,
+                                       unsigned int const vNDepthBins)
+        : fTable(vTable)
+        , fThreshold(vThreshold)
+        , fDepth(std::move(vDepth))
+        , fMaxDepth(vMaxDepth)
+        , fNDepthBins(vNDepthBins) {
+      if (vNDepthBins == 0 || vMaxDepth <= GrammageType::zero()) {
+        throw runtime_error("CascadeEquations: invalid depth grid");
+      }
+      Init();
+    }
+
+    void CascadeEquations::Init() {
+      unsigned int const nTypes = fTable.GetNumberOfTypes();
+      unsigned int const nBins = fTable.GetNumberOfBins();
+      fSource.assign(fNDepthBins * gNSubSteps + 1,
+                     Eigen::VectorXd::Zero(nTypes * nBins + 1));
+      fHasSource = false;
+      fProfile.assign(nTypes, vector<double>(fNDepthBins, 0));
+      fDepositProfile.assign(fNDepthBins, 0_eV);
+      fGround.assign(nTypes, vector<double>(nBins, 0));
+      fNCaptured = 0;
+      fCapturedEnergy = 0_eV;
+    }
+
+    void CascadeEquations::Capture(Code const vCode, HEPEnergyType const vE,
+                                   GrammageType const vX) {
+      int const type = fTable.GetTypeIndex(vCode);
+      if (type < 0) {
+        throw runtime_error("CascadeEquations: particle type not in table");
+      }
+      // shared between the two neighbouring sub-steps, at the mean depth vX
+      unsigned int const nSteps = fNDepthBins * gNSubSteps;
+      double const x = min<double>(max(0., vX / fMaxDepth * nSteps), nSteps);
+      unsigned int const step = x;
+      double const f = x - step;
+      unsigned int const nBins = fTable.GetNumberOfBins();
+      for (auto const& [s, weight] : {make_pair(step, 1 - f), make_pair(step + 1, f)}) {
+        if (weight == 0) { continue; }
+        Eigen::VectorXd& source = fSource[min(s, nSteps)];
+        if (!fTable.Distribute(vE, [&](unsigned int k, double w) {
+              source[type * nBins + k] += weight * w;
+            })) {
+          source[source.size() - 1] += weight * vE / 1_GeV; // below the grid: deposited
+        }
+      }
+      fHasSource = true;
+      ++fNCaptured;
+      fCapturedEnergy += vE;
+    }
+
+    EProcessReturn CascadeEquations::DoSecondaries(StackView& vS) {
+      auto p = vS.begin();
+      while (p != vS.end()) {
+        Code const pid = p.GetPID();
+        HEPEnergyType const energy = p.GetEnergy();
+        if (energy < fThreshold && fTable.GetTypeIndex(pid) >= 0) {
+          Capture(pid, energy, fDepth(p.GetPosition()));
+          p.Delete();
+        } else {
+          ++p; // next entry in SecondaryView
+        }
+      }
+      return EProcessReturn::eOk;
+    }
+
+    void CascadeEquations::BuildPropagator() {
+      unsigned int const nBins = fTable.GetNumberOfBins();
+      unsigned int const n = fTable.GetNumberOfTypes() * nBins;
+      double const dX = fMaxDepth / (fNDepthBins * gNSubSteps) / (1_g / (1_cm * 1_cm));
+
+      // the generator A of the linear system, times the sub-step dX
+      Eigen::MatrixXd a = Eigen::MatrixXd::Zero(n + 1, n + 1);
+      Eigen::VectorXd rate(n); // interactions per particle in dX
+      for (unsigned int j = 0; j < n; ++j) {
+        rate[j] = dX / (fTable.GetInteractionLength(j / nBins, j % nBins) /
+                        (1_g / (1_cm * 1_cm)));
+        a(j, j) = -rate[j];
+        a(n, j) = rate[j] * (fTable.GetDepositedEnergy(j) / 1_GeV);
+      }
+      for (auto const& [fromTo, yield] : fTable.GetYields()) {
+        auto const [from, to] = fromTo;
+        a(to, from) += rate[from] * yield;
+      }
+
+      // scaling and squaring, the norm of the deposit row does not matter
+      double const norm = a.topRows(n).cwiseAbs().colwise().sum().maxCoeff();
+      int const nSquare = norm > 0.5 ? int(ceil(log2(norm / 0.5))) : 0;
+      a /= pow(2., nSquare);
+      Eigen::MatrixXd term = Eigen::MatrixXd::Identity(n + 1, n + 1);
+      fPropagator = term;
+      for (int i = 1; i <= 18; ++i) {
+        term = term * a / double(i);
+        fPropagator += term;
+      }
+      for (int i = 0; i < nSquare; ++i) { fPropagator = fPropagator * fPropagator; }
+      fHasPropagator = true;
+    }
+
+    EProcessReturn CascadeEquations::DoCascadeEquations(Stack&) {
+      if (!fHasSource) { return EProcessReturn::eOk; }
+      if (!fHasPropagator) { BuildPropagator(); }
+
+      unsigned int const nTypes = fTable.GetNumberOfTypes();
+      unsigned int const nBins = fTable.GetNumberOfBins();
+      unsigned int const n = nTypes * nBins;
+
+      Eigen::VectorXd state = Eigen::VectorXd::Zero(n + 1);
+      for (unsigned int bin = 0; bin < fNDepthBins; ++bin) {
+        for (unsigned int step = 0; step < gNSubSteps; ++step) {
+          state += fSource[bin * gNSubSteps + step];
+          state = fPropagator * state;
+        }
+        fDepositProfile[bin] += state[n] * 1_GeV;
+        state[n] = 0;
+        for (unsigned int type = 0; type < nTypes; ++type) {
+          fProfile[type][bin] += state.segment(type * nBins, nBins).sum();
+        }
+      }
+
+      // particles captured beyond the maximum depth go to the ground directly
+      state += fSource.back();
+      fDepositProfile.back() += state[n] * 1_GeV;
+      for (unsigned int type = 0; type < nTypes; ++type) {
+        for (unsigned int k = 0; k < nBins; ++k) {
+          fGround[type][k] += state[type * nBins + k];
+        }
+      }
+
+      for (auto& source : fSource) { source.setZero(); }
+      fHasSource = false;
+      return EProcessReturn::eOk;
+    }
+
+    GrammageType CascadeEquations::GetDepth(unsigned int const vBin) const {
+      return fMaxDepth * (vBin + 1.) / fNDepthBins;
+    }
+
+    vector<double> const& CascadeEquations::GetProfile(Code const vCode) const {
+      int const type = fTable.GetTypeIndex(vCode);
+      if (type < 0) {
+        throw runtime_error("CascadeEquations: particle type not in table");
+      }
+      return fProfile[type];
+    }
+
+    vector<double> const& CascadeEquations::GetGroundSpectrum(Code const vCode) const {
+      int const type = fTable.GetTypeIndex(vCode);
+      if (type < 0) {
+        throw runtime_error("CascadeEquations: particle type not in table");
+      }
+      return fGround[type];
+    }
+
+    HEPEnergyType CascadeEquations::GetDepositedEnergy() const {
+      HEPEnergyType sum = 0_eV;
+      for (auto const e : fDepositProfile) { sum += e; }
+      return sum;
+    }
+
+    HEPEnergyType CascadeEquations::GetGroundEnergy() const {
+      HEPEnergyType sum = 0_eV;
+      for (unsigned int type = 0; type < fGround.size(); ++type) {
+        for (unsigned int k = 0; k < fGround[type].size(); ++k) {
+          sum += fGround[type][k] * fTable.GetEnergy(k);
+        }
+      }
+      return sum;
+    }
+
+    MonteCarloProfile::MonteCarloProfile(CascadeEquations const& vEquations,
+                                         CascadeEquationsTable const& vTable)
+        : fEquations(vEquations)
+        , fTable(vTable) {
+      Init();
+    }
+
+    void MonteCarloProfile::Init() {
+      fProfile.assign(fTable.GetNumberOfTypes(),
+                      vector<double>(fEquations.GetNumberOfDepthBins(), 0));
+    }
+
+    void MonteCarloProfile::Count(unsigned int const vType, GrammageType const vX0,
+                                  GrammageType const vX1) {
+      // GetDepth(bin) is at (bin + 1) / nBins of the maximum depth
+      unsigned int const nBins = fEquations.GetNumberOfDepthBins();
+      GrammageType const maxDepth = fEquations.GetDepth(nBins - 1);
+      auto const crossed = [&](GrammageType const vX) {
+        return min<double>(max(0., floor(vX / maxDepth * nBins)), nBins);
+      };
+      unsigned int const first = crossed(min(vX0, vX1));
+      unsigned int const last = crossed(max(vX0, vX1));
+      for (unsigned int bin = first; bin < last; ++bin) { fProfile[vType][bin] += 1; }
+    }
+
+    vector<double> const& MonteCarloProfile::GetProfile(Code const vCode) const {
+      int const type = fTable.GetTypeIndex(vCode);
+      if (type < 0) {
+        throw runtime_error("MonteCarloProfile: particle type not in table");
+      }
+      return fProfile[type];
+    }
+
+    vector<double> MonteCarloProfile::GetCombinedProfile(Code const vCode) const {
+      vector<double> profile = GetProfile(vCode);
+      auto const& equations = fEquations.GetProfile(vCode);
+      for (unsigned int bin = 0; bin < profile.size(); ++bin) {
+        profile[bin] += equations[bin];
+      }
+      return profile;
+    }
+
+  } // namespace cascade_equations
+} // namespace corsika::process
@@ -0,0 +1,341 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _corsika_process_cascade_equations_CascadeEquations_h_
+#define _corsika_process_cascade_equations_CascadeEquations_h_
+
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/particles/ParticleProperties.h>
+#include <corsika/process/CascadeEquationsProcess.h>
+#include <corsika/process/ContinuousProcess.h>
+#include <corsika/setup/SetupStack.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <Eigen/Dense>
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace corsika::process {
+  namespace cascade_equations {
+
+    /**
+     * The physics input of the cascade equations: for each tracked particle
+     * type and each node of a logarithmic energy grid, E_k = E_min r^k, the
+     * interaction length and the yields of secondaries.
+     *
+     * Secondaries of energy E are shared between the two neighbouring nodes
+     * such that both their number and their energy are conserved. The
+     * energy of secondaries below the grid, or of types that are not
+     * tracked, is counted as deposited.
+     */
+    class CascadeEquationsTable {
+
+    public:
+      /// one secondary produced at a node: (type, energy)
+      using Secondary = std::pair<particles::Code, units::si::HEPEnergyType>;
+
+      CascadeEquationsTable(std::vector<particles::Code> const& vCodes,
+                            units::si::HEPEnergyType vEmin, double vRatio,
+                            unsigned int vNBins);
+
+      unsigned int GetNumberOfTypes() const { return fCodes.size(); }
+      unsigned int GetNumberOfBins() const { return fNBins; }
+      particles::Code GetCode(unsigned int const vType) const { return fCodes[vType]; }
+      /// index of vCode in the table, -1 if it is not tracked
+      int GetTypeIndex(particles::Code) const;
+
+      units::si::HEPEnergyType GetEnergy(unsigned int const vBin) const {
+        return fEmin * std::pow(fRatio, vBin);
+      }
+      units::si::HEPEnergyType GetMaxEnergy() const { return GetEnergy(fNBins - 1); }
+
+      /// infinite by default, i.e. the particle does not interact
+      void SetInteractionLength(particles::Code, unsigned int vBin,
+                                units::si::GrammageType);
+      units::si::GrammageType GetInteractionLength(unsigned int vType,
+                                                   unsigned int vBin) const;
+
+      /// adds vWeight secondaries per interaction of vProjectile at node vBin
+      void AddSecondary(particles::Code vProjectile, unsigned int vBin,
+                        particles::Code vSecondary, units::si::HEPEnergyType vE,
+                        double vWeight = 1);
+
+      /**
+       * Tabulates the yields of vProjectile at node vBin as the average of
+       * vNSamples calls of vModel(vProjectile, E_vBin), which returns a
+       * container of Secondary.
+       */
+      template <typename TModel>
+      void Tabulate(particles::Code const vProjectile, unsigned int const vBin,
+                    unsigned int const vNSamples, TModel&& vModel) {
+        for (unsigned int i = 0; i < vNSamples; ++i) {
+          for (auto const& [code, energy] : vModel(vProjectile, GetEnergy(vBin))) {
+            AddSecondary(vProjectile, vBin, code, energy, 1. / vNSamples);
+          }
+        }
+      }
+
+      /**
+       * Tabulates the interaction lengths and yields of all types at all
+       * nodes from vModel, an InteractionProcess such as
+       * sibyll::Interaction, for projectiles moving down at vPosition in
+       * vEnv. The yields are the average of vNSamples calls of
+       * DoInteraction(). Nodes at which vModel does not interact, i.e.
+       * with infinite interaction length, are left empty. vModel must be
+       * initialised, and the types must not be nuclei.
+       */
+      template <typename TModel, typename TEnvironment>
+      void TabulateInteractions(TModel& vModel, TEnvironment const& vEnv,
+                                geometry::Point const& vPosition,
+                                unsigned int vNSamples);
+
+      /**
+       * Calls vF(node, weight) for the nodes representing a particle of
+       * energy vE. Returns false, without calling vF, below the grid.
+       * Above the grid the weight of the last node is scaled by the energy.
+       */
+      template <typename TFunction>
+      bool Distribute(units::si::HEPEnergyType const vE, TFunction&& vF) const {
+        double const x = std::log(vE / fEmin) / std::log(fRatio);
+        if (!(x >= 0)) { return false; }
+        if (x >= fNBins - 1) {
+          vF(fNBins - 1, vE / GetMaxEnergy());
+          return true;
+        }
+        unsigned int const k = x;
+        auto const e0 = GetEnergy(k);
+        auto const e1 = GetEnergy(k + 1);
+        double const w = (e1 - vE) / (e1 - e0);
+        vF(k, w);
+        if (w < 1) { vF(k + 1, 1 - w); }
+        return true;
+      }
+
+      /// yields (from, to) -> number, with index type * nBins + node
+      std::map<std::pair<unsigned int, unsigned int>, double> const& GetYields() const {
+        return fYields;
+      }
+      /// energy deposited per interaction at index type * nBins + node
+      units::si::HEPEnergyType GetDepositedEnergy(unsigned int const vIndex) const {
+        return fDeposited[vIndex];
+      }
+
+    private:
+      unsigned int GetIndex(particles::Code, unsigned int vBin) const;
+
+      std::vector<particles::Code> const fCodes;
+      units::si::HEPEnergyType const fEmin;
+      double const fRatio;
+      unsigned int const fNBins;
+
+      std::vector<units::si::GrammageType> fLambda;
+      std::map<std::pair<unsigned int, unsigned int>, double> fYields;
+      std::vector<units::si::HEPEnergyType> fDeposited;
+    };
+
+    /**
+     * \class CascadeEquations
+     *
+     * Hybrid simulation: secondaries of the types in the
+     * CascadeEquationsTable with energies below a threshold are removed
+     * from the Monte-Carlo and histogrammed in atmospheric depth and
+     * energy. Each time the Stack has run empty, the cascade equations
+     *
+     *   dN_i(E_k)/dX = -N_i(E_k)/lambda_i(E_k)
+     *                  + sum_j,k' N_j(E_k')/lambda_j(E_k') dN_j->i(E_k' -> E_k)
+     *
+     * are solved for these particles down to the maximum depth, adding to
+     * the longitudinal profiles, the energy deposit and the spectra at the
+     * maximum depth of the Monte-Carlo part.
+     *
+     * The equations are linear with constant coefficients in X, so they
+     * are solved exactly: the propagator exp(A dX / gNSubSteps) over a
+     * fraction of a depth bin is computed once by scaling and squaring,
+     * the solution is then gNSubSteps matrix-vector products per depth
+     * bin. A captured particle starts at the depth where it was captured:
+     * it is shared between the two neighbouring sub-steps such that its
+     * mean starting depth is conserved. Energy is conserved to numerical
+     * precision. Decays and continuous energy losses are not part of the
+     * equations.
+     */
+    class CascadeEquations : public CascadeEquationsProcess<CascadeEquations> {
+
+    public:
+      /// atmospheric depth of a position
+      using DepthFunction =
+          std::function<units::si::GrammageType(geometry::Point const&)>;
+
+      CascadeEquations(CascadeEquationsTable const& vTable,
+                       units::si::HEPEnergyType vThreshold, DepthFunction vDepth,
+                       units::si::GrammageType vMaxDepth, unsigned int vNDepthBins);
+
+      void Init();
+      EProcessReturn DoSecondaries(setup::StackView&);
+      EProcessReturn DoCascadeEquations(setup::Stack&);
+
+      /// atmospheric depth of vPosition
+      units::si::GrammageType GetDepthAt(geometry::Point const& vPosition) const {
+        return fDepth(vPosition);
+      }
+
+      /// takes over a particle of type vCode and energy vE at depth vX
+      void Capture(particles::Code vCode, units::si::HEPEnergyType vE,
+                   units::si::GrammageType vX);
+
+      /// @name results, accumulated over all calls of DoCascadeEquations
+      /// @{
+      unsigned int GetNumberOfDepthBins() const { return fNDepthBins; }
+      /// the depth at the end of bin vBin, where the profiles are taken
+      units::si::GrammageType GetDepth(unsigned int vBin) const;
+      /// number of particles of type vCode at GetDepth(bin)
+      std::vector<double> const& GetProfile(particles::Code vCode) const;
+      /// energy deposited in each depth bin
+      std::vector<units::si::HEPEnergyType> const& GetEnergyDepositProfile() const {
+        return fDepositProfile;
+      }
+      /// number of particles of type vCode at each energy node at max. depth
+      std::vector<double> const& GetGroundSpectrum(particles::Code vCode) const;
+
+      unsigned int GetNumberOfCapturedParticles() const { return fNCaptured; }
+      units::si::HEPEnergyType GetCapturedEnergy() const { return fCapturedEnergy; }
+      units::si::HEPEnergyType GetDepositedEnergy() const;
+      units::si::HEPEnergyType GetGroundEnergy() const;
+      /// @}
+
+    private:
+      /// sub-steps per depth bin, at which captured particles start
+      static unsigned int constexpr gNSubSteps = 8;
+
+      void BuildPropagator();
+
+      CascadeEquationsTable const& fTable;
+      units::si::HEPEnergyType const fThreshold;
+      DepthFunction const fDepth;
+      units::si::GrammageType const fMaxDepth;
+      unsigned int const fNDepthBins;
+
+      Eigen::MatrixXd fPropagator; //!< one sub-step, last row: deposited energy
+      bool fHasPropagator = false;
+      /// captured particles per sub-step, the last one is beyond fMaxDepth
+      std::vector<Eigen::VectorXd> fSource;
+      bool fHasSource = false;
+
+      std::vector<std::vector<double>> fProfile;
+      std::vector<units::si::HEPEnergyType> fDepositProfile;
+      std::vector<std::vector<double>> fGround;
+      unsigned int fNCaptured = 0;
+      units::si::HEPEnergyType fCapturedEnergy;
+    };
+
+    /**
+     * \class MonteCarloProfile
+     *
+     * The Monte-Carlo part of the longitudinal profiles of a hybrid
+     * simulation: counts the particles of the types in the
+     * CascadeEquationsTable, at all energies, whose steps cross the depths
+     * CascadeEquations::GetDepth(bin). GetCombinedProfile() adds the
+     * profile of the cascade equations, i.e. of the captured particles,
+     * for the profile of the whole shower.
+     */
+    class MonteCarloProfile : public ContinuousProcess<MonteCarloProfile> {
+
+    public:
+      MonteCarloProfile(CascadeEquations const& vEquations,
+                        CascadeEquationsTable const& vTable);
+
+      void Init();
+
+      template <typename TParticle, typename TTrack>
+      EProcessReturn DoContinuous(TParticle const& vP, TTrack const& vTrack) {
+        int const type = fTable.GetTypeIndex(vP.GetPID());
+        if (type >= 0) {
+          Count(type, fEquations.GetDepthAt(vTrack.GetPosition(0.)),
+                fEquations.GetDepthAt(vTrack.GetPosition(1.)));
+        }
+        return EProcessReturn::eOk;
+      }
+
+      template <typename TParticle, typename TTrack>
+      units::si::LengthType MaxStepLength(TParticle const&, TTrack const&) const {
+        return units::si::meter * std::numeric_limits<double>::infinity();
+      }
+
+      /// number of Monte-Carlo particles of type vCode at GetDepth(bin)
+      std::vector<double> const& GetProfile(particles::Code vCode) const;
+      /// GetProfile() plus CascadeEquations::GetProfile()
+      std::vector<double> GetCombinedProfile(particles::Code vCode) const;
+
+    private:
+      /// counts a particle of type vType crossing the depths between vX0 and vX1
+      void Count(unsigned int vType, units::si::GrammageType vX0,
+                 units::si::GrammageType vX1);
+
+      CascadeEquations const& fEquations;
+      CascadeEquationsTable const& fTable;
+      std::vector<std::vector<double>> fProfile;
+    };
+
+    template <typename TModel, typename TEnvironment>
+    void CascadeEquationsTable::TabulateInteractions(TModel& vModel,
+                                                     TEnvironment const& vEnv,
+                                                     geometry::Point const& vPosition,
+                                                     unsigned int const vNSamples) {
+      using namespace units::si;
+      auto const* const node = vEnv.GetUniverse()->GetContainingNode(vPosition);
+      auto const& rootCS =
+          geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+
+      setup::Stack stack;
+      for (auto const code : fCodes) {
+        HEPMassType const mass = particles::GetMass(code);
+        for (unsigned int k = 0; k < fNBins; ++k) {
+          HEPEnergyType const energy = GetEnergy(k);
+          if (energy <= mass) { continue; }
+          auto const primary = std::tuple<particles::Code, HEPEnergyType,
+                                             corsika::stack::MomentumVector,
+                                             geometry::Point, TimeType>{
+              code, energy,
+              corsika::stack::MomentumVector(
+                  rootCS, {0_GeV, 0_GeV, -sqrt((energy - mass) * (energy + mass))}),
+              vPosition, 0_ns};
+
+          stack.Clear();
+          auto particle = stack.AddParticle(primary);
+          particle.SetNode(node);
+          GrammageType const lambda = vModel.GetInteractionLength(particle);
+          if (std::isinf(lambda.magnitude())) { continue; }
+          SetInteractionLength(code, k, lambda);
+
+          for (unsigned int i = 0; i < vNSamples; ++i) {
+            stack.Clear();
+            auto p = stack.AddParticle(primary);
+            p.SetNode(node);
+            setup::StackView view(p);
+            auto projectile = view.GetProjectile();
+            vModel.DoInteraction(projectile);
+            for (auto s = view.begin(); s != view.end(); ++s) {
+              AddSecondary(code, k, s.GetPID(), s.GetEnergy(), 1. / vNSamples);
+            }
+          }
+        }
+      }
+    }
+
+  } // namespace cascade_equations
+} // namespace corsika::process
+
+#endif
@@ -0,0 +1,327 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#include <corsika/process/cascade_equations/CascadeEquations.h>
+
+#include <corsika/environment/Environment.h>
+#include <corsika/geometry/Line.h>
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/Trajectory.h>
+#include <corsika/geometry/Vector.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <corsika/setup/SetupStack.h>
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <tuple>
+#include <vector>
+
+using namespace corsika;
+using namespace corsika::process::cascade_equations;
+using namespace corsika::units;
+using namespace corsika::units::si;
+
+/// interaction model splitting every particle into two pions of half the energy
+struct SplitModel {
+  GrammageType GetInteractionLength(setup::Stack::ParticleType const& vP) const {
+    CHECK(vP.GetNode() != nullptr);
+    return vP.GetEnergy() < 1.5_GeV
+               ? std::numeric_limits<double>::infinity() * 1_g / (1_cm * 1_cm)
+               : 100_g / (1_cm * 1_cm);
+  }
+
+  process::EProcessReturn DoInteraction(setup::StackView::ParticleType& vP) {
+    ++fCalls;
+    for (auto const code : {particles::Code::PiPlus, particles::Code::PiMinus}) {
+      vP.AddSecondary(
+          std::tuple<particles::Code, units::si::HEPEnergyType,
+                     corsika::stack::MomentumVector, geometry::Point,
+                     units::si::TimeType>{code, vP.GetEnergy() / 2, vP.GetMomentum() / 2.,
+                                          vP.GetPosition(), vP.GetTime()});
+    }
+    return process::EProcessReturn::eOk;
+  }
+
+  int fCalls = 0;
+};
+
+TEST_CASE("CascadeEquations", "[processes]") {
+
+  auto const gcm2 = 1_g / (1_cm * 1_cm);
+  using Secondaries = std::vector<CascadeEquationsTable::Secondary>;
+
+  SECTION("energy grid") {
+    CascadeEquationsTable table({particles::Code::Proton}, 1_GeV, 10, 4);
+    CHECK(table.GetMaxEnergy() / 1_GeV == Approx(1000));
+    CHECK(table.GetTypeIndex(particles::Code::Proton) == 0);
+    CHECK(table.GetTypeIndex(particles::Code::Electron) == -1);
+
+    // number and energy are conserved
+    for (double const e : {1., 3., 55., 999., 5000.}) {
+      double n = 0, energy = 0;
+      CHECK(table.Distribute(e * 1_GeV, [&](unsigned int k, double w) {
+        n += w;
+        energy += w * table.GetEnergy(k) / 1_GeV;
+      }));
+      CHECK(energy == Approx(e));
+      if (e <= 1000) { CHECK(n == Approx(1)); }
+    }
+    CHECK_FALSE(table.Distribute(0.5_GeV, [](unsigned int, double) {}));
+
+    table.AddSecondary(particles::Code::Proton, 2, particles::Code::Electron, 10_GeV);
+    table.AddSecondary(particles::Code::Proton, 2, particles::Code::Proton, 0.1_GeV);
+    CHECK(table.GetDepositedEnergy(2) / 1_GeV == Approx(10.1));
+    CHECK(table.GetYields().empty());
+
+    CHECK_THROWS(CascadeEquationsTable({particles::Code::Proton}, 1_GeV, 1, 4));
+  }
+
+  // every particle splits into two of half the energy, with constant
+  // interaction length lambda: <N(X)> = sum_n 2^n Poisson(n; X/lambda)
+  SECTION("analytic solution") {
+    unsigned int const nBins = 12;
+    CascadeEquationsTable table({particles::Code::Proton}, 1_GeV, 2, nBins);
+    GrammageType const lambda = 100 * gcm2;
+    for (unsigned int k = 0; k < nBins; ++k) {
+      table.SetInteractionLength(particles::Code::Proton, k, lambda);
+      table.Tabulate(particles::Code::Proton, k, 1, [](particles::Code c, auto e) {
+        return Secondaries{{c, e / 2}, {c, e / 2}};
+      });
+    }
+
+    CascadeEquations ce(
+        table, 1_PeV, [=](geometry::Point const&) { return 0 * gcm2; }, 1000 * gcm2, 50);
+    HEPEnergyType const E0 = 1024_GeV; // node 10
+    ce.Capture(particles::Code::Proton, E0, 0 * gcm2);
+    setup::Stack stack;
+    ce.DoCascadeEquations(stack);
+
+    auto const& profile = ce.GetProfile(particles::Code::Proton);
+    for (unsigned int bin : {0, 4, 9, 19}) {
+      double const t = ce.GetDepth(bin) / lambda;
+      double expected = 0, poisson = std::exp(-t);
+      for (int n = 0; n <= 10; ++n) {
+        expected += std::pow(2, n) * poisson;
+        poisson *= t / (n + 1);
+      }
+      CHECK(profile[bin] == Approx(expected).epsilon(1e-8));
+    }
+    CHECK((ce.GetDepositedEnergy() + ce.GetGroundEnergy()) / E0 ==
+          Approx(1).epsilon(1e-10));
+  }
+
+  SECTION("energy conservation") {
+    unsigned int const nBins = 30;
+    std::vector<particles::Code> const codes{particles::Code::Proton,
+                                             particles::Code::PiPlus};
+    CascadeEquationsTable table(codes, 1_GeV, 1.5, nBins);
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> fraction(0, 1);
+    auto model = [&](particles::Code, HEPEnergyType e) {
+      double const f1 = fraction(rng), f2 = fraction(rng) * (1 - f1);
+      return Secondaries{{particles::Code::Proton, e * f1},
+                         {particles::Code::PiPlus, e * f2},
+                         {particles::Code::Gamma, e * (1 - f1 - f2)}};
+    };
+    for (auto const code : codes) {
+      for (unsigned int k = 0; k < nBins; ++k) {
+        table.SetInteractionLength(code, k, (80 + k) * gcm2);
+        table.Tabulate(code, k, 10, model);
+      }
+    }
+
+    CascadeEquations ce(
+        table, 1_PeV, [=](geometry::Point const&) { return 0 * gcm2; }, 1000 * gcm2, 20);
+    ce.Capture(particles::Code::Proton, 100_TeV, 0 * gcm2);
+    ce.Capture(particles::Code::PiPlus, 1_TeV, 500 * gcm2);
+    ce.Capture(particles::Code::PiPlus, 1_TeV, 5000 * gcm2); // beyond max. depth
+    ce.Capture(particles::Code::PiPlus, 0.5_GeV, 50 * gcm2); // below grid
+    CHECK(ce.GetNumberOfCapturedParticles() == 4);
+
+    setup::Stack stack;
+    ce.DoCascadeEquations(stack);
+    CHECK((ce.GetDepositedEnergy() + ce.GetGroundEnergy()) / ce.GetCapturedEnergy() ==
+          Approx(1).epsilon(1e-10));
+    CHECK(ce.GetGroundSpectrum(particles::Code::PiPlus)[0] >= 0);
+
+    // accumulates over calls, nothing to do without new particles
+    auto const deposit = ce.GetDepositedEnergy();
+    ce.DoCascadeEquations(stack);
+    CHECK(ce.GetDepositedEnergy() == deposit);
+
+    ce.Init();
+    CHECK(ce.GetDepositedEnergy() == 0_GeV);
+    CHECK(ce.GetNumberOfCapturedParticles() == 0);
+  }
+
+  // particles that get absorbed, captured within a depth bin:
+  // N(X) = exp(-(X - X0) / lambda) for X > X0
+  SECTION("capture depth") {
+    CascadeEquationsTable table({particles::Code::Proton}, 1_GeV, 2, 4);
+    GrammageType const lambda = 200 * gcm2;
+    for (unsigned int k = 0; k < 4; ++k) {
+      table.SetInteractionLength(particles::Code::Proton, k, lambda);
+      table.AddSecondary(particles::Code::Proton, k, particles::Code::Gamma,
+                         table.GetEnergy(k));
+    }
+    CascadeEquations ce(
+        table, 1_PeV, [=](geometry::Point const&) { return 0 * gcm2; }, 1000 * gcm2, 10);
+    GrammageType const X0 = 230 * gcm2;
+    ce.Capture(particles::Code::Proton, 4_GeV, X0);
+    setup::Stack stack;
+    ce.DoCascadeEquations(stack);
+
+    auto const& profile = ce.GetProfile(particles::Code::Proton);
+    CHECK(profile[1] == 0);
+    for (unsigned int bin : {2, 3, 9}) {
+      CHECK(profile[bin] ==
+            Approx(std::exp(-(ce.GetDepth(bin) - X0) / lambda)).epsilon(1e-3));
+    }
+    CHECK((ce.GetDepositedEnergy() + ce.GetGroundEnergy()) / 4_GeV ==
+          Approx(1).epsilon(1e-10));
+  }
+
+  SECTION("capture secondaries") {
+    using EnvType = environment::Environment<setup::IEnvironmentModel>;
+    EnvType env;
+    geometry::CoordinateSystem const& rootCS = env.GetCoordinateSystem();
+
+    CascadeEquationsTable table({particles::Code::PiPlus}, 1_GeV, 2, 10);
+    // vertical depth in a homogeneous atmosphere of 1 mg/cm^3
+    auto depth = [&](geometry::Point const& p) {
+      return (10_km - p.GetCoordinates(rootCS).GetZ()) * 1e-3 * 1_g /
+             (1_cm * 1_cm * 1_cm);
+    };
+    CascadeEquations ce(table, 100_GeV, depth, 1000 * gcm2, 10);
+
+    setup::Stack stack;
+    auto particle = stack.AddParticle(
+        std::tuple<particles::Code, units::si::HEPEnergyType,
+                   corsika::stack::MomentumVector, geometry::Point, units::si::TimeType>{
+            particles::Code::Proton, 1_TeV,
+            corsika::stack::MomentumVector(rootCS, {0_GeV, 0_GeV, 0_GeV}),
+            geometry::Point(rootCS, 0_m, 0_m, 5_km), 0_ns});
+    corsika::stack::SecondaryView view(particle);
+    auto projectile = view.GetProjectile();
+    for (auto const& [code, energy] :
+         Secondaries{{particles::Code::PiPlus, 10_GeV},
+                     {particles::Code::PiPlus, 500_GeV},
+                     {particles::Code::PiMinus, 10_GeV},
+                     {particles::Code::PiPlus, 20_GeV}}) {
+      projectile.AddSecondary(
+          std::tuple<particles::Code, units::si::HEPEnergyType,
+                     corsika::stack::MomentumVector, geometry::Point,
+                     units::si::TimeType>{
+              code, energy, corsika::stack::MomentumVector(rootCS, {0_GeV, 0_GeV, 0_GeV}),
+              geometry::Point(rootCS, 0_m, 0_m, 5.5_km), 0_ns});
+    }
+
+    ce.DoSecondaries(view);
+    CHECK(view.GetSize() == 2);
+    CHECK(ce.GetNumberOfCapturedParticles() == 2);
+    CHECK(ce.GetCapturedEnergy() == 30_GeV);
+
+    // no interactions: the pions arrive at the ground unchanged
+    ce.DoCascadeEquations(stack);
+    auto const& profile = ce.GetProfile(particles::Code::PiPlus);
+    CHECK(profile[3] == Approx(0));
+    CHECK(profile[4] == Approx(2));
+    CHECK(ce.GetGroundEnergy() / 1_GeV == Approx(30));
+  }
+
+  SECTION("tabulate interactions") {
+    using EnvType = environment::Environment<setup::IEnvironmentModel>;
+    EnvType env;
+    geometry::Point const origin(env.GetCoordinateSystem(), 0_m, 0_m, 0_m);
+
+    CascadeEquationsTable table({particles::Code::Proton, particles::Code::PiPlus},
+                                1_GeV, 2, 4);
+    SplitModel model;
+    table.TabulateInteractions(model, env, origin, 3);
+    CHECK(model.fCalls == 2 * 3 * 3); // nothing at 1 GeV
+
+    unsigned int const nBins = table.GetNumberOfBins();
+    for (unsigned int type = 0; type < 2; ++type) {
+      CHECK(std::isinf(table.GetInteractionLength(type, 0) / gcm2));
+      for (unsigned int k = 1; k < nBins; ++k) {
+        CHECK(table.GetInteractionLength(type, k) / gcm2 == Approx(100));
+        // the pi+ in the node below, the pi- is deposited
+        unsigned int const from = type * nBins + k;
+        CHECK(table.GetYields().at({from, nBins + k - 1}) == Approx(1));
+        CHECK(table.GetDepositedEnergy(from) / table.GetEnergy(k) == Approx(0.5));
+      }
+    }
+    CHECK(table.GetYields().size() == 2 * 3);
+  }
+
+  SECTION("combined profile") {
+    using EnvType = environment::Environment<setup::IEnvironmentModel>;
+    EnvType env;
+    geometry::CoordinateSystem const& rootCS = env.GetCoordinateSystem();
+
+    CascadeEquationsTable table({particles::Code::PiPlus}, 1_GeV, 2, 10);
+    // vertical depth in a homogeneous atmosphere of 1 mg/cm^3
+    auto depth = [&](geometry::Point const& p) {
+      return (10_km - p.GetCoordinates(rootCS).GetZ()) * 1e-3 * 1_g /
+             (1_cm * 1_cm * 1_cm);
+    };
+    CascadeEquations ce(table, 100_GeV, depth, 1000 * gcm2, 10);
+    MonteCarloProfile mc(ce, table);
+
+    setup::Stack stack;
+    auto particle = [&](particles::Code const vCode) {
+      return stack.AddParticle(
+          std::tuple<particles::Code, units::si::HEPEnergyType,
+                     corsika::stack::MomentumVector, geometry::Point,
+                     units::si::TimeType>{
+              vCode, 1_TeV,
+              corsika::stack::MomentumVector(rootCS, {0_GeV, 0_GeV, -1_TeV}),
+              geometry::Point(rootCS, 0_m, 0_m, 10_km), 0_ns});
+    };
+    auto step = [&](auto& vP, LengthType const vZ0, LengthType const vZ1) {
+      geometry::Point const start(rootCS, 0_m, 0_m, vZ0);
+      geometry::Vector<SpeedType::dimension_type> const velocity(
+          rootCS, 0_m / 1_s, 0_m / 1_s, (vZ1 - vZ0) / 1_s);
+      geometry::Trajectory<geometry::Line> const track(geometry::Line(start, velocity),
+                                                       1_s);
+      mc.DoContinuous(vP, track);
+    };
+
+    // steps from 95 to 250 and from 250 to 305 g/cm^2
+    auto pion = particle(particles::Code::PiPlus);
+    step(pion, 9.05_km, 7.5_km);
+    step(pion, 7.5_km, 6.95_km);
+    auto proton = particle(particles::Code::Proton); // not in the table
+    step(proton, 10_km, 0_km);
+
+    auto const& profile = mc.GetProfile(particles::Code::PiPlus);
+    CHECK(profile[0] == 1);
+    CHECK(profile[1] == 1);
+    CHECK(profile[2] == 1);
+    CHECK(profile[3] == 0);
+
+    // the captured pions at 550 g/cm^2 do not interact
+    ce.Capture(particles::Code::PiPlus, 10_GeV, 550 * gcm2);
+    ce.DoCascadeEquations(stack);
+    auto const combined = mc.GetCombinedProfile(particles::Code::PiPlus);
+    REQUIRE(combined.size() == 10);
+    CHECK(combined[2] == Approx(1));
+    CHECK(combined[4] == Approx(0));
+    CHECK(combined[5] == Approx(1));
+    CHECK(combined[9] == Approx(1));
+
+    mc.Init();
+    CHECK(mc.GetProfile(particles::Code::PiPlus)[0] == 0);
+  }
+}
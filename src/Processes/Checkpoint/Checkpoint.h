@@ -0,0 +1,343 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _Processes_Checkpoint_Checkpoint_h_
+#define _Processes_Checkpoint_Checkpoint_h_
+
+#include <corsika/process/BaseProcess.h>
+#include <corsika/process/StackProcess.h>
+#include <corsika/process/checkpoint/CheckpointFile.h>
+
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/geometry/Vector.h>
+#include <corsika/particles/ParticleProperties.h>
+#include <corsika/random/RNGManager.h>
+#include <corsika/stack/super_stupid/SuperStupidStack.h>
+#include <corsika/units/PhysicalUnits.h>
+#include <corsika/utl/BinaryIO.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace corsika::process::checkpoint {
+
+  /**
+   * StackProcess writing checkpoints of a running cascade, from which the
+   * simulation can be resumed with identical results after a crash or when
+   * a batch job hits its time limit.
+   *
+   * A checkpoint contains the particles on the stack with their volume
+   * nodes, the state of all random-number streams (see
+   * random::RNGManager::SaveState()) and the state of any process added with
+   * AddState(). Particles are stored bit-exactly in the root coordinate
+   * system.
+   *
+   * Since the cascade works on the top of the stack, usually only a few
+   * particles change between two checkpoints. Only the particles above the
+   * lowest modified index are written (a "delta" record) and appended to a
+   * journal, see CheckpointFile. When the deltas have grown larger than the
+   * last full record, the next checkpoint is a full one, replacing the
+   * journal. Particles changed in place are expected at or above the
+   * particle being stepped, as is the case for the Cascade and the
+   * secondaries processes. Other changes below it, e.g. the swaps of
+   * stack::ordered::OrderedStack, are taken from Stack::GetLowWater(). The
+   * Checkpoint must be the last StackProcess of the sequence.
+   *
+   * The internal state of the Fortran interaction models is not saved.
+   */
+  template <typename TStack>
+  class Checkpoint : public corsika::process::StackProcess<Checkpoint<TStack>> {
+
+    using ParticleType = typename TStack::ParticleType;
+    using NodeType = std::remove_cv_t<std::remove_pointer_t<
+        decltype(std::declval<ParticleType const&>().GetNode())>>;
+    using Clock = std::chrono::steady_clock;
+
+    enum class RecordType : uint8_t { eFull = 0, eDelta = 1 };
+
+  public:
+    /**
+     * \param vUniverse root of the volume tree, used to identify the nodes
+     * \param vNSteps number of cascade steps between two checkpoints
+     * \param vAsync write to disk in a background thread
+     */
+    Checkpoint(std::string const& vFilename, NodeType const& vUniverse,
+               unsigned int const vNSteps, bool const vAsync = true)
+        : StackProcess<Checkpoint<TStack>>(1)
+        , fFile(vFilename, vAsync)
+        , fNSteps(vNSteps)
+        , fLastTime(Clock::now()) {
+      if (vNSteps == 0) { throw std::runtime_error("Checkpoint: nSteps must be > 0"); }
+      IndexNodes(vUniverse);
+    }
+
+    void Init() {}
+
+    /**
+     * Register a process (or any other object) whose state is part of the
+     * checkpoint. It needs the methods SaveState(std::ostream&) and
+     * LoadState(std::istream&). The name identifies the state in the file.
+     */
+    template <typename TObject>
+    void AddState(std::string const& vName, TObject& vObject) {
+      fStates.emplace(
+          vName,
+          State{[&vObject](std::ostream& vStream) { vObject.SaveState(vStream); },
+                [&vObject](std::istream& vStream) { vObject.LoadState(vStream); }});
+    }
+
+    /**
+     * Limit the wall-clock overhead of checkpointing to the given fraction:
+     * after a checkpoint that took time T, the next one is written no
+     * earlier than T / vFraction later. 0 disables the limit.
+     */
+    void SetMaxOverhead(double const vFraction) { fMaxOverhead = vFraction; }
+
+    EProcessReturn DoStack(TStack& vStack) {
+      // the particle on top was stepped, everything above may be new
+      if (fLastSize > 0) { fLowWater = std::min(fLowWater, fLastSize - 1); }
+      fLowWater = std::min<std::size_t>(fLowWater, vStack.GetLowWater());
+      vStack.ResetLowWater();
+      fLastSize = vStack.GetSize();
+
+      if (++fStepsSinceLast < fNSteps) { return EProcessReturn::eOk; }
+      if (fMaxOverhead > 0 && Clock::now() - fLastTime < fLastCost / fMaxOverhead) {
+        return EProcessReturn::eOk;
+      }
+      Write(vStack);
+      return EProcessReturn::eOk;
+    }
+
+    /// write a checkpoint now, e.g. on a signal
+    void Write(TStack const& vStack) {
+      auto const start = Clock::now();
+      std::size_t const size = vStack.GetSize();
+      bool const full = fForceFull || fDeltaBytes >= fFullBytes;
+      std::size_t const base =
+          full ? 0 : std::min<std::size_t>({fLowWater, vStack.GetLowWater(), size});
+
+      std::ostringstream payload;
+      utl::WriteBinary(payload, full ? RecordType::eFull : RecordType::eDelta);
+      utl::WriteBinary(payload, uint64_t(base));
+      utl::WriteBinary(payload, uint64_t(size - base));
+      for (auto p = vStack.cbegin() + int(base); p != vStack.cend(); ++p) {
+        WriteParticle(payload, *p);
+      }
+      random::RNGManager::GetInstance().SaveState(payload);
+      utl::WriteBinary(payload, uint64_t(fStates.size()));
+      for (auto const& [name, state] : fStates) {
+        std::ostringstream data;
+        state.fSave(data);
+        utl::WriteBinary(payload, name);
+        utl::WriteBinary(payload, data.str());
+      }
+
+      std::string record = payload.str();
+      if (full) {
+        fFullBytes = record.size();
+        fDeltaBytes = 0;
+        fFile.Replace(std::move(record));
+      } else {
+        fDeltaBytes += record.size();
+        fFile.Append(std::move(record));
+      }
+
+      ++fNCheckpoints;
+      fForceFull = false;
+      fLowWater = size;
+      fLastSize = size;
+      fStepsSinceLast = 0;
+      fLastTime = Clock::now();
+      fLastCost = fLastTime - start;
+      fTotalCost += fLastCost;
+    }
+
+    /**
+     * Restore stack, random-number streams and registered states from the
+     * checkpoint file. The stack is cleared first.
+     *
+     * \return false if there is no checkpoint to restore from
+     * \throws std::runtime_error if the checkpoint is inconsistent
+     */
+    bool Restore(TStack& vStack) {
+      fFile.Flush();
+      auto const records = CheckpointFile::ReadRecords(fFile.GetFilename());
+      if (records.empty()) { return false; }
+
+      std::size_t first = records.size();
+      for (std::size_t i = 0; i < records.size(); ++i) {
+        if (RecordType(records[i][0]) == RecordType::eFull) { first = i; }
+      }
+      if (first == records.size()) {
+        throw std::runtime_error("Checkpoint: no full record in " + fFile.GetFilename());
+      }
+
+      vStack.Clear();
+      std::istringstream lastRecord;
+      for (std::size_t i = first; i < records.size(); ++i) {
+        std::istringstream record(records[i]);
+        utl::ReadBinary<RecordType>(record);
+        auto const base = utl::ReadBinary<uint64_t>(record);
+        auto const n = utl::ReadBinary<uint64_t>(record);
+        if (base > vStack.GetSize()) {
+          throw std::runtime_error("Checkpoint: inconsistent journal");
+        }
+        while (vStack.GetSize() > base) { vStack.DeleteLast(); }
+        for (uint64_t j = 0; j < n; ++j) { ReadParticle(record, vStack); }
+        if (i + 1 == records.size()) { lastRecord = std::move(record); }
+      }
+
+      random::RNGManager::GetInstance().LoadState(lastRecord);
+      auto const nStates = utl::ReadBinary<uint64_t>(lastRecord);
+      for (uint64_t i = 0; i < nStates; ++i) {
+        auto const name = utl::ReadBinary<std::string>(lastRecord);
+        std::istringstream data(utl::ReadBinary<std::string>(lastRecord));
+        if (auto it = fStates.find(name); it != fStates.end()) {
+          it->second.fLoad(data);
+        } else {
+          throw std::runtime_error("Checkpoint: no state registered for " + name);
+        }
+      }
+
+      // the journal may end with a torn record, start a new one
+      fForceFull = true;
+      fLowWater = 0;
+      vStack.ResetLowWater();
+      fLastSize = vStack.GetSize();
+      fStepsSinceLast = 0;
+      return true;
+    }
+
+    /// wait until all checkpoints written so far are on disk
+    void Flush() { fFile.Flush(); }
+
+    unsigned int GetNumberOfCheckpoints() const { return fNCheckpoints; }
+    /// wall-clock time spent in the simulation thread for checkpoints
+    double GetTime() const { return std::chrono::duration<double>(fTotalCost).count(); }
+
+  private:
+    struct State {
+      std::function<void(std::ostream&)> fSave;
+      std::function<void(std::istream&)> fLoad;
+    };
+
+    void IndexNodes(NodeType const& vNode) {
+      fNodeIndex.emplace(&vNode, fNodes.size());
+      fNodes.push_back(&vNode);
+      for (auto const& child : vNode.GetChildNodes()) { IndexNodes(*child); }
+    }
+
+    static void WriteVector(std::ostream& vStream, Eigen::Vector3d const& vVector) {
+      for (int i = 0; i < 3; ++i) { utl::WriteBinary(vStream, vVector[i]); }
+    }
+
+    static Eigen::Vector3d ReadVector(std::istream& vStream) {
+      Eigen::Vector3d vector;
+      for (int i = 0; i < 3; ++i) { vector[i] = utl::ReadBinary<double>(vStream); }
+      return vector;
+    }
+
+    template <typename TParticle>
+    void WriteParticle(std::ostream& vStream, TParticle const& vParticle) const {
+      using utl::WriteBinary;
+      auto const& rootCS = geometry::RootCoordinateSystem::GetInstance()
+                               .GetRootCoordinateSystem();
+      auto const code = vParticle.GetPID();
+      WriteBinary(vStream, code);
+      WriteBinary(vStream, vParticle.GetEnergy().magnitude());
+      WriteVector(vStream, vParticle.GetMomentum().GetComponents(rootCS).eVector);
+      WriteVector(vStream, vParticle.GetPosition().GetCoordinates(rootCS).eVector);
+      WriteBinary(vStream, vParticle.GetTime().magnitude());
+      if (code == particles::Code::Nucleus) {
+        WriteBinary(vStream, uint16_t(vParticle.GetNuclearA()));
+        WriteBinary(vStream, uint16_t(vParticle.GetNuclearZ()));
+      }
+      auto const* node = vParticle.GetNode();
+      WriteBinary(vStream, node ? int32_t(fNodeIndex.at(node)) : int32_t(-1));
+    }
+
+    void ReadParticle(std::istream& vStream, TStack& vStack) const {
+      using namespace corsika::units::si;
+      using phys::units::detail::magnitude_tag;
+      using utl::ReadBinary;
+      auto const& rootCS = geometry::RootCoordinateSystem::GetInstance()
+                               .GetRootCoordinateSystem();
+      auto const code = ReadBinary<particles::Code>(vStream);
+      HEPEnergyType const energy(magnitude_tag, ReadBinary<double>(vStream));
+      stack::MomentumVector const momentum(
+          rootCS, geometry::QuantityVector<hepmomentum_d>(ReadVector(vStream)));
+      geometry::Point const position(
+          rootCS, geometry::QuantityVector<length_d>(ReadVector(vStream)));
+      TimeType const time(magnitude_tag, ReadBinary<double>(vStream));
+
+      auto particle =
+          code == particles::Code::Nucleus
+              ? vStack.AddParticle(
+                    std::tuple<particles::Code, HEPEnergyType, stack::MomentumVector,
+                               geometry::Point, TimeType, unsigned short,
+                               unsigned short>{code, energy, momentum, position, time,
+                                               ReadBinary<uint16_t>(vStream),
+                                               ReadBinary<uint16_t>(vStream)})
+              : vStack.AddParticle(
+                    std::tuple<particles::Code, HEPEnergyType, stack::MomentumVector,
+                               geometry::Point, TimeType>{code, energy, momentum,
+                                                          position, time});
+
+      auto const nodeIndex = ReadBinary<int32_t>(vStream);
+      if (nodeIndex >= int32_t(fNodes.size())) {
+        throw std::runtime_error("Checkpoint: unknown volume node");
+      }
+      particle.SetNode(nodeIndex < 0 ? nullptr : fNodes[nodeIndex]);
+    }
+
+    CheckpointFile fFile;
+    unsigned int const fNSteps;
+    std::map<std::string, State> fStates;
+    std::vector<NodeType const*> fNodes;
+    std::unordered_map<NodeType const*, std::size_t> fNodeIndex;
+
+    std::size_t fLowWater = 0; //!< lowest stack index changed since last checkpoint
+    std::size_t fLastSize = 0; //!< stack size at the previous DoStack()
+    unsigned int fStepsSinceLast = 0;
+    bool fForceFull = true;
+    std::size_t fFullBytes = 0;  //!< size of the last full record
+    std::size_t fDeltaBytes = 0; //!< size of the delta records appended since
+
+    double fMaxOverhead = 0;
+    Clock::time_point fLastTime;
+    Clock::duration fLastCost{0};
+    Clock::duration fTotalCost{0};
+    unsigned int fNCheckpoints = 0;
+  };
+
+} // namespace corsika::process::checkpoint
+
+namespace corsika::process {
+
+  /// records one stack to one file
+  template <typename TStack>
+  struct is_thread_safe<checkpoint::Checkpoint<TStack>> : std::false_type {};
+
+} // namespace corsika::process
+
+#endif
@@ -0,0 +1,217 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#include <corsika/process/checkpoint/CheckpointFile.h>
+#include <corsika/utl/Tracer.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace corsika::process::checkpoint;
+
+namespace {
+
+  uint32_t const kMagic = 0x54504b43; // "CKPT"
+
+  uint64_t Checksum(std::string const& vData) { // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char const c : vData) {
+      hash ^= c;
+      hash *= 0x100000001b3ull;
+    }
+    return hash;
+  }
+
+  void ThrowErrno(std::string const& vWhat) {
+    throw std::runtime_error("CheckpointFile: " + vWhat + ": " + std::strerror(errno));
+  }
+
+  void WriteAll(int const vFd, char const* vData, std::size_t vSize) {
+    while (vSize > 0) {
+      auto const n = ::write(vFd, vData, vSize);
+      if (n < 0) {
+        if (errno == EINTR) { continue; }
+        ThrowErrno("write failed");
+      }
+      vData += n;
+      vSize -= n;
+    }
+  }
+
+  void WriteRecord(int const vFd, std::string const& vPayload) {
+    uint64_t const length = vPayload.size();
+    uint64_t const checksum = Checksum(vPayload);
+    WriteAll(vFd, reinterpret_cast<char const*>(&kMagic), sizeof(kMagic));
+    WriteAll(vFd, reinterpret_cast<char const*>(&length), sizeof(length));
+    WriteAll(vFd, vPayload.data(), vPayload.size());
+    WriteAll(vFd, reinterpret_cast<char const*>(&checksum), sizeof(checksum));
+    if (::fsync(vFd) != 0) { ThrowErrno("fsync failed"); }
+  }
+
+  std::string DirectoryOf(std::string const& vFilename) {
+    auto const slash = vFilename.rfind('/');
+    if (slash == std::string::npos) { return "."; }
+    return slash == 0 ? "/" : vFilename.substr(0, slash);
+  }
+
+} // namespace
+
+CheckpointFile::CheckpointFile(std::string const& vFilename, bool const vAsync)
+    : fFilename(vFilename)
+    , fAsync(vAsync) {
+  if (fAsync) { fWriter = std::thread(&CheckpointFile::WriterLoop, this); }
+}
+
+CheckpointFile::~CheckpointFile() {
+  if (!fAsync) { return; }
+  {
+    std::lock_guard lock(fMutex);
+    fStop = true;
+  }
+  fCondition.notify_all();
+  fWriter.join();
+}
+
+void CheckpointFile::Flush() {
+  corsika::utl::TraceScope const trace("CheckpointFile::Flush", "output");
+  if (fAsync) {
+    std::unique_lock lock(fMutex);
+    fCondition.wait(lock, [this] { return !fHasPending && !fBusy; });
+  }
+  RethrowError();
+}
+
+void CheckpointFile::Submit(std::string vPayload, bool const vReplace) {
+  if (!fAsync) {
+    Write(vPayload, vReplace);
+    return;
+  }
+
+  {
+    std::unique_lock lock(fMutex);
+    fCondition.wait(lock, [this] { return !fHasPending; });
+    fPending = std::move(vPayload);
+    fPendingReplace = vReplace;
+    fHasPending = true;
+  }
+  fCondition.notify_all();
+  RethrowError();
+}
+
+void CheckpointFile::RethrowError() {
+  std::exception_ptr error;
+  {
+    std::lock_guard lock(fMutex);
+    std::swap(error, fError);
+  }
+  if (error) { std::rethrow_exception(error); }
+}
+
+void CheckpointFile::WriterLoop() {
+  std::unique_lock lock(fMutex);
+  while (true) {
+    fCondition.wait(lock, [this] { return fHasPending || fStop; });
+    if (!fHasPending) { return; } // stopped and nothing left to write
+
+    std::string const payload = std::move(fPending);
+    bool const replace = fPendingReplace;
+    fHasPending = false;
+    fBusy = true;
+    lock.unlock();
+    fCondition.notify_all();
+
+    try {
+      Write(payload, replace);
+    } catch (...) {
+      lock.lock();
+      fError = std::current_exception();
+      lock.unlock();
+    }
+
+    lock.lock();
+    fBusy = false;
+    fCondition.notify_all();
+  }
+}
+
+void CheckpointFile::Write(std::string const& vPayload, bool const vReplace) const {
+  corsika::utl::TraceScope const trace("CheckpointFile::Write", "output");
+  if (!vReplace) {
+    int const fd = ::open(fFilename.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) { ThrowErrno("cannot open " + fFilename); }
+    try {
+      WriteRecord(fd, vPayload);
+    } catch (...) {
+      ::close(fd);
+      throw;
+    }
+    ::close(fd);
+    return;
+  }
+
+  std::string const tmpName = fFilename + ".tmp";
+  int const fd = ::open(tmpName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) { ThrowErrno("cannot open " + tmpName); }
+  try {
+    WriteRecord(fd, vPayload);
+  } catch (...) {
+    ::close(fd);
+    throw;
+  }
+  ::close(fd);
+  if (std::rename(tmpName.c_str(), fFilename.c_str()) != 0) {
+    ThrowErrno("cannot rename " + tmpName);
+  }
+
+  // make the rename itself durable
+  int const dirFd = ::open(DirectoryOf(fFilename).c_str(), O_RDONLY);
+  if (dirFd >= 0) {
+    ::fsync(dirFd);
+    ::close(dirFd);
+  }
+}
+
+std::vector<std::string> CheckpointFile::ReadRecords(std::string const& vFilename) {
+  std::vector<std::string> records;
+  std::ifstream file(vFilename, std::ios::binary);
+  if (!file) { return records; }
+
+  while (true) {
+    uint32_t magic;
+    uint64_t length;
+    if (!file.read(reinterpret_cast<char*>(&magic), sizeof(magic)) || magic != kMagic ||
+        !file.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+      break;
+    }
+
+    // do not trust the length of a torn record further than the file goes
+    auto const position = file.tellg();
+    file.seekg(0, std::ios::end);
+    auto const available = uint64_t(file.tellg() - position);
+    file.seekg(position);
+    if (length > available) { break; }
+
+    std::string payload(length, '\0');
+    uint64_t checksum;
+    if (!file.read(payload.data(), length) ||
+        !file.read(reinterpret_cast<char*>(&checksum), sizeof(checksum)) ||
+        checksum != Checksum(payload)) {
+      break;
+    }
+    records.push_back(std::move(payload));
+  }
+  return records;
+}
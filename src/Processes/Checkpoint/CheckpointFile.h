@@ -0,0 +1,84 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _Processes_Checkpoint_CheckpointFile_h_
+#define _Processes_Checkpoint_CheckpointFile_h_
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace corsika::process::checkpoint {
+
+  /**
+   * Journal of checkpoint records on disk.
+   *
+   * Every record is framed by a magic word, its length and a checksum, and
+   * is made durable with fsync before the call returns. Append() adds a
+   * record at the end, Replace() atomically replaces the whole journal by a
+   * single record (write to a temporary file, fsync, rename). A crash while
+   * writing leaves at most a torn record at the end, which ReadRecords()
+   * detects and ignores.
+   *
+   * With vAsync = true the records are written by a background thread, so
+   * the simulation continues while the data go to disk. At most one record
+   * waits in the queue; submitting another one blocks until it is taken.
+   * Errors of the writer are re-thrown by the next call.
+   */
+  class CheckpointFile {
+
+  public:
+    CheckpointFile(std::string const& vFilename, bool vAsync);
+    ~CheckpointFile();
+
+    CheckpointFile(CheckpointFile const&) = delete;
+    CheckpointFile& operator=(CheckpointFile const&) = delete;
+
+    void Append(std::string vPayload) { Submit(std::move(vPayload), false); }
+    void Replace(std::string vPayload) { Submit(std::move(vPayload), true); }
+
+    /// wait until all submitted records are on disk
+    void Flush();
+
+    std::string const& GetFilename() const { return fFilename; }
+
+    /**
+     * all complete records of the journal in the order written, an empty
+     * vector if the file does not exist
+     */
+    static std::vector<std::string> ReadRecords(std::string const& vFilename);
+
+  private:
+    void Submit(std::string vPayload, bool vReplace);
+    void Write(std::string const& vPayload, bool vReplace) const;
+    void WriterLoop();
+    void RethrowError();
+
+    std::string const fFilename;
+    bool const fAsync;
+
+    std::mutex fMutex;
+    std::condition_variable fCondition;
+    std::string fPending;
+    bool fHasPending = false;
+    bool fPendingReplace = false;
+    bool fBusy = false;
+    bool fStop = false;
+    std::exception_ptr fError;
+    std::thread fWriter;
+  };
+
+} // namespace corsika::process::checkpoint
+
+#endif
@@ -0,0 +1,454 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#include <corsika/process/checkpoint/Checkpoint.h>
+
+#include <corsika/cascade/Cascade.h>
+#include <corsika/process/ProcessSequence.h>
+#include <corsika/process/tracking_line/TrackingLine.h>
+
+#include <corsika/environment/Environment.h>
+#include <corsika/environment/HomogeneousMedium.h>
+#include <corsika/environment/NuclearComposition.h>
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/geometry/Sphere.h>
+#include <corsika/geometry/Vector.h>
+#include <corsika/particles/ParticleProperties.h>
+#include <corsika/random/RNGManager.h>
+#include <corsika/setup/SetupEnvironment.h>
+#include <corsika/setup/SetupStack.h>
+#include <corsika/stack/ordered/OrderedStack.h>
+#include <corsika/stack/particle_class/ParticleClassStack.h>
+#include <corsika/units/PhysicalUnits.h>
+#include <corsika/utl/BinaryIO.h>
+
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+using namespace corsika;
+using namespace corsika::geometry;
+using namespace corsika::process;
+using namespace corsika::process::checkpoint;
+using namespace corsika::units::si;
+
+using ParticleTuple = std::tuple<particles::Code, HEPEnergyType, stack::MomentumVector,
+                                 Point, TimeType>;
+
+namespace {
+
+  auto MakeEnvironment() {
+    setup::SetupEnvironment env;
+    auto& universe = *(env.GetUniverse());
+    auto medium = setup::SetupEnvironment::CreateNode<Sphere>(
+        Point{env.GetCoordinateSystem(), 0_m, 0_m, 0_m},
+        1_km * std::numeric_limits<double>::infinity());
+    using MyHomogeneousModel = environment::HomogeneousMedium<environment::IMediumModel>;
+    medium->SetModelProperties<MyHomogeneousModel>(
+        1_g / (1_cm * 1_cm * 1_cm),
+        environment::NuclearComposition(
+            std::vector<particles::Code>{particles::Code::Proton},
+            std::vector<float>{1.}));
+    universe.AddChild(std::move(medium));
+    return env;
+  }
+
+  class Counter {
+  public:
+    int fValue = 0;
+    void SaveState(std::ostream& vStream) const { utl::WriteBinary(vStream, fValue); }
+    void LoadState(std::istream& vStream) { fValue = utl::ReadBinary<int>(vStream); }
+  };
+
+  class ProcessSplit : public InteractionProcess<ProcessSplit> {
+  public:
+    void Init() {}
+
+    template <typename TParticle>
+    GrammageType GetInteractionLength(TParticle const&) const {
+      return 20_g / square(1_cm);
+    }
+
+    template <typename TProjectile>
+    EProcessReturn DoInteraction(TProjectile& vP) {
+      // asymmetric split, such that the result depends on the random numbers
+      auto& rng = random::RNGManager::GetInstance().GetRandomStream("cascade");
+      double const fraction = std::uniform_real_distribution<double>(0.2, 0.8)(rng);
+      HEPEnergyType const E = vP.GetEnergy();
+      vP.AddSecondary(ParticleTuple{vP.GetPID(), E * fraction, vP.GetMomentum(),
+                                    vP.GetPosition(), vP.GetTime()});
+      vP.AddSecondary(ParticleTuple{vP.GetPID(), E * (1 - fraction), vP.GetMomentum(),
+                                    vP.GetPosition(), vP.GetTime()});
+      return EProcessReturn::eInteracted;
+    }
+  };
+
+  // limits the steps, so that particles survive them in place
+  class ProcessStepLimit : public ContinuousProcess<ProcessStepLimit> {
+  public:
+    void Init() {}
+
+    template <typename TParticle, typename TTrack>
+    EProcessReturn DoContinuous(TParticle&, TTrack const&) const {
+      return EProcessReturn::eOk;
+    }
+
+    template <typename TParticle, typename TTrack>
+    LengthType MaxStepLength(TParticle const&, TTrack const&) const {
+      return 10_cm;
+    }
+  };
+
+  class ProcessCut : public SecondariesProcess<ProcessCut> {
+  public:
+    std::vector<double> fCut; //!< time and energy of all removed particles
+
+    void Init() {}
+
+    template <typename TStack>
+    EProcessReturn DoSecondaries(TStack& vS) {
+      auto p = vS.begin();
+      while (p != vS.end()) {
+        if (p.GetEnergy() < 1_GeV) {
+          fCut.push_back(p.GetTime() / 1_ns);
+          fCut.push_back(p.GetEnergy() / 1_GeV);
+          p.Delete();
+        } else {
+          ++p;
+        }
+      }
+      return EProcessReturn::eOk;
+    }
+
+    void SaveState(std::ostream& vStream) const {
+      utl::WriteBinary(vStream, uint64_t(fCut.size()));
+      for (double const v : fCut) { utl::WriteBinary(vStream, v); }
+    }
+    void LoadState(std::istream& vStream) {
+      fCut.resize(utl::ReadBinary<uint64_t>(vStream));
+      for (double& v : fCut) { v = utl::ReadBinary<double>(vStream); }
+    }
+  };
+
+  /// simulates a crash after a given number of steps
+  class ProcessCrash : public StackProcess<ProcessCrash> {
+    int fStepsLeft;
+
+  public:
+    ProcessCrash(int const vSteps)
+        : StackProcess<ProcessCrash>(1)
+        , fStepsLeft(vSteps) {}
+
+    void Init() {}
+
+    template <typename TStack>
+    EProcessReturn DoStack(TStack&) {
+      if (--fStepsLeft == 0) { throw std::runtime_error("crash"); }
+      return EProcessReturn::eOk;
+    }
+  };
+
+  template <typename TStack>
+  void AddPrimary(TStack& vStack) {
+    auto const& rootCS = RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+    vStack.AddParticle(ParticleTuple{
+        particles::Code::Electron, 100_GeV,
+        stack::MomentumVector(rootCS, {0_GeV, 0_GeV, -1_GeV}),
+        Point(rootCS, {0_m, 0_m, 10_km}), 0_ns});
+  }
+
+  /// bit-exact comparison of two stacks
+  template <typename TStack>
+  bool SameParticles(TStack const& vA, TStack const& vB) {
+    if (vA.GetSize() != vB.GetSize()) { return false; }
+    auto const& rootCS = RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+    for (auto a = vA.cbegin(), b = vB.cbegin(); a != vA.cend(); ++a, ++b) {
+      if (a.GetPID() != b.GetPID() || a.GetEnergy() != b.GetEnergy() ||
+          a.GetTime() != b.GetTime() || a.GetNode() != b.GetNode() ||
+          a.GetPosition().GetCoordinates(rootCS).eVector !=
+              b.GetPosition().GetCoordinates(rootCS).eVector) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+} // namespace
+
+TEST_CASE("Checkpoint", "[processes][checkpoint]") {
+
+  auto& rmng = random::RNGManager::GetInstance();
+  rmng.RegisterRandomStream("cascade");
+  rmng.SetDeterministicBuffers(false);
+
+  auto env = MakeEnvironment();
+  auto const& universe = *env.GetUniverse();
+  auto const* medium = universe.GetChildNodes().front().get();
+  auto const& rootCS = RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+
+  std::string const filename = "checkpoint_test.ckpt";
+  std::remove(filename.c_str());
+
+  SECTION("stack round trip") {
+    setup::Stack stack;
+    AddPrimary(stack);
+    stack.AddParticle(
+        std::tuple<particles::Code, HEPEnergyType, corsika::stack::MomentumVector, Point,
+                   TimeType, unsigned short, unsigned short>{
+        particles::Code::Nucleus, 1100_GeV,
+        corsika::stack::MomentumVector(rootCS, {0.1_GeV, 1.0 / 3 * 1_GeV, -700_GeV}),
+        Point(rootCS, {1_m / 7, 2_m, 3_km}), 1_ns / 3, 14, 7});
+    stack.last().SetNode(medium);
+
+    Checkpoint<setup::Stack> checkpoint(filename, universe, 1, GENERATE(false, true));
+    REQUIRE_FALSE(checkpoint.Restore(stack));
+    checkpoint.Write(stack);
+
+    setup::Stack restored;
+    REQUIRE(checkpoint.Restore(restored));
+    REQUIRE(restored.GetSize() == 2);
+    auto const original = stack.cbegin() + 1;
+    auto const copy = restored.cbegin() + 1;
+    CHECK(copy.GetPID() == particles::Code::Nucleus);
+    CHECK(copy.GetNuclearA() == 14);
+    CHECK(copy.GetNuclearZ() == 7);
+    CHECK(copy.GetEnergy() == original.GetEnergy());
+    CHECK(copy.GetTime() == original.GetTime());
+    CHECK(copy.GetMomentum().GetComponents(rootCS).eVector ==
+          original.GetMomentum().GetComponents(rootCS).eVector);
+    CHECK(copy.GetPosition().GetCoordinates(rootCS).eVector ==
+          original.GetPosition().GetCoordinates(rootCS).eVector);
+    CHECK(copy.GetNode() == medium);
+    CHECK(restored.cbegin().GetNode() == nullptr);
+  }
+
+  SECTION("incremental journal") {
+    setup::Stack stack;
+    for (int i = 0; i < 100; ++i) { AddPrimary(stack); }
+    Checkpoint<setup::Stack> checkpoint(filename, universe, 1, false);
+    checkpoint.DoStack(stack); // full
+    REQUIRE(CheckpointFile::ReadRecords(filename).size() == 1);
+
+    // a step: the top particle is replaced by two secondaries
+    stack.DeleteLast();
+    AddPrimary(stack);
+    AddPrimary(stack);
+    checkpoint.DoStack(stack);
+    auto const records = CheckpointFile::ReadRecords(filename);
+    REQUIRE(records.size() == 2);
+    {
+      std::istringstream delta(records[1]);
+      utl::ReadBinary<uint8_t>(delta);
+      CHECK(utl::ReadBinary<uint64_t>(delta) == 99); // first particle written
+      CHECK(utl::ReadBinary<uint64_t>(delta) == 2);  // number of particles
+    }
+
+    SECTION("restore") {
+      setup::Stack restored;
+      REQUIRE(checkpoint.Restore(restored));
+      CHECK(restored.GetSize() == 101);
+    }
+
+    SECTION("torn record is ignored") {
+      { // the beginning of a record, as from a crash during writing
+        std::ifstream in(filename, std::ios::binary);
+        std::string head(32, '\0');
+        in.read(head.data(), head.size());
+        std::ofstream file(filename, std::ios::binary | std::ios::app);
+        file.write(head.data(), head.size());
+      }
+      CHECK(CheckpointFile::ReadRecords(filename).size() == 2);
+      setup::Stack restored;
+      REQUIRE(checkpoint.Restore(restored));
+      CHECK(restored.GetSize() == 101);
+
+      // after a restore a new full record replaces the journal
+      checkpoint.Write(restored);
+      CHECK(CheckpointFile::ReadRecords(filename).size() == 1);
+    }
+  }
+
+  SECTION("random numbers and process states") {
+    setup::Stack stack;
+    Counter counter;
+    Checkpoint<setup::Stack> checkpoint(filename, universe, 1);
+    checkpoint.AddState("counter", counter);
+
+    auto& rng = rmng.GetRandomStream("cascade");
+    auto& buffer = rmng.GetUniformBuffer("cascade");
+    buffer();
+    counter.fValue = 42;
+    checkpoint.Write(stack);
+    std::vector<double> const expected{buffer(), buffer(), double(rng())};
+
+    counter.fValue = 0;
+    rmng.SeedAll(7);
+    REQUIRE(checkpoint.Restore(stack));
+    CHECK(counter.fValue == 42);
+    CHECK(std::vector<double>{buffer(), buffer(), double(rng())} == expected);
+  }
+
+  SECTION("resumed cascade") {
+    using SetupView = setup::StackView;
+    tracking_line::TrackingLine tracking;
+    ProcessSplit split;
+
+    auto run = [&](setup::Stack& vStack, auto& vSequence) {
+      cascade::Cascade<tracking_line::TrackingLine, std::decay_t<decltype(vSequence)>,
+                       setup::Stack, SetupView>
+          EAS(env, tracking, vSequence, vStack);
+      EAS.Init();
+      EAS.Run();
+    };
+
+    // uninterrupted reference
+    ProcessCut refCut;
+    {
+      rmng.SeedAll(1234);
+      setup::Stack stack;
+      AddPrimary(stack);
+      auto sequence = split << refCut;
+      run(stack, sequence);
+    }
+    auto const refRNG = rmng.dumpState().str();
+    REQUIRE(refCut.fCut.size() > 100);
+
+    // crash in the middle of the cascade
+    {
+      rmng.SeedAll(1234);
+      setup::Stack stack;
+      AddPrimary(stack);
+      ProcessCut cut;
+      ProcessCrash crash(150);
+      Checkpoint<setup::Stack> checkpoint(filename, universe, 17);
+      checkpoint.AddState("cut", cut);
+      auto sequence = split << cut << crash << checkpoint;
+      CHECK_THROWS(run(stack, sequence));
+      checkpoint.Flush();
+      REQUIRE(checkpoint.GetNumberOfCheckpoints() > 1);
+    }
+
+    // resume in a "new job"
+    rmng.SeedAll(99);
+    setup::Stack stack;
+    ProcessCut cut;
+    Checkpoint<setup::Stack> checkpoint(filename, universe, 17);
+    checkpoint.AddState("cut", cut);
+    REQUIRE(checkpoint.Restore(stack));
+    REQUIRE_FALSE(stack.IsEmpty());
+    auto sequence = split << cut << checkpoint;
+    run(stack, sequence);
+
+    CHECK(cut.fCut == refCut.fCut);
+    CHECK(rmng.dumpState().str() == refRNG);
+  }
+
+  // the stack order swaps particles from below the top, which must be in
+  // the delta records: the restored stack is the one at the last checkpoint
+  SECTION("ordered stack") {
+    using Stack = stack::ordered::OrderedStack<setup::Stack>;
+    tracking_line::TrackingLine tracking;
+    ProcessSplit split;
+    ProcessCut cut;
+
+    Stack stack;
+    stack.SetOrder(stack::ordered::StackOrder::eLowestEnergyFirst);
+    for (auto const E : {20_GeV, 3_GeV, 8_GeV, 2_GeV, 5_GeV}) {
+      stack.AddParticle(
+          ParticleTuple{particles::Code::Electron, E,
+                        stack::MomentumVector(rootCS, {0_GeV, 0_GeV, -1_GeV}),
+                        Point(rootCS, {0_m, 0_m, 10_km}), 0_ns});
+    }
+    Checkpoint<Stack> checkpoint(filename, universe, 1, false);
+    ProcessCrash crash(GENERATE(3, 8, 13, 30));
+    auto sequence = split << cut << checkpoint << crash;
+    cascade::Cascade<tracking_line::TrackingLine, decltype(sequence), Stack,
+                     setup::StackView>
+        EAS(env, tracking, sequence, stack);
+    EAS.Init();
+    CHECK_THROWS(EAS.Run());
+
+    Stack restored;
+    REQUIRE(checkpoint.Restore(restored));
+    CHECK(SameParticles(restored, stack));
+  }
+
+  // same for the class buckets, which take the particles of one class from
+  // below particles of other classes
+  SECTION("particle class stack") {
+    using Stack = stack::particle_class::ParticleClassStack<setup::Stack>;
+    tracking_line::TrackingLine tracking;
+    ProcessSplit split;
+    ProcessCut cut;
+
+    Stack stack;
+    for (auto const pid : {particles::Code::MuMinus, particles::Code::Electron,
+                           particles::Code::MuPlus, particles::Code::Gamma,
+                           particles::Code::MuMinus}) {
+      stack.AddParticle(
+          ParticleTuple{pid, 10_GeV,
+                        stack::MomentumVector(rootCS, {0_GeV, 0_GeV, -1_GeV}),
+                        Point(rootCS, {0_m, 0_m, 10_km}), 0_ns});
+    }
+    Checkpoint<Stack> checkpoint(filename, universe, 1, false);
+    ProcessCrash crash(GENERATE(3, 17, 18, 40));
+    auto sequence = split << cut << checkpoint << crash;
+    cascade::Cascade<tracking_line::TrackingLine, decltype(sequence), Stack,
+                     setup::StackView>
+        EAS(env, tracking, sequence, stack);
+    EAS.Init();
+    CHECK_THROWS(EAS.Run());
+
+    Stack restored;
+    REQUIRE(checkpoint.Restore(restored));
+    CHECK(SameParticles(restored, stack));
+  }
+
+  // RunBatched changes the batch below the top in place and deletes from it
+  SECTION("batched") {
+    using Stack = stack::particle_class::ParticleClassStack<setup::Stack>;
+    tracking_line::TrackingLine tracking;
+    ProcessStepLimit limit;
+    ProcessSplit split;
+    ProcessCut cut;
+
+    Stack stack;
+    for (auto const pid : {particles::Code::Electron, particles::Code::MuMinus,
+                           particles::Code::Electron, particles::Code::Electron,
+                           particles::Code::MuMinus, particles::Code::MuMinus}) {
+      stack.AddParticle(
+          ParticleTuple{pid, 10_GeV,
+                        stack::MomentumVector(rootCS, {0_GeV, 0_GeV, -1_GeV}),
+                        Point(rootCS, {0_m, 0_m, 10_km}), 0_ns});
+    }
+    Checkpoint<Stack> checkpoint(filename, universe, 1, false);
+    ProcessCrash crash(GENERATE(range(2, 40, 3)));
+    auto sequence = limit << split << cut << checkpoint << crash;
+    cascade::Cascade<tracking_line::TrackingLine, decltype(sequence), Stack,
+                     setup::StackView>
+        EAS(env, tracking, sequence, stack);
+    EAS.Init();
+    CHECK_THROWS(EAS.RunBatched(4));
+
+    Stack restored;
+    REQUIRE(checkpoint.Restore(restored));
+    CHECK(SameParticles(restored, stack));
+  }
+
+  std::remove(filename.c_str());
+}
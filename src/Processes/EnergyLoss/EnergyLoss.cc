@@ -14,6 +14,7 @@
 
 #include <corsika/setup/SetupStack.h>
 #include <corsika/setup/SetupTrajectory.h>
+#include <corsika/utl/BinaryIO.h>
 
 #include <cmath>
 #include <iostream>
@@ -51,14 +52,13 @@ namespace corsika::process::energy_loss {
    * For shell correction, see Sec 6 of https://www.nap.edu/read/20066/chapter/8#115
    *
    */
-  HEPEnergyType EnergyLoss::BetheBloch(SetupParticle const& p, GrammageType const dX) {
-
+  namespace {
     // all these are material constants and have to come through Environment
     // right now: values for nitrogen_D
     // 7 nitrogen_gas 82.0 0.49976 D E 0.0011653 0.0 1.7378 4.1323 0.15349 3.2125 10.54
-    auto Ieff = 82.0_eV;
-    [[maybe_unused]] auto Zmat = 7;
-    auto ZoverA = 0.49976_mol / 1_g;
+    auto const Ieff = 82.0_eV;
+    [[maybe_unused]] auto const Zmat = 7;
+    auto const ZoverA = 0.49976_mol / 1_g;
     const double x0 = 1.7378;
     const double x1 = 4.1323;
     const double Cbar = 10.54;
@@ -69,6 +69,13 @@ namespace corsika::process::energy_loss {
 
     // this is the Bethe-Bloch coefficiet 4pi N_A r_e^2 m_e c^2
     auto constexpr K = 0.307075_MeV / 1_mol * square(1_cm);
+
+    // simple-minded hard-coded value for b(E) inspired by data from
+    // http://pdg.lbl.gov/2018/AtomicNuclearProperties/ for N and O.
+    auto constexpr b = 3.0 * 1e-6 * square(1_cm) / 1_g;
+  } // namespace
+
+  HEPEnergyType EnergyLoss::BetheBloch(SetupParticle const& p, GrammageType const dX) {
     HEPEnergyType const E = p.GetEnergy();
     HEPMassType const m = p.GetMass();
     double const gamma = E / m;
@@ -149,9 +156,6 @@ namespace corsika::process::energy_loss {
   // radiation losses according to PDG 2018, ch. 33 ref. [5]
   HEPEnergyType EnergyLoss::RadiationLosses(SetupParticle const& vP,
                                             GrammageType const vDX) {
-    // simple-minded hard-coded value for b(E) inspired by data from
-    // http://pdg.lbl.gov/2018/AtomicNuclearProperties/ for N and O.
-    auto constexpr b = 3.0 * 1e-6 * square(1_cm) / 1_g;
     return -vP.GetEnergy() * b * vDX;
   }
 
@@ -160,11 +164,49 @@ namespace corsika::process::energy_loss {
     return BetheBloch(vP, vDX) + RadiationLosses(vP, vDX);
   }
 
+  // the same as BetheBloch + RadiationLosses, for arrays of bare magnitudes
+  Eigen::ArrayXd EnergyLoss::TotalEnergyLoss(HEPMassType const vMass, int const vZ,
+                                             Eigen::ArrayXd const& vE,
+                                             Eigen::ArrayXd const& vP,
+                                             Eigen::ArrayXd const& vdX) {
+    double const m = vMass.magnitude();
+    double const me = particles::Electron::GetMass().magnitude();
+    double const I = Ieff.magnitude();
+    int const Z2 = vZ * vZ;
+
+    Eigen::ArrayXd const gamma = vE / m;
+    Eigen::ArrayXd const gamma2 = gamma * gamma;
+    Eigen::ArrayXd const beta2 = (gamma2 - 1) / gamma2;
+    Eigen::ArrayXd const Wmax =
+        2 * me * beta2 * gamma2 / (1 + 2 * me / m * gamma + me * me / (m * m));
+
+    // Sternheimer parameterization, density corrections towards high energies
+    Eigen::ArrayXd const x = (vP / m).log10();
+    Eigen::ArrayXd const delta =
+        (x >= x1).select(2 * log(10) * x - Cbar,
+                         (x >= x0).select(2 * log(10) * x - Cbar +
+                                              aa * (x1 - x).max(0.).pow(sk),
+                                          delta0 * (2 * log(100) * (x - x0)).exp()));
+
+    double const barkas = 1; // does not work yet, see BetheBloch
+    double const alpha = 1. / 137.035999173;
+    Eigen::ArrayXd const y2 = Z2 * alpha * alpha / beta2;
+    Eigen::ArrayXd const bloch =
+        -y2 * (1.202 - y2 * (1.042 - 0.855 * y2 + 0.343 * y2 * y2));
+
+    Eigen::ArrayXd const aux = 2 * me * beta2 * gamma2 * Wmax / (I * I);
+    Eigen::ArrayXd const bethe = -(K * ZoverA).magnitude() * Z2 / beta2 *
+                                 (0.5 * aux.log() - beta2 - delta / 2 + barkas + bloch) *
+                                 vdX;
+    return bethe - vE * b.magnitude() * vdX;
+  }
+
+  template <typename TTrajectory>
   process::EProcessReturn EnergyLoss::DoContinuous(SetupParticle& p,
-                                                   SetupTrack const& t) {
+                                                   TTrajectory const& t) {
     if (p.GetChargeNumber() == 0) return process::EProcessReturn::eOk;
-    GrammageType const dX =
-        p.GetNode()->GetModelProperties().IntegratedGrammage(t, t.GetLength());
+    GrammageType const dX = p.GetNode()->GetModelProperties().IntegratedGrammage(
+        geometry::LinearApproximation(t), t.GetLength());
     cout << "EnergyLoss " << p.GetPID() << ", z=" << p.GetChargeNumber()
          << ", dX=" << dX / 1_g * square(1_cm) << "g/cm2" << endl;
     HEPEnergyType dE = TotalEnergyLoss(p, dX);
@@ -183,12 +225,13 @@ namespace corsika::process::energy_loss {
     p.SetEnergy(Enew);
     MomentumUpdate(p, Enew);
     fEnergyLossTot += dE;
-    GetXbin(p, t, dE);
+    GetXbin(p.GetNode()->GetModelProperties(), t.GetPosition(0), dE);
     return status;
   }
 
+  template <typename TTrajectory>
   LengthType EnergyLoss::MaxStepLength(SetupParticle const& vParticle,
-                                       SetupTrack const& vTrack) const {
+                                       TTrajectory const& vTrack) const {
     if (vParticle.GetChargeNumber() == 0) {
       return units::si::meter * std::numeric_limits<double>::infinity();
     }
@@ -199,11 +242,20 @@ namespace corsika::process::energy_loss {
     auto const maxLoss = 0.01 * vParticle.GetEnergy();
     auto const maxGrammage = maxLoss / dE * dX;
 
-    return vParticle.GetNode()->GetModelProperties().ArclengthFromGrammage(vTrack,
-                                                                           maxGrammage) *
+    return vParticle.GetNode()->GetModelProperties().ArclengthFromGrammage(
+               geometry::LinearApproximation(vTrack), maxGrammage) *
            1.0001; // to make sure particle gets absorbed when DoContinuous() is called
   }
 
+  template process::EProcessReturn EnergyLoss::DoContinuous(SetupParticle&,
+                                                            SetupTrack const&);
+  template process::EProcessReturn EnergyLoss::DoContinuous(
+      SetupParticle&, setup::HelixTrajectory const&);
+  template LengthType EnergyLoss::MaxStepLength(SetupParticle const&,
+                                                SetupTrack const&) const;
+  template LengthType EnergyLoss::MaxStepLength(SetupParticle const&,
+                                                setup::HelixTrajectory const&) const;
+
   void EnergyLoss::MomentumUpdate(corsika::setup::Stack::ParticleType& vP,
                                   corsika::units::si::HEPEnergyType Enew) {
     HEPMomentumType Pnew = elab2plab(Enew, vP.GetMass());
@@ -213,20 +265,19 @@ namespace corsika::process::energy_loss {
 
 #include <corsika/geometry/CoordinateSystem.h>
 
-  int EnergyLoss::GetXbin(SetupParticle const& vP, SetupTrack const& vTrack,
-                          const HEPEnergyType dE) {
+  int EnergyLoss::GetXbin(setup::IEnvironmentModel const& vMedium,
+                          geometry::Point const& vPosition, const HEPEnergyType dE) {
 
     using namespace corsika::geometry;
 
     CoordinateSystem const& rootCS =
         RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
     Point const pos1(rootCS, 0_m, 0_m, 0_m);
-    Point const pos2(rootCS, 0_m, 0_m, vTrack.GetPosition(0).GetCoordinates()[2]);
+    Point const pos2(rootCS, 0_m, 0_m, vPosition.GetCoordinates()[2]);
     auto const delta = (pos2 - pos1) / 1_s;
     Trajectory const t(Line(pos1, delta), 1_s);
 
-    GrammageType const grammage =
-        vP.GetNode()->GetModelProperties().IntegratedGrammage(t, t.GetLength());
+    GrammageType const grammage = vMedium.IntegratedGrammage(t, t.GetLength());
 
     const int bin = grammage / fdX;
 
@@ -245,4 +296,26 @@ namespace corsika::process::energy_loss {
     }
   }
 
+  void EnergyLoss::SaveState(std::ostream& vStream) const {
+    using corsika::utl::WriteBinary;
+    WriteBinary(vStream, fEnergyLossTot.magnitude());
+    WriteBinary(vStream, uint64_t(fProfile.size()));
+    for (auto const& [bin, dE] : fProfile) {
+      WriteBinary(vStream, int32_t(bin));
+      WriteBinary(vStream, dE);
+    }
+  }
+
+  void EnergyLoss::LoadState(std::istream& vStream) {
+    using corsika::utl::ReadBinary;
+    fEnergyLossTot =
+        HEPEnergyType(phys::units::detail::magnitude_tag, ReadBinary<double>(vStream));
+    fProfile.clear();
+    auto const nBins = ReadBinary<uint64_t>(vStream);
+    for (uint64_t i = 0; i < nBins; ++i) {
+      auto const bin = ReadBinary<int32_t>(vStream);
+      fProfile[bin] = ReadBinary<double>(vStream);
+    }
+  }
+
 } // namespace corsika::process::energy_loss
@@ -11,13 +11,22 @@
 #ifndef _Processes_EnergyLoss_h_
 #define _Processes_EnergyLoss_h_
 
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/process/BaseProcess.h>
 #include <corsika/process/ContinuousProcess.h>
 #include <corsika/units/PhysicalUnits.h>
 
+#include <corsika/setup/SetupEnvironment.h>
 #include <corsika/setup/SetupStack.h>
 #include <corsika/setup/SetupTrajectory.h>
 
+#include <Eigen/Core>
+
+#include <algorithm>
+#include <istream>
 #include <map>
+#include <ostream>
 
 namespace corsika::process::energy_loss {
 
@@ -31,13 +40,27 @@ namespace corsika::process::energy_loss {
   public:
     EnergyLoss();
     void Init() {}
+    /// TTrajectory can be setup::Trajectory or setup::HelixTrajectory
+    template <typename TTrajectory>
     process::EProcessReturn DoContinuous(setup::Stack::ParticleType&,
-                                         setup::Trajectory const&);
+                                         TTrajectory const&);
+    template <typename TTrajectory>
     units::si::LengthType MaxStepLength(setup::Stack::ParticleType const&,
-                                        setup::Trajectory const&) const;
+                                        TTrajectory const&) const;
+
+    /// batched DoContinuous and MaxStepLength, see cascade::ParticleBatch
+    template <typename TBatch>
+    void DoContinuousBatch(TBatch&);
+    template <typename TBatch>
+    void MaxStepLengthBatch(TBatch&) const;
 
     units::si::HEPEnergyType GetTotal() const { return fEnergyLossTot; }
     void PrintProfile() const;
+
+    /// total loss and profile, for checkpoint/restart
+    void SaveState(std::ostream&) const;
+    void LoadState(std::istream&);
+
     static units::si::HEPEnergyType BetheBloch(setup::Stack::ParticleType const&,
                                                const units::si::GrammageType);
     static units::si::HEPEnergyType RadiationLosses(setup::Stack::ParticleType const&,
@@ -45,8 +68,18 @@ namespace corsika::process::energy_loss {
     static units::si::HEPEnergyType TotalEnergyLoss(setup::Stack::ParticleType const&,
                                                     const units::si::GrammageType);
 
+    /**
+     * TotalEnergyLoss of many particles of mass vMass and charge number vZ,
+     * with energies vE and momenta vP in eV, over the grammages vdX in
+     * kg/m^2. Returns the (negative) changes of energy in eV.
+     */
+    static Eigen::ArrayXd TotalEnergyLoss(units::si::HEPMassType vMass, int vZ,
+                                          Eigen::ArrayXd const& vE,
+                                          Eigen::ArrayXd const& vP,
+                                          Eigen::ArrayXd const& vdX);
+
   private:
-    int GetXbin(setup::Stack::ParticleType const&, setup::Trajectory const&,
+    int GetXbin(setup::IEnvironmentModel const&, geometry::Point const&,
                 units::si::HEPEnergyType);
 
     units::si::HEPEnergyType fEnergyLossTot;
@@ -54,6 +87,75 @@ namespace corsika::process::energy_loss {
     std::map<int, double> fProfile; // longitudinal profile
   };
 
+  template <typename TBatch>
+  void EnergyLoss::DoContinuousBatch(TBatch& vBatch) {
+    if (vBatch.GetChargeNumber() == 0) { return; }
+    using namespace units::si;
+
+    double const m = vBatch.GetMass().magnitude();
+    auto& E = vBatch.GetEnergy();
+    auto& absorbed = vBatch.GetAbsorbed();
+    Eigen::ArrayXd const P = vBatch.GetMomentumNorm();
+    Eigen::ArrayXd const Ekin = E - m;
+    Eigen::ArrayXd dE = TotalEnergyLoss(vBatch.GetMass(), vBatch.GetChargeNumber(), E,
+                                        P, vBatch.GetGrammage());
+    typename TBatch::Mask const stopped = -dE > Ekin && !absorbed;
+    dE = absorbed.select(0., stopped.select(-Ekin, dE));
+    absorbed = absorbed || stopped;
+
+    E += dE;
+    Eigen::ArrayXd const scale =
+        (P > 0).select(((E - m) * (E + m)).max(0.).sqrt() / P, 0.);
+    vBatch.GetMomentumX() *= scale;
+    vBatch.GetMomentumY() *= scale;
+    vBatch.GetMomentumZ() *= scale;
+    fEnergyLossTot += HEPEnergyType(phys::units::detail::magnitude_tag, dE.sum());
+
+    // longitudinal profile, at the start of the steps
+    auto const& medium = vBatch.GetNode()->GetModelProperties();
+    auto const& rootCS =
+        geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+    for (Eigen::Index i = 0; i < dE.size(); ++i) {
+      if (absorbed[i] && !stopped[i]) { continue; }
+      GetXbin(medium,
+              geometry::Point(rootCS, {vBatch.GetStartX()[i] * meter,
+                                       vBatch.GetStartY()[i] * meter,
+                                       vBatch.GetStartZ()[i] * meter}),
+              HEPEnergyType(phys::units::detail::magnitude_tag, dE[i]));
+    }
+  }
+
+  template <typename TBatch>
+  void EnergyLoss::MaxStepLengthBatch(TBatch& vBatch) const {
+    if (vBatch.GetChargeNumber() == 0) { return; }
+    using namespace units::si;
+
+    auto constexpr dX = 1_g / square(1_cm);
+    auto const& E = vBatch.GetEnergy();
+    Eigen::ArrayXd const dE = -TotalEnergyLoss(
+        vBatch.GetMass(), vBatch.GetChargeNumber(), E, vBatch.GetMomentumNorm(),
+        Eigen::ArrayXd::Constant(E.size(), dX.magnitude())); // dE > 0
+    Eigen::ArrayXd const maxGrammage = 0.01 * E / dE * dX.magnitude();
+
+    auto const& medium = vBatch.GetNode()->GetModelProperties();
+    auto& maxLength = vBatch.GetMaxStepLength();
+    for (Eigen::Index i = 0; i < E.size(); ++i) {
+      LengthType const length = medium.ArclengthFromGrammage(
+          vBatch.GetTrajectory(i),
+          GrammageType(phys::units::detail::magnitude_tag, maxGrammage[i]));
+      // to make sure particle gets absorbed when DoContinuousBatch() is called
+      maxLength[i] = std::min(maxLength[i], length.magnitude() * 1.0001);
+    }
+  }
+
 } // namespace corsika::process::energy_loss
 
+namespace corsika::process {
+
+  /// fills the longitudinal profile of the whole shower
+  template <>
+  struct is_thread_safe<energy_loss::EnergyLoss> : std::false_type {};
+
+} // namespace corsika::process
+
 #endif
@@ -0,0 +1,79 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+/**
+ * EnergyLoss: BetheBloch and TotalEnergyLoss of a muon per call, and the
+ * batched TotalEnergyLoss per particle of a batch of 256 muons. BetheBloch
+ * prints diagnostics; std::cout is switched off during the benchmarks, so
+ * that the formatting is not measured, and the results are printed at the
+ * end.
+ */
+
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/particles/ParticleProperties.h>
+#include <corsika/process/energy_loss/EnergyLoss.h>
+#include <corsika/setup/SetupStack.h>
+#include <corsika/testing/Benchmark.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <Eigen/Core>
+
+#include <iomanip>
+#include <iostream>
+#include <tuple>
+
+using namespace corsika;
+using namespace corsika::units::si;
+using corsika::process::energy_loss::EnergyLoss;
+using corsika::testing::DoNotOptimize;
+using corsika::testing::RunBenchmark;
+
+int main() {
+  auto const& rootCS =
+      geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+  HEPMassType const mass = particles::MuMinus::GetMass();
+  HEPEnergyType const E0 = 10_GeV;
+  HEPMomentumType const P0 = sqrt(E0 * E0 - mass * mass);
+  GrammageType const dX = 10_g / (1_cm * 1_cm);
+
+  setup::Stack stack;
+  auto const muon = stack.AddParticle(
+      std::tuple<particles::Code, HEPEnergyType, stack::MomentumVector, geometry::Point,
+                 TimeType>{particles::Code::MuMinus, E0,
+                           stack::MomentumVector(rootCS, {0_GeV, 0_GeV, -P0}),
+                           geometry::Point(rootCS, 0_m, 0_m, 0_m), 0_ns});
+
+  int const nBatch = 256;
+  Eigen::ArrayXd const energy = Eigen::ArrayXd::LinSpaced(nBatch, 1e9, 1e12);
+  Eigen::ArrayXd const momentum = (energy.square() - std::pow(mass / 1_eV, 2)).sqrt();
+  Eigen::ArrayXd const grammage =
+      Eigen::ArrayXd::Constant(nBatch, dX / (1_kg / 1_m / 1_m));
+
+  std::cout.setstate(std::ios_base::badbit);
+
+  RunBenchmark("EnergyLoss::BetheBloch",
+               [&]() { DoNotOptimize(EnergyLoss::BetheBloch(muon, dX)); });
+  RunBenchmark("EnergyLoss::TotalEnergyLoss",
+               [&]() { DoNotOptimize(EnergyLoss::TotalEnergyLoss(muon, dX)); });
+  RunBenchmark("EnergyLoss::TotalEnergyLoss (batch of 256)", [&]() {
+    Eigen::ArrayXd const dE =
+        EnergyLoss::TotalEnergyLoss(mass, -1, energy, momentum, grammage);
+    DoNotOptimize(dE(0));
+  });
+
+  std::cout.clear();
+  for (auto const& result : testing::BenchmarkReport::GetInstance().GetResults()) {
+    std::cout << std::left << std::setw(48) << result.fName << std::right
+              << std::setw(14) << std::fixed << std::setprecision(2)
+              << result.fNanoSecondsPerIteration << " ns/iteration  ("
+              << result.fIterations << " iterations)" << std::endl;
+  }
+}
@@ -12,6 +12,7 @@
 #define _include_HadronicElasticInteraction_h
 
 #include <corsika/particles/ParticleProperties.h>
+#include <corsika/process/BaseProcess.h>
 #include <corsika/process/InteractionProcess.h>
 #include <corsika/random/RNGManager.h>
 
@@ -64,4 +65,13 @@ namespace corsika::process::HadronicElasticModel {
 
 } // namespace corsika::process::HadronicElasticModel
 
+namespace corsika::process {
+
+  /// draws from a shared RNGManager stream
+  template <>
+  struct is_thread_safe<HadronicElasticModel::HadronicElasticInteraction>
+      : std::false_type {};
+
+} // namespace corsika::process
+
 #endif
@@ -9,42 +9,105 @@
  */
 
 #include <corsika/process/observation_plane/ObservationPlane.h>
+#include <corsika/utl/BinaryIO.h>
+#include <corsika/utl/Tracer.h>
 
+#include <filesystem>
 #include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
 
 using namespace corsika::process::observation_plane;
 using namespace corsika::units::si;
 
 ObservationPlane::ObservationPlane(geometry::Plane const& vObsPlane,
-                                   std::string const& vFilename)
+                                   std::string const& vFilename, bool const vResume)
     : fObsPlane(vObsPlane)
-    , fOutputStream(vFilename) {
-  fOutputStream << "#PDG code, energy / eV, distance to center / m" << std::endl;
+    , fFilename(vFilename)
+    , fOutputStream(vFilename, vResume ? std::ios::app : std::ios::trunc) {
+  if (!vResume) {
+    fOutputStream << "#PDG code, energy / eV, distance to center / m" << std::endl;
+  }
 }
 
+template <typename TTrajectory>
 corsika::process::EProcessReturn ObservationPlane::DoContinuous(
-    setup::Stack::ParticleType const& vParticle, setup::Trajectory const& vTrajectory) {
+    setup::Stack::ParticleType const& vParticle, TTrajectory const& vTrajectory) {
 
   if (fObsPlane.IsAbove(vTrajectory.GetPosition(1.0001))) {
     return process::EProcessReturn::eOk;
   }
 
-  fOutputStream << static_cast<int>(particles::GetPDG(vParticle.GetPID())) << ' '
-                << vParticle.GetEnergy() * (1 / 1_eV) << ' '
-                << (vTrajectory.GetPosition(1) - fObsPlane.GetCenter()).norm() / 1_m
-                << std::endl;
+  Write(vParticle.GetPID(), vParticle.GetEnergy() * (1 / 1_eV),
+        (vTrajectory.GetPosition(1) - fObsPlane.GetCenter()).norm() / 1_m);
 
   return process::EProcessReturn::eParticleAbsorbed;
 }
 
+void ObservationPlane::Write(particles::Code const vCode, double const vEnergy,
+                             double const vDistance) {
+  fOutputStream << static_cast<int>(particles::GetPDG(vCode)) << ' ' << vEnergy << ' '
+                << vDistance << std::endl;
+  ++fCount;
+}
+
+template <typename TTrajectory>
 LengthType ObservationPlane::MaxStepLength(setup::Stack::ParticleType const&,
-                                           setup::Trajectory const& vTrajectory) {
+                                           TTrajectory const& vTrajectory) {
   if (!fObsPlane.IsAbove(vTrajectory.GetR0())) {
     return std::numeric_limits<double>::infinity() * 1_m;
   }
 
-  auto const pointOfIntersection = vTrajectory.GetPosition(
-      (fObsPlane.GetCenter() - vTrajectory.GetR0()).dot(fObsPlane.GetNormal()) /
-      vTrajectory.GetV0().dot(fObsPlane.GetNormal()));
-  return (vTrajectory.GetR0() - pointOfIntersection).norm();
+  auto const& normal = fObsPlane.GetNormal();
+  TimeType tIntersection = (fObsPlane.GetCenter() - vTrajectory.GetR0()).dot(normal) /
+                           vTrajectory.GetV0().dot(normal);
+
+  if constexpr (std::is_same_v<TTrajectory, setup::Trajectory>) {
+    auto const pointOfIntersection = vTrajectory.GetPosition(tIntersection);
+    return (vTrajectory.GetR0() - pointOfIntersection).norm();
+  } else {
+    // the straight-line estimate is refined by Newton iterations along the helix
+    for (int i = 0; i < 4 && tIntersection > 0_s; ++i) {
+      auto const distance =
+          (vTrajectory.GetPosition(tIntersection) - fObsPlane.GetCenter()).dot(normal);
+      tIntersection -= distance / vTrajectory.GetVelocity(tIntersection).dot(normal);
+    }
+    if (!(tIntersection > 0_s)) { return std::numeric_limits<double>::infinity() * 1_m; }
+    return vTrajectory.ArcLength(0_s, tIntersection);
+  }
+}
+
+void ObservationPlane::SaveState(std::ostream& vStream) {
+  {
+    corsika::utl::TraceScope const trace("ObservationPlane::flush", "output");
+    fOutputStream.flush();
+  }
+  corsika::utl::WriteBinary(vStream, fCount);
+  corsika::utl::WriteBinary(vStream, uint64_t(fOutputStream.tellp()));
+}
+
+void ObservationPlane::LoadState(std::istream& vStream) {
+  fCount = corsika::utl::ReadBinary<uint64_t>(vStream);
+  auto const length = corsika::utl::ReadBinary<uint64_t>(vStream);
+
+  fOutputStream.close();
+  if (std::filesystem::file_size(fFilename) < length) {
+    throw std::runtime_error("ObservationPlane: " + fFilename +
+                             " is shorter than at the checkpoint");
+  }
+  std::filesystem::resize_file(fFilename, length);
+  fOutputStream.open(fFilename, std::ios::app);
+  if (!fOutputStream) {
+    throw std::runtime_error("ObservationPlane: cannot reopen " + fFilename);
+  }
 }
+
+template corsika::process::EProcessReturn ObservationPlane::DoContinuous(
+    setup::Stack::ParticleType const&, setup::Trajectory const&);
+template corsika::process::EProcessReturn ObservationPlane::DoContinuous(
+    setup::Stack::ParticleType const&, setup::HelixTrajectory const&);
+template LengthType ObservationPlane::MaxStepLength(setup::Stack::ParticleType const&,
+                                                    setup::Trajectory const&);
+template LengthType ObservationPlane::MaxStepLength(setup::Stack::ParticleType const&,
+                                                    setup::HelixTrajectory const&);
@@ -12,12 +12,23 @@
 #define _Processes_ObservationPlane_h_
 
 #include <corsika/geometry/Plane.h>
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/process/BaseProcess.h>
 #include <corsika/process/ContinuousProcess.h>
 #include <corsika/setup/SetupStack.h>
 #include <corsika/setup/SetupTrajectory.h>
 #include <corsika/units/PhysicalUnits.h>
 
+#include <Eigen/Core>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <string>
 
 namespace corsika::process::observation_plane {
 
@@ -29,21 +40,106 @@ namespace corsika::process::observation_plane {
   class ObservationPlane : public corsika::process::ContinuousProcess<ObservationPlane> {
 
   public:
-    ObservationPlane(geometry::Plane const& vObsPlane, std::string const& vFilename);
+    /**
+     * With vResume the output file is not truncated and no header is
+     * written, for a restart from a checkpoint, see LoadState().
+     */
+    ObservationPlane(geometry::Plane const& vObsPlane, std::string const& vFilename,
+                     bool vResume = false);
     void Init() {}
 
+    /// TTrajectory can be setup::Trajectory or setup::HelixTrajectory
+    template <typename TTrajectory>
     corsika::process::EProcessReturn DoContinuous(
         corsika::setup::Stack::ParticleType const& vParticle,
-        corsika::setup::Trajectory const& vTrajectory);
+        TTrajectory const& vTrajectory);
 
+    template <typename TTrajectory>
     corsika::units::si::LengthType MaxStepLength(
-        corsika::setup::Stack::ParticleType const&,
-        corsika::setup::Trajectory const& vTrajectory);
+        corsika::setup::Stack::ParticleType const&, TTrajectory const& vTrajectory);
+
+    /// batched DoContinuous and MaxStepLength, see cascade::ParticleBatch
+    template <typename TBatch>
+    void DoContinuousBatch(TBatch& vBatch) {
+      auto const& rootCS =
+          geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+      auto const center = fObsPlane.GetCenter().GetCoordinates(rootCS).eVector;
+      auto const normal = fObsPlane.GetNormal().GetComponents(rootCS).eVector;
+      auto const& x = vBatch.GetX();
+      auto const& y = vBatch.GetY();
+      auto const& z = vBatch.GetZ();
+      auto const& x0 = vBatch.GetStartX();
+      auto const& y0 = vBatch.GetStartY();
+      auto const& z0 = vBatch.GetStartZ();
+
+      // slightly beyond the end of the step, like in DoContinuous
+      Eigen::ArrayXd const height =
+          normal(0) * (x0 + 1.0001 * (x - x0) - center(0)) +
+          normal(1) * (y0 + 1.0001 * (y - y0) - center(1)) +
+          normal(2) * (z0 + 1.0001 * (z - z0) - center(2));
+
+      auto& absorbed = vBatch.GetAbsorbed();
+      for (Eigen::Index i = 0; i < height.size(); ++i) {
+        if (absorbed[i] || height[i] > 0) { continue; }
+        Write(vBatch.GetPID(), vBatch.GetEnergy()[i],
+              std::sqrt(std::pow(x[i] - center(0), 2) + std::pow(y[i] - center(1), 2) +
+                        std::pow(z[i] - center(2), 2)));
+        absorbed[i] = true;
+      }
+    }
+
+    template <typename TBatch>
+    void MaxStepLengthBatch(TBatch& vBatch) const {
+      auto const& rootCS =
+          geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+      auto const center = fObsPlane.GetCenter().GetCoordinates(rootCS).eVector;
+      auto const normal = fObsPlane.GetNormal().GetComponents(rootCS).eVector;
+
+      Eigen::ArrayXd const height = normal(0) * (vBatch.GetX() - center(0)) +
+                                    normal(1) * (vBatch.GetY() - center(1)) +
+                                    normal(2) * (vBatch.GetZ() - center(2));
+      Eigen::ArrayXd const pNormal = normal(0) * vBatch.GetMomentumX() +
+                                     normal(1) * vBatch.GetMomentumY() +
+                                     normal(2) * vBatch.GetMomentumZ();
+      Eigen::ArrayXd const length =
+          (height > 0)
+              .select(height * vBatch.GetMomentumNorm() / pNormal.abs(),
+                      std::numeric_limits<double>::infinity());
+      vBatch.GetMaxStepLength() = vBatch.GetMaxStepLength().min(length);
+    }
+
+    /// number of particles written so far
+    uint64_t GetCount() const { return fCount; }
+
+    /**
+     * SaveState() flushes the output file and records its length, LoadState()
+     * truncates the file to that length again, so that particles written after
+     * a checkpoint are not duplicated on restart. On a restart the
+     * ObservationPlane must be constructed with vResume, otherwise the output
+     * up to the checkpoint is lost.
+     *
+     * \throws std::runtime_error if the file is shorter than at SaveState()
+     */
+    void SaveState(std::ostream&);
+    void LoadState(std::istream&);
 
   private:
+    /// one line of output, energy in eV and distance in m
+    void Write(particles::Code, double vEnergy, double vDistance);
+
     geometry::Plane const fObsPlane;
+    std::string const fFilename;
     std::ofstream fOutputStream;
+    uint64_t fCount = 0;
   };
 } // namespace corsika::process::observation_plane
 
+namespace corsika::process {
+
+  /// writes the particles of the whole shower to one file
+  template <>
+  struct is_thread_safe<observation_plane::ObservationPlane> : std::false_type {};
+
+} // namespace corsika::process
+
 #endif
@@ -14,6 +14,8 @@
 
 #include <corsika/process/observation_plane/ObservationPlane.h>
 
+#include <corsika/cascade/ParticleBatch.h>
+
 #include <corsika/geometry/Point.h>
 #include <corsika/geometry/RootCoordinateSystem.h>
 #include <corsika/geometry/Vector.h>
@@ -21,6 +23,11 @@
 #include <corsika/particles/ParticleProperties.h>
 #include <corsika/units/PhysicalUnits.h>
 
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
 using namespace corsika::units::si;
 using namespace corsika::process::observation_plane;
 using namespace corsika;
@@ -81,6 +88,70 @@ TEST_CASE("ContinuousProcess interface", "[proccesses][observation_plane]") {
     */
   }
 
+  SECTION("checkpoint") {
+    Plane const obsPlane(Point(rootCS, {0_m, 0_m, 0_m}),
+                         Vector<dimensionless_d>(rootCS, {0., 0., 1.}));
+    ObservationPlane obs(obsPlane, "particles_checkpoint.dat");
+
+    obs.DoContinuous(particle, track);
+    std::stringstream state;
+    obs.SaveState(state);
+    obs.DoContinuous(particle, track);
+    REQUIRE(obs.GetCount() == 2);
+
+    // particles written after the checkpoint are discarded on restart
+    obs.LoadState(state);
+    CHECK(obs.GetCount() == 1);
+    obs.DoContinuous(particle, track);
+    CHECK(obs.GetCount() == 2);
+
+    std::ifstream file("particles_checkpoint.dat");
+    std::string line;
+    int nLines = 0;
+    while (std::getline(file, line)) { ++nLines; }
+    CHECK(nLines == 3); // header and two particles
+  }
+
+  SECTION("restart from checkpoint") {
+    Plane const obsPlane(Point(rootCS, {0_m, 0_m, 0_m}),
+                         Vector<dimensionless_d>(rootCS, {0., 0., 1.}));
+    auto const readFile = [](std::string const& vFilename) {
+      std::ifstream file(vFilename, std::ios::binary);
+      return std::string(std::istreambuf_iterator<char>(file), {});
+    };
+
+    // uninterrupted run
+    {
+      ObservationPlane obs(obsPlane, "particles_reference.dat");
+      for (int i = 0; i < 3; ++i) { obs.DoContinuous(particle, track); }
+    }
+
+    // interrupted after the checkpoint, and restarted in a new object
+    std::stringstream state;
+    {
+      ObservationPlane obs(obsPlane, "particles_restart.dat");
+      obs.DoContinuous(particle, track);
+      obs.DoContinuous(particle, track);
+      obs.SaveState(state);
+      obs.DoContinuous(particle, track);
+    }
+    {
+      ObservationPlane obs(obsPlane, "particles_restart.dat", true);
+      obs.LoadState(state);
+      CHECK(obs.GetCount() == 2);
+      obs.DoContinuous(particle, track);
+    }
+
+    std::string const reference = readFile("particles_reference.dat");
+    CHECK(reference.size() > 0);
+    CHECK(readFile("particles_restart.dat") == reference);
+
+    // without resume the output of the first run is gone
+    state.seekg(0);
+    ObservationPlane truncated(obsPlane, "particles_restart.dat");
+    CHECK_THROWS(truncated.LoadState(state));
+  }
+
   SECTION("inclined plane") {
     Plane const obsPlane(Point(rootCS, {0_m, 0_m, 0_m}),
                          Vector<dimensionless_d>(rootCS, {1., 1., 0.5}));
@@ -93,4 +164,48 @@ TEST_CASE("ContinuousProcess interface", "[proccesses][observation_plane]") {
 
     SECTION("steplength") { REQUIRE(length == 12_m); }
   }
+
+  SECTION("batched") {
+    Plane const obsPlane(Point(rootCS, {0_m, 0_m, 0_m}),
+                         Vector<dimensionless_d>(rootCS, {1., 1., 0.5}));
+    ObservationPlane obs(obsPlane, "particles_batch.dat");
+    obs.Init();
+
+    cascade::ParticleBatch<setup::Stack> batch(stack);
+    REQUIRE(batch.Gather(1) == 1);
+    obs.MaxStepLengthBatch(batch);
+    // the same as for the straight track starting at the particle
+    CHECK(batch.GetMaxStepLength()[0] ==
+          Approx(obs.MaxStepLength(particle, batch.GetTrajectory(0)) / 1_m));
+
+    // stop half-way: nothing is written
+    batch.Move(batch.GetMaxStepLength() / 2);
+    obs.DoContinuousBatch(batch);
+    CHECK_FALSE(batch.GetAbsorbed()[0]);
+    CHECK(obs.GetCount() == 0);
+
+    batch.Move(batch.GetMaxStepLength());
+    obs.DoContinuousBatch(batch);
+    CHECK(batch.GetAbsorbed()[0]);
+    CHECK(obs.GetCount() == 1);
+  }
+
+  SECTION("curved track") {
+    Plane const obsPlane(Point(rootCS, {0_m, 0_m, 0_m}),
+                         Vector<dimensionless_d>(rootCS, {0., 0., 1.}));
+    ObservationPlane obs(obsPlane, "particles.dat");
+
+    Vector<units::si::SpeedType::dimension_type> const vPar(rootCS, 0_m / second,
+                                                            0_m / second,
+                                                            -0.9 * units::constants::c);
+    Vector<units::si::SpeedType::dimension_type> const vPerp(
+        rootCS, 0.3 * units::constants::c, 0_m / second, 0_m / second);
+    Helix const helix(start, 1e7 / second, vPar, vPerp);
+    Trajectory<Helix> const curvedTrack(helix, 100_m / units::constants::c);
+
+    obs.Init();
+    LengthType const length = obs.MaxStepLength(particle, curvedTrack);
+    REQUIRE(helix.PositionFromArclength(length).GetCoordinates(rootCS)[2] / 1_m ==
+            Approx(0).margin(1e-9));
+  }
 }
@@ -36,84 +36,74 @@ namespace corsika::process {
     }
 
     bool ParticleCut::ParticleIsEmParticle(Code vCode) const {
-      // FOR NOW: switch
-      switch (vCode) {
-        case Code::Gamma:
-        case Code::Electron:
-        case Code::Positron:
-          return true;
-        default:
-          return false;
-      }
+      return particles::IsEM(vCode);
     }
 
     bool ParticleCut::ParticleIsInvisible(Code vCode) const {
-      bool is_inv = false;
-      // FOR NOW: switch
+      // FOR NOW: switch, tau neutrinos are kept
       switch (vCode) {
         case Code::NuE:
-          is_inv = true;
-          break;
         case Code::NuEBar:
-          is_inv = true;
-          break;
         case Code::NuMu:
-          is_inv = true;
-          break;
         case Code::NuMuBar:
-          is_inv = true;
-          break;
         case Code::MuPlus:
-          is_inv = true;
-          break;
         case Code::MuMinus:
-          is_inv = true;
-          break;
-
         case Code::Neutron:
-          is_inv = true;
-          break;
-
         case Code::AntiNeutron:
-          is_inv = true;
-          break;
-
+          return true;
         default:
-          break;
+          return false;
       }
-      return is_inv;
     }
 
-    EProcessReturn ParticleCut::DoSecondaries(corsika::setup::StackView& vS) {
-      auto p = vS.begin();
-      while (p != vS.end()) {
-        const Code pid = p.GetPID();
-        HEPEnergyType energy = p.GetEnergy();
-        cout << "ProcessCut: DoSecondaries: " << pid << " E= " << energy
-             << ", EcutTot=" << (fEmEnergy + fInvEnergy + fEnergy) / 1_GeV << " GeV"
-             << endl;
-        if (ParticleIsEmParticle(pid)) {
-          cout << "removing em. particle..." << endl;
-          fEmEnergy += energy;
-          fEmCount += 1;
-          p.Delete();
-        } else if (ParticleIsInvisible(pid)) {
-          cout << "removing inv. particle..." << endl;
-          fInvEnergy += energy;
-          fInvCount += 1;
-          p.Delete();
-        } else if (ParticleIsBelowEnergyCut(p)) {
-          cout << "removing low en. particle..." << endl;
-          fEnergy += energy;
-          p.Delete();
-        } else if (p.GetTime() > 10_ms) {
-          cout << "removing OLD particle..." << endl;
-          fEnergy += energy;
-          p.Delete();
-        } else {
-          ++p; // next entry in SecondaryView
-        }
+    bool ParticleCut::Reject(Code const vPID, HEPEnergyType const vEnergy,
+                             bool const vBelowCut, TimeType const vTime) {
+      cout << "ProcessCut: DoSecondaries: " << vPID << " E= " << vEnergy
+           << ", EcutTot=" << (fEmEnergy + fInvEnergy + fEnergy) / 1_GeV << " GeV"
+           << endl;
+      if (ParticleIsEmParticle(vPID)) {
+        cout << "removing em. particle..." << endl;
+        fEmEnergy += vEnergy;
+        fEmCount += 1;
+        return true;
+      } else if (ParticleIsInvisible(vPID)) {
+        cout << "removing inv. particle..." << endl;
+        fInvEnergy += vEnergy;
+        fInvCount += 1;
+        return true;
+      } else if (vBelowCut) {
+        cout << "removing low en. particle..." << endl;
+        fEnergy += vEnergy;
+        return true;
+      } else if (vTime > 10_ms) {
+        cout << "removing OLD particle..." << endl;
+        fEnergy += vEnergy;
+        return true;
       }
+      return false;
+    }
+
+    bool ParticleCut::RejectSecondary(Code const vPID, HEPEnergyType const vEnergy,
+                                      TimeType const vTime) {
+      // the energy cut of nuclei is per nucleon, leave them to DoSecondaries
+      if (vPID == Code::Nucleus) { return false; }
+      return Reject(vPID, vEnergy, vEnergy < fECut, vTime);
+    }
+
+    SecondaryFilter ParticleCut::GetSecondaryFilter() {
+      return [this](Code const vPID, HEPEnergyType const vEnergy, TimeType const vTime) {
+        return RejectSecondary(vPID, vEnergy, vTime);
+      };
+    }
+
+    EProcessReturn ParticleCut::DoSecondaries(corsika::setup::StackView& vS) {
+      // keep the order, so the stack is the same as with the SecondaryFilter
+      vS.RemoveIf(
+          [&](auto& p) {
+            return Reject(p.GetPID(), p.GetEnergy(), ParticleIsBelowEnergyCut(p),
+                          p.GetTime());
+          },
+          true);
       return EProcessReturn::eOk;
     }
 
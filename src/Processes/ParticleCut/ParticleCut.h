@@ -13,6 +13,7 @@
 
 #include <corsika/particles/ParticleProperties.h>
 #include <corsika/process/SecondariesProcess.h>
+#include <corsika/process/SecondaryFilter.h>
 #include <corsika/setup/SetupStack.h>
 #include <corsika/units/PhysicalUnits.h>
 
@@ -35,6 +36,16 @@ namespace corsika::process {
       bool ParticleIsInvisible(particles::Code) const;
       EProcessReturn DoSecondaries(corsika::setup::StackView&);
 
+      /**
+       * Applies the cuts of DoSecondaries to a secondary before it is
+       * created, see SecondaryFilter. Rejected particles are accounted
+       * for exactly as in DoSecondaries. Nuclei are never rejected here.
+       */
+      bool RejectSecondary(particles::Code, units::si::HEPEnergyType,
+                           units::si::TimeType);
+      /// RejectSecondary of this ParticleCut, to be passed to the models
+      SecondaryFilter GetSecondaryFilter();
+
       template <typename TParticle>
       bool ParticleIsBelowEnergyCut(TParticle const&) const;
 
@@ -48,6 +59,10 @@ namespace corsika::process {
       units::si::HEPEnergyType GetEmEnergy() const { return fEmEnergy; }
       unsigned int GetNumberEmParticles() const { return fEmCount; }
       unsigned int GetNumberInvParticles() const { return fInvCount; }
+
+    private:
+      bool Reject(particles::Code, units::si::HEPEnergyType, bool vBelowCut,
+                  units::si::TimeType);
     };
   } // namespace particle_cut
 } // namespace corsika::process
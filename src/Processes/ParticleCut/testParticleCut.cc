@@ -76,6 +76,19 @@ TEST_CASE("ParticleCut", "[processes]") {
     REQUIRE(view.GetSize() == 6);
   }
 
+  SECTION("invisible particles") {
+    ParticleCut cut(20_GeV);
+    for (auto const pid :
+         {particles::Code::NuE, particles::Code::NuEBar, particles::Code::NuMu,
+          particles::Code::NuMuBar, particles::Code::MuPlus, particles::Code::MuMinus,
+          particles::Code::Neutron, particles::Code::AntiNeutron}) {
+      CHECK(cut.ParticleIsInvisible(pid));
+    }
+    CHECK_FALSE(cut.ParticleIsInvisible(particles::Code::NuTau));
+    CHECK_FALSE(cut.ParticleIsInvisible(particles::Code::NuTauBar));
+    CHECK_FALSE(cut.ParticleIsInvisible(particles::Code::Proton));
+  }
+
   SECTION("cut low energy") {
     ParticleCut cut(20_GeV);
 
@@ -104,4 +117,41 @@ TEST_CASE("ParticleCut", "[processes]") {
 
     REQUIRE(view.GetSize() == 0);
   }
+
+  SECTION("secondary filter") {
+    ParticleCut cut(20_GeV);
+    ParticleCut filter(20_GeV);
+    auto const reject = filter.GetSecondaryFilter();
+
+    auto particle = stack.AddParticle(
+        std::tuple<particles::Code, units::si::HEPEnergyType,
+                   corsika::stack::MomentumVector, geometry::Point, units::si::TimeType>{
+            particles::Code::Proton, Eabove,
+            corsika::stack::MomentumVector(rootCS, {0_GeV, 0_GeV, 0_GeV}),
+            geometry::Point(rootCS, 0_m, 0_m, 0_m), 0_ns});
+    corsika::stack::SecondaryView view(particle);
+    auto projectile = view.GetProjectile();
+    unsigned int nAccepted = 0;
+    for (auto const E : {Eabove, Ebelow}) {
+      for (auto proType : particleList) {
+        projectile.AddSecondary(
+            std::tuple<particles::Code, units::si::HEPEnergyType,
+                       corsika::stack::MomentumVector, geometry::Point,
+                       units::si::TimeType>{
+                proType, E, corsika::stack::MomentumVector(rootCS, {0_GeV, 0_GeV, 0_GeV}),
+                geometry::Point(rootCS, 0_m, 0_m, 0_m), 0_ns});
+        if (!reject(proType, E, 0_ns)) { ++nAccepted; }
+      }
+    }
+
+    cut.DoSecondaries(view);
+
+    // identical statistics with and without pre-filter
+    REQUIRE(view.GetSize() == nAccepted);
+    CHECK(filter.GetEmEnergy() == cut.GetEmEnergy());
+    CHECK(filter.GetInvEnergy() == cut.GetInvEnergy());
+    CHECK(filter.GetCutEnergy() == cut.GetCutEnergy());
+    CHECK(filter.GetNumberEmParticles() == cut.GetNumberEmParticles());
+    CHECK(filter.GetNumberInvParticles() == cut.GetNumberInvParticles());
+  }
 }
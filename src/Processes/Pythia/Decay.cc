@@ -96,6 +96,7 @@ namespace corsika::process::pythia {
     // coordinate system, get global frame of reference
     geometry::CoordinateSystem& rootCS =
         geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+    auto const xDecay = decayPoint.GetCoordinates(rootCS);
 
     fCount++;
 
@@ -133,16 +134,13 @@ namespace corsika::process::pythia {
         auto const pyId =
             particles::ConvertFromPDG(static_cast<particles::PDGCode>(event[i].id()));
         HEPEnergyType pyEn = event[i].e() * 1_GeV;
-        MomentumVector pyP(rootCS, {event[i].px() * 1_GeV, event[i].py() * 1_GeV,
-                                    event[i].pz() * 1_GeV});
+        geometry::QuantityVector<hepmomentum_d> const pyP{
+            event[i].px() * 1_GeV, event[i].py() * 1_GeV, event[i].pz() * 1_GeV};
 
-        cout << "particle: id=" << pyId << " momentum=" << pyP.GetComponents() / 1_GeV
+        cout << "particle: id=" << pyId << " momentum=" << pyP / 1_GeV
              << " energy=" << pyEn << endl;
 
-        vP.AddSecondary(
-            tuple<particles::Code, units::si::HEPEnergyType,
-                  corsika::stack::MomentumVector, geometry::Point, units::si::TimeType>{
-                pyId, pyEn, pyP, decayPoint, t0});
+        vP.EmplaceSecondary(pyId, pyEn, pyP, xDecay, t0);
       }
 
     // set particle stable
@@ -13,6 +13,7 @@
 
 #include <Pythia8/Pythia.h>
 #include <corsika/particles/ParticleProperties.h>
+#include <corsika/process/BaseProcess.h>
 #include <corsika/process/DecayProcess.h>
 
 namespace corsika::process {
@@ -45,6 +46,10 @@ namespace corsika::process {
     };
 
   } // namespace pythia
+
+  /// Pythia draws from the shared RNGManager stream "pythia"
+  template <>
+  struct is_thread_safe<pythia::Decay> : std::false_type {};
 } // namespace corsika::process
 
 #endif
@@ -281,6 +281,7 @@ namespace corsika::process::pythia {
       // position and time of interaction, not used in Sibyll
       Point pOrig = vP.GetPosition();
       TimeType tOrig = vP.GetTime();
+      auto const xOrig = pOrig.GetCoordinates(rootCS);
 
       // define target
       // FOR NOW: target is always at rest
@@ -391,15 +392,12 @@ namespace corsika::process::pythia {
           auto const pyId =
               particles::ConvertFromPDG(static_cast<particles::PDGCode>(p8p.id()));
 
-          const MomentumVector pyPlab(
-              rootCS, {p8p.px() * 1_GeV, p8p.py() * 1_GeV, p8p.pz() * 1_GeV});
+          geometry::QuantityVector<hepmomentum_d> const pyPlab{
+              p8p.px() * 1_GeV, p8p.py() * 1_GeV, p8p.pz() * 1_GeV};
           HEPEnergyType const pyEn = p8p.e() * 1_GeV;
 
           // add to corsika stack
-          auto pnew = vP.AddSecondary(
-              tuple<particles::Code, units::si::HEPEnergyType, stack::MomentumVector,
-                    geometry::Point, units::si::TimeType>{pyId, pyEn, pyPlab, pOrig,
-                                                          tOrig});
+          auto pnew = vP.EmplaceSecondary(pyId, pyEn, pyPlab, xOrig, tOrig);
 
           Plab_final += pnew.GetMomentum();
           Elab_final += pnew.GetEnergy();
@@ -14,6 +14,7 @@
 #include <Pythia8/Pythia.h>
 
 #include <corsika/particles/ParticleProperties.h>
+#include <corsika/process/BaseProcess.h>
 #include <corsika/process/InteractionProcess.h>
 #include <corsika/random/RNGManager.h>
 #include <corsika/units/PhysicalUnits.h>
@@ -72,4 +73,12 @@ namespace corsika::process::pythia {
 
 } // namespace corsika::process::pythia
 
+namespace corsika::process {
+
+  /// Pythia draws from the shared RNGManager stream "pythia"
+  template <>
+  struct is_thread_safe<pythia::Interaction> : std::false_type {};
+
+} // namespace corsika::process
+
 #endif
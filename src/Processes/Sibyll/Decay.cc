@@ -135,6 +135,9 @@ namespace corsika::process::sibyll {
     // remember position
     Point const decayPoint = vP.GetPosition();
     TimeType const t0 = vP.GetTime();
+    geometry::CoordinateSystem const& rootCS =
+        geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+    auto const xDecay = decayPoint.GetCoordinates(rootCS);
     // remember if particles is unstable
     // auto const priorIsUnstable = IsUnstable(pCode);
     // switch on decay for this particle
@@ -155,12 +158,11 @@ namespace corsika::process::sibyll {
     for (auto& psib : ss) {
       // FOR NOW: skip particles that have decayed in Sibyll, move to iterator?
       if (psib.HasDecayed()) continue;
+      auto const pid = process::sibyll::ConvertFromSibyll(psib.GetPID());
+      if (fSecondaryFilter && fSecondaryFilter(pid, psib.GetEnergy(), t0)) continue;
       // add to corsika stack
-      vP.AddSecondary(
-          tuple<particles::Code, units::si::HEPEnergyType, corsika::stack::MomentumVector,
-                geometry::Point, units::si::TimeType>{
-              process::sibyll::ConvertFromSibyll(psib.GetPID()), psib.GetEnergy(),
-              psib.GetMomentum(), decayPoint, t0});
+      vP.EmplaceSecondary(pid, psib.GetEnergy(),
+                          psib.GetMomentum().GetComponents(rootCS), xDecay, t0);
     }
     // empty sibyll stack
     ss.Clear();
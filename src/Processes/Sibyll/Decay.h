@@ -12,9 +12,12 @@
 #define _include_corsika_process_sibyll_decay_h_
 
 #include <corsika/particles/ParticleProperties.h>
+#include <corsika/process/BaseProcess.h>
 #include <corsika/process/DecayProcess.h>
 #include <corsika/process/SecondariesProcess.h>
+#include <corsika/process/SecondaryFilter.h>
 
+#include <utility>
 #include <vector>
 
 namespace corsika::process {
@@ -42,6 +45,14 @@ namespace corsika::process {
       void PrintDecayConfig(const corsika::particles::Code);
       void SetHadronsUnstable();
 
+      /**
+       Decay products for which vFilter returns true are not written to
+       the stack, see SecondaryFilter.
+     */
+      void SetSecondaryFilter(SecondaryFilter vFilter) {
+        fSecondaryFilter = std::move(vFilter);
+      }
+
       template <typename TParticle>
       corsika::units::si::TimeType GetLifetime(TParticle const&) const;
 
@@ -54,10 +65,17 @@ namespace corsika::process {
 
       template <typename TParticleView>
       EProcessReturn DoSecondaries(TParticleView&);
+
+    private:
+      SecondaryFilter fSecondaryFilter;
     };
 
   } // namespace sibyll
 
+  /// Sibyll keeps its state in Fortran common blocks
+  template <>
+  struct is_thread_safe<sibyll::Decay> : std::false_type {};
+
 } // namespace corsika::process
 
 #endif
@@ -19,7 +19,9 @@
 #include <corsika/setup/SetupStack.h>
 #include <corsika/setup/SetupTrajectory.h>
 #include <corsika/utl/COMBoost.h>
+#include <corsika/utl/StepArena.h>
 
+#include <memory_resource>
 #include <tuple>
 
 using std::cout;
@@ -211,6 +213,7 @@ namespace corsika::process::sibyll {
       // position and time of interaction, not used in Sibyll
       Point pOrig = vP.GetPosition();
       TimeType tOrig = vP.GetTime();
+      auto const xOrig = pOrig.GetCoordinates(rootCS);
 
       // define target
       // for Sibyll is always a single nucleon
@@ -271,7 +274,8 @@ namespace corsika::process::sibyll {
        */
       //#warning reading interaction cross section again, should not be necessary
       auto const& compVec = mediumComposition.GetComponents();
-      std::vector<si::CrossSectionType> cross_section_of_components(compVec.size());
+      std::pmr::vector<si::CrossSectionType> cross_section_of_components(
+          compVec.size(), utl::GetStepResource());
 
       for (size_t i = 0; i < compVec.size(); ++i) {
         auto const targetId = compVec[i];
@@ -347,18 +351,19 @@ namespace corsika::process::sibyll {
           auto const pCoM = psib.GetMomentum();
           HEPEnergyType const eCoM = psib.GetEnergy();
           auto const Plab = boost.fromCoM(FourVector(eCoM, pCoM));
+          HEPEnergyType const Elab = Plab.GetTimeLikeComponent();
 
-          // add to corsika stack
-          auto pnew = vP.AddSecondary(
-              tuple<particles::Code, units::si::HEPEnergyType, stack::MomentumVector,
-                    geometry::Point, units::si::TimeType>{
-                  process::sibyll::ConvertFromSibyll(psib.GetPID()),
-                  Plab.GetTimeLikeComponent(), Plab.GetSpaceLikeComponents(), pOrig,
-                  tOrig});
-
-          Plab_final += pnew.GetMomentum();
-          Elab_final += pnew.GetEnergy();
+          Plab_final += Plab.GetSpaceLikeComponents();
+          Elab_final += Elab;
           Ecm_final += psib.GetEnergy();
+
+          particles::Code const pid = process::sibyll::ConvertFromSibyll(psib.GetPID());
+          if (fSecondaryFilter && fSecondaryFilter(pid, Elab, tOrig)) continue;
+
+          // add to corsika stack
+          vP.EmplaceSecondary(pid, Elab,
+                              Plab.GetSpaceLikeComponents().GetComponents(rootCS),
+                              xOrig, tOrig);
         }
         cout << "conservation (all GeV): Ecm_final=" << Ecm_final / 1_GeV << endl
              << "Elab_final=" << Elab_final / 1_GeV
@@ -12,10 +12,13 @@
 #define _corsika_process_sibyll_interaction_h_
 
 #include <corsika/particles/ParticleProperties.h>
+#include <corsika/process/BaseProcess.h>
 #include <corsika/process/InteractionProcess.h>
+#include <corsika/process/SecondaryFilter.h>
 #include <corsika/random/RNGManager.h>
 #include <corsika/units/PhysicalUnits.h>
 #include <tuple>
+#include <utility>
 
 namespace corsika::process::sibyll {
 
@@ -39,6 +42,14 @@ namespace corsika::process::sibyll {
     void SetAllUnstable();
     void SetAllStable();
 
+    /**
+       Secondaries for which vFilter returns true are not written to
+       the stack, see SecondaryFilter.
+     */
+    void SetSecondaryFilter(SecondaryFilter vFilter) {
+      fSecondaryFilter = std::move(vFilter);
+    }
+
     bool WasInitialized() { return fInitialized; }
     bool IsValidCoMEnergy(corsika::units::si::HEPEnergyType ecm) const {
       return (fMinEnergyCoM <= ecm) && (ecm <= fMaxEnergyCoM);
@@ -87,8 +98,17 @@ namespace corsika::process::sibyll {
     const corsika::units::si::HEPEnergyType fMaxEnergyCoM =
         1.e6 * 1e9 * corsika::units::si::electronvolt;
     const int fMaxTargetMassNumber = 18;
+    SecondaryFilter fSecondaryFilter;
   };
 
 } // namespace corsika::process::sibyll
 
+namespace corsika::process {
+
+  /// Sibyll keeps its state in Fortran common blocks
+  template <>
+  struct is_thread_safe<sibyll::Interaction> : std::false_type {};
+
+} // namespace corsika::process
+
 #endif
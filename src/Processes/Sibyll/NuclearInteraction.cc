@@ -17,10 +17,12 @@
 #include <corsika/process/sibyll/nuclib.h>
 #include <corsika/units/PhysicalUnits.h>
 #include <corsika/utl/COMBoost.h>
+#include <corsika/utl/StepArena.h>
 
 #include <corsika/setup/SetupStack.h>
 #include <corsika/setup/SetupTrajectory.h>
 
+#include <memory_resource>
 #include <set>
 
 using std::cout;
@@ -355,6 +357,7 @@ namespace corsika::process::sibyll {
     // position and time of interaction, not used in NUCLIB
     Point pOrig = vP.GetPosition();
     TimeType tOrig = vP.GetTime();
+    auto const xOrig = pOrig.GetCoordinates(rootCS);
 
     cout << "Interaction: position of interaction: " << pOrig.GetCoordinates() << endl;
     cout << "Interaction: time: " << tOrig << endl;
@@ -439,7 +442,8 @@ namespace corsika::process::sibyll {
       should be passed from GetInteractionLength if possible
     */
     auto const& compVec = mediumComposition.GetComponents();
-    vector<si::CrossSectionType> cross_section_of_components(compVec.size());
+    std::pmr::vector<si::CrossSectionType> cross_section_of_components(
+        compVec.size(), utl::GetStepResource());
 
     for (size_t i = 0; i < compVec.size(); ++i) {
       auto const targetId = compVec[i];
@@ -553,18 +557,14 @@ namespace corsika::process::sibyll {
 
       if (nuclA == 1)
         // add nucleon
-        vP.AddSecondary(
-            tuple<particles::Code, units::si::HEPEnergyType, stack::MomentumVector,
-                  geometry::Point, units::si::TimeType>{
-                specCode, Plab.GetTimeLikeComponent(), Plab.GetSpaceLikeComponents(),
-                pOrig, tOrig});
+        vP.EmplaceSecondary(specCode, Plab.GetTimeLikeComponent(),
+                            Plab.GetSpaceLikeComponents().GetComponents(rootCS), xOrig,
+                            tOrig);
       else
         // add nucleus
-        vP.AddSecondary(tuple<particles::Code, units::si::HEPEnergyType,
-                              corsika::stack::MomentumVector, geometry::Point,
-                              units::si::TimeType, unsigned short, unsigned short>{
-            specCode, Plab.GetTimeLikeComponent(), Plab.GetSpaceLikeComponents(), pOrig,
-            tOrig, nuclA, nuclZ});
+        vP.EmplaceSecondary(specCode, Plab.GetTimeLikeComponent(),
+                            Plab.GetSpaceLikeComponents().GetComponents(rootCS), xOrig,
+                            tOrig, nuclA, nuclZ);
     }
 
     // add elastic nucleons to corsika stack
@@ -581,11 +581,9 @@ namespace corsika::process::sibyll {
       const double mass_ratio = particles::GetMass(elaNucCode) / ProjMass;
       auto const Plab = PprojLab * mass_ratio;
 
-      vP.AddSecondary(
-          tuple<particles::Code, units::si::HEPEnergyType, corsika::stack::MomentumVector,
-                geometry::Point, units::si::TimeType>{
-              elaNucCode, Plab.GetTimeLikeComponent(), Plab.GetSpaceLikeComponents(),
-              pOrig, tOrig});
+      vP.EmplaceSecondary(elaNucCode, Plab.GetTimeLikeComponent(),
+                          Plab.GetSpaceLikeComponents().GetComponents(rootCS), xOrig,
+                          tOrig);
     }
 
     // add inelastic interactions
@@ -595,11 +593,9 @@ namespace corsika::process::sibyll {
       auto pCode = particles::Proton::GetCode();
       // temporarily add to stack, will be removed after interaction in DoInteraction
       cout << "inelastic interaction no. " << j << endl;
-      auto inelasticNucleon = vP.AddSecondary(
-          tuple<particles::Code, units::si::HEPEnergyType, corsika::stack::MomentumVector,
-                geometry::Point, units::si::TimeType>{
-              pCode, PprojNucLab.GetTimeLikeComponent(),
-              PprojNucLab.GetSpaceLikeComponents(), pOrig, tOrig});
+      auto inelasticNucleon = vP.EmplaceSecondary(
+          pCode, PprojNucLab.GetTimeLikeComponent(),
+          PprojNucLab.GetSpaceLikeComponents().GetComponents(rootCS), xOrig, tOrig);
       // create inelastic interaction
       cout << "calling HadronicInteraction..." << endl;
       fHadronicInteraction.DoInteraction(inelasticNucleon);
@@ -12,6 +12,7 @@
 #define _corsika_process_sibyll_nuclearinteraction_h_
 
 #include <corsika/particles/ParticleProperties.h>
+#include <corsika/process/BaseProcess.h>
 #include <corsika/process/InteractionProcess.h>
 #include <corsika/random/RNGManager.h>
 
@@ -79,4 +80,12 @@ namespace corsika::process::sibyll {
 
 } // namespace corsika::process::sibyll
 
+namespace corsika::process {
+
+  /// Sibyll keeps its state in Fortran common blocks
+  template <typename TEnvironment>
+  struct is_thread_safe<sibyll::NuclearInteraction<TEnvironment>> : std::false_type {};
+
+} // namespace corsika::process
+
 #endif
@@ -0,0 +1,233 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+/**
+ * Secondaries per second written to setup::Stack for the final state of a
+ * 1 PeV proton-oxygen interaction in Sibyll: the complete interaction, and
+ * the transfer of the final state alone, with AddSecondary(tuple) as the
+ * model interfaces used to do and with EmplaceSecondary.
+ *
+ * Further the calls of Sibyll in every step of a hadron: the cross
+ * sections and interaction length of a proton in oxygen, and the lifetime
+ * and decay of a charged kaon.
+ */
+
+#include <corsika/process/sibyll/Decay.h>
+#include <corsika/process/sibyll/Interaction.h>
+
+#include <corsika/environment/Environment.h>
+#include <corsika/environment/HomogeneousMedium.h>
+#include <corsika/environment/NuclearComposition.h>
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/geometry/Sphere.h>
+#include <corsika/particles/ParticleProperties.h>
+#include <corsika/random/RNGManager.h>
+#include <corsika/setup/SetupStack.h>
+#include <corsika/testing/Benchmark.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace corsika;
+using namespace corsika::units::si;
+using corsika::testing::DoNotOptimize;
+using corsika::testing::RunBenchmark;
+
+using ParticleTuple = std::tuple<particles::Code, HEPEnergyType, stack::MomentumVector,
+                                 geometry::Point, TimeType>;
+
+/// the models print every event, which is not what we want to measure
+class SilenceStdout {
+public:
+  SilenceStdout() {
+    std::cout.flush();
+    std::fflush(stdout);
+    fSaved = ::dup(1);
+    int const null = ::open("/dev/null", O_WRONLY);
+    ::dup2(null, 1);
+    ::close(null);
+  }
+  ~SilenceStdout() {
+    std::cout.flush();
+    std::fflush(stdout);
+    ::dup2(fSaved, 1);
+    ::close(fSaved);
+  }
+
+private:
+  int fSaved;
+};
+
+/// for results of RunBenchmark while stdout was silenced
+void Print(testing::BenchmarkResult const& vResult) {
+  std::cout << std::left << std::setw(48) << vResult.fName << std::right
+            << std::setw(14) << std::fixed << std::setprecision(2)
+            << vResult.fNanoSecondsPerIteration << " ns/iteration  ("
+            << vResult.fIterations << " iterations)" << std::defaultfloat << std::endl;
+}
+
+int main() {
+  using EnvType = environment::Environment<environment::IMediumModel>;
+  EnvType env;
+  auto& universe = *(env.GetUniverse());
+  auto theMedium = EnvType::CreateNode<geometry::Sphere>(
+      geometry::Point{env.GetCoordinateSystem(), 0_m, 0_m, 0_m},
+      1_km * std::numeric_limits<double>::infinity());
+  using MyHomogeneousModel = environment::HomogeneousMedium<environment::IMediumModel>;
+  theMedium->SetModelProperties<MyHomogeneousModel>(
+      1_kg / (1_m * 1_m * 1_m),
+      environment::NuclearComposition(
+          std::vector<particles::Code>{particles::Code::Oxygen}, std::vector<float>{1.}));
+  auto const* node = theMedium.get();
+  universe.AddChild(std::move(theMedium));
+
+  auto const& rootCS =
+      geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+  random::RNGManager::GetInstance().RegisterRandomStream("s_rndm");
+  random::RNGManager::GetInstance().SeedAll(1);
+
+  HEPEnergyType const E0 = 1e6_GeV;
+  HEPMomentumType const P0 = sqrt(E0 * E0 - square(particles::Proton::GetMass()));
+  ParticleTuple const primary{particles::Code::Proton, E0,
+                              stack::MomentumVector(rootCS, {0_GeV, 0_GeV, -P0}),
+                              geometry::Point(rootCS, 0_m, 0_m, 0_m), 0_ns};
+
+  process::sibyll::Interaction model;
+  {
+    SilenceStdout silence;
+    model.Init();
+  }
+
+  // complete interactions
+  int const nEvents = 50;
+  std::size_t nSecondaries = 0;
+  std::vector<ParticleTuple> finalState;
+  double seconds = 0;
+  for (int i = 0; i < nEvents; ++i) {
+    setup::Stack stack;
+    auto particle = stack.AddParticle(primary);
+    particle.SetNode(node);
+    setup::StackView view(particle);
+    auto projectile = view.GetProjectile();
+    auto const start = std::chrono::steady_clock::now();
+    {
+      SilenceStdout silence;
+      model.DoInteraction(projectile);
+    }
+    seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                   .count();
+    nSecondaries += view.GetSize();
+    if (finalState.size() < view.GetSize()) {
+      finalState.clear();
+      for (auto const& p : view) {
+        finalState.emplace_back(p.GetPID(), p.GetEnergy(), p.GetMomentum(),
+                                p.GetPosition(), p.GetTime());
+      }
+    }
+  }
+  std::cout << "Sibyll 1 PeV p-O interaction: " << double(nSecondaries) / nEvents
+            << " secondaries/event, " << nSecondaries / seconds << " secondaries/s"
+            << std::endl;
+
+  // the transfer of the largest final state to the stack
+  double const n = finalState.size();
+  setup::Stack stack;
+  auto const resultTuple = RunBenchmark("AddSecondary(tuple)", [&]() {
+    stack.Clear();
+    auto particle = stack.AddParticle(primary);
+    setup::StackView view(particle);
+    auto projectile = view.GetProjectile();
+    for (auto const& s : finalState) {
+      projectile.AddSecondary(ParticleTuple{std::get<0>(s), std::get<1>(s),
+                                            std::get<2>(s), std::get<3>(s),
+                                            std::get<4>(s)});
+    }
+    DoNotOptimize(view.GetSize());
+  });
+  std::cout << "  " << n / resultTuple.fNanoSecondsPerIteration * 1e9
+            << " secondaries/s" << std::endl;
+
+  auto const resultEmplace = RunBenchmark("EmplaceSecondary", [&]() {
+    stack.Clear();
+    auto particle = stack.AddParticle(primary);
+    setup::StackView view(particle);
+    auto projectile = view.GetProjectile();
+    auto const x = std::get<3>(primary).GetCoordinates(rootCS);
+    for (auto const& s : finalState) {
+      projectile.EmplaceSecondary(std::get<0>(s), std::get<1>(s),
+                                  std::get<2>(s).GetComponents(rootCS), x,
+                                  std::get<4>(s));
+    }
+    DoNotOptimize(view.GetSize());
+  });
+  std::cout << "  " << n / resultEmplace.fNanoSecondsPerIteration * 1e9
+            << " secondaries/s" << std::endl;
+
+  // cross sections, as needed in every step of a hadron
+  {
+    stack.Clear();
+    auto particle = stack.AddParticle(primary);
+    particle.SetNode(node);
+    HEPEnergyType const sqrtS = sqrt(2 * E0 * units::constants::nucleonMass);
+    testing::BenchmarkResult resultCrossSection, resultLength;
+    {
+      SilenceStdout silence;
+      resultCrossSection = RunBenchmark("Interaction::GetCrossSection", [&]() {
+        DoNotOptimize(model.GetCrossSection(particles::Code::Proton,
+                                            particles::Code::Oxygen, sqrtS));
+      });
+      resultLength = RunBenchmark("Interaction::GetInteractionLength", [&]() {
+        DoNotOptimize(model.GetInteractionLength(particle));
+      });
+    }
+    Print(resultCrossSection);
+    Print(resultLength);
+  }
+
+  // decays of a charged kaon
+  {
+    process::sibyll::Decay decay;
+    HEPEnergyType const E = 10_GeV;
+    HEPMomentumType const P = sqrt(E * E - square(particles::KPlus::GetMass()));
+    ParticleTuple const kaon{particles::Code::KPlus, E,
+                             stack::MomentumVector(rootCS, {0_GeV, 0_GeV, -P}),
+                             geometry::Point(rootCS, 0_m, 0_m, 0_m), 0_ns};
+    testing::BenchmarkResult resultLifetime, resultDecay;
+    {
+      SilenceStdout silence;
+      decay.Init();
+      stack.Clear();
+      auto const particle = stack.AddParticle(kaon);
+      resultLifetime = RunBenchmark("Decay::GetLifetime", [&]() {
+        DoNotOptimize(decay.GetLifetime(particle));
+      });
+      resultDecay = RunBenchmark("Decay::DoDecay", [&]() {
+        stack.Clear();
+        auto particle = stack.AddParticle(kaon);
+        setup::StackView view(particle);
+        auto projectile = view.GetProjectile();
+        decay.DoDecay(projectile);
+        DoNotOptimize(view.GetSize());
+      });
+    }
+    Print(resultLifetime);
+    Print(resultDecay);
+  }
+}
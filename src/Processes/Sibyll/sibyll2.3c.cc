@@ -11,15 +11,13 @@
 #include <corsika/process/sibyll/sibyll2.3c.h>
 
 #include <corsika/random/RNGManager.h>
-#include <random>
 
 int get_nwounded() { return s_chist_.nwd; }
 double get_sibyll_mass2(int& id) { return s_mass1_.am2[id]; }
 
 double s_rndm_(int&) {
-  static corsika::random::RNG& rng =
-      corsika::random::RNGManager::GetInstance().GetRandomStream("s_rndm");
+  static corsika::random::UniformBuffer<corsika::random::RNG>& buffer =
+      corsika::random::RNGManager::GetInstance().GetUniformBuffer("s_rndm");
 
-  std::uniform_real_distribution<double> dist;
-  return dist(rng);
+  return buffer();
 }
@@ -118,10 +118,20 @@ TEST_CASE("SibyllInterface", "[processes]") {
     auto projectile = view.GetProjectile();
 
     Interaction model;
+    // drop secondaries below 1 GeV before they are written to the stack
+    unsigned int nAccepted = 0;
+    model.SetSecondaryFilter([&](particles::Code, HEPEnergyType vE, TimeType) {
+      if (vE < 1_GeV) return true;
+      ++nAccepted;
+      return false;
+    });
 
     model.Init();
     [[maybe_unused]] const process::EProcessReturn ret = model.DoInteraction(projectile);
     [[maybe_unused]] const GrammageType length = model.GetInteractionLength(particle);
+
+    CHECK(view.GetSize() == nAccepted);
+    for (auto const& p : view) { CHECK(p.GetEnergy() >= 1_GeV); }
   }
 
   SECTION("NuclearInteractionInterface") {
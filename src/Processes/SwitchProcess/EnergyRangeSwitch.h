@@ -0,0 +1,331 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _corsika_EnergyRangeSwitch_h
+#define _corsika_EnergyRangeSwitch_h
+
+#include <corsika/particles/ParticleProperties.h>
+#include <corsika/process/InteractionProcess.h>
+#include <corsika/process/ProcessSequence.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace corsika::process::switch_process {
+
+  using particles::ParticleClass;
+
+  /// whether vCode is a projectile of an EnergyRange for vClass, empty for any
+  inline bool IsInClass(particles::Code const vCode,
+                        std::optional<ParticleClass> const vClass) {
+    return !vClass || particles::GetParticleClass(vCode) == *vClass;
+  }
+
+  /// model number fModel of an EnergyRangeSwitch is used in [fMin, fMax)
+  struct EnergyRange {
+    std::size_t fModel;
+    units::si::HEPEnergyType fMin;
+    units::si::HEPEnergyType fMax;
+    std::optional<ParticleClass> fClass = {}; //!< the projectiles, all if empty
+  };
+
+  /**
+   * Generalisation of SwitchProcess to any number of interaction models,
+   * each of them used in one or more energy ranges for a class of
+   * projectiles, e.g.
+   *
+   *   EnergyRangeSwitch models({{0, 0_GeV, 1_GeV}, {1, 1_GeV, 80_GeV},
+   *                             {2, 80_GeV, 1e12_GeV}}, fast, urqmd, sibyll);
+   *
+   * The models can be single interaction processes or ProcessSequences.
+   * Where ranges overlap, the one given first is used, unless blending is
+   * switched on: then the cross section and the interactions are a linear
+   * interpolation in energy between the two models across the overlap.
+   * Blending needs the ranges to be staggered: a range inside another one,
+   * which would end with a jump back to the outer model, is rejected with
+   * std::runtime_error, as are more than two overlapping ranges.
+   * Outside of all ranges the projectile does not interact.
+   *
+   * The ranges are compiled into a table of energy intervals per particle
+   * class when the switch is constructed. The interval of a projectile is
+   * looked up once per step, by GetInverseInteractionLength(), and reused
+   * by SelectInteraction().
+   *
+   * The Init() of a model is called when it is used for the first time, so
+   * that models needed by no particle of a shower are never initialised.
+   */
+  template <typename... TModels>
+  class EnergyRangeSwitch : public BaseProcess<EnergyRangeSwitch<TModels...>> {
+
+    static std::size_t constexpr kNoModel = sizeof...(TModels);
+
+    /// up to two models with the weight of the second one, w = a + b * E
+    struct Selection {
+      std::size_t fModel1 = kNoModel;
+      std::size_t fModel2 = kNoModel;
+      double fWeightOffset = 0;
+      double fWeightSlope = 0; //!< per eV
+    };
+
+    /// the intervals of a set of ranges, Selection i is used below fUpper[i]
+    struct Table {
+      std::vector<double> fUpper; //!< in eV
+      std::vector<Selection> fSelections;
+    };
+
+  public:
+    EnergyRangeSwitch(std::vector<EnergyRange> const& vRanges, TModels&... vModels)
+        : fModels(vModels...)
+        , fRanges(vRanges) {
+      for (auto const& r : fRanges) {
+        if (r.fModel >= kNoModel) {
+          throw std::runtime_error("EnergyRangeSwitch: no such model");
+        }
+        if (!(r.fMin < r.fMax)) {
+          throw std::runtime_error("EnergyRangeSwitch: empty energy range");
+        }
+      }
+      BuildTables();
+    }
+
+    /// interpolate linearly between overlapping ranges, unchanged on error
+    void SetBlending(bool const vBlending) {
+      bool const previous = fBlending;
+      fBlending = vBlending;
+      try {
+        BuildTables();
+      } catch (std::runtime_error const&) {
+        fBlending = previous;
+        BuildTables();
+        throw;
+      }
+    }
+    bool GetBlending() const { return fBlending; }
+
+    /// the models are initialised on first use
+    void Init() {
+      fInitialized.fill(false);
+      fHasLast = false;
+    }
+
+    bool IsInitialized(std::size_t const vModel) const { return fInitialized[vModel]; }
+
+    template <typename TParticle>
+    units::si::GrammageType GetInteractionLength(TParticle& vP) {
+      return 1 / GetInverseInteractionLength(vP);
+    }
+
+    template <typename TParticle>
+    units::si::InverseGrammageType GetInverseInteractionLength(TParticle& vP) {
+      using namespace units::si;
+      auto const [selection, weight] = Resolve(vP);
+      InverseGrammageType invLambda = 0 * meter * meter / gram;
+      if (selection.fModel1 != kNoModel && weight < 1) {
+        invLambda += (1 - weight) * Apply(selection.fModel1, [&](auto& vModel) {
+          return vModel.GetInverseInteractionLength(vP);
+        });
+      }
+      if (selection.fModel2 != kNoModel && weight > 0) {
+        invLambda += weight * Apply(selection.fModel2, [&](auto& vModel) {
+          return vModel.GetInverseInteractionLength(vP);
+        });
+      }
+      return invLambda;
+    }
+
+    // see SwitchProcess::SelectInteraction
+    template <typename TParticle, typename TSecondaries>
+    EProcessReturn SelectInteraction(TParticle& vP, TSecondaries& vS,
+                                     units::si::InverseGrammageType lambda_select,
+                                     units::si::InverseGrammageType& lambda_inv_count) {
+      auto const [selection, weight] = Resolve(vP);
+      if (selection.fModel1 != kNoModel && weight < 1) {
+        auto const ret = Select(selection.fModel1, 1 - weight, vP, vS, lambda_select,
+                                lambda_inv_count);
+        if (ret != EProcessReturn::eOk) { return ret; }
+      }
+      if (selection.fModel2 != kNoModel && weight > 0) {
+        return Select(selection.fModel2, weight, vP, vS, lambda_select,
+                      lambda_inv_count);
+      }
+      return EProcessReturn::eOk;
+    }
+
+  private:
+    /// calls vFunction with model vIndex, which is initialised if needed
+    template <typename TFunction>
+    decltype(auto) Apply(std::size_t const vIndex, TFunction&& vFunction) {
+      if (!fInitialized[vIndex]) {
+        auto init = [](auto& vModel) { vModel.Init(); };
+        Call(vIndex, init, std::make_index_sequence<kNoModel>());
+        fInitialized[vIndex] = true;
+      }
+      return Call(vIndex, vFunction, std::make_index_sequence<kNoModel>());
+    }
+
+    template <typename TFunction, std::size_t... I>
+    decltype(auto) Call(std::size_t const vIndex, TFunction& vFunction,
+                        std::index_sequence<I...>) {
+      using Result = decltype(vFunction(std::get<0>(fModels)));
+      if constexpr (std::is_void_v<Result>) {
+        ((vIndex == I ? vFunction(std::get<I>(fModels)) : void()), ...);
+      } else {
+        Result result{};
+        ((vIndex == I ? void(result = vFunction(std::get<I>(fModels))) : void()), ...);
+        return result;
+      }
+    }
+
+    /// SelectInteraction of a model whose cross section is scaled by vWeight
+    template <typename TParticle, typename TSecondaries>
+    EProcessReturn Select(std::size_t const vIndex, double const vWeight, TParticle& vP,
+                          TSecondaries& vS, units::si::InverseGrammageType lambda_select,
+                          units::si::InverseGrammageType& lambda_inv_count) {
+      return Apply(vIndex, [&](auto& vModel) {
+        using TModel = std::decay_t<decltype(vModel)>;
+        if constexpr (is_process_sequence_v<TModel> || is_switch_process_v<TModel>) {
+          // the sequence counts unweighted, from zero
+          auto count = lambda_inv_count * 0;
+          auto const ret = vModel.SelectInteraction(
+              vP, vS, (lambda_select - lambda_inv_count) / vWeight, count);
+          lambda_inv_count += vWeight * count;
+          return ret;
+        } else {
+          lambda_inv_count += vWeight * vModel.GetInverseInteractionLength(vP);
+          if (lambda_select < lambda_inv_count) {
+            vModel.DoInteraction(vS);
+            return EProcessReturn::eInteracted;
+          }
+          return EProcessReturn::eOk;
+        }
+      });
+    }
+
+    /// the models to be used for vP, and the weight of the second one
+    template <typename TParticle>
+    std::pair<Selection const&, double> Resolve(TParticle const& vP) {
+      double const energy = vP.GetEnergy().magnitude();
+      particles::Code const pid = vP.GetPID();
+      if (!fHasLast || energy != fLastEnergy || pid != fLastPID) {
+        auto const& table = fTables[fTableOfCode[static_cast<std::size_t>(pid)]];
+        auto const interval =
+            std::upper_bound(table.fUpper.begin(), table.fUpper.end(), energy) -
+            table.fUpper.begin();
+        fLast = &table.fSelections[interval];
+        fLastWeight = std::clamp(fLast->fWeightOffset + fLast->fWeightSlope * energy,
+                                 0., 1.);
+        fLastEnergy = energy;
+        fLastPID = pid;
+        fHasLast = true;
+      }
+      return {*fLast, fLastWeight};
+    }
+
+    /// one Table for each distinct set of ranges applying to a particle
+    void BuildTables() {
+      fTables.clear();
+      std::vector<std::vector<bool>> signatures;
+      for (std::size_t code = 0; code < particles::detail::size; ++code) {
+        std::vector<bool> applies;
+        for (auto const& r : fRanges) {
+          applies.push_back(IsInClass(static_cast<particles::Code>(code), r.fClass));
+        }
+        auto const it = std::find(signatures.begin(), signatures.end(), applies);
+        fTableOfCode[code] = it - signatures.begin();
+        if (it == signatures.end()) {
+          signatures.push_back(applies);
+          fTables.push_back(BuildTable(applies));
+        }
+      }
+      fHasLast = false;
+    }
+
+    Table BuildTable(std::vector<bool> const& vApplies) const {
+      std::vector<double> edges;
+      for (std::size_t i = 0; i < fRanges.size(); ++i) {
+        if (!vApplies[i]) { continue; }
+        edges.push_back(fRanges[i].fMin.magnitude());
+        edges.push_back(fRanges[i].fMax.magnitude());
+      }
+      std::sort(edges.begin(), edges.end());
+      edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+      Table table;
+      table.fUpper = edges;
+      table.fSelections.resize(edges.size() + 1); // below and above all ranges
+      for (std::size_t k = 1; k < edges.size(); ++k) {
+        double const center = (edges[k - 1] + edges[k]) / 2;
+        std::vector<EnergyRange const*> active;
+        for (std::size_t i = 0; i < fRanges.size(); ++i) {
+          if (vApplies[i] && fRanges[i].fMin.magnitude() <= center &&
+              center < fRanges[i].fMax.magnitude()) {
+            active.push_back(&fRanges[i]);
+          }
+        }
+        if (active.empty()) { continue; }
+
+        Selection& s = table.fSelections[k];
+        s.fModel1 = active[0]->fModel;
+        if (!fBlending || active.size() == 1 || active[0]->fModel == active[1]->fModel) {
+          continue;
+        }
+        if (active.size() > 2) {
+          throw std::runtime_error(
+              "EnergyRangeSwitch: cannot blend more than two overlapping ranges");
+        }
+        // the weight of the range starting later, or ending later, rises
+        // across the overlap
+        auto const* lower = active[0];
+        auto const* upper = active[1];
+        if (upper->fMin < lower->fMin ||
+            (upper->fMin == lower->fMin && upper->fMax < lower->fMax)) {
+          std::swap(lower, upper);
+        }
+        if (upper->fMax < lower->fMax) {
+          throw std::runtime_error("EnergyRangeSwitch: cannot blend nested ranges");
+        }
+        double const begin = upper->fMin.magnitude();
+        double const end = lower->fMax.magnitude();
+        s.fModel1 = lower->fModel;
+        s.fModel2 = upper->fModel;
+        s.fWeightSlope = 1 / (end - begin);
+        s.fWeightOffset = -begin / (end - begin);
+      }
+      return table;
+    }
+
+    std::tuple<TModels&...> fModels;
+    std::vector<EnergyRange> const fRanges;
+    bool fBlending = false;
+    std::array<bool, sizeof...(TModels)> fInitialized{};
+
+    std::vector<Table> fTables;
+    std::array<std::size_t, particles::detail::size> fTableOfCode{};
+
+    // the selection of the current step
+    bool fHasLast = false;
+    double fLastEnergy = 0;
+    particles::Code fLastPID = particles::Code::Unknown;
+    Selection const* fLast = nullptr;
+    double fLastWeight = 0;
+  };
+
+} // namespace corsika::process::switch_process
+
+#endif
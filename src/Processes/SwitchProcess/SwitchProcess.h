@@ -24,6 +24,8 @@ namespace corsika::process::switch_process {
    * single interaction processes or multiple ones combined in a ProcessSequence. A
    * SwitchProcess itself will always be regarded as a distinct case when assembled into a
    * (greater) ProcessSequence.
+   *
+   * See EnergyRangeSwitch for more than two models.
    */
 
   template <class TLowEProcess, class THighEProcess>
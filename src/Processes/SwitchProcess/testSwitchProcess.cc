@@ -8,6 +8,7 @@
  * the license.
  */
 
+#include <corsika/process/switch_process/EnergyRangeSwitch.h>
 #include <corsika/process/switch_process/SwitchProcess.h>
 #include <corsika/stack/SecondaryView.h>
 #include <corsika/stack/Stack.h>
@@ -16,7 +17,10 @@
 #include <catch2/catch.hpp>
 
 #include <algorithm>
+#include <cmath>
+#include <numeric>
 #include <random>
+#include <stdexcept>
 
 using namespace corsika;
 using namespace corsika::process;
@@ -27,25 +31,43 @@ class TestStackData {
 public:
   // these functions are needed for the Stack interface
   void Init() {}
-  void Clear() { fData.clear(); }
+  void Clear() {
+    fData.clear();
+    fPID.clear();
+  }
   unsigned int GetSize() const { return fData.size(); }
   unsigned int GetCapacity() const { return fData.size(); }
-  void Copy(int i1, int i2) { fData[i2] = fData[i1]; }
-  void Swap(int i1, int i2) { std::swap(fData[i1], fData[i2]); }
+  void Copy(int i1, int i2) {
+    fData[i2] = fData[i1];
+    fPID[i2] = fPID[i1];
+  }
+  void Swap(int i1, int i2) {
+    std::swap(fData[i1], fData[i2]);
+    std::swap(fPID[i1], fPID[i2]);
+  }
 
   // custom data access function
   void SetData(unsigned int i, HEPEnergyType v) { fData[i] = v; }
   HEPEnergyType GetData(const unsigned int i) const { return fData[i]; }
+  void SetPID(unsigned int i, particles::Code v) { fPID[i] = v; }
+  particles::Code GetPID(const unsigned int i) const { return fPID[i]; }
 
   // these functions are also needed by the Stack interface
-  void IncrementSize() { fData.resize(fData.size() + 1); }
+  void IncrementSize() {
+    fData.resize(fData.size() + 1);
+    fPID.resize(fPID.size() + 1, particles::Code::Unknown);
+  }
   void DecrementSize() {
-    if (fData.size() > 0) { fData.pop_back(); }
+    if (fData.size() > 0) {
+      fData.pop_back();
+      fPID.pop_back();
+    }
   }
 
   // custom private data section
 private:
   std::vector<HEPEnergyType> fData;
+  std::vector<particles::Code> fPID;
 };
 
 /**
@@ -75,6 +97,10 @@ public:
 
   // default version for particle-creation from input data
   void SetParticleData(const std::tuple<HEPEnergyType> v) { SetEnergy(std::get<0>(v)); }
+  void SetParticleData(const std::tuple<HEPEnergyType, particles::Code> v) {
+    SetEnergy(std::get<0>(v));
+    SetPID(std::get<1>(v));
+  }
   void SetParticleData(TestParticleInterface<StackIteratorInterface>& /*parent*/,
                        std::tuple<HEPEnergyType> v) {
     SetEnergy(std::get<0>(v));
@@ -83,6 +109,8 @@ public:
   // here are the fundamental methods for access to TestStackData data
   void SetEnergy(HEPEnergyType v) { GetStackData().SetData(GetIndex(), v); }
   HEPEnergyType GetEnergy() const { return GetStackData().GetData(GetIndex()); }
+  void SetPID(particles::Code v) { GetStackData().SetPID(GetIndex(), v); }
+  particles::Code GetPID() const { return GetStackData().GetPID(GetIndex()); }
 };
 
 using SimpleStack = corsika::stack::Stack<TestStackData, TestParticleInterface>;
@@ -98,7 +126,8 @@ auto constexpr kgMSq = 1_kg / (1_m * 1_m);
 
 template <int N>
 struct DummyProcess : InteractionProcess<DummyProcess<N>> {
-  void Init() {}
+  int fInitCalls = 0;
+  void Init() { ++fInitCalls; }
 
   template <typename TParticle>
   corsika::units::si::GrammageType GetInteractionLength(TParticle const&) const {
@@ -262,3 +291,123 @@ TEST_CASE("SwitchProcess from ProcessSequence") {
     }
   }
 }
+
+TEST_CASE("EnergyRangeSwitch") {
+  DummyProcess<1> fast;
+  DummyProcess<2> low;
+  DummyProcess<3> high;
+
+  using switch_process::EnergyRange;
+  using switch_process::ParticleClass;
+
+  SimpleStack stack;
+  auto particle = [&](HEPEnergyType const E,
+                      particles::Code const pid = particles::Code::Proton) {
+    stack.Clear();
+    stack.AddParticle(std::tuple<HEPEnergyType, particles::Code>{E, pid});
+    return stack.GetNextParticle();
+  };
+  auto length = [&](auto& vModels, HEPEnergyType const E,
+                    particles::Code const pid = particles::Code::Proton) {
+    auto p = particle(E, pid);
+    return vModels.GetInteractionLength(p) / kgMSq;
+  };
+
+  SECTION("energy ranges") {
+    switch_process::EnergyRangeSwitch models(
+        {{0, 0_GeV, 1_GeV}, {1, 1_GeV, 80_GeV}, {2, 80_GeV, 1e6_GeV}}, fast, low, high);
+    models.Init();
+    CHECK(length(models, 0.5_GeV) == Approx(1));
+    CHECK(length(models, 1_GeV) == Approx(2));
+    CHECK(length(models, 79_GeV) == Approx(2));
+    CHECK(length(models, 1_TeV) == Approx(3));
+    // outside of all ranges
+    CHECK(std::isinf(length(models, 1e7_GeV)));
+
+    // in a ProcessSequence
+    DummyProcess<4> additional;
+    auto seq = models << additional;
+    auto p = particle(10_GeV);
+    CHECK(seq.GetTotalInteractionLength(p) / kgMSq == Approx(4. / 3));
+  }
+
+  SECTION("lazy initialisation") {
+    switch_process::EnergyRangeSwitch models(
+        {{0, 0_GeV, 1_GeV}, {1, 1_GeV, 80_GeV}, {2, 80_GeV, 1e6_GeV}}, fast, low, high);
+    models.Init();
+    CHECK_FALSE(models.IsInitialized(1));
+    length(models, 10_GeV);
+    length(models, 20_GeV);
+    CHECK(models.IsInitialized(1));
+    CHECK(low.fInitCalls == 1);
+    CHECK(fast.fInitCalls == 0);
+    CHECK(high.fInitCalls == 0);
+  }
+
+  SECTION("particle class") {
+    // the first matching range is used
+    switch_process::EnergyRangeSwitch models(
+        {{0, 0_GeV, 1e6_GeV, ParticleClass::eMuon}, {1, 0_GeV, 1e6_GeV}}, fast, low);
+    CHECK(length(models, 10_GeV, particles::Code::MuMinus) == Approx(1));
+    CHECK(length(models, 10_GeV, particles::Code::PiPlus) == Approx(2));
+  }
+
+  SECTION("blending") {
+    auto seq = low << high;
+    switch_process::EnergyRangeSwitch models({{0, 0_GeV, 2_TeV}, {1, 1_TeV, 1e6_GeV}},
+                                             fast, seq);
+    auto p = particle(1.5_TeV);
+    CHECK(models.GetInteractionLength(p) / kgMSq == Approx(1));
+
+    models.SetBlending(true);
+    // half of each model
+    InverseGrammageType const invLambda = 0.5 / kgMSq + 0.5 * (1. / 2 + 1. / 3) / kgMSq;
+    CHECK(models.GetInverseInteractionLength(p) * kgMSq == Approx(invLambda * kgMSq));
+    CHECK(length(models, 0.9_TeV) == Approx(1));
+    CHECK(length(models, 2.1_TeV) == Approx(6. / 5));
+
+    // the number of secondaries tells which model interacted
+    std::vector<int> numberOfSecondaries;
+    for (int i = 0; i < 1000; ++i) {
+      auto theParticle = particle(1.5_TeV);
+      StackTestView view(theParticle);
+      auto projectile = view.GetProjectile();
+      InverseGrammageType accumulator = 0 / kgMSq;
+      models.SelectInteraction(theParticle, projectile, (i + 0.5) / 1000. * invLambda,
+                               accumulator);
+      numberOfSecondaries.push_back(view.GetSize());
+    }
+    auto const mean =
+        std::accumulate(numberOfSecondaries.cbegin(), numberOfSecondaries.cend(), 0.) /
+        numberOfSecondaries.size();
+    double const expected = (0.5 * 1 + 0.5 / 2 * 2 + 0.5 / 3 * 3) / kgMSq / invLambda;
+    CHECK(mean == Approx(expected).margin(0.01));
+  }
+
+  SECTION("invalid ranges") {
+    using Switch = switch_process::EnergyRangeSwitch<DummyProcess<1>, DummyProcess<2>>;
+    CHECK_THROWS_AS(Switch({{2, 0_GeV, 1_GeV}}, fast, low), std::runtime_error);
+    CHECK_THROWS_AS(Switch({{0, 1_GeV, 1_GeV}}, fast, low), std::runtime_error);
+    Switch models({{0, 0_GeV, 10_GeV}, {1, 1_GeV, 10_GeV}, {0, 2_GeV, 10_GeV}}, fast,
+                  low);
+    CHECK_THROWS_AS(models.SetBlending(true), std::runtime_error);
+    CHECK_FALSE(models.GetBlending());
+    CHECK(length(models, 5_GeV) == Approx(1));
+
+    // the weight of the inner range would drop back to zero at 5 GeV
+    Switch nested({{0, 0_GeV, 10_GeV}, {1, 1_GeV, 5_GeV}}, fast, low);
+    CHECK_THROWS_AS(nested.SetBlending(true), std::runtime_error);
+    CHECK_FALSE(nested.GetBlending());
+  }
+
+  SECTION("blending of ranges with the same start") {
+    using Switch = switch_process::EnergyRangeSwitch<DummyProcess<1>, DummyProcess<2>>;
+    Switch models({{0, 1_GeV, 10_GeV}, {1, 1_GeV, 5_GeV}}, fast, low);
+    models.SetBlending(true);
+    // from the shorter range to the longer one, continuous at 5 GeV
+    CHECK(length(models, 1_GeV) == Approx(2));
+    CHECK(length(models, 3_GeV) == Approx(4. / 3));
+    CHECK(length(models, 4.999_GeV) == Approx(1).epsilon(1e-3));
+    CHECK(length(models, 5_GeV) == Approx(1));
+  }
+}
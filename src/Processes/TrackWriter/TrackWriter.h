@@ -11,6 +11,7 @@
 #ifndef _Processes_track_writer_TrackWriter_h_
 #define _Processes_track_writer_TrackWriter_h_
 
+#include <corsika/process/BaseProcess.h>
 #include <corsika/process/ContinuousProcess.h>
 #include <corsika/units/PhysicalUnits.h>
 
@@ -40,4 +41,12 @@ namespace corsika::process::track_writer {
 
 } // namespace corsika::process::track_writer
 
+namespace corsika::process {
+
+  /// writes the tracks of the whole shower to one file
+  template <>
+  struct is_thread_safe<track_writer::TrackWriter> : std::false_type {};
+
+} // namespace corsika::process
+
 #endif
@@ -0,0 +1,77 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#include <corsika/process/tracking_helix/TrackingHelix.h>
+#include <corsika/process/tracking_line/TrackingLine.h>
+
+#include <cmath>
+
+using namespace corsika::geometry;
+using namespace corsika::units::si;
+
+namespace corsika::process::tracking_helix {
+
+  Helix MakeHelix(Point const& vR0, Vector<SpeedType::dimension_type> const& vVelocity,
+                  Vector<MagneticFluxDensityType::dimension_type> const& vB,
+                  int vChargeNumber, HEPEnergyType vEnergy) {
+    auto const zeroVelocity = vVelocity * 0;
+    auto const B = vB.norm();
+
+    if (vChargeNumber == 0 || B.magnitude() == 0) {
+      return Helix(vR0, 0 / 1_s, vVelocity, zeroVelocity, zeroVelocity);
+    }
+
+    auto const direction = vB.normalized();
+    auto const vPar = direction * vVelocity.dot(direction);
+    auto const vPerp = vVelocity - vPar;
+    auto const uPerp = vPerp.cross(direction);
+
+    // omega_c = Z e B c^2 / E, with E in eV the elementary charge cancels
+    FrequencyType const omegaC = vChargeNumber * B * square(units::constants::c) /
+                                 (vEnergy / 1_eV * units::si::volt);
+
+    return Helix(vR0, omegaC, vPar, vPerp, uPerp);
+  }
+
+  std::optional<std::pair<TimeType, TimeType>> TimeOfIntersection(
+      Helix const& vHelix, Line const& vChord, TimeType vMaxTime,
+      Sphere const& vSphere) {
+    auto const opt = tracking_line::TimeOfIntersection(vChord, vSphere);
+    if (!opt.has_value()) { return {}; }
+
+    auto const& center = vSphere.GetCenter();
+    auto const R2 = vSphere.GetRadius() * vSphere.GetRadius();
+
+    // Newton iterations on f(t) = |r(t) - c|^2 - R^2 along the exact helix
+    auto refine = [&](TimeType t) {
+      if (!(t.magnitude() > 0) || t > vMaxTime) { return t; }
+      TimeType tNew = t;
+      for (int i = 0; i < 10; ++i) {
+        auto const delta = vHelix.GetPosition(tNew) - center;
+        auto const f = delta.squaredNorm() - R2;
+        auto const df = 2 * delta.dot(vHelix.GetVelocity(tNew));
+        if (df.magnitude() == 0) { break; }
+        auto const dt = f / df;
+        tNew = tNew - dt;
+        if (abs(dt) <= 1e-12 * abs(tNew)) { break; }
+      }
+      // keep the estimate from the chord if Newton failed to converge
+      if (!std::isfinite(tNew.magnitude()) || !(tNew.magnitude() > 0) ||
+          abs(tNew - t) > 0.5 * t) {
+        return t;
+      }
+      return tNew;
+    };
+
+    auto const [t1, t2] = *opt;
+    return std::make_pair(refine(t1), refine(t2));
+  }
+
+} // namespace corsika::process::tracking_helix
@@ -0,0 +1,157 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_corsika_processes_TrackingHelix_h_
+#define _include_corsika_processes_TrackingHelix_h_
+
+#include <corsika/geometry/Helix.h>
+#include <corsika/geometry/Line.h>
+#include <corsika/geometry/Sphere.h>
+#include <corsika/geometry/Trajectory.h>
+#include <corsika/geometry/Vector.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace corsika::process {
+
+  namespace tracking_helix {
+
+    /**
+     * Construct the Helix of a particle with charge number \p vChargeNumber and
+     * energy \p vEnergy starting at \p vR0 with \p vVelocity in the field \p vB.
+     * For neutral particles or vanishing fields the Helix is a straight line.
+     */
+    geometry::Helix MakeHelix(
+        geometry::Point const& vR0,
+        geometry::Vector<units::si::SpeedType::dimension_type> const& vVelocity,
+        geometry::Vector<units::si::MagneticFluxDensityType::dimension_type> const& vB,
+        int vChargeNumber, units::si::HEPEnergyType vEnergy);
+
+    /**
+     * Intersection of a Helix with a Sphere. The Helix is approximated by the chord
+     * \p vChord, for which the intersection is analytic; the resulting times are then
+     * refined by Newton iterations on the exact Helix. Times are relative to the
+     * start of the Helix, the chord has to start at the same point.
+     */
+    std::optional<std::pair<units::si::TimeType, units::si::TimeType>>
+    TimeOfIntersection(geometry::Helix const& vHelix, geometry::Line const& vChord,
+                       units::si::TimeType vMaxTime, geometry::Sphere const& vSphere);
+
+    /**
+     * Tracking of charged particles on helices in a static magnetic field, given by
+     * TMagneticField, e.g. environment::UniformMagneticField or
+     * environment::GridMagneticField. The field is evaluated at the beginning of
+     * each step, the step length is limited such that the direction of flight does
+     * not change by more than the maximum bending angle. Neutral particles are
+     * tracked on straight lines.
+     */
+    template <typename TMagneticField>
+    class TrackingHelix {
+
+    public:
+      TrackingHelix(TMagneticField const& vField, double vMaxBendingAngle = 0.1)
+          : fField(vField)
+          , fMaxBendingAngle(vMaxBendingAngle) {}
+
+      template <typename Particle>
+      auto GetTrack(Particle const& p) {
+        using namespace corsika::units::si;
+        using namespace corsika::geometry;
+        geometry::Vector<SpeedType::dimension_type> const velocity =
+            p.GetMomentum() / p.GetEnergy() * corsika::units::constants::c;
+        auto const currentPosition = p.GetPosition();
+
+        Helix const helix =
+            MakeHelix(currentPosition, velocity, fField.GetMagneticField(currentPosition),
+                      p.GetChargeNumber(), p.GetEnergy());
+
+        // adaptive step control: the rate at which the direction changes is
+        // omega_c * v_perp / v
+        auto const speed = velocity.norm();
+        auto const bendingRate =
+            abs(helix.GetOmegaC()) * helix.GetVPerp().norm() / speed;
+        TimeType const maxTime =
+            bendingRate.magnitude() > 0
+                ? fMaxBendingAngle / bendingRate
+                : std::numeric_limits<TimeType::value_type>::infinity() * 1_s;
+
+        Line const chord =
+            std::isfinite(maxTime.magnitude())
+                ? Line(currentPosition,
+                       (helix.GetPosition(maxTime) - currentPosition) / maxTime)
+                : Line(currentPosition, velocity);
+
+        auto const* currentLogicalVolumeNode = p.GetNode();
+        auto const& children = currentLogicalVolumeNode->GetChildNodes();
+        auto const& excluded = currentLogicalVolumeNode->GetExcludedNodes();
+
+        std::vector<std::pair<TimeType, decltype(p.GetNode())>> intersections;
+
+        // for entering from outside
+        auto addIfIntersects = [&](auto const& vtn) {
+          auto const& sphere = dynamic_cast<geometry::Sphere const&>(
+              vtn.GetVolume()); // everything is assumed to be a sphere, as in
+                                // TrackingLine
+          if (auto opt = TimeOfIntersection(helix, chord, maxTime, sphere);
+              opt.has_value()) {
+            auto const [t1, t2] = *opt;
+            [[maybe_unused]] auto dummy_t2 = t2;
+            if (t1.magnitude() > 0) intersections.emplace_back(t1, &vtn);
+          }
+        };
+
+        for (auto const& child : children) { addIfIntersects(*child); }
+        for (auto const* ex : excluded) { addIfIntersects(*ex); }
+
+        {
+          auto const& sphere = dynamic_cast<geometry::Sphere const&>(
+              currentLogicalVolumeNode->GetVolume());
+          if (auto opt = TimeOfIntersection(helix, chord, maxTime, sphere);
+              opt.has_value()) {
+            [[maybe_unused]] auto const [t1, t2] = *opt;
+            [[maybe_unused]] auto dummy_t1 = t1;
+            intersections.emplace_back(t2, currentLogicalVolumeNode->GetParent());
+          }
+        }
+
+        // the bending limit: the particle stays in the current volume
+        intersections.emplace_back(maxTime, currentLogicalVolumeNode);
+
+        auto const minIter = std::min_element(
+            intersections.cbegin(), intersections.cend(),
+            [](auto const& a, auto const& b) { return a.first < b.first; });
+
+        TimeType const min = minIter->first;
+        if (!std::isfinite(min.magnitude())) {
+          throw std::runtime_error("TrackingHelix: no intersection with anything!");
+        }
+
+        return std::make_tuple(geometry::Trajectory<geometry::Helix>(helix, min),
+                               speed * min, minIter->second);
+      }
+
+    private:
+      TMagneticField const& fField;
+      double const fMaxBendingAngle;
+    };
+
+  } // namespace tracking_helix
+
+} // namespace corsika::process
+
+#endif
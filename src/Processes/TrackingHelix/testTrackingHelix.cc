@@ -0,0 +1,137 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#include <corsika/process/tracking_helix/TrackingHelix.h>
+
+#include <corsika/environment/Environment.h>
+#include <corsika/environment/UniformMagneticField.h>
+#include <corsika/particles/ParticleProperties.h>
+
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/Sphere.h>
+#include <corsika/geometry/Vector.h>
+
+#include <corsika/setup/SetupEnvironment.h>
+#include <corsika/setup/SetupStack.h>
+
+#include <catch2/catch.hpp>
+
+using namespace corsika;
+using namespace corsika::process;
+using namespace corsika::units;
+using namespace corsika::geometry;
+using namespace corsika::units::si;
+
+namespace {
+  auto elab2plab(HEPEnergyType Elab, HEPMassType m) {
+    return sqrt((Elab - m) * (Elab + m));
+  }
+} // namespace
+
+TEST_CASE("TrackingHelix") {
+  setup::SetupEnvironment env;
+  auto const& cs = env.GetCoordinateSystem();
+  auto& universe = *(env.GetUniverse());
+
+  auto const radius = 20_m;
+  auto theMedium = setup::SetupEnvironment::CreateNode<Sphere>(
+      Point{cs, 0_m, 0_m, 0_m}, radius);
+  auto const* theMediumPtr = theMedium.get();
+  universe.AddChild(std::move(theMedium));
+
+  Point const origin(cs, {0_m, 0_m, 0_m});
+  setup::Stack stack;
+
+  using corsika::stack::MomentumVector;
+  auto addParticle = [&](particles::Code code, MomentumVector const& p) {
+    stack.Clear();
+    stack.AddParticle(
+        std::tuple<particles::Code, units::si::HEPEnergyType,
+                   corsika::stack::MomentumVector, geometry::Point, units::si::TimeType>{
+            code, 1_GeV, p, origin, 0_ns});
+    auto particle = stack.GetNextParticle();
+    particle.SetNode(theMediumPtr);
+    return particle;
+  };
+
+  auto const pMuon = elab2plab(1_GeV, particles::MuPlus::GetMass());
+
+  SECTION("neutral particles go straight") {
+    environment::UniformMagneticField const field(
+        Vector<magnetic_flux_density_d>(cs, 0_T, 0_T, 1_T));
+    tracking_helix::TrackingHelix tracking(field);
+
+    auto p =
+        addParticle(particles::Code::NuMu, MomentumVector(cs, {0_GeV, 0_GeV, 1_GeV}));
+    auto const [traj, geomMaxLength, nextVol] = tracking.GetTrack(p);
+
+    CHECK(nextVol == &universe);
+    CHECK(geomMaxLength / radius == Approx(1));
+    CHECK((traj.GetPosition(1.) - Point(cs, 0_m, 0_m, radius)).norm() / 1_m ==
+          Approx(0).margin(1e-6));
+  }
+
+  SECTION("step limited by bending angle") {
+    environment::UniformMagneticField const field(
+        Vector<magnetic_flux_density_d>(cs, 0_T, 0_T, 1_T));
+    double const maxAngle = 0.01;
+    tracking_helix::TrackingHelix tracking(field, maxAngle);
+
+    auto p =
+        addParticle(particles::Code::MuPlus, MomentumVector(cs, {pMuon, 0_GeV, 0_GeV}));
+    auto const [traj, geomMaxLength, nextVol] = tracking.GetTrack(p);
+
+    // gyro radius p / (e B c), with p in GeV
+    LengthType const gyroRadius = pMuon / 1_eV * 1_V / (1_T * constants::c);
+
+    CHECK(nextVol == theMediumPtr);
+    CHECK(geomMaxLength / (maxAngle * gyroRadius) == Approx(1));
+
+    // direction changed by the maximum bending angle, positive charges bend to -y
+    auto const v0 = traj.GetVelocity(0_s);
+    auto const v1 = traj.GetVelocity(traj.GetDuration());
+    CHECK(v0.dot(v1) / v0.squaredNorm() == Approx(cos(maxAngle)));
+    CHECK(v1.GetComponents(cs)[1] < 0_m / 1_s);
+
+    // the end point is on the circle around the center of gyration
+    Point const center(cs, 0_m, -gyroRadius, 0_m);
+    CHECK((traj.GetPosition(1.) - center).norm() / gyroRadius == Approx(1));
+  }
+
+  SECTION("negative charges bend the other way") {
+    environment::UniformMagneticField const field(
+        Vector<magnetic_flux_density_d>(cs, 0_T, 0_T, 1_T));
+    tracking_helix::TrackingHelix tracking(field);
+
+    auto p =
+        addParticle(particles::Code::MuMinus, MomentumVector(cs, {pMuon, 0_GeV, 0_GeV}));
+    auto const [traj, geomMaxLength, nextVol] = tracking.GetTrack(p);
+    [[maybe_unused]] auto dummy = geomMaxLength;
+    [[maybe_unused]] auto dummyVol = nextVol;
+    CHECK(traj.GetVelocity(traj.GetDuration()).GetComponents(cs)[1] > 0_m / 1_s);
+  }
+
+  SECTION("intersection with sphere") {
+    // gyro radius of about 100 m
+    environment::UniformMagneticField const field(
+        Vector<magnetic_flux_density_d>(cs, 0_T, 0_T, 0.033_T));
+    tracking_helix::TrackingHelix tracking(field, 1.);
+
+    auto p = addParticle(particles::Code::MuPlus,
+                         MomentumVector(cs, {pMuon / sqrt(2.), 0_GeV, pMuon / sqrt(2.)}));
+    auto const [traj, geomMaxLength, nextVol] = tracking.GetTrack(p);
+
+    CHECK(nextVol == &universe);
+    CHECK((traj.GetPosition(1.) - origin).norm() / radius == Approx(1).epsilon(1e-8));
+    CHECK(geomMaxLength / traj.GetLength() == Approx(1));
+    // the curved path is longer than the radius
+    CHECK(geomMaxLength > radius);
+  }
+}
@@ -0,0 +1,163 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#include <corsika/process/tracking_line/SphereBatch.h>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+using namespace corsika::geometry;
+using namespace corsika::units::si;
+
+namespace {
+
+  // The kernels work on chunks of fixed maximum size, so that all
+  // temporaries live on the stack (no heap allocation) and stay in L1.
+  constexpr Eigen::Index kChunk = 64;
+  typedef Eigen::Array<double, Eigen::Dynamic, 1, 0, kChunk, 1> ChunkArray;
+  typedef Eigen::Array<bool, Eigen::Dynamic, 1, 0, kChunk, 1> ChunkMask;
+
+  double const kInfinity = std::numeric_limits<double>::infinity();
+
+  /**
+   * Calls vFunction(begin, size, vDotDelta, discriminant, sqrtDiscriminant,
+   * invDenom) for consecutive chunks of the spheres in vSpheres, with the
+   * same arithmetic as the scalar TimeOfIntersection(Line, Sphere).
+   */
+  template <typename TFunction>
+  void ForEachChunk(Line const& vLine,
+                    corsika::process::tracking_line::SphereBatch const& vSpheres,
+                    TFunction&& vFunction) {
+    auto const& cs = vSpheres.GetCoordinateSystem();
+    Eigen::Vector3d const r0 = vLine.GetR0().GetCoordinates(cs).eVector;
+    Eigen::Vector3d const v = vLine.GetV0().GetComponents(cs).eVector;
+    double const vSqNorm = v.squaredNorm();
+    double const invDenom = 1 / vSqNorm;
+
+    ChunkArray vDotDelta, discriminant, sqDisc;
+    Eigen::Index const n = vSpheres.GetSize();
+    for (Eigen::Index begin = 0; begin < n; begin += kChunk) {
+      auto const size = std::min(kChunk, n - begin);
+      auto const dx = r0(0) - vSpheres.GetX().segment(begin, size);
+      auto const dy = r0(1) - vSpheres.GetY().segment(begin, size);
+      auto const dz = r0(2) - vSpheres.GetZ().segment(begin, size);
+      auto const r2 = vSpheres.GetRadiusSquared().segment(begin, size);
+
+      vDotDelta = v(0) * dx + v(1) * dy + v(2) * dz;
+      discriminant = vDotDelta * vDotDelta - vSqNorm * (dx * dx + dy * dy + dz * dz - r2);
+      sqDisc = discriminant.max(0.).sqrt();
+
+      vFunction(begin, size, vDotDelta, discriminant, sqDisc, invDenom);
+    }
+  }
+
+} // namespace
+
+namespace corsika::process::tracking_line {
+
+  void TimesOfIntersection(Line const& vLine, SphereBatch const& vSpheres,
+                           Eigen::ArrayXd& vEntry, Eigen::ArrayXd& vExit) {
+    double const nan = std::numeric_limits<double>::quiet_NaN();
+    vEntry.resize(vSpheres.GetSize());
+    vExit.resize(vSpheres.GetSize());
+
+    ForEachChunk(vLine, vSpheres,
+                 [&](auto begin, auto size, auto const& vDotDelta,
+                     auto const& discriminant, auto const& sqDisc, double invDenom) {
+                   auto const intersects = (discriminant > 0);
+                   vEntry.segment(begin, size) =
+                       intersects.select((-vDotDelta - sqDisc) * invDenom, nan);
+                   vExit.segment(begin, size) =
+                       intersects.select((-vDotDelta + sqDisc) * invDenom, nan);
+                 });
+  }
+
+  std::optional<std::pair<TimeType, std::size_t>> NearestEntry(
+      Line const& vLine, SphereBatch const& vSpheres) {
+    double tMin = kInfinity;
+    Eigen::Index index = -1;
+    ChunkArray t1;
+
+    ForEachChunk(vLine, vSpheres,
+                 [&](auto begin, auto size, auto const& vDotDelta,
+                     auto const& discriminant, auto const& sqDisc, double invDenom) {
+                   t1 = (-vDotDelta - sqDisc) * invDenom;
+                   t1 = (discriminant > 0 && t1 > 0).select(t1, kInfinity);
+                   if (double const chunkMin = t1.minCoeff(); chunkMin < tMin) {
+                     tMin = chunkMin;
+                     // first one wins in case of equal times
+                     index = begin + (std::find(t1.data(), t1.data() + size, chunkMin) -
+                                      t1.data());
+                   }
+                 });
+
+    if (index < 0) { return {}; }
+    return std::make_pair(TimeType(phys::units::detail::magnitude_tag, tMin),
+                          std::size_t(index));
+  }
+
+  void NearestEntries(LineBatch const& vLines, SphereBatch const& vSpheres,
+                      Eigen::ArrayXd& vTime, Eigen::ArrayXi& vIndex) {
+    if (&vLines.GetCoordinateSystem() != &vSpheres.GetCoordinateSystem()) {
+      throw std::runtime_error(
+          "NearestEntries: LineBatch and SphereBatch need the same coordinate system");
+    }
+
+    Eigen::Index const n = vLines.GetSize();
+    Eigen::Index const nSpheres = vSpheres.GetSize();
+    vTime.resize(n);
+    vIndex.resize(n);
+
+    auto const cx = vSpheres.GetX();
+    auto const cy = vSpheres.GetY();
+    auto const cz = vSpheres.GetZ();
+    auto const r2 = vSpheres.GetRadiusSquared();
+
+    ChunkArray x, y, z, vx, vy, vz, vSqNorm, invDenom;
+    ChunkArray vDotDelta, discriminant, t1, time;
+    Eigen::Array<int, Eigen::Dynamic, 1, 0, kChunk, 1> index;
+    ChunkMask closer;
+
+    // the particles are the inner (SIMD) dimension, a chunk of them is kept
+    // in L1 while looping over all spheres
+    for (Eigen::Index begin = 0; begin < n; begin += kChunk) {
+      auto const size = std::min(kChunk, n - begin);
+      x = vLines.GetX().segment(begin, size);
+      y = vLines.GetY().segment(begin, size);
+      z = vLines.GetZ().segment(begin, size);
+      vx = vLines.GetVX().segment(begin, size);
+      vy = vLines.GetVY().segment(begin, size);
+      vz = vLines.GetVZ().segment(begin, size);
+      vSqNorm = vx * vx + vy * vy + vz * vz;
+      invDenom = vSqNorm.inverse();
+      time.setConstant(size, kInfinity);
+      index.setConstant(size, -1);
+
+      for (Eigen::Index i = 0; i < nSpheres; ++i) {
+        auto const dx = x - cx(i);
+        auto const dy = y - cy(i);
+        auto const dz = z - cz(i);
+        vDotDelta = vx * dx + vy * dy + vz * dz;
+        discriminant =
+            vDotDelta * vDotDelta - vSqNorm * (dx * dx + dy * dy + dz * dz - r2(i));
+        t1 = (-vDotDelta - discriminant.max(0.).sqrt()) * invDenom;
+
+        closer = (discriminant > 0) && (t1 > 0) && (t1 < time);
+        time = closer.select(t1, time);
+        index = closer.select(int(i), index);
+      }
+
+      vTime.segment(begin, size) = time;
+      vIndex.segment(begin, size) = index;
+    }
+  }
+
+} // namespace corsika::process::tracking_line
@@ -0,0 +1,147 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_corsika_processes_TrackingLine_SphereBatch_h_
+#define _include_corsika_processes_TrackingLine_SphereBatch_h_
+
+#include <corsika/geometry/CoordinateSystem.h>
+#include <corsika/geometry/Line.h>
+#include <corsika/geometry/Sphere.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <Eigen/Core>
+
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace corsika::process::tracking_line {
+
+  typedef Eigen::Map<Eigen::ArrayXd const> ConstArrayMap;
+
+  /**
+   * A set of spheres stored as structure of arrays, with all centres given
+   * in one common coordinate system. The centres are transformed once, when
+   * a sphere is added, so that the intersection kernels below only have
+   * to transform the line, and can process the spheres with SIMD packets.
+   *
+   * All numbers are stored as bare magnitudes of the phys::units
+   * quantities.
+   */
+  class SphereBatch {
+  public:
+    SphereBatch(geometry::CoordinateSystem const& vCS)
+        : fCS(&vCS) {}
+
+    void Add(geometry::Sphere const& vSphere) {
+      auto const center = vSphere.GetCenter().GetCoordinates(*fCS).eVector;
+      auto const radius = vSphere.GetRadius().magnitude();
+      fX.push_back(center(0));
+      fY.push_back(center(1));
+      fZ.push_back(center(2));
+      fR2.push_back(radius * radius);
+    }
+
+    void Clear() {
+      fX.clear();
+      fY.clear();
+      fZ.clear();
+      fR2.clear();
+    }
+
+    std::size_t GetSize() const { return fX.size(); }
+    geometry::CoordinateSystem const& GetCoordinateSystem() const { return *fCS; }
+
+    ConstArrayMap GetX() const { return {fX.data(), long(fX.size())}; }
+    ConstArrayMap GetY() const { return {fY.data(), long(fY.size())}; }
+    ConstArrayMap GetZ() const { return {fZ.data(), long(fZ.size())}; }
+    ConstArrayMap GetRadiusSquared() const { return {fR2.data(), long(fR2.size())}; }
+
+  private:
+    geometry::CoordinateSystem const* fCS;
+    std::vector<double> fX, fY, fZ, fR2;
+  };
+
+  /**
+   * Many straight lines (start point and velocity), stored as structure of
+   * arrays in one common coordinate system, to be intersected with the same
+   * SphereBatch at once.
+   */
+  class LineBatch {
+  public:
+    LineBatch(geometry::CoordinateSystem const& vCS)
+        : fCS(&vCS) {}
+
+    void Add(geometry::Line const& vLine) {
+      auto const r0 = vLine.GetR0().GetCoordinates(*fCS).eVector;
+      auto const v0 = vLine.GetV0().GetComponents(*fCS).eVector;
+      Add(r0(0), r0(1), r0(2), v0(0), v0(1), v0(2));
+    }
+
+    /// a line given by its start point and velocity in GetCoordinateSystem()
+    void Add(double const vX, double const vY, double const vZ, double const vVX,
+             double const vVY, double const vVZ) {
+      fX.push_back(vX);
+      fY.push_back(vY);
+      fZ.push_back(vZ);
+      fVX.push_back(vVX);
+      fVY.push_back(vVY);
+      fVZ.push_back(vVZ);
+    }
+
+    void Clear() {
+      for (auto* v : {&fX, &fY, &fZ, &fVX, &fVY, &fVZ}) { v->clear(); }
+    }
+
+    std::size_t GetSize() const { return fX.size(); }
+    geometry::CoordinateSystem const& GetCoordinateSystem() const { return *fCS; }
+
+    ConstArrayMap GetX() const { return {fX.data(), long(fX.size())}; }
+    ConstArrayMap GetY() const { return {fY.data(), long(fY.size())}; }
+    ConstArrayMap GetZ() const { return {fZ.data(), long(fZ.size())}; }
+    ConstArrayMap GetVX() const { return {fVX.data(), long(fVX.size())}; }
+    ConstArrayMap GetVY() const { return {fVY.data(), long(fVY.size())}; }
+    ConstArrayMap GetVZ() const { return {fVZ.data(), long(fVZ.size())}; }
+
+  private:
+    geometry::CoordinateSystem const* fCS;
+    std::vector<double> fX, fY, fZ, fVX, fVY, fVZ;
+  };
+
+  /**
+   * Batched version of TimeOfIntersection(Line, Sphere): computes for all
+   * spheres in \p vSpheres the entry and exit times (in units of s) of
+   * \p vLine. Spheres that are not intersected get NaN.
+   */
+  void TimesOfIntersection(geometry::Line const& vLine, SphereBatch const& vSpheres,
+                           Eigen::ArrayXd& vEntry, Eigen::ArrayXd& vExit);
+
+  /**
+   * Returns the earliest positive entry time of \p vLine into any sphere of
+   * \p vSpheres, together with the index of that sphere. For equal times
+   * the lower index wins.
+   */
+  std::optional<std::pair<units::si::TimeType, std::size_t>> NearestEntry(
+      geometry::Line const& vLine, SphereBatch const& vSpheres);
+
+  /**
+   * Many-particle version of NearestEntry: for every line of \p vLines,
+   * \p vTime receives the earliest positive entry time (in units of s,
+   * infinity if none) and \p vIndex the index of the sphere (-1 if none).
+   * The loop over the spheres is the outer one, so that the particles are
+   * processed in SIMD packets.
+   */
+  void NearestEntries(LineBatch const& vLines, SphereBatch const& vSpheres,
+                      Eigen::ArrayXd& vTime, Eigen::ArrayXi& vIndex);
+
+} // namespace corsika::process::tracking_line
+
+#endif
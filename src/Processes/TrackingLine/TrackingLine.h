@@ -13,13 +13,19 @@
 
 #include <corsika/geometry/Line.h>
 #include <corsika/geometry/Plane.h>
+#include <corsika/geometry/RootCoordinateSystem.h>
 #include <corsika/geometry/Sphere.h>
 #include <corsika/geometry/Trajectory.h>
 #include <corsika/geometry/Vector.h>
+#include <corsika/process/tracking_line/SphereBatch.h>
 #include <corsika/units/PhysicalUnits.h>
+#include <corsika/utl/StepArena.h>
+#include <memory_resource>
 #include <optional>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace corsika::environment {
   template <typename IEnvironmentModel>
@@ -77,30 +83,21 @@ namespace corsika::process {
         auto const& children = currentLogicalVolumeNode->GetChildNodes();
         auto const& excluded = currentLogicalVolumeNode->GetExcludedNodes();
 
-        std::vector<std::pair<TimeType, decltype(p.GetNode())>> intersections;
-
-        // for entering from outside
-        auto addIfIntersects = [&](auto const& vtn) {
-          auto const& volume = vtn.GetVolume();
-          auto const& sphere = dynamic_cast<geometry::Sphere const&>(
-              volume); // for the moment we are a bit bold here and assume
-          // everything is a sphere, crashes with exception if not
-
-          if (auto opt = TimeOfIntersection(line, sphere); opt.has_value()) {
-            auto const [t1, t2] = *opt;
-            std::cout << "intersection times: " << t1 / 1_s << "; "
-                      << t2 / 1_s
-                      // << " " << vtn.GetModelProperties().GetName()
-                      << std::endl;
-            if (t1.magnitude() > 0)
-              intersections.emplace_back(t1, &vtn);
-            else if (t2.magnitude() > 0)
-              std::cout << "inside other volume" << std::endl;
+        std::pmr::vector<std::pair<TimeType, decltype(p.GetNode())>> intersections(
+            utl::GetStepResource());
+
+        // for entering from outside: all daughters at once, see SphereBatch
+        if (auto const nearest =
+                NearestEntry(line, GetDaughterSpheres(*currentLogicalVolumeNode));
+            nearest.has_value()) {
+          auto const [t1, index] = *nearest;
+          std::cout << "intersection time: " << t1 / 1_s << std::endl;
+          if (index < children.size()) {
+            intersections.emplace_back(t1, children[index].get());
+          } else {
+            intersections.emplace_back(t1, excluded[index - children.size()]);
           }
-        };
-
-        for (auto const& child : children) { addIfIntersects(*child); }
-        for (auto const* ex : excluded) { addIfIntersects(*ex); }
+        }
 
         {
           auto const& sphere = dynamic_cast<geometry::Sphere const&>(
@@ -134,6 +131,114 @@ namespace corsika::process {
         return std::make_tuple(geometry::Trajectory<geometry::Line>(line, min),
                                velocity.norm() * min, minIter->second);
       }
+
+      /**
+       * Batched GetTrack() for Cascade::RunBatched: sets the geometric step
+       * length and the next volume of all particles of \p vBatch, which are
+       * in the same volume, with the SIMD kernels of SphereBatch.
+       */
+      template <typename TBatch>
+      void GetTracks(TBatch& vBatch) {
+        auto const& node = *vBatch.GetNode();
+        auto const& rootCS =
+            geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+        double const c = corsika::units::constants::c.magnitude();
+
+        Eigen::ArrayXd const vx = vBatch.GetMomentumX() / vBatch.GetEnergy() * c;
+        Eigen::ArrayXd const vy = vBatch.GetMomentumY() / vBatch.GetEnergy() * c;
+        Eigen::ArrayXd const vz = vBatch.GetMomentumZ() / vBatch.GetEnergy() * c;
+        auto const& x = vBatch.GetX();
+        auto const& y = vBatch.GetY();
+        auto const& z = vBatch.GetZ();
+
+        LineBatch lines(rootCS);
+        for (Eigen::Index i = 0; i < x.size(); ++i) {
+          lines.Add(x[i], y[i], z[i], vx[i], vy[i], vz[i]);
+        }
+        NearestEntries(lines, GetDaughterSpheres(node), fEntryTime, fEntryIndex);
+
+        // exit from the current volume
+        auto const& sphere = dynamic_cast<geometry::Sphere const&>(node.GetVolume());
+        auto const center = sphere.GetCenter().GetCoordinates(rootCS).eVector;
+        double const r = sphere.GetRadius().magnitude();
+        Eigen::ArrayXd const dx = x - center(0);
+        Eigen::ArrayXd const dy = y - center(1);
+        Eigen::ArrayXd const dz = z - center(2);
+        Eigen::ArrayXd const vSqNorm = vx * vx + vy * vy + vz * vz;
+        Eigen::ArrayXd const vDotDelta = vx * dx + vy * dy + vz * dz;
+        Eigen::ArrayXd const discriminant =
+            vDotDelta * vDotDelta - vSqNorm * (dx * dx + dy * dy + dz * dz - r * r);
+        Eigen::ArrayXd const exitTime =
+            (-vDotDelta + discriminant.max(0.).sqrt()) / vSqNorm;
+
+        auto const& children = node.GetChildNodes();
+        auto const& excluded = node.GetExcludedNodes();
+        auto& nextNode = vBatch.GetNextNode();
+        auto& length = vBatch.GetStepLength();
+        for (Eigen::Index i = 0; i < x.size(); ++i) {
+          double time = exitTime[i];
+          nextNode[i] = node.GetParent();
+          if (int const index = fEntryIndex[i]; index >= 0 && fEntryTime[i] < time) {
+            time = fEntryTime[i];
+            nextNode[i] = std::size_t(index) < children.size()
+                              ? children[index].get()
+                              : excluded[index - children.size()];
+          }
+          length[i] = std::sqrt(vSqNorm[i]) * time;
+        }
+      }
+
+    private:
+      /**
+       * Returns the spheres of the child and excluded nodes of \p vNode (in
+       * this order) as SphereBatch. The batch is built once per node and
+       * rebuilt only if the daughters of the node change.
+       */
+      template <typename TNode>
+      SphereBatch const& GetDaughterSpheres(TNode const& vNode) {
+        auto const& children = vNode.GetChildNodes();
+        auto const& excluded = vNode.GetExcludedNodes();
+        auto const& rootCS =
+            geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+        auto& cache = fDaughterCache.try_emplace(&vNode, rootCS).first->second;
+
+        auto& nodes = cache.fNodes;
+        bool upToDate = (nodes.size() == children.size() + excluded.size());
+        for (size_t i = 0; upToDate && i < children.size(); ++i) {
+          upToDate = (nodes[i] == children[i].get());
+        }
+        for (size_t i = 0; upToDate && i < excluded.size(); ++i) {
+          upToDate = (nodes[children.size() + i] == excluded[i]);
+        }
+
+        if (!upToDate) {
+          auto& spheres = cache.fSpheres;
+          nodes.clear();
+          spheres.Clear();
+          auto add = [&](auto const& vtn) {
+            // for the moment we are a bit bold here and assume
+            // everything is a sphere, crashes with exception if not
+            spheres.Add(dynamic_cast<geometry::Sphere const&>(vtn.GetVolume()));
+            nodes.push_back(&vtn);
+          };
+          for (auto const& child : children) { add(*child); }
+          for (auto const* ex : excluded) { add(*ex); }
+        }
+
+        return cache.fSpheres;
+      }
+
+      struct DaughterCache {
+        DaughterCache(geometry::CoordinateSystem const& vCS)
+            : fSpheres(vCS) {}
+
+        std::vector<void const*> fNodes; //!< the nodes belonging to fSpheres
+        SphereBatch fSpheres;
+      };
+
+      std::unordered_map<void const*, DaughterCache> fDaughterCache;
+      Eigen::ArrayXd fEntryTime; //!< work space of GetTracks()
+      Eigen::ArrayXi fEntryIndex;
     };
 
   } // namespace tracking_line
@@ -0,0 +1,98 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+/**
+ * Micro benchmark of the line-sphere intersection: the scalar
+ * TimeOfIntersection(Line, Sphere), called once per daughter volume, versus
+ * the batched SphereBatch kernels.
+ */
+
+#include <corsika/process/tracking_line/SphereBatch.h>
+#include <corsika/process/tracking_line/TrackingLine.h>
+#include <corsika/testing/Benchmark.h>
+
+#include <corsika/geometry/Line.h>
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/geometry/Sphere.h>
+#include <corsika/geometry/Vector.h>
+
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace corsika;
+using namespace corsika::geometry;
+using namespace corsika::process::tracking_line;
+using namespace corsika::units::si;
+using corsika::testing::RunBenchmark;
+
+int main() {
+  auto const& rootCS = RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> uniform(-1, 1);
+
+  auto randomLine = [&]() {
+    return Line(Point(rootCS, {uniform(rng) * 1_km, uniform(rng) * 1_km, 0_m}),
+                Vector<SpeedType::dimension_type>(rootCS, uniform(rng) * 1_m / 1_s,
+                                                  uniform(rng) * 1_m / 1_s, 1_m / 1_s));
+  };
+
+  for (size_t const nSpheres : {4, 16, 64, 256}) {
+    std::vector<Sphere> spheres;
+    SphereBatch batch(rootCS);
+    for (size_t i = 0; i < nSpheres; ++i) {
+      spheres.emplace_back(Point(rootCS, {uniform(rng) * 1_km, uniform(rng) * 1_km,
+                                          (uniform(rng) + 2) * 1_km}),
+                           (uniform(rng) + 2) * 100_m);
+      batch.Add(spheres.back());
+    }
+
+    Line const line = randomLine();
+    std::string const suffix = " (" + std::to_string(nSpheres) + " spheres)";
+
+    RunBenchmark("scalar TimeOfIntersection" + suffix, [&]() {
+      auto tMin = std::numeric_limits<double>::infinity() * 1_s;
+      for (auto const& sphere : spheres) {
+        if (auto const opt = TimeOfIntersection(line, sphere);
+            opt && opt->first > 0_s && opt->first < tMin) {
+          tMin = opt->first;
+        }
+      }
+      testing::DoNotOptimize(tMin);
+    });
+
+    RunBenchmark("batched NearestEntry" + suffix, [&]() {
+      testing::DoNotOptimize(NearestEntry(line, batch));
+    });
+
+    size_t const nLines = 1024;
+    std::vector<Line> lines;
+    LineBatch lineBatch(rootCS);
+    for (size_t i = 0; i < nLines; ++i) {
+      lines.push_back(randomLine());
+      lineBatch.Add(lines.back());
+    }
+    std::string const manySuffix = " (" + std::to_string(nLines) + " lines, " +
+                                   std::to_string(nSpheres) + " spheres)";
+
+    RunBenchmark("per-line NearestEntry" + manySuffix, [&]() {
+      for (auto const& l : lines) { testing::DoNotOptimize(NearestEntry(l, batch)); }
+    });
+
+    Eigen::ArrayXd times;
+    Eigen::ArrayXi indices;
+    RunBenchmark("batched NearestEntries" + manySuffix, [&]() {
+      NearestEntries(lineBatch, batch, times, indices);
+      testing::DoNotOptimize(times);
+    });
+  }
+}
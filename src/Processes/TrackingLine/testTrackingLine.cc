@@ -8,6 +8,7 @@
  * the license.
  */
 
+#include <corsika/process/tracking_line/SphereBatch.h>
 #include <corsika/process/tracking_line/TrackingLine.h>
 #include <testTrackingLineStack.h> // test-build, and include file is obtained from CMAKE_CURRENT_SOURCE_DIR
 
@@ -97,4 +98,117 @@ TEST_CASE("TrackingLine") {
                 .norm()
                 .magnitude() == Approx(0).margin(1e-4));
   }
+
+  SECTION("batched intersection with spheres") {
+    auto const translatedCS = cs.translate({1_m, 2_m, 3_m});
+    auto const rotatedCS =
+        translatedCS.rotate(QuantityVector<length_d>{0_m, 1_m, 1_m}, 0.3);
+    std::vector<Sphere> spheres;
+    spheres.emplace_back(Point(cs, {0_m, 0_m, 10_m}), 1_m);
+    spheres.emplace_back(Point(cs, {5_m, 0_m, 10_m}), 1_m); // missed
+    spheres.emplace_back(Point(rotatedCS, {0_m, 0_m, 0_m}), 2_m);
+    spheres.emplace_back(Point(cs, {0_m, 0_m, -1_m}), 3_m);  // contains origin
+    spheres.emplace_back(Point(cs, {0_m, 0.5_m, 5_m}), 1_m); // nearest
+    spheres.emplace_back(Point(cs, {0_m, 0_m, -20_m}), 1_m); // behind
+
+    tracking_line::SphereBatch batch(cs);
+    for (auto const& sphere : spheres) { batch.Add(sphere); }
+    REQUIRE(batch.GetSize() == spheres.size());
+
+    Point const origin(cs, {0_m, 0_m, 0_m});
+    Vector<SpeedType::dimension_type> const v(cs, 0_m / second, 0.1_m / second,
+                                              2_m / second);
+    Line const line(origin, v);
+
+    Eigen::ArrayXd entry, exit;
+    tracking_line::TimesOfIntersection(line, batch, entry, exit);
+    REQUIRE(entry.size() == long(spheres.size()));
+
+    for (size_t i = 0; i < spheres.size(); ++i) {
+      auto const opt = tracking_line::TimeOfIntersection(line, spheres[i]);
+      REQUIRE(opt.has_value() == !std::isnan(entry(i)));
+      if (opt) {
+        CHECK(entry(i) == Approx(opt->first / 1_s));
+        CHECK(exit(i) == Approx(opt->second / 1_s));
+      }
+    }
+
+    auto const nearest = tracking_line::NearestEntry(line, batch);
+    REQUIRE(nearest.has_value());
+    CHECK(nearest->second == 4);
+    CHECK(nearest->first / 1_s ==
+          Approx(tracking_line::TimeOfIntersection(line, spheres[4])->first / 1_s));
+
+    // backwards only the sphere behind is entered
+    Line const backwards(origin, v * -1);
+    CHECK(tracking_line::NearestEntry(backwards, batch)->second == 5);
+
+    // empty batch
+    CHECK_FALSE(tracking_line::NearestEntry(line, tracking_line::SphereBatch(cs)));
+
+    // many lines at once
+    tracking_line::LineBatch lines(cs);
+    std::vector<Line> lineVector{line, backwards,
+                                 Line(Point(cs, {10_m, 0_m, 0_m}), v),
+                                 Line(Point(rotatedCS, {0_m, 0_m, -5_m}), v)};
+    for (auto const& l : lineVector) { lines.Add(l); }
+
+    Eigen::ArrayXd times;
+    Eigen::ArrayXi indices;
+    tracking_line::NearestEntries(lines, batch, times, indices);
+    for (size_t i = 0; i < lineVector.size(); ++i) {
+      auto const single = tracking_line::NearestEntry(lineVector[i], batch);
+      REQUIRE(single.has_value() == (indices(i) >= 0));
+      if (single) {
+        CHECK(indices(i) == long(single->second));
+        CHECK(times(i) == Approx(single->first / 1_s));
+      } else {
+        CHECK(std::isinf(times(i)));
+      }
+    }
+
+    REQUIRE_THROWS(
+        tracking_line::NearestEntries(tracking_line::LineBatch(rotatedCS), batch,
+                                      times, indices));
+  }
+
+  SECTION("entering daughter volumes") {
+    auto& universe = *(env.GetUniverse());
+    using TEnv = environment::Environment<environment::Empty>;
+
+    auto farChild = TEnv::CreateNode<Sphere>(Point{cs, 0_m, 0_m, 50_m}, 5_m);
+    auto const* farChildPtr = farChild.get();
+    universe.AddChild(std::move(farChild));
+
+    TestTrackingLineStack stack;
+    stack.AddParticle(
+        std::tuple<particles::Code, units::si::HEPEnergyType,
+                   corsika::stack::MomentumVector, geometry::Point, units::si::TimeType>{
+            particles::Code::MuPlus,
+            1_GeV,
+            {cs, {0_GeV, 0_GeV, 1_GeV}},
+            {cs, {0_m, 0_m, 0_m}},
+            0_ns});
+    auto p = stack.GetNextParticle();
+    p.SetNode(&universe);
+
+    {
+      auto const [traj, length, nextVol] = tracking.GetTrack(p);
+      CHECK(nextVol == farChildPtr);
+      CHECK(length / 45_m == Approx(1).epsilon(1e-4));
+      [[maybe_unused]] auto dummy_traj = traj;
+    }
+
+    // a new daughter must not be hidden by the cached SphereBatch
+    auto nearChild = TEnv::CreateNode<Sphere>(Point{cs, 0_m, 0_m, 20_m}, 5_m);
+    auto const* nearChildPtr = nearChild.get();
+    universe.AddChild(std::move(nearChild));
+
+    {
+      auto const [traj, length, nextVol] = tracking.GetTrack(p);
+      CHECK(nextVol == nearChildPtr);
+      CHECK(length / 15_m == Approx(1).epsilon(1e-4));
+      [[maybe_unused]] auto dummy_traj = traj;
+    }
+  }
 }
@@ -9,14 +9,17 @@
  */
 
 #include <corsika/geometry/QuantityVector.h>
+#include <corsika/geometry/RootCoordinateSystem.h>
 #include <corsika/geometry/Vector.h>
 #include <corsika/particles/ParticleProperties.h>
 #include <corsika/process/urqmd/UrQMD.h>
 #include <corsika/units/PhysicalUnits.h>
+#include <corsika/utl/StepArena.h>
 
 #include <algorithm>
 #include <functional>
 #include <iostream>
+#include <memory_resource>
 #include <random>
 
 using namespace corsika::process::UrQMD;
@@ -124,13 +127,16 @@ corsika::process::EProcessReturn UrQMD::DoInteraction(SetupProjectile& vProjecti
   auto const& projectileMomentumLab = vProjectile.GetMomentum();
   auto const& projectilePosition = vProjectile.GetPosition();
   auto const projectileTime = vProjectile.GetTime();
+  geometry::CoordinateSystem const& rootCS =
+      geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+  auto const projectileCoordinates = projectilePosition.GetCoordinates(rootCS);
 
   // sample target particle
   auto const& mediumComposition =
       vProjectile.GetNode()->GetModelProperties().GetNuclearComposition();
   auto const componentCrossSections = std::invoke([&]() {
     auto const& components = mediumComposition.GetComponents();
-    std::vector<CrossSectionType> crossSections;
+    std::pmr::vector<CrossSectionType> crossSections(corsika::utl::GetStepResource());
     crossSections.reserve(components.size());
 
     for (auto const c : components) {
@@ -216,13 +222,13 @@ corsika::process::EProcessReturn UrQMD::DoInteraction(SetupProjectile& vProjecti
             1_GeV);
 
     auto const energy = sqrt(momentum.squaredNorm() + square(particles::GetMass(code)));
+    if (fSecondaryFilter && fSecondaryFilter(code, energy, projectileTime)) continue;
 
     momentum.rebase(originalCS); // transform back into standard lab frame
     std::cout << i << " " << code << " " << momentum.GetComponents() << std::endl;
 
-    vProjectile.AddSecondary(
-        std::tuple<particles::Code, HEPEnergyType, stack::MomentumVector, geometry::Point,
-                   TimeType>{code, energy, momentum, projectilePosition, projectileTime});
+    vProjectile.EmplaceSecondary(code, energy, momentum.GetComponents(rootCS),
+                                 projectileCoordinates, projectileTime);
   }
 
   std::cout << "UrQMD generated " << sys_.npart << " secondaries!" << std::endl;
@@ -234,80 +240,38 @@ corsika::process::EProcessReturn UrQMD::DoInteraction(SetupProjectile& vProjecti
  * the random number generator function of UrQMD
  */
 double corsika::process::UrQMD::ranf_(int&) {
-  static corsika::random::RNG& rng =
-      corsika::random::RNGManager::GetInstance().GetRandomStream("UrQMD");
-  static std::uniform_real_distribution<double> dist;
+  static corsika::random::UniformBuffer<corsika::random::RNG>& buffer =
+      corsika::random::RNGManager::GetInstance().GetUniformBuffer("UrQMD");
 
-  return dist(rng);
+  return buffer();
 }
 
 corsika::particles::Code corsika::process::UrQMD::ConvertFromUrQMD(int vItyp, int vIso3) {
-  int const pdgInt =
-      pdgid_(vItyp, vIso3); // use the conversion function provided by UrQMD
-  if (pdgInt == 0) {        // pdgid_ returns 0 on error
-    throw std::runtime_error("UrQMD pdgid() returned 0");
+  auto const row = vItyp - minUrQMDItyp;
+  auto const column = vIso3 - minUrQMDIso3;
+  if (row >= 0 && row < int(urqmd2corsika.size()) && column >= 0 &&
+      column < int(urqmd2corsika[0].size())) {
+    if (auto const code = urqmd2corsika[row][column];
+        code != corsika::particles::Code::Unknown) {
+      return code;
+    }
   }
-  auto const pdg = static_cast<particles::PDGCode>(pdgInt);
-  return particles::ConvertFromPDG(pdg);
+
+  throw std::runtime_error(std::string("UrQMD/CORSIKA conversion of (")
+                               .append(std::to_string(vItyp))
+                               .append(", ")
+                               .append(std::to_string(vIso3))
+                               .append(") impossible"));
 }
 
 std::pair<int, int> corsika::process::UrQMD::ConvertToUrQMD(
     corsika::particles::Code code) {
-  static const std::map<int, std::pair<int, int>> mapPDGToUrQMD{
-      // data mostly from github.com/afedynitch/ParticleDataTool
-      {22, {100, 0}},      // gamma
-      {111, {101, 0}},     // pi0
-      {211, {101, 2}},     // pi+
-      {-211, {101, -2}},   // pi-
-      {321, {106, 1}},     // K+
-      {-321, {-106, -1}},  // K-
-      {311, {106, -1}},    // K0
-      {-311, {-106, 1}},   // K0bar
-      {2212, {1, 1}},      // p
-      {2112, {1, -1}},     // n
-      {-2212, {-1, -1}},   // pbar
-      {-2112, {-1, 1}},    // nbar
-      {221, {102, 0}},     // eta
-      {213, {104, 2}},     // rho+
-      {-213, {104, -2}},   // rho-
-      {113, {104, 0}},     // rho0
-      {323, {108, 2}},     // K*+
-      {-323, {108, -2}},   // K*-
-      {313, {108, 0}},     // K*0
-      {-313, {-108, 0}},   // K*0-bar
-      {223, {103, 0}},     // omega
-      {333, {109, 0}},     // phi
-      {3222, {40, 2}},     // Sigma+
-      {3212, {40, 0}},     // Sigma0
-      {3112, {40, -2}},    // Sigma-
-      {3322, {49, 0}},     // Xi0
-      {3312, {49, -1}},    // Xi-
-      {3122, {27, 0}},     // Lambda0
-      {2224, {17, 4}},     // Delta++
-      {2214, {17, 2}},     // Delta+
-      {2114, {17, 0}},     // Delta0
-      {1114, {17, -2}},    // Delta-
-      {3224, {41, 2}},     // Sigma*+
-      {3214, {41, 0}},     // Sigma*0
-      {3114, {41, -2}},    // Sigma*-
-      {3324, {50, 0}},     // Xi*0
-      {3314, {50, -1}},    // Xi*-
-      {3334, {55, 0}},     // Omega-
-      {411, {133, 2}},     // D+
-      {-411, {133, -2}},   // D-
-      {421, {133, 0}},     // D0
-      {-421, {-133, 0}},   // D0-bar
-      {441, {107, 0}},     // etaC
-      {431, {138, 1}},     // Ds+
-      {-431, {138, -1}},   // Ds-
-      {433, {139, 1}},     // Ds*+
-      {-433, {139, -1}},   // Ds*-
-      {413, {134, 1}},     // D*+
-      {-413, {134, -1}},   // D*-
-      {10421, {134, 0}},   // D*0
-      {-10421, {-134, 0}}, // D*0-bar
-      {443, {135, 0}},     // jpsi
-  };
-
-  return mapPDGToUrQMD.at(static_cast<int>(GetPDG(code)));
+  auto const [ityp, iso3] =
+      corsika2urqmd[static_cast<corsika::particles::CodeIntType>(code)];
+  if (ityp == 0) {
+    throw std::runtime_error(std::string("UrQMD/CORSIKA conversion of ")
+                                 .append(corsika::particles::GetName(code))
+                                 .append(" impossible"));
+  }
+  return {ityp, iso3};
 }
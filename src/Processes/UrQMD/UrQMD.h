@@ -12,7 +12,9 @@
 #define _Processes_UrQMD_UrQMD_h
 
 #include <corsika/particles/ParticleProperties.h>
+#include <corsika/process/BaseProcess.h>
 #include <corsika/process/InteractionProcess.h>
+#include <corsika/process/SecondaryFilter.h>
 #include <corsika/random/RNGManager.h>
 #include <corsika/setup/SetupStack.h>
 #include <corsika/units/PhysicalUnits.h>
@@ -38,6 +40,14 @@ namespace corsika::process::UrQMD {
 
     bool CanInteract(particles::Code) const;
 
+    /**
+       Secondaries for which vFilter returns true are not written to
+       the stack, see SecondaryFilter.
+     */
+    void SetSecondaryFilter(corsika::process::SecondaryFilter vFilter) {
+      fSecondaryFilter = std::move(vFilter);
+    }
+
   private:
     static corsika::units::si::CrossSectionType GetCrossSection(
         particles::Code, particles::Code, corsika::units::si::HEPEnergyType, int);
@@ -45,6 +55,7 @@ namespace corsika::process::UrQMD {
         corsika::random::RNGManager::GetInstance().GetRandomStream("UrQMD");
 
     std::uniform_int_distribution<int> fBooleanDist{0, 1};
+    corsika::process::SecondaryFilter fSecondaryFilter;
   };
 
   namespace constants {
@@ -129,14 +140,31 @@ namespace corsika::process::UrQMD {
   extern struct { std::array<double, 3> xs, bim; } cxs_u2_;
   }
 
+#include <corsika/process/urqmd/Generated.inc>
+
   /**
-   * convert CORSIKA code to UrQMD code tuple
+   * convert CORSIKA code to UrQMD code tuple (ityp, iso3), by table look-up
    *
-   * In the current implementation a detour via the PDG code is made.
+   * \throws std::runtime_error if the particle is not available in UrQMD
    */
   std::pair<int, int> ConvertToUrQMD(particles::Code);
+
+  /**
+   * convert UrQMD code tuple (ityp, iso3) to CORSIKA code, by table look-up;
+   * the table has the same content as the UrQMD function pdgid()
+   *
+   * \throws std::runtime_error if there is no corresponding CORSIKA particle
+   */
   particles::Code ConvertFromUrQMD(int vItyp, int vIso3);
 
 } // namespace corsika::process::UrQMD
 
+namespace corsika::process {
+
+  /// UrQMD keeps its state in Fortran common blocks
+  template <>
+  struct is_thread_safe<UrQMD::UrQMD> : std::false_type {};
+
+} // namespace corsika::process
+
 #endif
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+
+# (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+#
+# See file AUTHORS for a list of contributors.
+#
+# This software is distributed under the terms of the GNU General Public
+# Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+# the license.
+
+
+import pickle, sys, re
+
+
+
+# loads the pickled particle_db (which is an OrderedDict)
+def load_particledb(filename):
+    with open(filename, "rb") as f:
+        particle_db = pickle.load(f)
+    return particle_db
+
+
+
+# reads the (ityp, iso3) of the particles that can be given to UrQMD as
+# projectile or target
+def read_urqmd_codes(filename, particle_db):
+    with open(filename) as f:
+        for line in f:
+            line = line.strip()
+            if len(line) == 0 or line[0] == '#':
+                continue
+            identifier, ityp, iso3 = line.split()[:3]
+            try:
+                particle_db[identifier]["urqmd_code"] = (int(ityp), int(iso3))
+            except KeyError as e:
+                raise Exception("Identifier '{:s}' not found in particle_db".format(identifier))
+
+
+
+# reads the table idtab (ityp, iso3, pdg) used by the UrQMD function pdgid()
+# from ityp2pdg.f
+def read_idtab(filename):
+    with open(filename) as f:
+        source = f.read()
+    
+    block = source[source.index("data idtab/"):]
+    block = block[len("data idtab/"):block.index("/", len("data idtab/"))]
+    
+    numbers = []
+    for line in block.splitlines():
+        if len(line) == 0 or line[0] in "cC!":
+            continue  # comment line
+        line = line[6:]  # column 6 is the continuation mark
+        numbers += [int(n) for n in re.findall(r"-?\d+", line)]
+
+    if len(numbers) % 3 != 0:
+        raise Exception("cannot parse idtab in {:s}".format(filename))
+    return [tuple(numbers[i:i+3]) for i in range(0, len(numbers), 3)]
+
+
+
+# generates the look-up table to convert corsika codes to (ityp, iso3)
+def generate_corsika2urqmd(particle_db):
+    string = "std::array<std::array<int, 2>, {:d}> constexpr corsika2urqmd = {{{{\n".format(len(particle_db))
+    for identifier, pData in particle_db.items():
+        ityp, iso3 = pData.get("urqmd_code", (0, 0))
+        string += "  {{{{{:d}, {:d}}}}}, // {:s}\n".format(ityp, iso3, identifier if ityp else identifier + " (not implemented in UrQMD)")
+    string += "}};\n"
+    return string
+
+
+
+# generates the look-up table to convert (ityp, iso3) to corsika codes, with
+# the same content as the UrQMD function pdgid()
+def generate_urqmd2corsika(particle_db, idtab):
+    pdg2identifier = {pData['pdg'] : identifier for identifier, pData in particle_db.items()}
+    
+    # pdgid() allows antiparticles (negative ityp) for baryons and for the
+    # mesons with half-integer isospin (odd iso3)
+    minmes = 100
+    entries = {}
+    for ityp, iso3, pdg in idtab:
+        entries.setdefault((ityp, iso3), pdg)
+        if ityp <= minmes or iso3 % 2 != 0:
+            entries.setdefault((-ityp, -iso3), -pdg)
+    
+    minItyp = min(ityp for ityp, iso3 in entries)
+    maxItyp = max(ityp for ityp, iso3 in entries)
+    minIso3 = min(iso3 for ityp, iso3 in entries)
+    maxIso3 = max(iso3 for ityp, iso3 in entries)
+    
+    string = "int constexpr minUrQMDItyp = {:d};\n".format(minItyp)
+    string += "int constexpr minUrQMDIso3 = {:d};\n\n".format(minIso3)
+    string += "std::array<std::array<corsika::particles::Code, {:d}>, {:d}> constexpr urqmd2corsika = {{{{\n".format(maxIso3 - minIso3 + 1, maxItyp - minItyp + 1)
+    for ityp in range(minItyp, maxItyp + 1):
+        codes = []
+        for iso3 in range(minIso3, maxIso3 + 1):
+            pdg = entries.get((ityp, iso3))
+            codes.append("corsika::particles::Code::" + pdg2identifier.get(pdg, "Unknown"))
+        string += "  {{{{{:s}}}}}, // ityp {:d}\n".format(", ".join(codes), ityp)
+    string += "}};\n"
+    return string
+
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 4:
+        print("usage: {:s} <particle_db.pkl> <urqmd_codes.dat> <ityp2pdg.f>".format(sys.argv[0]), file=sys.stderr)
+        sys.exit(1)
+        
+    print("code_generator.py for UrQMD")
+    
+    particle_db = load_particledb(sys.argv[1])
+    read_urqmd_codes(sys.argv[2], particle_db)
+    idtab = read_idtab(sys.argv[3])
+    
+    with open("Generated.inc", "w") as f:
+        print("// this file is automatically generated\n// edit at your own risk!\n", file=f)
+        print(generate_corsika2urqmd(particle_db), file=f)
+        print(generate_urqmd2corsika(particle_db, idtab), file=f)
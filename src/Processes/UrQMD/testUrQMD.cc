@@ -129,6 +129,18 @@ TEST_CASE("UrQMD") {
     REQUIRE(process::UrQMD::ConvertFromUrQMD(101, 0) == particles::Code::Pi0);
     REQUIRE(process::UrQMD::ConvertToUrQMD(particles::Code::PiPlus) ==
             std::make_pair<int, int>(101, 2));
+    REQUIRE(process::UrQMD::ConvertFromUrQMD(-1, -1) == particles::Code::AntiProton);
+    REQUIRE(process::UrQMD::ConvertFromUrQMD(-106, -1) == particles::Code::KMinus);
+    REQUIRE_THROWS(process::UrQMD::ConvertFromUrQMD(-101, 0));
+    REQUIRE_THROWS(process::UrQMD::ConvertFromUrQMD(1000, 0));
+    REQUIRE_THROWS(process::UrQMD::ConvertToUrQMD(particles::Code::Electron));
+
+    for (auto const code : {particles::Code::Proton, particles::Code::AntiNeutron,
+                            particles::Code::PiMinus, particles::Code::K0Bar,
+                            particles::Code::Lambda0, particles::Code::SigmaMinus}) {
+      auto const [ityp, iso3] = process::UrQMD::ConvertToUrQMD(code);
+      REQUIRE(process::UrQMD::ConvertFromUrQMD(ityp, iso3) == code);
+    }
   }
 
   feenableexcept(FE_INVALID);
@@ -17,6 +17,9 @@
 // extension with nuclear data for Code::Nucleus
 #include <corsika/stack/nuclear_extension/NuclearStackExtension.h>
 
+// extension with lineage keys for reproducible random numbers
+#include <corsika/stack/lineage/LineageStackExtension.h>
+
 // extension with geometry information for tracking
 #include <corsika/environment/Environment.h>
 #include <corsika/setup/SetupEnvironment.h>
@@ -126,10 +129,30 @@ namespace corsika::setup {
                                       GeometryData<setup::SetupEnvironment>,
                                       StackWithGeometryInterface>;
 
+    // add the lineage keys for reproducible random numbers
+    template <typename StackIter>
+    using StackWithLineageInterface = corsika::stack::CombinedParticleInterface<
+        StackWithGeometry::PIType, corsika::stack::lineage::LineageDataInterface,
+        StackIter>;
+
+    using StackWithLineage =
+        corsika::stack::CombinedStack<typename StackWithGeometry::StackImpl,
+                                      corsika::stack::lineage::LineageData,
+                                      StackWithLineageInterface>;
+
   } // namespace detail
 
-  // this is the REAL stack we use:
+  // this is the REAL stack we use, with the lineage keys (16 bytes per
+  // particle) only if configured WITH_LINEAGE_STACK for Cascade::SetLineageRNG
+#ifdef CORSIKA_LINEAGE_STACK
+  using Stack = detail::StackWithLineage;
+  template <typename StackIter>
+  using StackInterface = detail::StackWithLineageInterface<StackIter>;
+#else
   using Stack = detail::StackWithGeometry;
+  template <typename StackIter>
+  using StackInterface = detail::StackWithGeometryInterface<StackIter>;
+#endif
 
   /*
     See Issue 161
@@ -145,7 +168,7 @@ namespace corsika::setup {
 #if defined(__clang__)
   using StackView =
       corsika::stack::SecondaryView<typename corsika::setup::Stack::StackImpl,
-                                    corsika::setup::detail::StackWithGeometryInterface>;
+                                    corsika::setup::StackInterface>;
 #elif defined(__GNUC__) || defined(__GNUG__)
   using StackView = corsika::stack::MakeView<corsika::setup::Stack>::type;
 #endif
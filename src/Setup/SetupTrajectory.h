@@ -24,6 +24,9 @@ namespace corsika::setup {
   /// definition of Trajectory base class, to be used in tracking and cascades
   typedef corsika::geometry::Trajectory<corsika::geometry::Line> Trajectory;
 
+  /// trajectory of charged particles in a magnetic field, see TrackingHelix
+  typedef corsika::geometry::Trajectory<corsika::geometry::Helix> HelixTrajectory;
+
   /*
   typedef std::variant<std::monostate, corsika::geometry::Trajectory<Line>,
                        corsika::geometry::Trajectory<Helix>>
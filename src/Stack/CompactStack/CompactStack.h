@@ -0,0 +1,207 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_compactstack_h_
+#define _include_compactstack_h_
+
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/geometry/Vector.h>
+#include <corsika/particles/ParticleProperties.h>
+#include <corsika/stack/Stack.h>
+#include <corsika/stack/super_stupid/SuperStupidStack.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace corsika::stack {
+
+  namespace compact {
+
+    /**
+     * Memory implementation of a particle stack with a compile-time
+     * storage precision TFloat for momenta and positions.
+     *
+     * PID, energy and time are always stored as in SuperStupidStack, with
+     * double precision. Momenta are stored as TFloat components in the
+     * root coordinate system, positions as TFloat components relative to
+     * a per-stack reference point, so that the float resolution applies
+     * to the distance from there and not from the center of the
+     * earth. With TFloat = float one particle takes 48 bytes, compared to
+     * 72 bytes with double and 82 bytes in SuperStupidStack.
+     *
+     * The ParticleInterface is that of SuperStupidStack.
+     */
+    template <typename TFloat = float>
+    class CompactStackImpl {
+
+      static_assert(std::is_floating_point_v<TFloat>,
+                    "CompactStack: storage type must be floating point");
+
+    public:
+      /// the binary layout of one particle
+      struct ParticleRecord {
+        double fEnergy;
+        double fTime;
+        TFloat fMomentum[3];
+        TFloat fPosition[3]; //!< relative to the reference point
+        corsika::particles::Code fPID;
+      };
+
+      CompactStackImpl()
+          : fReference(Eigen::Vector3d::Zero()) {}
+
+      /// \param vReference the point positions are stored relative to
+      CompactStackImpl(corsika::geometry::Point const& vReference)
+          : fReference(vReference.GetCoordinates(GetRootCS())) {}
+
+      void Init() {}
+      void Dump() const {}
+
+      void Clear() { fData.clear(); }
+
+      unsigned int GetSize() const { return fData.size(); }
+      unsigned int GetCapacity() const { return fData.capacity(); }
+
+      void SetPID(const unsigned int i, const corsika::particles::Code id) {
+        fData[i].fPID = id;
+      }
+      void SetEnergy(const unsigned int i, const corsika::units::si::HEPEnergyType e) {
+        fData[i].fEnergy = e.magnitude();
+      }
+      void SetMomentum(const unsigned int i, const MomentumVector& v) {
+        Store(v.GetComponents(GetRootCS()).eVector, fData[i].fMomentum);
+      }
+      void SetPosition(const unsigned int i, const corsika::geometry::Point& v) {
+        Store((v.GetCoordinates(GetRootCS()) - fReference).eVector,
+              fData[i].fPosition);
+      }
+      void SetTime(const unsigned int i, const corsika::units::si::TimeType& v) {
+        fData[i].fTime = v.magnitude();
+      }
+
+      /// all data at once, momentum and position in the root coordinate system
+      void SetParticle(
+          const unsigned int i, const corsika::particles::Code id,
+          const corsika::units::si::HEPEnergyType e,
+          const geometry::QuantityVector<corsika::units::si::hepmomentum_d>& p,
+          const geometry::QuantityVector<corsika::units::si::length_d>& x,
+          const corsika::units::si::TimeType t) {
+        auto& r = fData[i];
+        r.fPID = id;
+        r.fEnergy = e.magnitude();
+        Store(p.eVector, r.fMomentum);
+        Store((x - fReference).eVector, r.fPosition);
+        r.fTime = t.magnitude();
+      }
+
+      corsika::particles::Code GetPID(const unsigned int i) const {
+        return fData[i].fPID;
+      }
+      corsika::units::si::HEPEnergyType GetEnergy(const unsigned int i) const {
+        return corsika::units::si::HEPEnergyType(phys::units::detail::magnitude_tag,
+                                                 fData[i].fEnergy);
+      }
+      MomentumVector GetMomentum(const unsigned int i) const {
+        return MomentumVector(
+            GetRootCS(), geometry::QuantityVector<corsika::units::si::hepmomentum_d>(
+                             Load(fData[i].fMomentum)));
+      }
+      corsika::geometry::Point GetPosition(const unsigned int i) const {
+        return corsika::geometry::Point(
+            GetRootCS(),
+            geometry::QuantityVector<corsika::units::si::length_d>(
+                Load(fData[i].fPosition)) +
+                fReference);
+      }
+      corsika::units::si::TimeType GetTime(const unsigned int i) const {
+        return corsika::units::si::TimeType(phys::units::detail::magnitude_tag,
+                                            fData[i].fTime);
+      }
+
+      /**
+       *   Function to copy particle at location i1 in stack to i2
+       */
+      void Copy(const unsigned int i1, const unsigned int i2) { fData[i2] = fData[i1]; }
+
+      /**
+       *   Function to swap particles at locations i1 and i2 in stack
+       */
+      void Swap(const unsigned int i1, const unsigned int i2) {
+        std::swap(fData[i1], fData[i2]);
+      }
+
+      void IncrementSize() {
+        fData.push_back(ParticleRecord{0, 0, {0, 0, 0}, {0, 0, 0},
+                                       corsika::particles::Code::Unknown});
+      }
+
+      void DecrementSize() {
+        if (!fData.empty()) { fData.pop_back(); }
+      }
+
+      /// @name reference point of the stored positions
+      /// @{
+      corsika::geometry::Point GetReferencePoint() const {
+        return corsika::geometry::Point(GetRootCS(), fReference);
+      }
+      /// the positions of the particles already on the stack are converted
+      void SetReferencePoint(corsika::geometry::Point const& vReference) {
+        auto const reference = vReference.GetCoordinates(GetRootCS());
+        Eigen::Vector3d const shift = (fReference - reference).eVector;
+        for (auto& r : fData) { Store(Load(r.fPosition) + shift, r.fPosition); }
+        fReference = reference;
+      }
+      /// @}
+
+    private:
+      static corsika::geometry::CoordinateSystem const& GetRootCS() {
+        return corsika::geometry::RootCoordinateSystem::GetInstance()
+            .GetRootCoordinateSystem();
+      }
+
+      static void Store(Eigen::Vector3d const& v, TFloat* vTarget) {
+        for (int k = 0; k < 3; ++k) { vTarget[k] = static_cast<TFloat>(v[k]); }
+      }
+      static Eigen::Vector3d Load(TFloat const* v) {
+        return Eigen::Vector3d(v[0], v[1], v[2]);
+      }
+
+      geometry::QuantityVector<corsika::units::si::length_d> fReference;
+      std::vector<ParticleRecord> fData;
+    }; // end class CompactStackImpl
+
+    /**
+     * The stack of CompactStackImpl, with access to its reference point.
+     */
+    template <typename TFloat = float>
+    class CompactStack
+        : public Stack<CompactStackImpl<TFloat>, super_stupid::ParticleInterface> {
+
+      using Base = Stack<CompactStackImpl<TFloat>, super_stupid::ParticleInterface>;
+
+    public:
+      using Base::Base;
+
+      corsika::geometry::Point GetReferencePoint() const {
+        return Base::GetStackData().GetReferencePoint();
+      }
+      void SetReferencePoint(corsika::geometry::Point const& vReference) {
+        Base::GetStackData().SetReferencePoint(vReference);
+      }
+    };
+
+  } // namespace compact
+
+} // namespace corsika::stack
+
+#endif
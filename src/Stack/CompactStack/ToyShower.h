@@ -0,0 +1,133 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_compactstack_toyshower_h_
+#define _include_compactstack_toyshower_h_
+
+/**
+ * A toy shower for the validation and the benchmark of CompactStack
+ * against double-precision stacks: every particle moves one step along
+ * its momentum and splits into two above an energy cut, until it reaches
+ * the ground. The random numbers are derived from the (double precision)
+ * energy of the particle, so that a stack with lower position or momentum
+ * precision sees the same sequence of splittings.
+ */
+
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/particles/ParticleProperties.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace corsika::stack::compact::toy {
+
+  struct ToyShowerResult {
+    std::vector<double> fProfile; //!< steps per height bin
+    std::vector<double> fGround;  //!< particles per core distance bin at the ground
+    double fSumDistance = 0;      //!< sum of core distances at the ground in m
+    std::size_t fNGround = 0;
+    std::size_t fNParticles = 0;
+  };
+
+  double constexpr kProfileBin = 1000;  // m
+  double constexpr kGroundBin = 10;     // m
+  int constexpr kNGroundBins = 100;
+
+  inline uint64_t SplitMix(uint64_t& vState) {
+    uint64_t z = (vState += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  inline double Uniform(uint64_t& vState) { return (SplitMix(vState) >> 11) * 0x1p-53; }
+
+  inline auto Momentum(units::si::HEPEnergyType const vE, Eigen::Vector3d const& vDir) {
+    return geometry::QuantityVector<units::si::hepmomentum_d>(
+        vE * vDir[0], vE * vDir[1], vE * vDir[2]);
+  }
+
+  template <typename TStack>
+  ToyShowerResult RunToyShower(TStack& vStack, units::si::HEPEnergyType const vE0,
+                               units::si::HEPEnergyType const vCut,
+                               units::si::LengthType const vHeight) {
+    using namespace corsika::units::si;
+    auto const& rootCS =
+        geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+
+    Eigen::Vector3d const axis = Eigen::Vector3d(0.3, 0.1, -1).normalized();
+    double const height = vHeight / 1_m;
+    Eigen::Vector3d const core = Eigen::Vector3d(0, 0, height) - height / axis[2] * axis;
+
+    ToyShowerResult result;
+    result.fProfile.assign(int(height / kProfileBin) + 1, 0);
+    result.fGround.assign(kNGroundBins + 1, 0);
+
+    vStack.Clear();
+    vStack.EmplaceParticle(particles::Code::Proton, vE0, Momentum(vE0, axis),
+                           geometry::QuantityVector<length_d>(0_m, 0_m, vHeight), 0_ns);
+
+    while (!vStack.IsEmpty()) {
+      auto const p = vStack.GetNextParticle();
+      HEPEnergyType const E = p.GetEnergy();
+      Eigen::Vector3d const x = p.GetPosition().GetCoordinates(rootCS).eVector;
+      Eigen::Vector3d const dir =
+          p.GetMomentum().GetComponents(rootCS).eVector.normalized();
+      TimeType const t = p.GetTime();
+      vStack.DeleteLast();
+      ++result.fNParticles;
+
+      double const e = E / 1_GeV;
+      uint64_t state;
+      std::memcpy(&state, &e, sizeof(state));
+      double const step = 300 * (0.5 + Uniform(state));
+
+      Eigen::Vector3d const xNew = x + step * dir;
+      if (xNew[2] < 0) {
+        Eigen::Vector3d const ground = x - x[2] / dir[2] * dir;
+        double const r = std::hypot(ground[0] - core[0], ground[1] - core[1]);
+        result.fGround[std::min(int(r / kGroundBin), kNGroundBins)] += 1;
+        result.fSumDistance += r;
+        ++result.fNGround;
+        continue;
+      }
+      result.fProfile[int(xNew[2] / kProfileBin)] += 1;
+      TimeType const tNew = t + step * 1_m / units::constants::c;
+      geometry::QuantityVector<length_d> const position(xNew);
+      if (E < vCut) { // no more splitting, but tracked to the ground
+        vStack.EmplaceParticle(particles::Code::Proton, E, Momentum(E, dir), position,
+                               tNew);
+        continue;
+      }
+
+      double const f = 0.1 + 0.8 * Uniform(state);
+      double const theta = 0.05 * Uniform(state);
+      double const phi = 2 * M_PI * Uniform(state);
+      Eigen::Vector3d const u = dir.unitOrthogonal();
+      Eigen::Vector3d const kick =
+          std::sin(theta) * (std::cos(phi) * u + std::sin(phi) * dir.cross(u));
+      for (auto const& [fraction, sign] : {std::pair{f, 1.}, std::pair{1 - f, -1.}}) {
+        Eigen::Vector3d const dirNew = (std::cos(theta) * dir + sign * kick).normalized();
+        vStack.EmplaceParticle(particles::Code::Proton, E * fraction,
+                               Momentum(E * fraction, dirNew), position, tNew);
+      }
+    }
+    return result;
+  }
+
+} // namespace corsika::stack::compact::toy
+
+#endif
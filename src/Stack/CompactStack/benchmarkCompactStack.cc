@@ -0,0 +1,98 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+/**
+ * Memory per particle and throughput of CompactStack<float>,
+ * CompactStack<double> and SuperStupidStack: filling the stack, a read
+ * pass over energy and position of all particles (memory bandwidth), and
+ * the toy shower of the validation test.
+ */
+
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/stack/compact/CompactStack.h>
+#include <corsika/stack/super_stupid/SuperStupidStack.h>
+#include <corsika/testing/Benchmark.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include "ToyShower.h"
+
+#include <iostream>
+#include <string>
+
+using namespace corsika;
+using namespace corsika::units::si;
+using corsika::stack::compact::CompactStack;
+using corsika::stack::compact::CompactStackImpl;
+using corsika::testing::DoNotOptimize;
+using corsika::testing::RunBenchmark;
+
+template <typename TStack>
+void Measure(std::string const& vName, std::size_t const vBytesPerParticle,
+             TStack& vStack) {
+  auto const& rootCS =
+      geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+  std::cout << vName << ": " << vBytesPerParticle << " bytes/particle" << std::endl;
+
+  int const n = 1 << 20;
+  auto const fill = RunBenchmark(vName + ", fill", [&]() {
+    vStack.Clear();
+    for (int i = 0; i < n; ++i) {
+      vStack.EmplaceParticle(particles::Code::Proton, i * 1_GeV,
+                             geometry::QuantityVector<hepmomentum_d>(0_GeV, 0_GeV, 1_GeV),
+                             geometry::QuantityVector<length_d>(1_m, 2_m, i * 1_m), 0_ns);
+    }
+  });
+  std::cout << "  " << fill.fNanoSecondsPerIteration / n << " ns/particle" << std::endl;
+
+  auto const read = RunBenchmark(vName + ", read", [&]() {
+    HEPEnergyType sumE = 0_GeV;
+    LengthType sumZ = 0_m;
+    for (auto const& p : vStack) {
+      sumE += p.GetEnergy();
+      sumZ += p.GetPosition().GetCoordinates(rootCS).GetZ();
+    }
+    DoNotOptimize(sumE);
+    DoNotOptimize(sumZ);
+  });
+  std::cout << "  " << read.fNanoSecondsPerIteration / n << " ns/particle"
+            << std::endl;
+
+  std::size_t nParticles = 0;
+  auto const shower = RunBenchmark(vName + ", toy shower", [&]() {
+    DoNotOptimize(nParticles =
+                      stack::compact::toy::RunToyShower(vStack, 1e4_GeV, 1_GeV, 10_km)
+                          .fNParticles);
+  });
+  std::cout << "  " << shower.fNanoSecondsPerIteration / nParticles << " ns/particle"
+            << std::endl;
+}
+
+int main() {
+  auto const& rootCS =
+      geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+  geometry::Point const reference(rootCS, {0_m, 0_m, 10_km});
+
+  {
+    CompactStack<float> s(reference);
+    Measure("CompactStack<float>", sizeof(CompactStackImpl<float>::ParticleRecord), s);
+  }
+  {
+    CompactStack<double> s(reference);
+    Measure("CompactStack<double>", sizeof(CompactStackImpl<double>::ParticleRecord),
+            s);
+  }
+  {
+    stack::super_stupid::SuperStupidStack s;
+    std::size_t const bytes = sizeof(particles::Code) + sizeof(HEPEnergyType) +
+                              sizeof(stack::MomentumVector) +
+                              sizeof(geometry::Point) + sizeof(TimeType);
+    Measure("SuperStupidStack", bytes, s);
+  }
+}
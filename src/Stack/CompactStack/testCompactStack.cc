@@ -0,0 +1,120 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/stack/compact/CompactStack.h>
+#include <corsika/stack/super_stupid/SuperStupidStack.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include "ToyShower.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <tuple>
+
+using namespace corsika;
+using namespace corsika::geometry;
+using namespace corsika::stack::compact;
+using namespace corsika::units::si;
+
+TEST_CASE("CompactStack", "[stack]") {
+
+  geometry::CoordinateSystem& rootCS =
+      geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+
+  auto particle = [&](int const i) {
+    return std::tuple<particles::Code, HEPEnergyType, stack::MomentumVector, Point,
+                      TimeType>{
+        particles::Code::Electron, i * 1_GeV,
+        stack::MomentumVector(rootCS, {1_GeV, 2_GeV, i * 1_GeV}),
+        Point(rootCS, {1_m, i * 1_m, 10_km}), i * 1_s};
+  };
+
+  SECTION("read+write") {
+    CompactStack<> s;
+    s.AddParticle(particle(7));
+
+    REQUIRE(s.GetSize() == 1);
+    auto p = s.GetNextParticle();
+    CHECK(p.GetPID() == particles::Code::Electron);
+    CHECK(p.GetEnergy() == 7_GeV);
+    CHECK(p.GetMomentum().GetComponents(rootCS).GetZ() == 7_GeV);
+    CHECK(p.GetPosition().GetCoordinates(rootCS).GetY() == 7_m);
+    CHECK(p.GetTime() == 7_s);
+
+    s.Swap(s.begin(), s.AddParticle(particle(3)));
+    CHECK(s.begin().GetEnergy() == 3_GeV);
+    s.Delete(s.begin());
+    CHECK(s.GetNextParticle().GetEnergy() == 7_GeV);
+  }
+
+  SECTION("precision") {
+    // energy and time keep double precision
+    HEPEnergyType const E = (1 + 1e-12) * 1_GeV;
+    TimeType const t = (1 + 1e-12) * 1_s;
+    CompactStack<float> s(Point(rootCS, {0_m, 0_m, 10_km}));
+    CompactStack<double> d(Point(rootCS, {0_m, 0_m, 10_km}));
+    auto const pos = QuantityVector<length_d>(1.234567_m, 0_m, 10_km + 0.1_mm);
+    auto const mom = QuantityVector<hepmomentum_d>(1_GeV, 1e-3_GeV, 0_GeV);
+    auto const ps = s.EmplaceParticle(particles::Code::Proton, E, mom, pos, t);
+    auto const pd = d.EmplaceParticle(particles::Code::Proton, E, mom, pos, t);
+    CHECK(ps.GetEnergy() == E);
+    CHECK(ps.GetTime() == t);
+    CHECK(pd.GetPosition().GetCoordinates(rootCS).GetX() == 1.234567_m);
+
+    // float positions relative to the reference point resolve 0.1 mm at 10 km
+    auto const x = ps.GetPosition().GetCoordinates(rootCS);
+    CHECK(x.GetX() / 1_m == Approx(1.234567).epsilon(1e-7));
+    CHECK((x.GetZ() - 10_km) / 1_mm == Approx(0.1).epsilon(1e-3));
+    CHECK(ps.GetMomentum().GetComponents(rootCS).GetY() / 1_GeV ==
+          Approx(1e-3).epsilon(1e-7));
+
+    // moving the reference point keeps the positions
+    s.SetReferencePoint(Point(rootCS, {0_m, 0_m, 0_m}));
+    CHECK(s.GetReferencePoint().GetCoordinates(rootCS).GetZ() == 0_m);
+    CHECK(s.GetNextParticle().GetPosition().GetCoordinates(rootCS).GetX() / 1_m ==
+          Approx(1.234567).epsilon(1e-7));
+  }
+
+  SECTION("record size") {
+    CHECK(sizeof(CompactStackImpl<float>::ParticleRecord) <= 48);
+    CHECK(sizeof(CompactStackImpl<float>::ParticleRecord) <
+          sizeof(CompactStackImpl<double>::ParticleRecord));
+  }
+
+  SECTION("toy shower validation") {
+    // longitudinal profile and ground distribution of the float stack must
+    // agree with SuperStupidStack, which keeps everything in double
+    HEPEnergyType const E0 = 1e4_GeV;
+    HEPEnergyType const cut = 1_GeV;
+    LengthType const height = 10_km;
+
+    stack::super_stupid::SuperStupidStack reference;
+    CompactStack<float> compact(Point(rootCS, {0_m, 0_m, height}));
+    auto const r = toy::RunToyShower(reference, E0, cut, height);
+    auto const c = toy::RunToyShower(compact, E0, cut, height);
+
+    REQUIRE(r.fNGround > 1000);
+    CHECK(double(c.fNParticles) == Approx(r.fNParticles).epsilon(1e-3));
+    CHECK(double(c.fNGround) == Approx(r.fNGround).epsilon(1e-3));
+    CHECK(c.fSumDistance / c.fNGround ==
+          Approx(r.fSumDistance / r.fNGround).epsilon(1e-5));
+
+    REQUIRE(c.fProfile.size() == r.fProfile.size());
+    for (std::size_t i = 0; i < r.fProfile.size(); ++i) {
+      CHECK(std::abs(c.fProfile[i] - r.fProfile[i]) <= 1e-3 * r.fProfile[i] + 2);
+    }
+    REQUIRE(c.fGround.size() == r.fGround.size());
+    for (std::size_t i = 0; i < r.fGround.size(); ++i) {
+      CHECK(std::abs(c.fGround[i] - r.fGround[i]) <= 1e-2 * r.fGround[i] + 2);
+    }
+  }
+}
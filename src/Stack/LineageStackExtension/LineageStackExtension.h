@@ -0,0 +1,133 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_stack_lineagestackextension_h_
+#define _include_stack_lineagestackextension_h_
+
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace corsika::stack::lineage {
+
+  /**
+   * Key of secondary number vIndex (counted from 1) of the particle with
+   * key vParent. The finaliser of splitmix64 makes the keys of siblings and
+   * of different generations look independent.
+   */
+  inline uint64_t MixLineage(uint64_t const vParent, uint64_t const vIndex) {
+    uint64_t z = vParent + 0x9E3779B97F4A7C15ull * vIndex;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+  /**
+   * @class LineageData
+   *
+   * Stack data for lineage-keyed random numbers: every particle carries a
+   * 64-bit key derived from the key of its parent and its index among the
+   * secondaries of the parent, and counts its steps and secondaries. See
+   * Cascade::SetLineageRNG and RNGManager::SetLineageKey.
+   */
+  class LineageData {
+
+  public:
+    /// the key and the counters of one particle
+    struct Record {
+      uint64_t fKey;
+      uint32_t fNSteps;
+      uint32_t fNSecondaries;
+    };
+
+    void Init() {}
+    void Clear() { fRecords.clear(); }
+    unsigned int GetSize() const { return fRecords.size(); }
+    unsigned int GetCapacity() const { return fRecords.size(); }
+    void Copy(const int i1, const int i2) { fRecords[i2] = fRecords[i1]; }
+    void Swap(const int i1, const int i2) { std::swap(fRecords[i1], fRecords[i2]); }
+
+    void SetLineageKey(const int i, uint64_t const v) { fRecords[i] = {v, 0, 0}; }
+    uint64_t GetLineageKey(const int i) const { return fRecords[i].fKey; }
+    void SetRecord(const int i, Record const& v) { fRecords[i] = v; }
+    Record const& GetRecord(const int i) const { return fRecords[i]; }
+
+    /// key of the next step of particle i, different for every step
+    uint64_t NextStepKey(const int i) {
+      auto& r = fRecords[i];
+      return MixLineage(~r.fKey, ++r.fNSteps);
+    }
+
+    /// key of the next secondary of particle i
+    uint64_t NextSecondaryKey(const int i) {
+      auto& r = fRecords[i];
+      return MixLineage(r.fKey, ++r.fNSecondaries);
+    }
+
+    void IncrementSize() { fRecords.push_back({0, 0, 0}); }
+    void DecrementSize() {
+      if (fRecords.size() > 0) { fRecords.pop_back(); }
+    }
+
+  private:
+    std::vector<Record> fRecords;
+  };
+
+  /**
+   * @class LineageDataInterface
+   *
+   * The particle interface of LineageData. Particles created without
+   * parent, i.e. primaries, are keyed by their position on the stack.
+   */
+  template <typename T>
+  class LineageDataInterface : public T {
+
+  public:
+    using T::GetIndex;
+    using T::GetStackData;
+    using T::SetParticleData;
+
+    void SetParticleData(const std::tuple<uint64_t> v) {
+      SetLineageKey(std::get<0>(v));
+    }
+    void SetParticleData(LineageDataInterface& parent, const std::tuple<uint64_t>) {
+      SetParticleData(parent);
+    }
+    void SetParticleData() { SetLineageKey(MixLineage(0, GetIndex() + 1)); }
+    void SetParticleData(LineageDataInterface& parent) {
+      SetLineageKey(parent.GetStackData().NextSecondaryKey(parent.GetIndex()));
+    }
+
+    void SetLineageKey(uint64_t const v) { GetStackData().SetLineageKey(GetIndex(), v); }
+    uint64_t GetLineageKey() const { return GetStackData().GetLineageKey(GetIndex()); }
+    uint64_t NextStepKey() { return GetStackData().NextStepKey(GetIndex()); }
+
+    /// e.g. to move a particle to another stack without changing its lineage
+    void SetLineageRecord(LineageData::Record const& v) {
+      GetStackData().SetRecord(GetIndex(), v);
+    }
+    LineageData::Record const& GetLineageRecord() const {
+      return GetStackData().GetRecord(GetIndex());
+    }
+  };
+
+  /// to detect particles with lineage key
+  template <typename T, typename = void>
+  struct has_lineage_key : std::false_type {};
+
+  template <typename T>
+  struct has_lineage_key<T, std::void_t<decltype(std::declval<T&>().NextStepKey())>>
+      : std::true_type {};
+
+} // namespace corsika::stack::lineage
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/stack/CombinedStack.h>
+#include <corsika/stack/lineage/LineageStackExtension.h>
+#include <corsika/stack/super_stupid/SuperStupidStack.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <catch2/catch.hpp>
+
+#include <set>
+#include <tuple>
+
+using namespace corsika;
+using namespace corsika::geometry;
+using namespace corsika::stack::lineage;
+using namespace corsika::units::si;
+
+template <typename StackIter>
+using LineageParticleInterface = corsika::stack::CombinedParticleInterface<
+    corsika::stack::super_stupid::SuperStupidStack::PIType, LineageDataInterface,
+    StackIter>;
+
+using LineageStack = corsika::stack::CombinedStack<
+    corsika::stack::super_stupid::SuperStupidStack::StackImpl, LineageData,
+    LineageParticleInterface>;
+
+TEST_CASE("LineageStackExtension", "[stack]") {
+
+  geometry::CoordinateSystem& dummyCS =
+      geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+
+  auto particle = [&](HEPEnergyType const vE) {
+    return std::tuple<particles::Code, HEPEnergyType, corsika::stack::MomentumVector,
+                      geometry::Point, TimeType>{
+        particles::Code::Electron, vE,
+        corsika::stack::MomentumVector(dummyCS, {0_GeV, 0_GeV, vE}),
+        Point(dummyCS, {0_m, 0_m, 0_m}), 0_s};
+  };
+
+  SECTION("primaries") {
+    LineageStack s;
+    std::set<uint64_t> keys;
+    for (int i = 0; i < 100; ++i) {
+      auto const p = s.AddParticle(particle(1_GeV));
+      CHECK(p.GetLineageKey() == MixLineage(0, i + 1));
+      keys.insert(p.GetLineageKey());
+    }
+    CHECK(keys.size() == 100);
+
+    auto p = s.GetNextParticle();
+    p.SetLineageKey(42);
+    CHECK(p.GetLineageKey() == 42);
+  }
+
+  SECTION("secondaries") {
+    LineageStack s;
+    auto p = s.AddParticle(particle(10_GeV));
+    uint64_t const parent = p.GetLineageKey();
+
+    auto const s1 = p.AddSecondary(particle(1_GeV));
+    auto const s2 = p.AddSecondary(particle(2_GeV));
+    CHECK(s1.GetLineageKey() == MixLineage(parent, 1));
+    CHECK(s2.GetLineageKey() == MixLineage(parent, 2));
+    CHECK(p.GetLineageKey() == parent);
+
+    // the keys follow the particles when the stack is reordered
+    s.Swap(s.begin() + 1, s.begin() + 2);
+    CHECK((s.begin() + 1).GetLineageKey() == MixLineage(parent, 2));
+    CHECK((s.begin() + 2).GetLineageKey() == MixLineage(parent, 1));
+    s.Copy(s.begin() + 2, s.begin());
+    CHECK(s.begin().GetLineageKey() == MixLineage(parent, 1));
+  }
+
+  SECTION("steps") {
+    LineageStack s;
+    auto p = s.AddParticle(particle(1_GeV));
+    std::set<uint64_t> keys{p.GetLineageKey()};
+    for (int i = 0; i < 100; ++i) { keys.insert(p.NextStepKey()); }
+    CHECK(keys.size() == 101);
+
+    // steps and secondaries are counted independently
+    LineageStack t;
+    auto q = t.AddParticle(particle(1_GeV));
+    CHECK(p.AddSecondary(particle(1_GeV)).GetLineageKey() ==
+          q.AddSecondary(particle(1_GeV)).GetLineageKey());
+  }
+}
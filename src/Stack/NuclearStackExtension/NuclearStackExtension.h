@@ -19,7 +19,9 @@
 #include <corsika/geometry/Vector.h>
 
 #include <algorithm>
+#include <stdexcept>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 namespace corsika::stack {
@@ -138,6 +140,53 @@ namespace corsika::stack {
                                                         std::get<4>(v)});
       }
 
+      /**
+       * Raw data, see ParticleBase::EmplaceSecondary, the nuclear A and Z
+       * follow the data of the inner ParticleInterface for a Nucleus.
+       */
+      void SetParticleData(
+          EmplaceTag, const corsika::particles::Code vPID,
+          const corsika::units::si::HEPEnergyType vE,
+          const corsika::geometry::QuantityVector<corsika::units::si::hepmomentum_d>&
+              vMomentum,
+          const corsika::geometry::QuantityVector<corsika::units::si::length_d>&
+              vPosition,
+          const corsika::units::si::TimeType vTime) {
+        if (vPID == corsika::particles::Code::Nucleus) {
+          throw std::runtime_error(
+              "NuclearStackExtension: no A and Z specified for new Nucleus!");
+        }
+        InnerParticleInterface<StackIteratorInterface>::SetParticleData(
+            EmplaceTag{}, vPID, vE, vMomentum, vPosition, vTime);
+        SetNucleusRef(-1); // this is not a nucleus
+      }
+
+      void SetParticleData(
+          EmplaceTag, const corsika::particles::Code vPID,
+          const corsika::units::si::HEPEnergyType vE,
+          const corsika::geometry::QuantityVector<corsika::units::si::hepmomentum_d>&
+              vMomentum,
+          const corsika::geometry::QuantityVector<corsika::units::si::length_d>&
+              vPosition,
+          const corsika::units::si::TimeType vTime, const unsigned short vA,
+          const unsigned short vZ) {
+        if (vPID != corsika::particles::Code::Nucleus || vA == 0 || vZ == 0) {
+          throw std::runtime_error(
+              "NuclearStackExtension: no A and Z specified for new Nucleus!");
+        }
+        SetNucleusRef(GetStackData().GetNucleusNextRef()); // store this nucleus data ref
+        SetNuclearA(vA);
+        SetNuclearZ(vZ);
+        InnerParticleInterface<StackIteratorInterface>::SetParticleData(
+            EmplaceTag{}, vPID, vE, vMomentum, vPosition, vTime);
+      }
+
+      template <typename... TArgs>
+      void SetParticleData(InnerParticleInterface<StackIteratorInterface>&, EmplaceTag,
+                           TArgs&&... v) {
+        SetParticleData(EmplaceTag{}, std::forward<TArgs>(v)...);
+      }
+
       /**
        * @name individual setters
        * @{
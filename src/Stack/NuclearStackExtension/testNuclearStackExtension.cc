@@ -121,6 +121,25 @@ TEST_CASE("NuclearStackExtension", "[stack]") {
     REQUIRE_THROWS(pout.GetNuclearZ());
   }
 
+  SECTION("emplace") {
+    ExtStack s;
+    QuantityVector<hepmomentum_d> const p{1_GeV, 1_GeV, 1_GeV};
+    QuantityVector<length_d> const x{1_m, 1_m, 1_m};
+    auto nucleus = s.EmplaceParticle(particles::Code::Nucleus, 10_GeV, p, x, 100_s,
+                                     (unsigned short)(12), (unsigned short)(6));
+    auto const proton =
+        nucleus.EmplaceSecondary(particles::Code::Proton, 1_GeV, p, x, 1_s);
+    REQUIRE(s.GetSize() == 2);
+    CHECK(nucleus.GetNuclearA() == 12);
+    CHECK(nucleus.GetNuclearZ() == 6);
+    CHECK(nucleus.GetChargeNumber() == 6);
+    CHECK(proton.GetEnergy() == 1_GeV);
+    CHECK_THROWS(proton.GetNuclearA());
+    CHECK_THROWS(s.EmplaceParticle(particles::Code::Nucleus, 10_GeV, p, x, 100_s));
+    CHECK_THROWS(s.EmplaceParticle(particles::Code::Proton, 10_GeV, p, x, 100_s,
+                                   (unsigned short)(1), (unsigned short)(1)));
+  }
+
   SECTION("stack fill and cleanup") {
 
     ExtStack s;
@@ -0,0 +1,244 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_corsika_stack_ordered_OrderedStack_h_
+#define _include_corsika_stack_ordered_OrderedStack_h_
+
+#include <corsika/units/PhysicalUnits.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace corsika::stack::ordered {
+
+  /**
+   * Which particle Cascade::Run takes next from an OrderedStack.
+   */
+  enum class StackOrder {
+    /// the last particle added, as the plain Stack does (default)
+    eLastInFirstOut,
+    /// the particle with the lowest energy, which keeps the stack small
+    /// since low-energy particles die quickly
+    eLowestEnergyFirst,
+    /// the particle with the most ancestors, i.e. depth-first along the
+    /// shower tree; ties are resolved LIFO
+    eHighestGenerationFirst,
+    /// LIFO while the stack is smaller than the hybrid threshold, lowest
+    /// energy first above it until the stack has shrunk to half the
+    /// threshold
+    eHybrid
+  };
+
+  /**
+   * \class OrderedStack
+   *
+   * Wraps a Stack and changes the particle returned by GetNextParticle()
+   * according to a StackOrder. Everything else, in particular the
+   * ParticleInterface, is that of TStack, so OrderedStack<TStack> can be
+   * used wherever TStack is used, e.g. as the stack of a Cascade.
+   *
+   * The selected particle is swapped to the top of the stack, so that
+   * secondaries are added behind it as usual. The swap lowers
+   * Stack::GetLowWater(), so that e.g. a Checkpoint records it. The
+   * particles are indexed in a binary heap, which is updated lazily:
+   * GetNextParticle() assumes that since the previous call only the particle
+   * returned then, particles above it and particles at or above
+   * Stack::GetLowWater() were changed, as is the case during Cascade::Run
+   * and Cascade::RunBatched. If the stack is modified otherwise, call
+   * Invalidate(). GetLowWater() and ResetLowWater() of the OrderedStack
+   * include its own swaps.
+   *
+   * The generation of a particle is counted by OrderedStack itself: all
+   * particles created in a step are one generation beyond the particle
+   * returned before, unless only that particle is left at its place.
+   */
+  template <typename TStack>
+  class OrderedStack : public TStack {
+
+  public:
+    using ParticleType = typename TStack::ParticleType;
+    using TStack::TStack;
+
+    void SetOrder(StackOrder const vOrder) {
+      fOrder = vOrder;
+      fHeapActive = vOrder == StackOrder::eLowestEnergyFirst ||
+                    vOrder == StackOrder::eHighestGenerationFirst;
+      Invalidate();
+    }
+    StackOrder GetOrder() const { return fOrder; }
+
+    /// stack size above which eHybrid switches to lowest energy first
+    void SetHybridThreshold(std::size_t const vThreshold) {
+      if (vThreshold < 2) {
+        throw std::runtime_error("OrderedStack: hybrid threshold must be >= 2");
+      }
+      fHybridThreshold = vThreshold;
+    }
+    std::size_t GetHybridThreshold() const { return fHybridThreshold; }
+
+    /// largest stack size seen by GetNextParticle()
+    std::size_t GetPeakSize() const { return fPeakSize; }
+    void ResetPeakSize() { fPeakSize = 0; }
+
+    /// forget all ordering information, e.g. after external modifications
+    void Invalidate() {
+      fHeap.clear();
+      fClean = 0;
+      fHasParent = false;
+      std::fill(fGeneration.begin(), fGeneration.end(), 0);
+    }
+
+    void Clear() {
+      TStack::Clear();
+      Invalidate();
+    }
+
+    /// see Stack::GetLowWater()
+    unsigned int GetLowWater() const {
+      return std::min(fLowWater, TStack::GetLowWater());
+    }
+    void ResetLowWater() {
+      SyncLowWater();
+      fLowWater = std::numeric_limits<unsigned int>::max();
+    }
+
+    ParticleType GetNextParticle() {
+      SyncLowWater();
+      std::size_t const size = TStack::GetSize();
+      fPeakSize = std::max(fPeakSize, size);
+
+      if (fOrder == StackOrder::eHybrid) {
+        if (!fHeapActive && size > fHybridThreshold) {
+          fHeapActive = true;
+          Invalidate();
+        } else if (fHeapActive && size < fHybridThreshold / 2) {
+          fHeapActive = false;
+        }
+      }
+      if (!fHeapActive || size == 0) { return TStack::GetNextParticle(); }
+
+      Update(size);
+
+      // pop until a valid entry is found, stale ones are simply dropped
+      Entry best;
+      do {
+        std::pop_heap(fHeap.begin(), fHeap.end(), Lower);
+        best = fHeap.back();
+        fHeap.pop_back();
+      } while (best.fIndex >= size || best.fStamp != fStamp[best.fIndex]);
+
+      std::size_t const top = size - 1;
+      if (best.fIndex != top) {
+        TStack::Swap(TStack::begin() + int(best.fIndex), TStack::begin() + int(top));
+        std::swap(fGeneration[best.fIndex], fGeneration[top]);
+        Push(best.fIndex); // the former top particle
+        // the swap is indexed already, keep it only for GetLowWater()
+        fLowWater = std::min(fLowWater, TStack::GetLowWater());
+        TStack::ResetLowWater();
+      }
+      ++fStamp[top];
+      fParentGeneration = fGeneration[top];
+      fHasParent = true;
+      fParent = top;
+      fClean = top;
+      return TStack::last();
+    }
+
+  private:
+    struct Entry {
+      double fKey; //!< the smallest key is taken first
+      uint32_t fIndex;
+      uint32_t fStamp;
+    };
+
+    /// heap order, i.e. true if a is taken after b
+    static bool Lower(Entry const& a, Entry const& b) {
+      return a.fKey > b.fKey || (a.fKey == b.fKey && a.fIndex < b.fIndex);
+    }
+
+    double GetKey(std::size_t const vIndex) const {
+      if (fOrder == StackOrder::eHighestGenerationFirst) {
+        return -double(fGeneration[vIndex]);
+      }
+      return (TStack::cbegin() + int(vIndex)).GetEnergy() / units::si::electronvolt;
+    }
+
+    void Push(std::size_t const vIndex) {
+      ++fStamp[vIndex];
+      fHeap.push_back(Entry{GetKey(vIndex), uint32_t(vIndex), fStamp[vIndex]});
+      std::push_heap(fHeap.begin(), fHeap.end(), Lower);
+    }
+
+    /// moves the changes reported to TStack to fClean and fLowWater
+    void SyncLowWater() {
+      unsigned int const lowWater = TStack::GetLowWater();
+      fClean = std::min<std::size_t>(fClean, lowWater);
+      fLowWater = std::min(fLowWater, lowWater);
+      TStack::ResetLowWater();
+    }
+
+    /// index the particles changed since the last call
+    void Update(std::size_t const vSize) {
+      if (fStamp.size() < vSize) {
+        fStamp.resize(vSize, 0);
+        fGeneration.resize(vSize, 0);
+      }
+      fClean = std::min(fClean, vSize);
+
+      if (fHasParent) {
+        // the particles below the parent keep their generation, even if
+        // changed in place
+        std::size_t const parent = std::min(fParent, vSize);
+        bool const survived = vSize == parent + 1;
+        uint32_t const generation = fParentGeneration + (survived ? 0 : 1);
+        std::fill(fGeneration.begin() + parent, fGeneration.begin() + vSize, generation);
+      }
+
+      // many stale entries accumulate when the stack shrinks: rebuild
+      if (fHeap.size() + (vSize - fClean) > 2 * vSize + 1024) {
+        fHeap.clear();
+        fClean = 0;
+      }
+      if (fClean == 0) {
+        fHeap.clear();
+        for (std::size_t i = 0; i < vSize; ++i) {
+          ++fStamp[i];
+          fHeap.push_back(Entry{GetKey(i), uint32_t(i), fStamp[i]});
+        }
+        std::make_heap(fHeap.begin(), fHeap.end(), Lower);
+      } else {
+        for (std::size_t i = fClean; i < vSize; ++i) { Push(i); }
+      }
+      fClean = vSize;
+    }
+
+    StackOrder fOrder = StackOrder::eLastInFirstOut;
+    bool fHeapActive = false;
+    std::size_t fHybridThreshold = 1 << 16;
+    std::size_t fPeakSize = 0;
+
+    std::vector<Entry> fHeap;
+    std::vector<uint32_t> fStamp;      //!< version of the particle at each index
+    std::vector<uint32_t> fGeneration; //!< generation of the particle at each index
+    std::size_t fClean = 0; //!< particles below this index are unchanged and indexed
+    std::size_t fParent = 0; //!< index of the particle returned last
+    uint32_t fParentGeneration = 0;
+    bool fHasParent = false;
+    //! changes already indexed, but not yet reset by ResetLowWater()
+    unsigned int fLowWater = std::numeric_limits<unsigned int>::max();
+  };
+
+} // namespace corsika::stack::ordered
+
+#endif
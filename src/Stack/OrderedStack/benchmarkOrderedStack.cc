@@ -0,0 +1,96 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+/**
+ * Peak stack size and throughput of the StackOrder policies of
+ * OrderedStack in a toy shower: every particle above a cut splits into two
+ * with a random energy fraction, the stack is worked off like in
+ * Cascade::Run.
+ */
+
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/particles/ParticleProperties.h>
+#include <corsika/setup/SetupStack.h>
+#include <corsika/stack/ordered/OrderedStack.h>
+#include <corsika/testing/Benchmark.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace corsika;
+using namespace corsika::units::si;
+using corsika::stack::ordered::OrderedStack;
+using corsika::stack::ordered::StackOrder;
+using corsika::testing::DoNotOptimize;
+using corsika::testing::RunBenchmark;
+
+using ParticleTuple = std::tuple<particles::Code, HEPEnergyType, stack::MomentumVector,
+                                 geometry::Point, TimeType>;
+
+/// returns the number of particles processed
+std::size_t RunShower(OrderedStack<setup::Stack>& vStack, HEPEnergyType const vE0,
+                      HEPEnergyType const vCut) {
+  auto const& rootCS =
+      geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+  stack::MomentumVector const momentum(rootCS, {0_GeV, 0_GeV, -1_GeV});
+  geometry::Point const origin(rootCS, {0_m, 0_m, 0_m});
+
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<double> fraction(0.05, 0.95);
+
+  vStack.Clear();
+  vStack.ResetPeakSize();
+  vStack.AddParticle(ParticleTuple{particles::Code::Proton, vE0, momentum, origin, 0_ns});
+
+  std::size_t n = 0;
+  while (!vStack.IsEmpty()) {
+    HEPEnergyType const E = vStack.GetNextParticle().GetEnergy();
+    vStack.DeleteLast();
+    ++n;
+    if (E < vCut) { continue; }
+    double const f = fraction(rng);
+    vStack.AddParticle(
+        ParticleTuple{particles::Code::Proton, E * f, momentum, origin, 0_ns});
+    vStack.AddParticle(
+        ParticleTuple{particles::Code::Proton, E * (1 - f), momentum, origin, 0_ns});
+  }
+  return n;
+}
+
+int main() {
+  HEPEnergyType const E0 = 1e5_GeV;
+  HEPEnergyType const cut = 1_GeV;
+
+  std::vector<std::pair<std::string, StackOrder>> const orders{
+      {"LIFO", StackOrder::eLastInFirstOut},
+      {"lowest energy first", StackOrder::eLowestEnergyFirst},
+      {"highest generation first", StackOrder::eHighestGenerationFirst},
+      {"hybrid", StackOrder::eHybrid}};
+
+  for (auto const& [name, order] : orders) {
+    OrderedStack<setup::Stack> stack;
+    stack.SetOrder(order);
+    stack.SetHybridThreshold(16);
+
+    std::size_t nParticles = 0;
+    auto const result = RunBenchmark(
+        "toy shower, " + name,
+        [&]() { DoNotOptimize(nParticles = RunShower(stack, E0, cut)); }, 0.5);
+    std::cout << "  " << nParticles << " particles, "
+              << result.fNanoSecondsPerIteration / nParticles
+              << " ns/particle, peak stack " << stack.GetPeakSize() << std::endl;
+  }
+}
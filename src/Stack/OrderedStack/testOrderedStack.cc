@@ -0,0 +1,112 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/stack/ordered/OrderedStack.h>
+#include <corsika/stack/super_stupid/SuperStupidStack.h>
+#include <corsika/units/PhysicalUnits.h>
+
+using namespace corsika::geometry;
+using namespace corsika::units::si;
+
+#include <catch2/catch.hpp>
+
+using namespace corsika;
+using namespace corsika::stack::ordered;
+
+#include <tuple>
+
+TEST_CASE("OrderedStack", "[stack]") {
+
+  CoordinateSystem& rootCS =
+      RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+  OrderedStack<stack::super_stupid::SuperStupidStack> stack;
+  auto add = [&](HEPEnergyType const E) {
+    stack.AddParticle(
+        std::tuple<particles::Code, units::si::HEPEnergyType,
+                   corsika::stack::MomentumVector, geometry::Point, units::si::TimeType>{
+            particles::Code::Electron, E,
+            corsika::stack::MomentumVector(rootCS, {0_GeV, 0_GeV, -1_GeV}),
+            Point(rootCS, {0_m, 0_m, 0_m}), 0_ns});
+  };
+  // takes the next particle and removes it, as an interaction does
+  auto next = [&]() {
+    HEPEnergyType const E = stack.GetNextParticle().GetEnergy();
+    stack.DeleteLast();
+    return E / 1_GeV;
+  };
+
+  SECTION("LIFO") {
+    for (auto const E : {5_GeV, 1_GeV, 4_GeV}) { add(E); }
+    CHECK(next() == 4);
+    CHECK(next() == 1);
+    CHECK(next() == 5);
+  }
+
+  SECTION("lowest energy first") {
+    stack.SetOrder(StackOrder::eLowestEnergyFirst);
+    for (auto const E : {5_GeV, 1_GeV, 4_GeV, 2_GeV, 3_GeV}) { add(E); }
+    CHECK(next() == 1);
+    add(2.5_GeV); // secondaries
+    add(0.5_GeV);
+    CHECK(next() == 0.5);
+    CHECK(next() == 2);
+    CHECK(next() == 2.5);
+    CHECK(next() == 3);
+    CHECK(next() == 4);
+    CHECK(next() == 5);
+    CHECK(stack.IsEmpty());
+    CHECK(stack.GetPeakSize() == 6);
+  }
+
+  SECTION("changes below the top") {
+    stack.SetOrder(StackOrder::eLowestEnergyFirst);
+    for (auto const E : {5_GeV, 1_GeV, 4_GeV, 2_GeV, 3_GeV}) { add(E); }
+    stack.ResetLowWater();
+    CHECK(next() == 1);
+    CHECK(stack.GetLowWater() == 1); // the swap
+    stack.ResetLowWater();
+    CHECK(stack.GetLowWater() == stack.GetSize());
+    // changed in place and reported, as by Cascade::RunBatched
+    stack.begin().SetEnergy(0.5_GeV);
+    stack.LowerLowWater(0);
+    CHECK(next() == 0.5);
+    CHECK(next() == 2);
+  }
+
+  SECTION("highest generation first") {
+    stack.SetOrder(StackOrder::eHighestGenerationFirst);
+    add(1_GeV);
+    CHECK(next() == 1);
+    add(11_GeV); // generation 1
+    add(12_GeV);
+    CHECK(next() == 12);
+    add(21_GeV); // generation 2
+    add(22_GeV);
+    CHECK(next() == 22);
+    CHECK(next() == 21);
+    CHECK(next() == 11);
+  }
+
+  SECTION("hybrid") {
+    stack.SetOrder(StackOrder::eHybrid);
+    stack.SetHybridThreshold(4);
+    for (auto const E : {1_GeV, 2_GeV, 5_GeV, 3_GeV, 4_GeV}) { add(E); }
+    CHECK(next() == 1); // above threshold: lowest energy
+    CHECK(next() == 2);
+    CHECK(next() == 3);
+    CHECK(next() == 4);
+    CHECK(next() == 5);
+    add(6_GeV);
+    add(7_GeV);
+    CHECK(next() == 7); // below half the threshold: LIFO again
+    CHECK(next() == 6);
+  }
+}
@@ -0,0 +1,243 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_corsika_stack_particle_class_ParticleClassStack_h_
+#define _include_corsika_stack_particle_class_ParticleClassStack_h_
+
+#include <corsika/particles/ParticleProperties.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace corsika::stack::particle_class {
+
+  using particles::ParticleClass;
+
+  /**
+   * \class ParticleClassStack
+   *
+   * Wraps a Stack, like OrderedStack, and makes GetNextParticle() return
+   * particles of one particles::ParticleClass at a time: the particles of
+   * each class are kept in a bucket, and the current class is worked off
+   * (LIFO within the class) before the next non-empty class in the class
+   * order is taken. The cascade thus runs through long sequences of steps with
+   * the same models and processes, which keeps their branches and tables
+   * hot.
+   *
+   * The buckets hold indices into the unchanged TStack, so the
+   * ParticleInterface, SecondaryView etc. are those of TStack. The
+   * selected particle is swapped to the top of the stack, which lowers
+   * Stack::GetLowWater() for e.g. a Checkpoint, and the buckets
+   * are updated lazily under the same assumption as in OrderedStack: since
+   * the previous GetNextParticle() only the particle returned then,
+   * particles above it and particles at or above Stack::GetLowWater() were
+   * changed. Otherwise, call Invalidate().
+   */
+  template <typename TStack>
+  class ParticleClassStack : public TStack {
+
+  public:
+    using ParticleType = typename TStack::ParticleType;
+    using TStack::TStack;
+
+    /**
+     * the order in which the classes are taken when the current one is
+     * empty; classes not given are appended in their default order
+     */
+    void SetClassOrder(std::vector<ParticleClass> const& vOrder) {
+      std::vector<ParticleClass> order;
+      for (auto const c : vOrder) {
+        if (std::find(order.begin(), order.end(), c) != order.end()) {
+          throw std::runtime_error("ParticleClassStack: class given twice");
+        }
+        order.push_back(c);
+      }
+      for (auto const c : DefaultOrder()) {
+        if (std::find(order.begin(), order.end(), c) == order.end()) {
+          order.push_back(c);
+        }
+      }
+      fOrder = order;
+    }
+    std::vector<ParticleClass> const& GetClassOrder() const { return fOrder; }
+
+    /// the class of the particle returned by the last GetNextParticle()
+    ParticleClass GetCurrentClass() const { return fCurrent; }
+
+    /// number of particles of class vClass on the stack
+    std::size_t GetClassSize(ParticleClass const vClass) const {
+      std::size_t const size = TStack::GetSize();
+      std::size_t const clean =
+          std::min({fClean, size, std::size_t(TStack::GetLowWater())});
+      std::size_t n = fCount[Index(vClass)];
+      // the particles above fClean may have changed since they were counted
+      for (std::size_t i = clean; i < fKnown; ++i) {
+        if (fClass[i] == vClass) { --n; }
+      }
+      for (std::size_t i = clean; i < size; ++i) {
+        if (particles::GetParticleClass((TStack::cbegin() + int(i)).GetPID()) == vClass) {
+          ++n;
+        }
+      }
+      return n;
+    }
+
+    /// number of times GetNextParticle() took a new class from the class order
+    std::size_t GetNumberOfClassSwitches() const { return fNSwitches; }
+
+    /// forget all bucket information, e.g. after external modifications
+    void Invalidate() {
+      for (auto& bucket : fBuckets) { bucket.clear(); }
+      fCount.fill(0);
+      fHasCurrent = false;
+      fClean = 0;
+      fKnown = 0;
+    }
+
+    void Clear() {
+      TStack::Clear();
+      Invalidate();
+    }
+
+    /// see Stack::GetLowWater()
+    unsigned int GetLowWater() const {
+      return std::min(fLowWater, TStack::GetLowWater());
+    }
+    void ResetLowWater() {
+      SyncLowWater();
+      fLowWater = std::numeric_limits<unsigned int>::max();
+    }
+
+    ParticleType GetNextParticle() {
+      SyncLowWater();
+      std::size_t const size = TStack::GetSize();
+      if (size == 0) { return TStack::GetNextParticle(); }
+
+      Update(size);
+
+      if (!fHasCurrent || !HasValid(fCurrent, size)) {
+        for (auto const c : fOrder) {
+          if (HasValid(c, size)) {
+            fCurrent = c;
+            fHasCurrent = true;
+            ++fNSwitches;
+            break;
+          }
+        }
+      }
+      auto& bucket = fBuckets[Index(fCurrent)];
+      Entry const selected = bucket.back();
+      bucket.pop_back();
+
+      std::size_t const top = size - 1;
+      if (selected.fIndex != top) {
+        TStack::Swap(TStack::begin() + int(selected.fIndex), TStack::begin() + int(top));
+        std::swap(fClass[selected.fIndex], fClass[top]);
+        Push(selected.fIndex); // the former top particle
+        // the swap is bucketed already, keep it only for GetLowWater()
+        fLowWater = std::min(fLowWater, TStack::GetLowWater());
+        TStack::ResetLowWater();
+      }
+      ++fStamp[top]; // the returned particle is in no bucket any more
+      fClean = top;
+      return TStack::last();
+    }
+
+  private:
+    struct Entry {
+      uint32_t fIndex;
+      uint32_t fStamp;
+    };
+
+    static std::vector<ParticleClass> DefaultOrder() {
+      return {ParticleClass::eElectromagnetic, ParticleClass::eMuon,
+              ParticleClass::eHadron,          ParticleClass::eNucleus,
+              ParticleClass::eNeutrino,        ParticleClass::eOther};
+    }
+
+    static std::size_t Index(ParticleClass const vClass) {
+      return static_cast<std::size_t>(vClass);
+    }
+
+    /// moves the changes reported to TStack to fClean and fLowWater
+    void SyncLowWater() {
+      unsigned int const lowWater = TStack::GetLowWater();
+      fClean = std::min<std::size_t>(fClean, lowWater);
+      fLowWater = std::min(fLowWater, lowWater);
+      TStack::ResetLowWater();
+    }
+
+    /// drops stale entries from the top of the bucket
+    bool HasValid(ParticleClass const vClass, std::size_t const vSize) {
+      auto& bucket = fBuckets[Index(vClass)];
+      while (!bucket.empty() && (bucket.back().fIndex >= vSize ||
+                                 bucket.back().fStamp != fStamp[bucket.back().fIndex])) {
+        bucket.pop_back();
+      }
+      return !bucket.empty();
+    }
+
+    void Push(std::size_t const vIndex) {
+      ++fStamp[vIndex];
+      fBuckets[Index(fClass[vIndex])].push_back(
+          Entry{uint32_t(vIndex), fStamp[vIndex]});
+    }
+
+    /// classify the particles changed since the last call
+    void Update(std::size_t const vSize) {
+      if (fStamp.size() < vSize) {
+        fStamp.resize(vSize, 0);
+        fClass.resize(vSize, ParticleClass::eHadron);
+      }
+      for (std::size_t i = vSize; i < fKnown; ++i) { --fCount[Index(fClass[i])]; }
+      fKnown = std::min(fKnown, vSize);
+      fClean = std::min(fClean, vSize);
+
+      // many stale entries accumulate when the stack shrinks: rebuild
+      std::size_t entries = 0;
+      for (auto const& bucket : fBuckets) { entries += bucket.size(); }
+      if (entries + (vSize - fClean) > 2 * vSize + 1024) {
+        for (auto& bucket : fBuckets) { bucket.clear(); }
+        fClean = 0;
+      }
+
+      for (std::size_t i = fClean; i < vSize; ++i) {
+        if (i < fKnown) { --fCount[Index(fClass[i])]; }
+        fClass[i] = particles::GetParticleClass((TStack::cbegin() + int(i)).GetPID());
+        ++fCount[Index(fClass[i])];
+        Push(i);
+      }
+      fKnown = vSize;
+      fClean = vSize;
+    }
+
+    std::vector<ParticleClass> fOrder = DefaultOrder();
+    ParticleClass fCurrent = ParticleClass::eElectromagnetic;
+    bool fHasCurrent = false;
+    std::size_t fNSwitches = 0;
+
+    std::array<std::vector<Entry>, particles::kNParticleClasses> fBuckets;
+    std::array<std::size_t, particles::kNParticleClasses> fCount{};
+    std::vector<uint32_t> fStamp;        //!< version of the particle at each index
+    std::vector<ParticleClass> fClass;   //!< class of the particle at each index
+    std::size_t fClean = 0; //!< particles below this index are unchanged and bucketed
+    std::size_t fKnown = 0; //!< particles below this index are counted in fCount
+    //! changes already bucketed, but not yet reset by ResetLowWater()
+    unsigned int fLowWater = std::numeric_limits<unsigned int>::max();
+  };
+
+} // namespace corsika::stack::particle_class
+
+#endif
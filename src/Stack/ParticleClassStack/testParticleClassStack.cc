@@ -0,0 +1,130 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/stack/particle_class/ParticleClassStack.h>
+#include <corsika/stack/super_stupid/SuperStupidStack.h>
+#include <corsika/units/PhysicalUnits.h>
+
+using namespace corsika::geometry;
+using namespace corsika::units::si;
+
+#include <catch2/catch.hpp>
+
+using namespace corsika;
+using namespace corsika::stack::particle_class;
+
+#include <tuple>
+
+TEST_CASE("ParticleClassStack", "[stack]") {
+
+  using particles::Code;
+
+  CoordinateSystem& rootCS =
+      RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+  ParticleClassStack<stack::super_stupid::SuperStupidStack> stack;
+  auto add = [&](Code const pid, HEPEnergyType const E) {
+    stack.AddParticle(
+        std::tuple<particles::Code, units::si::HEPEnergyType,
+                   corsika::stack::MomentumVector, geometry::Point, units::si::TimeType>{
+            pid, E, corsika::stack::MomentumVector(rootCS, {0_GeV, 0_GeV, -1_GeV}),
+            Point(rootCS, {0_m, 0_m, 0_m}), 0_ns});
+  };
+  // takes the next particle and removes it, as an interaction does
+  auto next = [&]() {
+    HEPEnergyType const E = stack.GetNextParticle().GetEnergy();
+    stack.DeleteLast();
+    return E / 1_GeV;
+  };
+
+  SECTION("default order") {
+    add(Code::Proton, 1_GeV);
+    add(Code::Electron, 2_GeV);
+    add(Code::MuPlus, 3_GeV);
+    add(Code::Gamma, 4_GeV);
+    add(Code::PiMinus, 5_GeV);
+    add(Code::TauMinus, 6_GeV);
+    CHECK(stack.GetClassSize(ParticleClass::eElectromagnetic) == 2);
+    CHECK(stack.GetClassSize(ParticleClass::eHadron) == 2);
+    CHECK(stack.GetClassSize(ParticleClass::eMuon) == 1);
+    CHECK(stack.GetClassSize(ParticleClass::eNeutrino) == 0);
+    CHECK(stack.GetClassSize(ParticleClass::eOther) == 1);
+
+    CHECK(next() == 4); // LIFO within the class
+    CHECK(stack.GetCurrentClass() == ParticleClass::eElectromagnetic);
+    CHECK(next() == 2);
+    CHECK(next() == 3);
+    CHECK(stack.GetCurrentClass() == ParticleClass::eMuon);
+    CHECK(next() == 5);
+    CHECK(next() == 1);
+    CHECK(next() == 6);
+    CHECK(stack.IsEmpty());
+    CHECK(stack.GetClassSize(ParticleClass::eHadron) == 0);
+  }
+
+  SECTION("current class is finished first") {
+    stack.SetClassOrder({ParticleClass::eHadron});
+    REQUIRE(stack.GetClassOrder().size() == particles::kNParticleClasses);
+    CHECK(stack.GetClassOrder()[1] == ParticleClass::eElectromagnetic);
+    add(Code::Gamma, 1_GeV);
+    add(Code::Proton, 2_GeV);
+    add(Code::Proton, 3_GeV);
+    CHECK(next() == 3);
+    add(Code::Gamma, 4_GeV); // secondaries
+    add(Code::PiPlus, 5_GeV);
+    add(Code::Gamma, 6_GeV);
+    CHECK(stack.GetClassSize(ParticleClass::eElectromagnetic) == 3);
+    CHECK(next() == 5);
+    CHECK(next() == 2);
+    CHECK(next() == 6);
+    CHECK(next() == 4);
+    CHECK(next() == 1);
+    CHECK(stack.IsEmpty());
+    CHECK(stack.GetNumberOfClassSwitches() == 2);
+  }
+
+  SECTION("class sizes of a changed stack") {
+    add(Code::Gamma, 1_GeV);
+    add(Code::Proton, 2_GeV);
+    CHECK(next() == 1);
+    add(Code::MuMinus, 3_GeV); // replaces the returned particle
+    add(Code::Oxygen, 4_GeV);
+    auto const& constStack = stack;
+    CHECK(constStack.GetClassSize(ParticleClass::eElectromagnetic) == 0);
+    CHECK(constStack.GetClassSize(ParticleClass::eMuon) == 1);
+    CHECK(constStack.GetClassSize(ParticleClass::eHadron) == 1);
+    CHECK(constStack.GetClassSize(ParticleClass::eNucleus) == 1);
+    stack.DeleteLast();
+    CHECK(constStack.GetClassSize(ParticleClass::eNucleus) == 0);
+    CHECK(next() == 3);
+    CHECK(next() == 2);
+    CHECK(stack.IsEmpty());
+  }
+
+  SECTION("changes below the top") {
+    add(Code::MuPlus, 1_GeV);
+    add(Code::Proton, 2_GeV);
+    add(Code::Proton, 3_GeV);
+    add(Code::Gamma, 4_GeV);
+    CHECK(next() == 4);
+    // the last particle is moved into the place of the muon
+    stack.Delete(stack.begin());
+    CHECK(stack.GetClassSize(ParticleClass::eMuon) == 0);
+    CHECK(next() == 2);
+    CHECK(stack.GetCurrentClass() == ParticleClass::eHadron);
+    CHECK(next() == 3);
+    CHECK(stack.IsEmpty());
+  }
+
+  SECTION("class given twice") {
+    REQUIRE_THROWS(stack.SetClassOrder(
+        {ParticleClass::eMuon, ParticleClass::eHadron, ParticleClass::eMuon}));
+  }
+}
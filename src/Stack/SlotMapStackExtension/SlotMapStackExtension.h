@@ -0,0 +1,205 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_stack_slotmapstackextension_h_
+#define _include_stack_slotmapstackextension_h_
+
+#include <corsika/stack/CombinedStack.h>
+#include <corsika/stack/SecondaryView.h>
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace corsika::stack::slot_map {
+
+  /**
+   * Stable reference to a particle on a SlotMapStack. It remains valid
+   * while the particle is moved on the stack, e.g. by Delete() of another
+   * particle or by an OrderedStack, and becomes stale when the particle is
+   * deleted or overwritten.
+   */
+  struct ParticleHandle {
+    uint32_t fSlot;
+    uint32_t fGeneration;
+
+    bool operator==(ParticleHandle const& v) const {
+      return fSlot == v.fSlot && fGeneration == v.fGeneration;
+    }
+    bool operator!=(ParticleHandle const& v) const { return !(*this == v); }
+  };
+
+  /**
+   * @class SlotMapData
+   *
+   * Stack data mapping ParticleHandles to stack indices. Every particle
+   * owns a slot, which stores its current index and a generation counter.
+   * Copy(), Swap(), IncrementSize() and DecrementSize() keep the slots up to
+   * date in O(1); a slot is recycled with the next generation when its
+   * particle is deleted, which makes all handles to it stale.
+   *
+   * A particle copied onto another one takes its slot along, the copy left
+   * behind gets a new one. This way the handle follows the particle moved
+   * by Stack::Delete(), which copies the last particle into the gap.
+   */
+  class SlotMapData {
+
+    static uint32_t constexpr kFree = std::numeric_limits<uint32_t>::max();
+
+    struct Slot {
+      uint32_t fIndex;
+      uint32_t fGeneration;
+    };
+
+  public:
+    void Init() {}
+    void Clear() {
+      for (auto const slot : fSlotOfIndex) { Release(slot); }
+      fSlotOfIndex.clear();
+    }
+    unsigned int GetSize() const { return fSlotOfIndex.size(); }
+    unsigned int GetCapacity() const { return fSlotOfIndex.capacity(); }
+
+    void Copy(const int i1, const int i2) {
+      if (i1 == i2) { return; }
+      Release(fSlotOfIndex[i2]);
+      Assign(i2, fSlotOfIndex[i1]);
+      Assign(i1, Acquire());
+    }
+    void Swap(const int i1, const int i2) {
+      uint32_t const slot1 = fSlotOfIndex[i1];
+      Assign(i1, fSlotOfIndex[i2]);
+      Assign(i2, slot1);
+    }
+
+    void IncrementSize() {
+      fSlotOfIndex.push_back(kFree);
+      Assign(fSlotOfIndex.size() - 1, Acquire());
+    }
+    void DecrementSize() {
+      if (fSlotOfIndex.empty()) { return; }
+      Release(fSlotOfIndex.back());
+      fSlotOfIndex.pop_back();
+    }
+
+    ParticleHandle GetHandle(const int i) const {
+      uint32_t const slot = fSlotOfIndex[i];
+      return {slot, fSlots[slot].fGeneration};
+    }
+
+    bool IsValid(ParticleHandle const v) const {
+      return v.fSlot < fSlots.size() && fSlots[v.fSlot].fGeneration == v.fGeneration &&
+             fSlots[v.fSlot].fIndex != kFree;
+    }
+
+    /// \throws std::runtime_error if the handle is stale
+    unsigned int GetIndex(ParticleHandle const v) const {
+      if (!IsValid(v)) {
+        throw std::runtime_error("SlotMapStack: stale particle handle");
+      }
+      return fSlots[v.fSlot].fIndex;
+    }
+
+  private:
+    uint32_t Acquire() {
+      if (fFree.empty()) {
+        fSlots.push_back({kFree, 0});
+        return fSlots.size() - 1;
+      }
+      uint32_t const slot = fFree.back();
+      fFree.pop_back();
+      return slot;
+    }
+
+    void Release(uint32_t const vSlot) {
+      fSlots[vSlot].fIndex = kFree;
+      ++fSlots[vSlot].fGeneration;
+      fFree.push_back(vSlot);
+    }
+
+    void Assign(uint32_t const vIndex, uint32_t const vSlot) {
+      fSlotOfIndex[vIndex] = vSlot;
+      fSlots[vSlot].fIndex = vIndex;
+    }
+
+    std::vector<Slot> fSlots;
+    std::vector<uint32_t> fFree;        //!< released slots
+    std::vector<uint32_t> fSlotOfIndex; //!< per particle
+  };
+
+  /**
+   * @class SlotMapDataInterface
+   *
+   * The particle interface of SlotMapData.
+   */
+  template <typename T>
+  class SlotMapDataInterface : public T {
+
+  public:
+    using T::GetIndex;
+    using T::GetStackData;
+    using T::SetParticleData;
+
+    // the slot is assigned by SlotMapData::IncrementSize()
+    void SetParticleData() {}
+    void SetParticleData(SlotMapDataInterface&) {}
+
+    ParticleHandle GetHandle() const { return GetStackData().GetHandle(GetIndex()); }
+  };
+
+  namespace detail {
+    template <typename TStack>
+    struct SlotMapStackTypes {
+      template <typename TStackIter>
+      using PIType = CombinedParticleInterface<TStack::template PIType,
+                                               SlotMapDataInterface, TStackIter>;
+      using StackType =
+          CombinedStack<typename TStack::StackImpl, SlotMapData, PIType>;
+    };
+  } // namespace detail
+
+  /**
+   * \class SlotMapStack
+   *
+   * TStack extended by SlotMapData: particle.GetHandle() returns a
+   * ParticleHandle, which can be turned back into the particle with
+   * GetParticle() as long as IsValid() is true.
+   */
+  template <typename TStack>
+  class SlotMapStack : public detail::SlotMapStackTypes<TStack>::StackType {
+
+    using Base = typename detail::SlotMapStackTypes<TStack>::StackType;
+
+  public:
+    using ParticleType = typename Base::ParticleType;
+    using Base::Base;
+
+    bool IsValid(ParticleHandle const v) const { return Base::GetStackData().IsValid(v); }
+
+    /// \throws std::runtime_error if the handle is stale
+    ParticleType GetParticle(ParticleHandle const v) {
+      return Base::begin() + int(Base::GetStackData().GetIndex(v));
+    }
+  };
+
+  /**
+   * The SecondaryView of a SlotMapStack. MakeView<SlotMapStack<TStack>>
+   * does not resolve the nested PIType alias with gcc, see Issue 161.
+   */
+  template <typename TStack>
+  using SlotMapStackView =
+      SecondaryView<typename SlotMapStack<TStack>::StackImpl,
+                    detail::SlotMapStackTypes<TStack>::template PIType>;
+
+} // namespace corsika::stack::slot_map
+
+#endif
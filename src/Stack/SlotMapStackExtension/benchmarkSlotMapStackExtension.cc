@@ -0,0 +1,127 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+/**
+ * Overhead of SlotMapStack on setup::Stack: a toy shower (every particle
+ * above a cut splits into two, the stack is worked off like in
+ * Cascade::Run), and random access to particles by index and by
+ * ParticleHandle.
+ */
+
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/particles/ParticleProperties.h>
+#include <corsika/setup/SetupStack.h>
+#include <corsika/stack/slot_map/SlotMapStackExtension.h>
+#include <corsika/testing/Benchmark.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <tuple>
+#include <vector>
+
+using namespace corsika;
+using namespace corsika::units::si;
+using corsika::stack::slot_map::ParticleHandle;
+using corsika::stack::slot_map::SlotMapStack;
+using corsika::testing::DoNotOptimize;
+using corsika::testing::RunBenchmark;
+
+using ParticleTuple = std::tuple<particles::Code, HEPEnergyType, stack::MomentumVector,
+                                 geometry::Point, TimeType>;
+
+auto const& gRootCS =
+    geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+
+ParticleTuple MakeParticle(HEPEnergyType const vE) {
+  return ParticleTuple{particles::Code::Proton, vE,
+                       stack::MomentumVector(gRootCS, {0_GeV, 0_GeV, -1_GeV}),
+                       geometry::Point(gRootCS, {0_m, 0_m, 0_m}), 0_ns};
+}
+
+/// returns the number of particles processed
+template <typename TStack>
+std::size_t RunShower(TStack& vStack, HEPEnergyType const vE0, HEPEnergyType const vCut) {
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<double> fraction(0.05, 0.95);
+
+  vStack.Clear();
+  vStack.AddParticle(MakeParticle(vE0));
+
+  std::size_t n = 0;
+  while (!vStack.IsEmpty()) {
+    HEPEnergyType const E = vStack.GetNextParticle().GetEnergy();
+    vStack.DeleteLast();
+    ++n;
+    if (E < vCut) { continue; }
+    double const f = fraction(rng);
+    vStack.AddParticle(MakeParticle(E * f));
+    vStack.AddParticle(MakeParticle(E * (1 - f)));
+  }
+  return n;
+}
+
+int main() {
+  HEPEnergyType const E0 = 1e5_GeV;
+  HEPEnergyType const cut = 1_GeV;
+
+  std::size_t nParticles = 0;
+  setup::Stack plain;
+  auto const resultPlain = RunBenchmark(
+      "toy shower, setup::Stack",
+      [&]() { DoNotOptimize(nParticles = RunShower(plain, E0, cut)); }, 0.5);
+  std::cout << "  " << resultPlain.fNanoSecondsPerIteration / nParticles
+            << " ns/particle" << std::endl;
+
+  SlotMapStack<setup::Stack> slotMap;
+  auto const resultSlotMap = RunBenchmark(
+      "toy shower, SlotMapStack<setup::Stack>",
+      [&]() { DoNotOptimize(nParticles = RunShower(slotMap, E0, cut)); }, 0.5);
+  std::cout << "  " << resultSlotMap.fNanoSecondsPerIteration / nParticles
+            << " ns/particle" << std::endl;
+
+  // random access to a shuffled stack
+  int const nStack = 10000;
+  slotMap.Clear();
+  std::vector<int> indices;
+  std::vector<ParticleHandle> handles;
+  for (int i = 0; i < nStack; ++i) {
+    auto const p = slotMap.AddParticle(MakeParticle((i + 1) * 1_GeV));
+    handles.push_back(p.GetHandle());
+    indices.push_back(i);
+  }
+  std::mt19937 rng(4321);
+  for (int i = nStack - 1; i > 0; --i) {
+    int const j = std::uniform_int_distribution<int>(0, i)(rng);
+    slotMap.Swap(slotMap.begin() + i, slotMap.begin() + j);
+  }
+  std::shuffle(indices.begin(), indices.end(), rng);
+  for (int i = 0; i < nStack; ++i) {
+    handles[i] = (slotMap.begin() + indices[i]).GetHandle();
+  }
+
+  auto const resultIndex = RunBenchmark("random access, index", [&]() {
+    HEPEnergyType sum = 0_GeV;
+    for (int const i : indices) { sum += (slotMap.begin() + i).GetEnergy(); }
+    DoNotOptimize(sum);
+  });
+  std::cout << "  " << resultIndex.fNanoSecondsPerIteration / nStack << " ns/access"
+            << std::endl;
+
+  auto const resultHandle = RunBenchmark("random access, ParticleHandle", [&]() {
+    HEPEnergyType sum = 0_GeV;
+    for (auto const& h : handles) { sum += slotMap.GetParticle(h).GetEnergy(); }
+    DoNotOptimize(sum);
+  });
+  std::cout << "  " << resultHandle.fNanoSecondsPerIteration / nStack << " ns/access"
+            << std::endl;
+}
@@ -0,0 +1,110 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/stack/slot_map/SlotMapStackExtension.h>
+#include <corsika/stack/super_stupid/SuperStupidStack.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <catch2/catch.hpp>
+
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+using namespace corsika;
+using namespace corsika::geometry;
+using namespace corsika::stack::slot_map;
+using namespace corsika::units::si;
+
+using TestStack = SlotMapStack<corsika::stack::super_stupid::SuperStupidStack>;
+
+TEST_CASE("SlotMapStackExtension", "[stack]") {
+
+  geometry::CoordinateSystem& dummyCS =
+      geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+
+  auto particle = [&](HEPEnergyType const vE) {
+    return std::tuple<particles::Code, HEPEnergyType, corsika::stack::MomentumVector,
+                      geometry::Point, TimeType>{
+        particles::Code::Electron, vE,
+        corsika::stack::MomentumVector(dummyCS, {0_GeV, 0_GeV, vE}),
+        Point(dummyCS, {0_m, 0_m, 0_m}), 0_s};
+  };
+
+  TestStack s;
+  std::vector<ParticleHandle> handles;
+  for (int i = 0; i < 5; ++i) {
+    handles.push_back(s.AddParticle(particle((i + 1) * 1_GeV)).GetHandle());
+  }
+
+  SECTION("lookup") {
+    for (int i = 0; i < 5; ++i) {
+      CHECK(s.IsValid(handles[i]));
+      CHECK(s.GetParticle(handles[i]).GetEnergy() == (i + 1) * 1_GeV);
+    }
+  }
+
+  SECTION("swap") {
+    s.Swap(s.begin(), s.begin() + 4);
+    CHECK(s.GetParticle(handles[0]).GetEnergy() == 1_GeV);
+    CHECK(s.GetParticle(handles[4]).GetEnergy() == 5_GeV);
+    CHECK(s.begin().GetHandle() == handles[4]);
+  }
+
+  SECTION("delete") {
+    // the last particle is moved into the gap, its handle follows it
+    s.Delete(s.begin() + 1);
+    CHECK(s.GetSize() == 4);
+    CHECK_FALSE(s.IsValid(handles[1]));
+    CHECK_THROWS_AS(s.GetParticle(handles[1]), std::runtime_error);
+    for (int i : {0, 2, 3, 4}) {
+      CHECK(s.GetParticle(handles[i]).GetEnergy() == (i + 1) * 1_GeV);
+    }
+
+    s.GetNextParticle().Delete();
+    CHECK_FALSE(s.IsValid(handles[3]));
+
+    // recycled slots come with a new generation
+    auto const h = s.AddParticle(particle(10_GeV)).GetHandle();
+    CHECK(h != handles[1]);
+    CHECK(h != handles[3]);
+    CHECK_FALSE(s.IsValid(handles[1]));
+    CHECK_FALSE(s.IsValid(handles[3]));
+    CHECK(s.GetParticle(h).GetEnergy() == 10_GeV);
+  }
+
+  SECTION("copy") {
+    s.Copy(s.begin() + 4, s.begin());
+    CHECK_FALSE(s.IsValid(handles[0]));
+    CHECK(s.begin().GetHandle() == handles[4]);
+    CHECK((s.begin() + 4).GetHandle() != handles[4]);
+  }
+
+  SECTION("clear") {
+    s.Clear();
+    for (auto const& h : handles) { CHECK_FALSE(s.IsValid(h)); }
+    CHECK_FALSE(s.IsValid(ParticleHandle{1000, 0}));
+  }
+
+  SECTION("secondaries") {
+    using StackView =
+        SlotMapStackView<corsika::stack::super_stupid::SuperStupidStack>;
+    auto p = s.GetNextParticle();
+    StackView view(p);
+    auto projectile = view.GetProjectile();
+    auto const h1 = projectile.AddSecondary(particle(0.5_GeV)).GetHandle();
+    auto const h2 = projectile.AddSecondary(particle(0.25_GeV)).GetHandle();
+    CHECK(s.GetSize() == 7);
+    CHECK(s.GetParticle(h1).GetEnergy() == 0.5_GeV);
+    CHECK(s.GetParticle(h2).GetEnergy() == 0.25_GeV);
+    CHECK(p.GetHandle() == handles[4]);
+  }
+}
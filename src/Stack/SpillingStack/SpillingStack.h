@@ -0,0 +1,350 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#ifndef _include_spillingstack_h_
+#define _include_spillingstack_h_
+
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/geometry/Vector.h>
+#include <corsika/particles/ParticleProperties.h>
+#include <corsika/stack/Stack.h>
+#include <corsika/stack/super_stupid/SuperStupidStack.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace corsika::stack {
+
+  namespace spilling {
+
+    /**
+     * Memory implementation of a particle stack for showers that do not fit
+     * into RAM.
+     *
+     * The top of the stack, where the cascade works, is kept in RAM (the
+     * "hot" window). When the hot window grows beyond GetMaxHotSize()
+     * particles, its oldest GetChunkSize() particles are copied in one
+     * block to a memory-mapped temporary file and released from RAM. When
+     * the hot window has drained, the most recently spilled chunk is
+     * copied back in one block. The hot window is a ring buffer, so neither
+     * moves the particles that stay in RAM.
+     *
+     * The I/O is left to the kernel: spilled pages are handed over with
+     * msync(MS_ASYNC) and dropped from the process, and the chunk to be
+     * reloaded next is announced with madvise(MADV_WILLNEED) well before it
+     * is needed, so the cascade does not wait for the disk in the normal
+     * case. Particles in the file remain accessible by index, e.g. for
+     * StackInspector, only more slowly.
+     *
+     * Momenta and positions are stored as plain numbers in the root
+     * coordinate system. The ParticleInterface is that of SuperStupidStack.
+     */
+    class SpillingStackImpl {
+
+    public:
+      /// the binary layout of one particle, in RAM and on disk
+      struct ParticleRecord {
+        double fEnergy;
+        double fMomentum[3];
+        double fPosition[3];
+        double fTime;
+        corsika::particles::Code fPID;
+      };
+
+      static constexpr std::size_t kDefaultMaxHotSize = 1 << 20;
+
+      /**
+       * \param vMaxHotSize number of particles kept in RAM
+       * \param vChunkSize number of particles spilled or reloaded at once,
+       * by default half of vMaxHotSize
+       * \param vDirectory where the temporary file is created, by default
+       * the system's temporary directory
+       */
+      SpillingStackImpl(std::size_t const vMaxHotSize = kDefaultMaxHotSize,
+                        std::size_t const vChunkSize = 0,
+                        std::string const& vDirectory = "")
+          : fMaxHotSize(vMaxHotSize)
+          , fChunkSize(vChunkSize ? vChunkSize : vMaxHotSize / 2)
+          , fDirectory(vDirectory.empty()
+                           ? std::filesystem::temp_directory_path().string()
+                           : vDirectory) {
+        if (fChunkSize == 0 || fChunkSize > fMaxHotSize) {
+          throw std::runtime_error(
+              "SpillingStack: chunk size must be > 0 and <= the hot size");
+        }
+        // uninitialised, the pages are touched only when used
+        fHot.reset(new ParticleRecord[fHotCapacity]);
+      }
+
+      ~SpillingStackImpl() {
+        if (fCold) { ::munmap(fCold, fColdCapacity * sizeof(ParticleRecord)); }
+        if (fFile >= 0) { ::close(fFile); }
+      }
+
+      SpillingStackImpl(SpillingStackImpl const&) = delete;
+      SpillingStackImpl& operator=(SpillingStackImpl const&) = delete;
+
+      void Init() {}
+      void Dump() const {}
+
+      void Clear() {
+        fHotBegin = 0;
+        fHotSize = 0;
+        fBase = 0;
+      }
+
+      unsigned int GetSize() const { return fBase + fHotSize; }
+      unsigned int GetCapacity() const { return GetSize(); }
+
+      void SetPID(const unsigned int i, const corsika::particles::Code id) {
+        At(i).fPID = id;
+      }
+      void SetEnergy(const unsigned int i, const corsika::units::si::HEPEnergyType e) {
+        At(i).fEnergy = e.magnitude();
+      }
+      void SetMomentum(const unsigned int i, const MomentumVector& v) {
+        auto const& p = v.GetComponents(GetRootCS()).eVector;
+        std::copy(p.data(), p.data() + 3, At(i).fMomentum);
+      }
+      void SetPosition(const unsigned int i, const corsika::geometry::Point& v) {
+        auto const& x = v.GetCoordinates(GetRootCS()).eVector;
+        std::copy(x.data(), x.data() + 3, At(i).fPosition);
+      }
+      void SetTime(const unsigned int i, const corsika::units::si::TimeType& v) {
+        At(i).fTime = v.magnitude();
+      }
+
+      /// all data at once, momentum and position in the root coordinate system
+      void SetParticle(
+          const unsigned int i, const corsika::particles::Code id,
+          const corsika::units::si::HEPEnergyType e,
+          const geometry::QuantityVector<corsika::units::si::hepmomentum_d>& p,
+          const geometry::QuantityVector<corsika::units::si::length_d>& x,
+          const corsika::units::si::TimeType t) {
+        auto& r = At(i);
+        r.fPID = id;
+        r.fEnergy = e.magnitude();
+        std::copy(p.eVector.data(), p.eVector.data() + 3, r.fMomentum);
+        std::copy(x.eVector.data(), x.eVector.data() + 3, r.fPosition);
+        r.fTime = t.magnitude();
+      }
+
+      corsika::particles::Code GetPID(const unsigned int i) const { return At(i).fPID; }
+      corsika::units::si::HEPEnergyType GetEnergy(const unsigned int i) const {
+        return corsika::units::si::HEPEnergyType(phys::units::detail::magnitude_tag,
+                                                 At(i).fEnergy);
+      }
+      MomentumVector GetMomentum(const unsigned int i) const {
+        double const* p = At(i).fMomentum;
+        return MomentumVector(
+            GetRootCS(), geometry::QuantityVector<corsika::units::si::hepmomentum_d>(
+                             Eigen::Vector3d(p[0], p[1], p[2])));
+      }
+      corsika::geometry::Point GetPosition(const unsigned int i) const {
+        double const* x = At(i).fPosition;
+        return corsika::geometry::Point(
+            GetRootCS(), geometry::QuantityVector<corsika::units::si::length_d>(
+                             Eigen::Vector3d(x[0], x[1], x[2])));
+      }
+      corsika::units::si::TimeType GetTime(const unsigned int i) const {
+        return corsika::units::si::TimeType(phys::units::detail::magnitude_tag,
+                                            At(i).fTime);
+      }
+
+      /**
+       *   Function to copy particle at location i1 in stack to i2
+       */
+      void Copy(const unsigned int i1, const unsigned int i2) { At(i2) = At(i1); }
+
+      /**
+       *   Function to swap particles at locations i1 and i2 in stack
+       */
+      void Swap(const unsigned int i1, const unsigned int i2) {
+        std::swap(At(i1), At(i2));
+      }
+
+      void IncrementSize() {
+        ++fHotSize;
+        At(GetSize() - 1) = ParticleRecord{0, {0, 0, 0}, {0, 0, 0}, 0,
+                                           corsika::particles::Code::Unknown};
+        if (fHotSize > fMaxHotSize) { Spill(); }
+      }
+
+      void DecrementSize() {
+        if (GetSize() == 0) { return; }
+        if (fHotSize == 0) { Reload(); }
+        --fHotSize;
+        if (fBase == 0) { return; }
+        if (fHotSize == fChunkSize / 4) { Prefetch(); }
+        if (fHotSize == 0) { Reload(); }
+      }
+
+      /// @name configuration and statistics
+      /// @{
+      std::size_t GetMaxHotSize() const { return fMaxHotSize; }
+      std::size_t GetChunkSize() const { return fChunkSize; }
+      std::size_t GetHotSize() const { return fHotSize; }
+      std::size_t GetSpilledSize() const { return fBase; }
+      std::size_t GetNumberOfSpills() const { return fNSpills; }
+      std::size_t GetNumberOfReloads() const { return fNReloads; }
+      /// @}
+
+    private:
+      static corsika::geometry::CoordinateSystem const& GetRootCS() {
+        return corsika::geometry::RootCoordinateSystem::GetInstance()
+            .GetRootCoordinateSystem();
+      }
+
+      ParticleRecord& At(unsigned int const i) {
+        return i >= fBase ? fHot[HotSlot(i - fBase)] : fCold[i];
+      }
+      ParticleRecord const& At(unsigned int const i) const {
+        return i >= fBase ? fHot[HotSlot(i - fBase)] : fCold[i];
+      }
+
+      /// the slot of the vOffset-th particle of the hot window in fHot
+      std::size_t HotSlot(std::size_t const vOffset) const {
+        std::size_t const slot = fHotBegin + vOffset;
+        return slot < fHotCapacity ? slot : slot - fHotCapacity;
+      }
+
+      /**
+       * calls vCopy(records, position, n) for the up to two contiguous
+       * pieces of the vN hot particles from offset vOffset on, position is
+       * that of the piece within the vN particles
+       */
+      template <typename TCopy>
+      void CopyHot(std::size_t const vOffset, std::size_t const vN, TCopy vCopy) {
+        std::size_t const first = HotSlot(vOffset);
+        std::size_t const n1 = std::min(vN, fHotCapacity - first);
+        vCopy(fHot.get() + first, 0, n1);
+        vCopy(fHot.get(), n1, vN - n1);
+      }
+
+      static void ThrowErrno(std::string const& vWhat) {
+        throw std::runtime_error("SpillingStack: " + vWhat + ": " +
+                                 std::strerror(errno));
+      }
+
+      /// [begin, end) of the records [vFirst, vFirst + vN) in whole pages
+      std::pair<char*, std::size_t> PageRange(std::size_t const vFirst,
+                                              std::size_t const vN) const {
+        std::size_t const page = ::sysconf(_SC_PAGESIZE);
+        auto const begin = reinterpret_cast<std::uintptr_t>(fCold + vFirst);
+        auto const end = reinterpret_cast<std::uintptr_t>(fCold + vFirst + vN);
+        auto const alignedBegin = begin / page * page;
+        return {reinterpret_cast<char*>(alignedBegin), end - alignedBegin};
+      }
+
+      void EnsureColdCapacity(std::size_t const vN) {
+        if (vN <= fColdCapacity) { return; }
+
+        if (fFile < 0) {
+          std::string name = fDirectory + "/corsika_stack_XXXXXX";
+          fFile = ::mkstemp(name.data());
+          if (fFile < 0) { ThrowErrno("cannot create file in " + fDirectory); }
+          ::unlink(name.c_str()); // removed automatically when closed
+        }
+
+        std::size_t const capacity = std::max({vN, 2 * fColdCapacity, 4 * fChunkSize});
+        if (::ftruncate(fFile, capacity * sizeof(ParticleRecord)) != 0) {
+          ThrowErrno("cannot grow file");
+        }
+        if (fCold) { ::munmap(fCold, fColdCapacity * sizeof(ParticleRecord)); }
+        void* const map = ::mmap(nullptr, capacity * sizeof(ParticleRecord),
+                                 PROT_READ | PROT_WRITE, MAP_SHARED, fFile, 0);
+        if (map == MAP_FAILED) {
+          fCold = nullptr;
+          fColdCapacity = 0;
+          ThrowErrno("cannot map file");
+        }
+        fCold = static_cast<ParticleRecord*>(map);
+        fColdCapacity = capacity;
+      }
+
+      /// move the oldest chunk of the hot window to the file
+      void Spill() {
+        std::size_t const n = fChunkSize;
+        EnsureColdCapacity(fBase + n);
+        ParticleRecord* const cold = fCold + fBase;
+        CopyHot(0, n, [&](ParticleRecord* vHot, std::size_t vAt, std::size_t vN) {
+          std::copy(vHot, vHot + vN, cold + vAt);
+        });
+        auto const [pages, length] = PageRange(fBase, n);
+        ::msync(pages, length, MS_ASYNC);    // start writing back
+        ::madvise(pages, length, MADV_DONTNEED); // and release the memory
+        fHotBegin = HotSlot(n);
+        fHotSize -= n;
+        fBase += n;
+        ++fNSpills;
+      }
+
+      /// ask the kernel to read the next chunk to be reloaded
+      void Prefetch() const {
+        std::size_t const n = std::min(fChunkSize, fBase);
+        auto const [pages, length] = PageRange(fBase - n, n);
+        ::madvise(pages, length, MADV_WILLNEED);
+      }
+
+      /// move the most recently spilled chunk back into the hot window
+      void Reload() {
+        std::size_t const n = std::min(fChunkSize, fBase);
+        fHotBegin = HotSlot(fHotCapacity - n);
+        fHotSize += n;
+        ParticleRecord const* const cold = fCold + fBase - n;
+        CopyHot(0, n, [&](ParticleRecord* vHot, std::size_t vAt, std::size_t vN) {
+          std::copy(cold + vAt, cold + vAt + vN, vHot);
+        });
+        auto const [pages, length] = PageRange(fBase - n, n);
+        ::madvise(pages, length, MADV_DONTNEED);
+        fBase -= n;
+        ++fNReloads;
+      }
+
+      std::size_t const fMaxHotSize;
+      std::size_t const fChunkSize;
+      std::string const fDirectory;
+
+      std::size_t const fHotCapacity = fMaxHotSize + 1;
+      //! ring buffer of the particles [fBase, GetSize()), starting at fHotBegin
+      std::unique_ptr<ParticleRecord[]> fHot;
+      std::size_t fHotBegin = 0;
+      std::size_t fHotSize = 0;
+      std::size_t fBase = 0; //!< number of particles in the file
+      int fFile = -1;
+      ParticleRecord* fCold = nullptr; //!< the mapped file, particles [0, fBase)
+      std::size_t fColdCapacity = 0;
+
+      std::size_t fNSpills = 0;
+      std::size_t fNReloads = 0;
+    }; // end class SpillingStackImpl
+
+    typedef Stack<SpillingStackImpl, super_stupid::ParticleInterface> SpillingStack;
+
+  } // namespace spilling
+
+} // namespace corsika::stack
+
+#endif
@@ -0,0 +1,131 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/stack/spilling/SpillingStack.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <catch2/catch.hpp>
+
+#include <tuple>
+#include <vector>
+
+using namespace corsika;
+using namespace corsika::geometry;
+using namespace corsika::stack::spilling;
+using namespace corsika::units::si;
+
+TEST_CASE("SpillingStack", "[stack]") {
+
+  geometry::CoordinateSystem& rootCS =
+      geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+
+  auto particle = [&](int const i) {
+    return std::tuple<particles::Code, HEPEnergyType, stack::MomentumVector, Point,
+                      TimeType>{
+        particles::Code::Electron, i * 1_GeV,
+        stack::MomentumVector(rootCS, {1_GeV, 2_GeV, i * 1_GeV}),
+        Point(rootCS, {1_m, i * 1_m, 3_m}), i * 1_s};
+  };
+
+  SECTION("read+write") {
+    SpillingStack s;
+    s.AddParticle(particle(7));
+
+    REQUIRE(s.GetSize() == 1);
+    auto p = s.GetNextParticle();
+    CHECK(p.GetPID() == particles::Code::Electron);
+    CHECK(p.GetEnergy() == 7_GeV);
+    CHECK(p.GetMomentum().GetComponents(rootCS).GetZ() == 7_GeV);
+    CHECK(p.GetPosition().GetCoordinates(rootCS).GetY() == 7_m);
+    CHECK(p.GetTime() == 7_s);
+  }
+
+  SECTION("spill and reload") {
+    SpillingStack s(100, 40);
+    int const n = 1000;
+    for (int i = 0; i < n; ++i) { s.AddParticle(particle(i)); }
+    REQUIRE(s.GetSize() == n);
+
+    // all particles remain accessible by index
+    int i = 0;
+    for (auto const& p : s) {
+      CHECK(p.GetEnergy() == i * 1_GeV);
+      CHECK(p.GetPosition().GetCoordinates(rootCS).GetY() == i * 1_m);
+      ++i;
+    }
+
+    // swap particles in file and RAM
+    s.Swap(s.begin(), s.last());
+    CHECK(s.begin().GetEnergy() == (n - 1) * 1_GeV);
+    CHECK(s.last().GetEnergy() == 0_GeV);
+    s.Swap(s.begin(), s.last());
+
+    // works off the stack like the cascade
+    for (int j = n - 1; j >= 0; --j) {
+      REQUIRE(s.GetNextParticle().GetEnergy() == j * 1_GeV);
+      s.GetNextParticle().Delete();
+      if (j % 7 == 0) { // some secondaries now and then
+        s.AddParticle(particle(-1));
+        s.AddParticle(particle(-2));
+        s.GetNextParticle().Delete();
+        s.GetNextParticle().Delete();
+      }
+    }
+    CHECK(s.IsEmpty());
+  }
+
+  SECTION("hot window") {
+    SpillingStackImpl impl(100, 40);
+    for (int i = 0; i < 1000; ++i) {
+      impl.IncrementSize();
+      impl.SetEnergy(i, i * 1_GeV);
+      CHECK(impl.GetHotSize() <= 100);
+    }
+    CHECK(impl.GetSpilledSize() + impl.GetHotSize() == 1000);
+    CHECK(impl.GetNumberOfSpills() == 23);
+
+    for (int i = 999; i >= 0; --i) {
+      REQUIRE(impl.GetEnergy(i) == i * 1_GeV);
+      impl.DecrementSize();
+      if (impl.GetSize() > 0) { CHECK(impl.GetHotSize() > 0); }
+    }
+    CHECK(impl.GetNumberOfReloads() == 23);
+    CHECK(impl.GetSpilledSize() == 0);
+  }
+
+  SECTION("ring buffer") {
+    // spills and reloads at varying positions of the hot window
+    SpillingStackImpl impl(10, 4);
+    std::vector<int> reference;
+    for (int step = 0; step < 200; ++step) {
+      bool const push = reference.empty() || (step / 13) % 3 != 2;
+      if (push) {
+        impl.IncrementSize();
+        impl.SetEnergy(impl.GetSize() - 1, step * 1_GeV);
+        reference.push_back(step);
+      } else {
+        impl.DecrementSize();
+        reference.pop_back();
+      }
+      REQUIRE(impl.GetSize() == reference.size());
+      for (std::size_t i = 0; i < reference.size(); ++i) {
+        REQUIRE(impl.GetEnergy(i) == reference[i] * 1_GeV);
+      }
+    }
+    CHECK(impl.GetNumberOfSpills() > 0);
+    CHECK(impl.GetNumberOfReloads() > 0);
+  }
+
+  SECTION("configuration") {
+    CHECK_THROWS(SpillingStackImpl(10, 20));
+    CHECK(SpillingStackImpl(10).GetChunkSize() == 5);
+  }
+}
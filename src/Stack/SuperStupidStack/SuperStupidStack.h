@@ -20,6 +20,7 @@
 #include <corsika/geometry/Vector.h>
 
 #include <algorithm>
+#include <utility>
 #include <vector>
 
 namespace corsika::stack {
@@ -72,6 +73,26 @@ namespace corsika::stack {
         SetPosition(std::get<3>(v));
         SetTime(std::get<4>(v));
       }
+      /**
+       * Raw data, see ParticleBase::EmplaceSecondary: the momentum and the
+       * position are the components in the root coordinate system.
+       */
+      void SetParticleData(
+          EmplaceTag, const corsika::particles::Code vPID,
+          const corsika::units::si::HEPEnergyType vE,
+          const corsika::geometry::QuantityVector<corsika::units::si::hepmomentum_d>&
+              vMomentum,
+          const corsika::geometry::QuantityVector<corsika::units::si::length_d>&
+              vPosition,
+          const corsika::units::si::TimeType vTime) {
+        GetStackData().SetParticle(GetIndex(), vPID, vE, vMomentum, vPosition, vTime);
+      }
+      template <typename... TArgs>
+      void SetParticleData(ParticleInterface<StackIteratorInterface>&, EmplaceTag,
+                           TArgs&&... v) {
+        SetParticleData(EmplaceTag{}, std::forward<TArgs>(v)...);
+      }
+
       /*      void SetParticleData(ParticleInterface<StackIteratorInterface>&,
                            const corsika::particles::Code vDataPID,
                            const corsika::units::si::HEPEnergyType vDataE,
@@ -173,6 +194,22 @@ namespace corsika::stack {
         fTime[i] = v;
       }
 
+      /// all data at once, momentum and position in the root coordinate system
+      void SetParticle(
+          const unsigned int i, const corsika::particles::Code id,
+          const corsika::units::si::HEPEnergyType e,
+          const corsika::geometry::QuantityVector<corsika::units::si::hepmomentum_d>& p,
+          const corsika::geometry::QuantityVector<corsika::units::si::length_d>& x,
+          const corsika::units::si::TimeType t) {
+        geometry::CoordinateSystem const& rootCS =
+            geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+        fDataPID[i] = id;
+        fDataE[i] = e;
+        fMomentum[i] = MomentumVector(rootCS, p);
+        fPosition[i] = corsika::geometry::Point(rootCS, x);
+        fTime[i] = t;
+      }
+
       corsika::particles::Code GetPID(const unsigned int i) const { return fDataPID[i]; }
       corsika::units::si::HEPEnergyType GetEnergy(const unsigned int i) const {
         return fDataE[i];
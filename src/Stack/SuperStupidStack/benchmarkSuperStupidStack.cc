@@ -0,0 +1,96 @@
+/*
+ * (c) Copyright 2019 CORSIKA Project, corsika-project@lists.kit.edu
+ *
+ * See file AUTHORS for a list of contributors.
+ *
+ * This software is distributed under the terms of the GNU General Public
+ * Licence version 3 (GPL Version 3). See file LICENSE for a full version of
+ * the license.
+ */
+
+/**
+ * Basic operations of SuperStupidStack: adding particles, deleting them
+ * from the top and from the middle, iterating over the stack, and
+ * creating a SecondaryView and adding secondaries through it.
+ */
+
+#include <corsika/geometry/Point.h>
+#include <corsika/geometry/RootCoordinateSystem.h>
+#include <corsika/stack/SecondaryView.h>
+#include <corsika/stack/super_stupid/SuperStupidStack.h>
+#include <corsika/testing/Benchmark.h>
+#include <corsika/units/PhysicalUnits.h>
+
+#include <iostream>
+#include <tuple>
+
+using namespace corsika;
+using namespace corsika::units::si;
+using corsika::stack::super_stupid::SuperStupidStack;
+using corsika::testing::DoNotOptimize;
+using corsika::testing::RunBenchmark;
+
+using StackView = corsika::stack::SecondaryView<stack::super_stupid::SuperStupidStackImpl,
+                                                stack::super_stupid::ParticleInterface>;
+using ParticleTuple = std::tuple<particles::Code, HEPEnergyType, stack::MomentumVector,
+                                 geometry::Point, TimeType>;
+
+int main() {
+  auto const& rootCS =
+      geometry::RootCoordinateSystem::GetInstance().GetRootCoordinateSystem();
+  ParticleTuple const particle{particles::Code::Electron, 1_GeV,
+                               stack::MomentumVector(rootCS, {0_GeV, 0_GeV, 1_GeV}),
+                               geometry::Point(rootCS, {0_m, 0_m, 0_m}), 0_ns};
+
+  int const n = 1000;
+  SuperStupidStack s;
+
+  auto const add = RunBenchmark("SuperStupidStack AddParticle", [&]() {
+    s.Clear();
+    for (int i = 0; i < n; ++i) { s.AddParticle(particle); }
+    DoNotOptimize(s.GetSize());
+  });
+  std::cout << "  " << add.fNanoSecondsPerIteration / n << " ns/particle" << std::endl;
+
+  auto const deleteLast = RunBenchmark("SuperStupidStack AddParticle+DeleteLast", [&]() {
+    s.Clear();
+    for (int i = 0; i < n; ++i) { s.AddParticle(particle); }
+    while (!s.IsEmpty()) { s.DeleteLast(); }
+  });
+  std::cout << "  " << deleteLast.fNanoSecondsPerIteration / n << " ns/particle"
+            << std::endl;
+
+  auto const deleteFirst =
+      RunBenchmark("SuperStupidStack AddParticle+Delete(begin)", [&]() {
+        s.Clear();
+        for (int i = 0; i < n; ++i) { s.AddParticle(particle); }
+        while (!s.IsEmpty()) { s.Delete(s.begin()); }
+      });
+  std::cout << "  " << deleteFirst.fNanoSecondsPerIteration / n << " ns/particle"
+            << std::endl;
+
+  s.Clear();
+  for (int i = 0; i < n; ++i) { s.AddParticle(particle); }
+  auto const iterate = RunBenchmark("SuperStupidStack iterate GetEnergy", [&]() {
+    HEPEnergyType sum = 0_GeV;
+    for (auto const& p : s) { sum += p.GetEnergy(); }
+    DoNotOptimize(sum);
+  });
+  std::cout << "  " << iterate.fNanoSecondsPerIteration / n << " ns/particle"
+            << std::endl;
+
+  auto projectile = s.GetNextParticle();
+  RunBenchmark("SecondaryView construction", [&]() {
+    StackView view(projectile);
+    DoNotOptimize(view.GetSize());
+  });
+
+  RunBenchmark("SecondaryView with 2 secondaries", [&]() {
+    StackView view(projectile);
+    view.AddSecondary(particle);
+    view.AddSecondary(particle);
+    DoNotOptimize(view.GetSize());
+    view.DeleteLast();
+    view.DeleteLast();
+  });
+}
@@ -67,4 +67,27 @@ TEST_CASE("SuperStupidStack", "[stack]") {
 
     REQUIRE(s.GetSize() == 0);
   }
+
+  SECTION("emplace") {
+
+    SuperStupidStack s;
+    auto p = s.EmplaceParticle(
+        particles::Code::Electron, 1.5_GeV,
+        geometry::QuantityVector<hepmomentum_d>{1_GeV, 2_GeV, 3_GeV},
+        geometry::QuantityVector<length_d>{1_m, 2_m, 3_m}, 100_s);
+    auto const sec = p.EmplaceSecondary(
+        particles::Code::Gamma, 0.5_GeV,
+        geometry::QuantityVector<hepmomentum_d>{0_GeV, 0_GeV, 0.5_GeV},
+        geometry::QuantityVector<length_d>{4_m, 5_m, 6_m}, 1_s);
+
+    REQUIRE(s.GetSize() == 2);
+    CHECK(p.GetPID() == particles::Code::Electron);
+    CHECK(p.GetEnergy() == 1.5_GeV);
+    CHECK(p.GetMomentum().GetComponents(dummyCS).GetZ() == 3_GeV);
+    CHECK(p.GetPosition().GetCoordinates(dummyCS).GetY() == 2_m);
+    CHECK(p.GetTime() == 100_s);
+    CHECK(sec.GetPID() == particles::Code::Gamma);
+    CHECK(sec.GetMomentum().GetComponents(dummyCS).GetZ() == 0.5_GeV);
+    CHECK(sec.GetPosition().GetCoordinates(dummyCS).GetZ() == 6_m);
+  }
 }